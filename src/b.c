@@ -76,6 +76,9 @@ wbk_b_clone(const wbk_b_t *other)
 		b = wbk_b_new();
 		memcpy(b->modifier_map, other->modifier_map, sizeof(wbk_mk_t) * WBK_B_MODIFER_MAP_LEN);
 		memcpy(b->key_map, other->key_map, sizeof(char) * WBK_B_KEY_MAP_LEN);
+		b->key_last = other->key_last;
+		b->ignore_mask = other->ignore_mask;
+		b->trigger = other->trigger;
 	}
 
 	return b;
@@ -93,6 +96,9 @@ wbk_b_reset(wbk_b_t *b)
 {
 	memset(b->modifier_map, 0, sizeof(wbk_mk_t) * WBK_B_MODIFER_MAP_LEN);
 	memset(b->key_map, 0, sizeof(char) * WBK_B_KEY_MAP_LEN);
+	b->key_last = '\0';
+	b->ignore_mask = 0;
+	b->trigger = TRIGGER_PRESS;
 
 	return 0;
 }
@@ -106,6 +112,7 @@ wbk_b_add(wbk_b_t *b, const wbk_be_t *be)
 	if (b->modifier_map[wbk_be_get_modifier(be)] == 0
 		|| b->key_map[wbk_be_get_key(be)] == 0) {
 	  b->modifier_map[wbk_be_get_modifier(be)] = 1;
+	  b->modifier_map[wbk_be_mk_get_generic(wbk_be_get_modifier(be))] = 1;
 	  b->key_map[wbk_be_get_key(be)] = 1;
       ret = 0;
     }
@@ -122,6 +129,9 @@ wbk_b_remove(wbk_b_t *b, const wbk_be_t *be)
 	if (b->modifier_map[wbk_be_get_modifier(be)] != 0
 		|| b->key_map[wbk_be_get_key(be)] != 0) {
 	  b->modifier_map[wbk_be_get_modifier(be)] = 0;
+	  if (wbk_b_is_implied(b, wbk_be_mk_get_generic(wbk_be_get_modifier(be))) == 0) {
+	    b->modifier_map[wbk_be_mk_get_generic(wbk_be_get_modifier(be))] = 0;
+	  }
 	  b->key_map[wbk_be_get_key(be)] = 0;
 	  ret = 0;
     }
@@ -134,22 +144,124 @@ wbk_b_contains(wbk_b_t *b, const wbk_be_t *be)
 {
 	int found;
 
-	found = 0;
-	if (b->modifier_map[wbk_be_get_modifier(be)] != 0
-		|| b->key_map[wbk_be_get_key(be)] != 0) {
-		found = 0;
+	if (wbk_be_get_modifier(be) != NOT_A_MODIFIER) {
+		found = b->modifier_map[wbk_be_get_modifier(be)] != 0;
+	} else {
+		found = b->key_map[(unsigned char) wbk_be_get_key(be)] != 0;
 	}
 
 	return found;
 }
 
+char
+wbk_b_get_key(const wbk_b_t *b)
+{
+	int i;
+
+	for (i = 1; i < WBK_B_KEY_MAP_LEN && b->key_map[i] == 0; i++) {
+		/* Find the key */
+	}
+
+	return i < WBK_B_KEY_MAP_LEN ? (char) i : '\0';
+}
+
+int
+wbk_b_is_implied(const wbk_b_t *b, wbk_mk_t modifier)
+{
+	int implied;
+
+	switch (modifier) {
+	case WIN:
+		implied = b->modifier_map[LWIN] || b->modifier_map[RWIN];
+		break;
+
+	case ALT:
+		implied = b->modifier_map[LALT] || b->modifier_map[RALT];
+		break;
+
+	case CTRL:
+		implied = b->modifier_map[LCTRL] || b->modifier_map[RCTRL];
+		break;
+
+	case SHIFT:
+		implied = b->modifier_map[LSHIFT] || b->modifier_map[RSHIFT];
+		break;
+
+	default:
+		implied = 0;
+	}
+
+	return implied;
+}
+
+int
+wbk_b_matches(const wbk_b_t *range, const wbk_b_t *b)
+{
+	unsigned char key;
+	int matches;
+	int i;
+
+	key = (unsigned char) wbk_b_get_key(b);
+
+	matches = range->key_last != '\0'
+	          && b->key_last == '\0'
+	          && range->trigger == b->trigger
+	          && key >= (unsigned char) wbk_b_get_key(range)
+	          && key <= (unsigned char) range->key_last;
+
+	for (i = 0; matches && i < WBK_B_MODIFER_MAP_LEN; i++) {
+		matches = (range->ignore_mask & (uint64_t) 1 << i)
+		          || range->modifier_map[i] == b->modifier_map[i];
+	}
+
+	/**
+	 * Combinations of more than one key are never matched by a range
+	 */
+	for (i = key + 1; matches && i < WBK_B_KEY_MAP_LEN; i++) {
+		matches = b->key_map[i] == 0;
+	}
+
+	return matches;
+}
+
 inline int
 wbk_b_compare(const wbk_b_t *b, const wbk_b_t *other)
 {
-	return memcmp(b->modifier_map, other->modifier_map, WBK_B_MODIFER_MAP_LEN * sizeof(wbk_mk_t))
+	return b->trigger != other->trigger
+		   || b->key_last != other->key_last
+		   || b->ignore_mask != other->ignore_mask
+		   || memcmp(b->modifier_map, other->modifier_map, WBK_B_MODIFER_MAP_LEN * sizeof(wbk_mk_t))
 		   || memcmp(b->key_map, other->key_map, WBK_B_KEY_MAP_LEN * sizeof(char));
 }
 
+unsigned int
+wbk_b_hash(const wbk_b_t *b)
+{
+	unsigned int hash;
+	const unsigned char *bytes;
+	int i;
+
+	/*
+	 * FNV-1a over the trigger, the key range, the ignored modifiers and both
+	 * maps
+	 */
+	hash = (2166136261u ^ b->trigger) * 16777619u;
+	hash = (hash ^ (unsigned char) b->key_last) * 16777619u;
+	hash = (hash ^ (unsigned int) (b->ignore_mask ^ b->ignore_mask >> 32)) * 16777619u;
+
+	bytes = (const unsigned char *) b->modifier_map;
+	for (i = 0; i < WBK_B_MODIFER_MAP_LEN * (int) sizeof(wbk_mk_t); i++) {
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+
+	bytes = (const unsigned char *) b->key_map;
+	for (i = 0; i < WBK_B_KEY_MAP_LEN * (int) sizeof(char); i++) {
+		hash = (hash ^ bytes[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
 char *
 wbk_b_to_str(const wbk_b_t *b)
 {
@@ -162,8 +274,49 @@ wbk_b_to_str(const wbk_b_t *b)
 	str[0] = '\0';
 	str_cur_pos = 0;
 
-	for (i = 0; i < WBK_B_MODIFER_MAP_LEN; i++) {
-		if (b->modifier_map[i] == 1) {
+	switch (b->trigger) {
+	case TRIGGER_TAP:
+		strcpy(str, TAP_STR);
+		break;
+
+	case TRIGGER_HOLD:
+		strcpy(str, HOLD_STR);
+		break;
+
+	case TRIGGER_DOUBLE_TAP:
+		strcpy(str, DOUBLE_TAP_STR);
+		break;
+
+	case TRIGGER_CHORD:
+		strcpy(str, CHORD_STR);
+		break;
+
+	case TRIGGER_RELEASE:
+		strcpy(str, RELEASE_STR);
+		break;
+
+	default:
+		break;
+	}
+	str_cur_pos = strlen(str);
+
+	/**
+	 * Ignoring the lock modifiers and the sides is the default of the rc file
+	 */
+	if (b->ignore_mask & ~(WBK_B_LOCK_MASK | WBK_B_SIDE_MASK)) {
+		if (str_cur_pos > 0) {
+			strcpy(str + str_cur_pos, " + ");
+			str_cur_pos += 3;
+		}
+		strcpy(str + str_cur_pos, ANY_STR);
+		str_cur_pos += strlen(ANY_STR);
+	}
+
+	/**
+	 * Generic modifiers held along with a side are written as the side only
+	 */
+	for (i = NOT_A_MODIFIER + 1; i < WBK_B_MODIFER_MAP_LEN; i++) {
+		if (b->modifier_map[i] == 1 && wbk_b_is_implied(b, i) == 0) {
 			if (str_cur_pos > 0) {
 				str[str_cur_pos++] = ' ';
 				str[str_cur_pos++] = '+';
@@ -276,13 +429,126 @@ wbk_b_to_str(const wbk_b_t *b)
 				str_cur_pos += strlen(F12_STR);
 				break;
 
+			case MOUSE_LEFT:
+				strcpy(str+str_cur_pos, MOUSE_LEFT_STR);
+				str_cur_pos += strlen(MOUSE_LEFT_STR);
+				break;
+
+			case MOUSE_MIDDLE:
+				strcpy(str+str_cur_pos, MOUSE_MIDDLE_STR);
+				str_cur_pos += strlen(MOUSE_MIDDLE_STR);
+				break;
+
+			case MOUSE_RIGHT:
+				strcpy(str+str_cur_pos, MOUSE_RIGHT_STR);
+				str_cur_pos += strlen(MOUSE_RIGHT_STR);
+				break;
+
+			case WHEEL_UP:
+				strcpy(str+str_cur_pos, WHEEL_UP_STR);
+				str_cur_pos += strlen(WHEEL_UP_STR);
+				break;
+
+			case WHEEL_DOWN:
+				strcpy(str+str_cur_pos, WHEEL_DOWN_STR);
+				str_cur_pos += strlen(WHEEL_DOWN_STR);
+				break;
+
+			case WHEEL_LEFT:
+				strcpy(str+str_cur_pos, WHEEL_LEFT_STR);
+				str_cur_pos += strlen(WHEEL_LEFT_STR);
+				break;
+
+			case WHEEL_RIGHT:
+				strcpy(str+str_cur_pos, WHEEL_RIGHT_STR);
+				str_cur_pos += strlen(WHEEL_RIGHT_STR);
+				break;
+
+			case MOUSE_BACK:
+				strcpy(str+str_cur_pos, MOUSE_BACK_STR);
+				str_cur_pos += strlen(MOUSE_BACK_STR);
+				break;
+
+			case MOUSE_FORWARD:
+				strcpy(str+str_cur_pos, MOUSE_FORWARD_STR);
+				str_cur_pos += strlen(MOUSE_FORWARD_STR);
+				break;
+
+			case LEFT:
+				strcpy(str+str_cur_pos, LEFT_STR);
+				str_cur_pos += strlen(LEFT_STR);
+				break;
+
+			case RIGHT:
+				strcpy(str+str_cur_pos, RIGHT_STR);
+				str_cur_pos += strlen(RIGHT_STR);
+				break;
+
+			case UP:
+				strcpy(str+str_cur_pos, UP_STR);
+				str_cur_pos += strlen(UP_STR);
+				break;
+
+			case DOWN:
+				strcpy(str+str_cur_pos, DOWN_STR);
+				str_cur_pos += strlen(DOWN_STR);
+				break;
+
+			case ESCAPE:
+				strcpy(str+str_cur_pos, ESCAPE_STR);
+				str_cur_pos += strlen(ESCAPE_STR);
+				break;
+
+			case LWIN:
+				strcpy(str+str_cur_pos, LWIN_STR);
+				str_cur_pos += strlen(LWIN_STR);
+				break;
+
+			case RWIN:
+				strcpy(str+str_cur_pos, RWIN_STR);
+				str_cur_pos += strlen(RWIN_STR);
+				break;
+
+			case LALT:
+				strcpy(str+str_cur_pos, LALT_STR);
+				str_cur_pos += strlen(LALT_STR);
+				break;
+
+			case RALT:
+				strcpy(str+str_cur_pos, RALT_STR);
+				str_cur_pos += strlen(RALT_STR);
+				break;
+
+			case LCTRL:
+				strcpy(str+str_cur_pos, LCTRL_STR);
+				str_cur_pos += strlen(LCTRL_STR);
+				break;
+
+			case RCTRL:
+				strcpy(str+str_cur_pos, RCTRL_STR);
+				str_cur_pos += strlen(RCTRL_STR);
+				break;
+
+			case LSHIFT:
+				strcpy(str+str_cur_pos, LSHIFT_STR);
+				str_cur_pos += strlen(LSHIFT_STR);
+				break;
+
+			case RSHIFT:
+				strcpy(str+str_cur_pos, RSHIFT_STR);
+				str_cur_pos += strlen(RSHIFT_STR);
+				break;
+
 			default:
 				break;
 			}
 		}
 	}
 
-	for (i = 0; i < WBK_B_KEY_MAP_LEN; i++) {
+	/**
+	 * Modifiers are tracked as the key 0 too. Skip it.
+	 */
+	for (i = 1; i < WBK_B_KEY_MAP_LEN; i++) {
 		if (b->key_map[i] == 1) {
 			if (str_cur_pos > 0) {
 				str[str_cur_pos++] = ' ';
@@ -290,7 +556,15 @@ wbk_b_to_str(const wbk_b_t *b)
 				str[str_cur_pos++] = ' ';
 			}
 
-			str[str_cur_pos++] = tolower(i);
+			if (b->key_last != '\0') {
+				str[str_cur_pos++] = '[';
+				str[str_cur_pos++] = tolower(i);
+				str[str_cur_pos++] = '-';
+				str[str_cur_pos++] = tolower(b->key_last);
+				str[str_cur_pos++] = ']';
+			} else {
+				str[str_cur_pos++] = tolower(i);
+			}
 			str[str_cur_pos] = '\0';
 		}
 	}
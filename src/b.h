@@ -30,17 +30,109 @@
 
 #include "be.h"
 
+#include <stdint.h>
+
 #ifndef WBK_B_H
 #define WBK_B_H
 
-#define WBK_B_MODIFER_MAP_LEN 30
+#define WBK_B_MODIFER_MAP_LEN 48
 #define WBK_B_KEY_MAP_LEN 256
 
+#define TAP_STR "Tap"
+#define HOLD_STR "Hold"
+#define DOUBLE_TAP_STR "Double"
+#define CHORD_STR "Chord"
+#define RELEASE_STR "Release"
+#define ANY_STR "Any"
+
+/**
+ * The lock modifiers. Bindings of the rc file ignore them unless they name
+ * them.
+ */
+#define WBK_B_LOCK_MASK ((uint64_t) 1 << NUMLOCK | (uint64_t) 1 << CAPSLOCK \
+                         | (uint64_t) 1 << SCROLL)
+
+/**
+ * The left and right modifiers. Bindings of the rc file ignore the sides of
+ * the modifiers, which they do not name a side of, as the generic modifier
+ * is held along with either side.
+ */
+#define WBK_B_SIDE_MASK ((uint64_t) 1 << LWIN | (uint64_t) 1 << RWIN \
+                         | (uint64_t) 1 << LALT | (uint64_t) 1 << RALT \
+                         | (uint64_t) 1 << LCTRL | (uint64_t) 1 << RCTRL \
+                         | (uint64_t) 1 << LSHIFT | (uint64_t) 1 << RSHIFT)
+
+/**
+ * The modifiers ignored by Any
+ */
+#define WBK_B_ANY_MASK ((uint64_t) 1 << WIN | (uint64_t) 1 << ALT \
+                        | (uint64_t) 1 << CTRL | (uint64_t) 1 << SHIFT | WBK_B_LOCK_MASK \
+                        | WBK_B_SIDE_MASK)
+
+/**
+ * @brief When a binding is executed
+ */
+typedef enum wbk_trigger_e {
+	/**
+	 * Once the combination is pressed
+	 */
+	TRIGGER_PRESS = 0,
+
+	/**
+	 * Once the combination is released again within the hold timeout
+	 */
+	TRIGGER_TAP,
+
+	/**
+	 * Once the combination is held for the hold timeout
+	 */
+	TRIGGER_HOLD,
+
+	/**
+	 * Once the combination is tapped twice within the double tap timeout
+	 */
+	TRIGGER_DOUBLE_TAP,
+
+	/**
+	 * Once the combination is pressed within the chord timeout, counted from
+	 * the first key pressed
+	 */
+	TRIGGER_CHORD,
+
+	/**
+	 * Once the combination is released, if no other key was pressed
+	 * meanwhile
+	 */
+	TRIGGER_RELEASE,
+
+	/**
+	 * Once a key of a combination, whose Hold binding fired, is released.
+	 * Bindings cannot use it; it ends the Hold binding of the combination
+	 * (see wbk_kc_exec_end()).
+	 */
+	TRIGGER_HOLD_END
+} wbk_trigger_t;
+
 typedef struct wbk_b_s
 {
 	wbk_mk_t modifier_map[WBK_B_MODIFER_MAP_LEN];
 
 	char key_map[WBK_B_KEY_MAP_LEN];
+
+	/**
+	 * The last key of a key range (e.g. Mod4+[1-9]). The first key is the one
+	 * in key_map. '\0' if the binding is no key range.
+	 */
+	char key_last;
+
+	/**
+	 * Bit (1 << modifier) is set for every modifier, which may or may not be
+	 * held when the binding matches (e.g. Any + F1). Modifiers of
+	 * modifier_map are never ignored.
+	 */
+	uint64_t ignore_mask;
+
+	wbk_trigger_t trigger;
 } wbk_b_t;
 
 /**
@@ -66,6 +158,7 @@ wbk_b_reset(wbk_b_t *b);
 
 /**
  * @brief Add a binding element. The binding will only be added if was not already added.
+ * Adding a left or right modifier adds its generic modifier too.
  * @param be Binding element to add.
  * @return 0 if the element was added. Non-0 otherwise.
  */
@@ -73,6 +166,8 @@ extern int
 wbk_b_add(wbk_b_t *b, const wbk_be_t *be);
 
 /**
+ * Removing a left or right modifier removes its generic modifier too, unless
+ * the other side is still held.
  * @param be Binding element to remove.
  * @return 0 if the element was removed. Non-0 otherwise.
  */
@@ -86,6 +181,30 @@ wbk_b_remove(wbk_b_t *b, const wbk_be_t *be);
 extern int
 wbk_b_contains(wbk_b_t *b, const wbk_be_t *be);
 
+/**
+ * @return The lowest key of the binding, which is no modifier, or '\0' if
+ *         there is none
+ */
+extern char
+wbk_b_get_key(const wbk_b_t *b);
+
+/**
+ * @return Non-0 if the binding holds the generic modifier only because it
+ * holds a left or right one of it, e.g. Shift of LShift + a. 0 otherwise.
+ */
+extern int
+wbk_b_is_implied(const wbk_b_t *b, wbk_mk_t modifier);
+
+/**
+ * @brief Checks if a binding is matched by a key range binding. The modifiers,
+ * except the ignored ones of range, and the trigger must be equal and the
+ * only key of b must be within the range.
+ * @param range A binding with a key range (see wbk_b_t.key_last)
+ * @return Non-0 if b is matched by range. 0 otherwise.
+ */
+extern int
+wbk_b_matches(const wbk_b_t *range, const wbk_b_t *b);
+
 /**
  * @param b
  * @param other
@@ -94,6 +213,13 @@ wbk_b_contains(wbk_b_t *b, const wbk_be_t *be);
 extern int
 wbk_b_compare(const wbk_b_t *b, const wbk_b_t *other);
 
+/**
+ * @brief Hashes a binding. Bindings being equal by wbk_b_compare() produce the
+ * same hash.
+ */
+extern unsigned int
+wbk_b_hash(const wbk_b_t *b);
+
 /**
  * @return A new string containing the binding in a human readable form. Free it
  * by yourself!
@@ -0,0 +1,395 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the input backend class implementation and private methods
+ */
+
+#include "backend.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Implementation of wbk_backend_free().
+ */
+static int
+wbk_backend_free_impl(wbk_backend_t *backend);
+
+/**
+ * Implementation of wbk_backend_start().
+ *
+ * Without an input source there is nothing to start.
+ */
+static int
+wbk_backend_start_impl(wbk_backend_t *backend);
+
+/**
+ * Implementation of wbk_backend_stop().
+ */
+static int
+wbk_backend_stop_impl(wbk_backend_t *backend);
+
+/**
+ * Passes b with a trigger to the execution function.
+ */
+static int
+wbk_backend_exec(wbk_backend_t *backend, wbk_b_t *b, wbk_trigger_t trigger);
+
+/**
+ * @return The flag telling whether the key down of be was swallowed
+ */
+static char *
+wbk_backend_swallowed(wbk_backend_t *backend, const wbk_be_t *be);
+
+/**
+ * Executes the tap of the last pressed combination and detects double taps.
+ * @return 0 if the tap or the double tap was swallowed.
+ */
+static int
+wbk_backend_tap(wbk_backend_t *backend);
+
+/**
+ * The timers are embedded into the input backend, which subclasses copy on
+ * creation. Thus the input backend is found by the position of the timer
+ * instead of a parameter.
+ */
+static void
+wbk_backend_hold_expire_fn(wbk_timer_t *timer, void *param);
+
+static void
+wbk_backend_nop_expire_fn(wbk_timer_t *timer, void *param);
+
+wbk_backend_t *
+wbk_backend_new(int (*exec_fn)(wbk_backend_t *backend, wbk_b_t *b, void *param),
+                void *param)
+{
+	wbk_backend_t *backend;
+
+	backend = NULL;
+	backend = malloc(sizeof(wbk_backend_t));
+
+	if (backend) {
+		memset(backend, 0, sizeof(wbk_backend_t));
+
+		backend->backend_free = wbk_backend_free_impl;
+		backend->backend_start = wbk_backend_start_impl;
+		backend->backend_stop = wbk_backend_stop_impl;
+
+		backend->exec_fn = exec_fn;
+		backend->param = param;
+		backend->cur_b = wbk_b_new();
+		backend->pressed_count = 0;
+
+		backend->twheel = wbk_twheel_new(0);
+		backend->hold_timeout = WBK_BACKEND_HOLD_TIMEOUT;
+		backend->double_tap_timeout = WBK_BACKEND_DOUBLE_TAP_TIMEOUT;
+		backend->chord_timeout = WBK_BACKEND_CHORD_TIMEOUT;
+
+		backend->tap_b = wbk_b_new();
+		backend->release_armed = 0;
+		wbk_timer_init(&(backend->hold_timer), wbk_backend_hold_expire_fn, NULL);
+
+		backend->hold_b = wbk_b_new();
+		backend->hold_active = 0;
+
+		backend->last_tap_b = wbk_b_new();
+		wbk_timer_init(&(backend->double_tap_timer), wbk_backend_nop_expire_fn, NULL);
+
+		wbk_timer_init(&(backend->chord_timer), wbk_backend_nop_expire_fn, NULL);
+	}
+
+	return backend;
+}
+
+int
+wbk_backend_free(wbk_backend_t *backend)
+{
+	return backend->backend_free(backend);
+}
+
+int
+wbk_backend_start(wbk_backend_t *backend)
+{
+	return backend->backend_start(backend);
+}
+
+int
+wbk_backend_stop(wbk_backend_t *backend)
+{
+	return backend->backend_stop(backend);
+}
+
+int
+wbk_backend_feed(wbk_backend_t *backend, const wbk_be_t *be, int pressed)
+{
+	return wbk_backend_feed_at(backend, be, pressed, wbk_twheel_get_time(backend->twheel));
+}
+
+int
+wbk_backend_feed_at(wbk_backend_t *backend, const wbk_be_t *be, int pressed,
+                    unsigned long time)
+{
+	int error;
+
+	error = 1;
+
+	wbk_twheel_advance(backend->twheel, time);
+
+	/**
+	 * Repeated presses of a held key do not change the combination
+	 */
+	if (pressed && wbk_b_add(backend->cur_b, be) == 0) {
+		if (backend->pressed_count++ == 0) {
+			wbk_timer_start(backend->twheel, &(backend->chord_timer), backend->chord_timeout);
+		}
+
+		memcpy(backend->tap_b, backend->cur_b, sizeof(wbk_b_t));
+		backend->release_armed = 1;
+		wbk_timer_start(backend->twheel, &(backend->hold_timer), backend->hold_timeout);
+
+		error = wbk_backend_exec(backend, backend->cur_b, TRIGGER_PRESS);
+
+		if (backend->pressed_count > 1
+		    && wbk_timer_pending(&(backend->chord_timer))
+		    && wbk_backend_exec(backend, backend->cur_b, TRIGGER_CHORD) == 0) {
+			error = 0;
+		}
+
+		*wbk_backend_swallowed(backend, be) = error == 0;
+	} else if (pressed) {
+		error = !*wbk_backend_swallowed(backend, be);
+	} else if (wbk_b_remove(backend->cur_b, be) == 0) {
+		if (--backend->pressed_count <= 0) {
+			backend->pressed_count = 0;
+			wbk_timer_cancel(backend->twheel, &(backend->chord_timer));
+		}
+
+		if (wbk_timer_pending(&(backend->hold_timer))) {
+			wbk_timer_cancel(backend->twheel, &(backend->hold_timer));
+			error = wbk_backend_tap(backend);
+		}
+
+		/**
+		 * Fires on the first key up of the combination, which need not be
+		 * a swallowed one
+		 */
+		if (backend->release_armed) {
+			backend->release_armed = 0;
+			if (wbk_backend_exec(backend, backend->tap_b, TRIGGER_RELEASE) == 0) {
+				error = 0;
+			}
+		}
+
+		if (wbk_backend_exec(backend, backend->cur_b, TRIGGER_PRESS) == 0) {
+			error = 0;
+		}
+
+		if (backend->hold_active && wbk_b_contains(backend->hold_b, be)) {
+			backend->hold_active = 0;
+			if (wbk_backend_exec(backend, backend->hold_b, TRIGGER_HOLD_END) == 0) {
+				error = 0;
+			}
+		}
+
+		/**
+		 * A key up is only swallowed if its key down was. Otherwise the
+		 * system would keep the key held.
+		 */
+		if (!*wbk_backend_swallowed(backend, be)) {
+			error = 1;
+		}
+		*wbk_backend_swallowed(backend, be) = 0;
+	}
+
+	return error;
+}
+
+int
+wbk_backend_feed_click(wbk_backend_t *backend, const wbk_be_t *be)
+{
+	int error;
+
+	error = wbk_backend_feed(backend, be, 1);
+	wbk_backend_feed(backend, be, 0);
+
+	return error;
+}
+
+int
+wbk_backend_reset(wbk_backend_t *backend)
+{
+	if (backend->hold_active) {
+		backend->hold_active = 0;
+		wbk_backend_exec(backend, backend->hold_b, TRIGGER_HOLD_END);
+	}
+
+	backend->pressed_count = 0;
+	backend->release_armed = 0;
+	memset(backend->swallowed_modifier_map, 0, sizeof(backend->swallowed_modifier_map));
+	memset(backend->swallowed_key_map, 0, sizeof(backend->swallowed_key_map));
+	wbk_timer_cancel(backend->twheel, &(backend->hold_timer));
+	wbk_timer_cancel(backend->twheel, &(backend->double_tap_timer));
+	wbk_timer_cancel(backend->twheel, &(backend->chord_timer));
+
+	return wbk_b_reset(backend->cur_b);
+}
+
+int
+wbk_backend_advance(wbk_backend_t *backend, unsigned long time)
+{
+	return wbk_twheel_advance(backend->twheel, time);
+}
+
+unsigned long
+wbk_backend_get_time(const wbk_backend_t *backend)
+{
+	return wbk_twheel_get_time(backend->twheel);
+}
+
+int
+wbk_backend_next_timeout(const wbk_backend_t *backend, unsigned long *timeout)
+{
+	return wbk_twheel_next_timeout(backend->twheel, timeout);
+}
+
+int
+wbk_backend_set_timeouts(wbk_backend_t *backend, unsigned long hold_timeout,
+                         unsigned long double_tap_timeout, unsigned long chord_timeout)
+{
+	backend->hold_timeout = hold_timeout;
+	backend->double_tap_timeout = double_tap_timeout;
+	backend->chord_timeout = chord_timeout;
+
+	return 0;
+}
+
+int
+wbk_backend_exec(wbk_backend_t *backend, wbk_b_t *b, wbk_trigger_t trigger)
+{
+	int error;
+
+	b->trigger = trigger;
+	error = backend->exec_fn(backend, b, backend->param);
+	b->trigger = TRIGGER_PRESS;
+
+	return error;
+}
+
+char *
+wbk_backend_swallowed(wbk_backend_t *backend, const wbk_be_t *be)
+{
+	return wbk_be_get_modifier(be) != NOT_A_MODIFIER
+	       ? &(backend->swallowed_modifier_map[wbk_be_get_modifier(be)])
+	       : &(backend->swallowed_key_map[(unsigned char) wbk_be_get_key(be)]);
+}
+
+int
+wbk_backend_tap(wbk_backend_t *backend)
+{
+	int error;
+
+	error = wbk_backend_exec(backend, backend->tap_b, TRIGGER_TAP);
+
+	if (wbk_timer_pending(&(backend->double_tap_timer))
+	    && wbk_b_compare(backend->last_tap_b, backend->tap_b) == 0) {
+		wbk_timer_cancel(backend->twheel, &(backend->double_tap_timer));
+
+		if (wbk_backend_exec(backend, backend->tap_b, TRIGGER_DOUBLE_TAP) == 0) {
+			error = 0;
+		}
+	} else {
+		memcpy(backend->last_tap_b, backend->tap_b, sizeof(wbk_b_t));
+		wbk_timer_start(backend->twheel, &(backend->double_tap_timer), backend->double_tap_timeout);
+	}
+
+	return error;
+}
+
+void
+wbk_backend_hold_expire_fn(wbk_timer_t *timer, void *param)
+{
+	wbk_backend_t *backend;
+
+	backend = (wbk_backend_t *) ((char *) timer - offsetof(wbk_backend_t, hold_timer));
+
+	if (wbk_backend_exec(backend, backend->tap_b, TRIGGER_HOLD) == 0) {
+		if (backend->hold_active) {
+			/**
+			 * Only the first held combination is kept held, others end at
+			 * once
+			 */
+			wbk_backend_exec(backend, backend->tap_b, TRIGGER_HOLD_END);
+		} else {
+			memcpy(backend->hold_b, backend->tap_b, sizeof(wbk_b_t));
+			backend->hold_active = 1;
+		}
+	}
+}
+
+void
+wbk_backend_nop_expire_fn(wbk_timer_t *timer, void *param)
+{
+	/**
+	 * Only the pending state of the timer matters
+	 */
+}
+
+int
+wbk_backend_free_impl(wbk_backend_t *backend)
+{
+	wbk_b_free(backend->cur_b);
+	backend->cur_b = NULL;
+
+	wbk_b_free(backend->tap_b);
+	backend->tap_b = NULL;
+
+	wbk_b_free(backend->hold_b);
+	backend->hold_b = NULL;
+
+	wbk_b_free(backend->last_tap_b);
+	backend->last_tap_b = NULL;
+
+	wbk_twheel_free(backend->twheel);
+	backend->twheel = NULL;
+
+	free(backend);
+
+	return 0;
+}
+
+int
+wbk_backend_start_impl(wbk_backend_t *backend)
+{
+	return 0;
+}
+
+int
+wbk_backend_stop_impl(wbk_backend_t *backend)
+{
+	return 0;
+}
@@ -0,0 +1,225 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the input backend class definition
+ *
+ * An input backend delivers key presses and releases of some input source to
+ * the portable core. The core tracks the currently pressed keys and passes
+ * every changed combination to the execution function. Subclasses only
+ * translate their events into binding elements and call
+ * wbk_backend_feed(). See kbdaemon.h for the WIN32 hooks, backend_evdev.h for
+ * Linux input devices and backend_sim.h for a simulated input source.
+ *
+ * Besides pressed combinations the core detects taps, holds, double taps and
+ * chords (see wbk_trigger_t) with a timer wheel. Time is taken from the
+ * timestamps of the events, thus the decisions are deterministic and
+ * recorded events can be replayed.
+ */
+
+#include "b.h"
+#include "twheel.h"
+
+#ifndef WBK_BACKEND_H
+#define WBK_BACKEND_H
+
+/**
+ * Default milliseconds a combination has to be held to count as hold instead
+ * of tap.
+ */
+#define WBK_BACKEND_HOLD_TIMEOUT 200
+
+/**
+ * Default milliseconds between two taps of a double tap.
+ */
+#define WBK_BACKEND_DOUBLE_TAP_TIMEOUT 300
+
+/**
+ * Default milliseconds, in which all keys of a chord have to be pressed.
+ */
+#define WBK_BACKEND_CHORD_TIMEOUT 50
+
+typedef struct wbk_backend_s wbk_backend_t;
+
+struct wbk_backend_s
+{
+	int (*backend_free)(wbk_backend_t *backend);
+	int (*backend_start)(wbk_backend_t *backend);
+	int (*backend_stop)(wbk_backend_t *backend);
+
+	/**
+	 * Function is called on the thread of the input backend, when the
+	 * combination of pressed keys changed or a trigger of it fired. The
+	 * trigger of b tells which one. Make sure the function executes fast.
+	 *
+	 * If the function returns 0, then the input backend swallows the event.
+	 */
+	int (*exec_fn)(wbk_backend_t *backend, wbk_b_t *b, void *param);
+	void *param;
+
+	/**
+	 * The currently pressed keys. Only used on the thread of the input
+	 * backend.
+	 */
+	wbk_b_t *cur_b;
+	int pressed_count;
+
+	/**
+	 * Whether the key down of each pressed modifier and key was swallowed.
+	 * Its repeats are swallowed alike. Its key up may only be swallowed if
+	 * it was, so the system never keeps a key held.
+	 */
+	char swallowed_modifier_map[WBK_B_MODIFER_MAP_LEN];
+	char swallowed_key_map[WBK_B_KEY_MAP_LEN];
+
+	/**
+	 * Everything below is only used on the thread of the input backend, too.
+	 */
+	wbk_twheel_t *twheel;
+	unsigned long hold_timeout;
+	unsigned long double_tap_timeout;
+	unsigned long chord_timeout;
+
+	/**
+	 * The combination of the last press. It is tapped if released while the
+	 * hold timer is pending, otherwise it is held once the timer expires.
+	 */
+	wbk_b_t *tap_b;
+	wbk_timer_t hold_timer;
+
+	/**
+	 * Set when tap_b is pressed. The first release of a key clears it and
+	 * fires the release of tap_b, unless another key was pressed meanwhile
+	 * and replaced tap_b.
+	 */
+	int release_armed;
+
+	/**
+	 * The combination whose Hold binding fired, while hold_active is set.
+	 * Releasing one of its keys ends the binding (see TRIGGER_HOLD_END).
+	 */
+	wbk_b_t *hold_b;
+	int hold_active;
+
+	/**
+	 * The last tapped combination. Tapping it again while the double tap
+	 * timer is pending is a double tap.
+	 */
+	wbk_b_t *last_tap_b;
+	wbk_timer_t double_tap_timer;
+
+	/**
+	 * Started by the first key of a combination.
+	 */
+	wbk_timer_t chord_timer;
+};
+
+/**
+ * @brief Creates a new input backend without an input source
+ * @return A new input backend or NULL if allocation failed
+ */
+extern wbk_backend_t *
+wbk_backend_new(int (*exec_fn)(wbk_backend_t *backend, wbk_b_t *b, void *param),
+                void *param);
+
+extern int
+wbk_backend_free(wbk_backend_t *backend);
+
+/**
+ * @brief Starts delivering events of the input source.
+ * @return Non-0 if the input source cannot be used.
+ */
+extern int
+wbk_backend_start(wbk_backend_t *backend);
+
+extern int
+wbk_backend_stop(wbk_backend_t *backend);
+
+/**
+ * @brief Tracks a key press or release and passes the changed combination to
+ * the execution function.
+ * @param pressed Non-0 if the key was pressed, 0 if it was released
+ * @return 0 if the execution function matched a key binding and the event
+ * should be swallowed. Non-0 otherwise.
+ */
+extern int
+wbk_backend_feed(wbk_backend_t *backend, const wbk_be_t *be, int pressed);
+
+/**
+ * @brief Like wbk_backend_feed(), but advances the time of the input backend
+ * to the timestamp of the event first.
+ * @param time The timestamp of the event in milliseconds
+ */
+extern int
+wbk_backend_feed_at(wbk_backend_t *backend, const wbk_be_t *be, int pressed,
+                    unsigned long time);
+
+/**
+ * @brief Tracks a press immediately followed by a release, as sent by a mouse
+ * wheel for every notch.
+ * @return 0 if the press matched a key binding and the event should be
+ * swallowed. Non-0 otherwise.
+ */
+extern int
+wbk_backend_feed_click(wbk_backend_t *backend, const wbk_be_t *be);
+
+/**
+ * @brief Forgets all currently pressed keys. A held Hold binding is ended.
+ */
+extern int
+wbk_backend_reset(wbk_backend_t *backend);
+
+/**
+ * @brief Lets time pass without events, e.g. to fire a hold while a key is
+ * held down.
+ * @param time The current time in milliseconds
+ */
+extern int
+wbk_backend_advance(wbk_backend_t *backend, unsigned long time);
+
+/**
+ * @return The time the input backend was advanced to in milliseconds
+ */
+extern unsigned long
+wbk_backend_get_time(const wbk_backend_t *backend);
+
+/**
+ * @brief Computes the milliseconds until wbk_backend_advance() needs to be
+ * called, even without further events.
+ * @return Non-0 if nothing is pending.
+ */
+extern int
+wbk_backend_next_timeout(const wbk_backend_t *backend, unsigned long *timeout);
+
+/**
+ * @brief Sets the timeouts of taps, holds, double taps and chords in
+ * milliseconds.
+ */
+extern int
+wbk_backend_set_timeouts(wbk_backend_t *backend, unsigned long hold_timeout,
+                         unsigned long double_tap_timeout, unsigned long chord_timeout);
+
+#endif // WBK_BACKEND_H
@@ -0,0 +1,437 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the Linux evdev input backend class implementation and private methods
+ */
+
+#include "backend_evdev.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+/**
+ * Number of events read at once. The kernel hands out whole events only, but
+ * pipes and recordings may split them.
+ */
+#define WBK_BACKEND_EVDEV_BATCH 64
+
+static wbk_logger_t logger =  { "backend_evdev" };
+
+/**
+ * Characters of the keys on a US layout, indexed by the Linux key code.
+ */
+static const char WBK_BACKEND_EVDEV_KEYS[KEY_SPACE + 1] = {
+	[KEY_1] = '1', [KEY_2] = '2', [KEY_3] = '3', [KEY_4] = '4', [KEY_5] = '5',
+	[KEY_6] = '6', [KEY_7] = '7', [KEY_8] = '8', [KEY_9] = '9', [KEY_0] = '0',
+	[KEY_MINUS] = '-', [KEY_EQUAL] = '=',
+	[KEY_Q] = 'q', [KEY_W] = 'w', [KEY_E] = 'e', [KEY_R] = 'r', [KEY_T] = 't',
+	[KEY_Y] = 'y', [KEY_U] = 'u', [KEY_I] = 'i', [KEY_O] = 'o', [KEY_P] = 'p',
+	[KEY_LEFTBRACE] = '[', [KEY_RIGHTBRACE] = ']',
+	[KEY_A] = 'a', [KEY_S] = 's', [KEY_D] = 'd', [KEY_F] = 'f', [KEY_G] = 'g',
+	[KEY_H] = 'h', [KEY_J] = 'j', [KEY_K] = 'k', [KEY_L] = 'l',
+	[KEY_SEMICOLON] = ';', [KEY_APOSTROPHE] = '\'', [KEY_GRAVE] = '`',
+	[KEY_BACKSLASH] = '\\',
+	[KEY_Z] = 'z', [KEY_X] = 'x', [KEY_C] = 'c', [KEY_V] = 'v', [KEY_B] = 'b',
+	[KEY_N] = 'n', [KEY_M] = 'm',
+	[KEY_COMMA] = ',', [KEY_DOT] = '.', [KEY_SLASH] = '/'
+};
+
+/**
+ * Implementation of wbk_backend_free().
+ */
+static int
+wbk_backend_evdev_free_impl(wbk_backend_t *backend);
+
+/**
+ * Implementation of wbk_backend_start().
+ *
+ * Opens the device and starts the reader thread.
+ */
+static int
+wbk_backend_evdev_start_impl(wbk_backend_t *backend);
+
+/**
+ * Implementation of wbk_backend_stop().
+ *
+ * Stops the reader thread, closes the device and releases all keys still
+ * pressed.
+ */
+static int
+wbk_backend_evdev_stop_impl(wbk_backend_t *backend);
+
+/**
+ * Reads events until stopped. Without events for a while, the time of the
+ * input backend is advanced by the poll timeout, so pending holds fire.
+ */
+static void *
+wbk_backend_evdev_thread(void *param);
+
+/**
+ * @return The timestamp of an event in milliseconds
+ */
+static unsigned long
+wbk_backend_evdev_time(const struct input_event *event);
+
+/**
+ * Feeds a batch of events into the portable core.
+ */
+static void
+wbk_backend_evdev_dispatch(wbk_backend_evdev_t *evdev,
+                           const struct input_event *event_arr, int event_arr_len);
+
+wbk_backend_evdev_t *
+wbk_backend_evdev_new(int (*exec_fn)(wbk_backend_t *backend, wbk_b_t *b, void *param),
+                      void *param,
+                      const char *device)
+{
+	wbk_backend_t *backend;
+	wbk_backend_evdev_t *evdev;
+
+	evdev = NULL;
+	evdev = malloc(sizeof(wbk_backend_evdev_t));
+
+	if (evdev) {
+		memset(evdev, 0, sizeof(wbk_backend_evdev_t));
+
+		backend = wbk_backend_new(exec_fn, param);
+		memcpy(evdev, backend, sizeof(wbk_backend_t));
+		free(backend); /* Just free the top level element */
+
+		evdev->super_backend_free = evdev->backend.backend_free;
+		evdev->super_backend_start = evdev->backend.backend_start;
+		evdev->super_backend_stop = evdev->backend.backend_stop;
+
+		evdev->backend.backend_free = wbk_backend_evdev_free_impl;
+		evdev->backend.backend_start = wbk_backend_evdev_start_impl;
+		evdev->backend.backend_stop = wbk_backend_evdev_stop_impl;
+
+		evdev->device = malloc(sizeof(char) * (strlen(device) + 1));
+		strcpy(evdev->device, device);
+
+		evdev->running = 0;
+		evdev->fd = -1;
+		evdev->stop_fd[0] = -1;
+		evdev->stop_fd[1] = -1;
+		evdev->finished = 0;
+		evdev->event_count = 0;
+	}
+
+	return evdev;
+}
+
+int
+wbk_backend_evdev_to_be(unsigned short code, wbk_be_t *be)
+{
+	be->modifier = NOT_A_MODIFIER;
+	be->key = '\0';
+
+	switch (code) {
+	case KEY_LEFTCTRL:
+		be->modifier = LCTRL;
+		break;
+
+	case KEY_RIGHTCTRL:
+		be->modifier = RCTRL;
+		break;
+
+	case KEY_LEFTSHIFT:
+		be->modifier = LSHIFT;
+		break;
+
+	case KEY_RIGHTSHIFT:
+		be->modifier = RSHIFT;
+		break;
+
+	case KEY_LEFTALT:
+		be->modifier = LALT;
+		break;
+
+	case KEY_RIGHTALT:
+		be->modifier = RALT;
+		break;
+
+	case KEY_LEFTMETA:
+		be->modifier = LWIN;
+		break;
+
+	case KEY_RIGHTMETA:
+		be->modifier = RWIN;
+		break;
+
+	case KEY_ENTER:
+	case KEY_KPENTER:
+		be->modifier = ENTER;
+		break;
+
+	case KEY_SPACE:         be->modifier = SPACE; break;
+	case KEY_ESC:           be->modifier = ESCAPE; break;
+	case KEY_NUMLOCK:       be->modifier = NUMLOCK; break;
+	case KEY_CAPSLOCK:      be->modifier = CAPSLOCK; break;
+	case KEY_SCROLLLOCK:    be->modifier = SCROLL; break;
+	case KEY_F1:            be->modifier = F1; break;
+	case KEY_F2:            be->modifier = F2; break;
+	case KEY_F3:            be->modifier = F3; break;
+	case KEY_F4:            be->modifier = F4; break;
+	case KEY_F5:            be->modifier = F5; break;
+	case KEY_F6:            be->modifier = F6; break;
+	case KEY_F7:            be->modifier = F7; break;
+	case KEY_F8:            be->modifier = F8; break;
+	case KEY_F9:            be->modifier = F9; break;
+	case KEY_F10:           be->modifier = F10; break;
+	case KEY_F11:           be->modifier = F11; break;
+	case KEY_F12:           be->modifier = F12; break;
+	case KEY_LEFT:          be->modifier = LEFT; break;
+	case KEY_RIGHT:         be->modifier = RIGHT; break;
+	case KEY_UP:            be->modifier = UP; break;
+	case KEY_DOWN:          be->modifier = DOWN; break;
+
+	case BTN_LEFT:          be->modifier = MOUSE_LEFT; break;
+	case BTN_MIDDLE:        be->modifier = MOUSE_MIDDLE; break;
+	case BTN_RIGHT:         be->modifier = MOUSE_RIGHT; break;
+	case BTN_SIDE:          be->modifier = MOUSE_BACK; break;
+	case BTN_EXTRA:         be->modifier = MOUSE_FORWARD; break;
+
+	default:
+		if (code < sizeof(WBK_BACKEND_EVDEV_KEYS)) {
+			be->key = WBK_BACKEND_EVDEV_KEYS[code];
+		}
+	}
+
+	return be->modifier == NOT_A_MODIFIER && be->key == '\0';
+}
+
+int
+wbk_backend_evdev_finished(const wbk_backend_evdev_t *evdev)
+{
+	return __atomic_load_n(&(evdev->finished), __ATOMIC_SEQ_CST);
+}
+
+int
+wbk_backend_evdev_free_impl(wbk_backend_t *backend)
+{
+	wbk_backend_evdev_t *evdev;
+
+	evdev = (wbk_backend_evdev_t *) backend;
+
+	wbk_backend_evdev_stop_impl(backend);
+
+	free(evdev->device);
+	evdev->device = NULL;
+
+	return evdev->super_backend_free(backend);
+}
+
+int
+wbk_backend_evdev_start_impl(wbk_backend_t *backend)
+{
+	wbk_backend_evdev_t *evdev;
+	int error;
+
+	evdev = (wbk_backend_evdev_t *) backend;
+
+	error = 0;
+	wbk_backend_evdev_stop_impl(backend);
+
+	evdev->fd = open(evdev->device, O_RDONLY | O_CLOEXEC);
+	if (evdev->fd < 0) {
+		wbk_logger_log(&logger, SEVERE, "Could not open input device %s\n", evdev->device);
+		error = 1;
+	}
+
+	if (!error && pipe(evdev->stop_fd)) {
+		error = 1;
+	}
+
+	if (!error) {
+		evdev->running = 1;
+		__atomic_store_n(&(evdev->finished), 0, __ATOMIC_SEQ_CST);
+		if (pthread_create(&(evdev->thread), NULL, wbk_backend_evdev_thread, evdev)) {
+			wbk_logger_log(&logger, SEVERE, "Could not start the input device thread\n");
+			evdev->running = 0;
+			error = 1;
+		}
+	}
+
+	if (error) {
+		wbk_backend_evdev_stop_impl(backend);
+	} else {
+		error = evdev->super_backend_start(backend);
+	}
+
+	return error;
+}
+
+int
+wbk_backend_evdev_stop_impl(wbk_backend_t *backend)
+{
+	wbk_backend_evdev_t *evdev;
+
+	evdev = (wbk_backend_evdev_t *) backend;
+
+	if (evdev->running) {
+		if (write(evdev->stop_fd[1], "", 1) == 1) {
+			pthread_join(evdev->thread, NULL);
+		}
+		evdev->running = 0;
+	}
+
+	if (evdev->stop_fd[0] >= 0) {
+		close(evdev->stop_fd[0]);
+		close(evdev->stop_fd[1]);
+		evdev->stop_fd[0] = -1;
+		evdev->stop_fd[1] = -1;
+	}
+
+	if (evdev->fd >= 0) {
+		close(evdev->fd);
+		evdev->fd = -1;
+	}
+
+	wbk_backend_reset(backend);
+
+	return evdev->super_backend_stop(backend);
+}
+
+void *
+wbk_backend_evdev_thread(void *param)
+{
+	wbk_backend_evdev_t *evdev;
+	struct input_event event_arr[WBK_BACKEND_EVDEV_BATCH];
+	struct pollfd fds[2];
+	size_t buffered;
+	ssize_t length;
+	unsigned long timeout;
+	int pending;
+	int running;
+	int result;
+
+	evdev = (wbk_backend_evdev_t *) param;
+
+	fds[0].fd = evdev->stop_fd[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = evdev->fd;
+	fds[1].events = POLLIN;
+
+	running = 1;
+	buffered = 0;
+	while (running) {
+		pending = wbk_backend_next_timeout((wbk_backend_t *) evdev, &timeout) == 0;
+		result = poll(fds, 2, pending ? (int) timeout : -1);
+
+		if (result == 0) {
+			wbk_backend_advance((wbk_backend_t *) evdev,
+			                    wbk_backend_get_time((wbk_backend_t *) evdev) + timeout);
+		} else if (result < 0) {
+			running = errno == EINTR;
+		} else if (fds[0].revents) {
+			running = 0;
+		} else {
+			length = read(evdev->fd, (char *) event_arr + buffered,
+			              sizeof(event_arr) - buffered);
+
+			if (length > 0) {
+				buffered += length;
+				wbk_backend_evdev_dispatch(evdev, event_arr,
+				                           buffered / sizeof(struct input_event));
+
+				/**
+				 * Keep the start of a split event for the next read
+				 */
+				length = buffered % sizeof(struct input_event);
+				memmove(event_arr, (char *) event_arr + buffered - length, length);
+				buffered = length;
+			} else if (length < 0 && (errno == EINTR || errno == EAGAIN)) {
+				/**
+				 * Nothing to read yet
+				 */
+			} else {
+				wbk_logger_log(&logger, INFO, "Input device %s closed\n", evdev->device);
+				__atomic_store_n(&(evdev->finished), 1, __ATOMIC_SEQ_CST);
+				running = 0;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+unsigned long
+wbk_backend_evdev_time(const struct input_event *event)
+{
+	return (unsigned long) event->input_event_sec * 1000
+		+ event->input_event_usec / 1000;
+}
+
+void
+wbk_backend_evdev_dispatch(wbk_backend_evdev_t *evdev,
+                           const struct input_event *event_arr, int event_arr_len)
+{
+	wbk_be_t be;
+	int i;
+
+	for (i = 0; i < event_arr_len; i++) {
+		if (event_arr[i].type == EV_REL) {
+			/**
+			 * Mouse moves are the most frequent events, only wheels matter
+			 */
+			if (event_arr[i].code == REL_WHEEL && event_arr[i].value) {
+				wbk_backend_advance((wbk_backend_t *) evdev, wbk_backend_evdev_time(&(event_arr[i])));
+				be.modifier = event_arr[i].value > 0 ? WHEEL_UP : WHEEL_DOWN;
+				be.key = '\0';
+				wbk_backend_feed_click((wbk_backend_t *) evdev, &be);
+				__atomic_add_fetch(&(evdev->event_count), 1, __ATOMIC_SEQ_CST);
+			} else if (event_arr[i].code == REL_HWHEEL && event_arr[i].value) {
+				wbk_backend_advance((wbk_backend_t *) evdev, wbk_backend_evdev_time(&(event_arr[i])));
+				be.modifier = event_arr[i].value > 0 ? WHEEL_RIGHT : WHEEL_LEFT;
+				be.key = '\0';
+				wbk_backend_feed_click((wbk_backend_t *) evdev, &be);
+				__atomic_add_fetch(&(evdev->event_count), 1, __ATOMIC_SEQ_CST);
+			}
+		} else if (event_arr[i].type == EV_SYN && event_arr[i].code == SYN_DROPPED) {
+			/**
+			 * The kernel dropped events, thus releases may have been missed
+			 */
+			wbk_backend_reset((wbk_backend_t *) evdev);
+		} else if (event_arr[i].type == EV_KEY
+		           && wbk_backend_evdev_to_be(event_arr[i].code, &be) == 0) {
+			/**
+			 * A value of 2 is an auto repeat, which the core ignores
+			 */
+			wbk_backend_feed_at((wbk_backend_t *) evdev, &be, event_arr[i].value != 0,
+			                    wbk_backend_evdev_time(&(event_arr[i])));
+			__atomic_add_fetch(&(evdev->event_count), 1, __ATOMIC_SEQ_CST);
+		}
+	}
+}
@@ -0,0 +1,100 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the Linux evdev input backend class definition
+ *
+ * wbk_backend_evdev_t inherits all methods of wbk_backend_t (see backend.h).
+ * It reads the key, mouse button and wheel events of a single evdev device
+ * (/dev/input/event*) on its own thread and feeds them into the portable core, just like the WIN32 hooks
+ * do. Any file delivering struct input_event records works, thus recorded
+ * events in a regular file or a pipe can stand in for a device.
+ *
+ * Reading a device does not remove its events from the input stream of other
+ * applications, so matched events are not swallowed.
+ */
+
+#include "backend.h"
+
+#ifndef WBK_BACKEND_EVDEV_H
+#define WBK_BACKEND_EVDEV_H
+
+#include <pthread.h>
+
+typedef struct wbk_backend_evdev_s wbk_backend_evdev_t;
+
+struct wbk_backend_evdev_s
+{
+	wbk_backend_t backend;
+	int (*super_backend_free)(wbk_backend_t *backend);
+	int (*super_backend_start)(wbk_backend_t *backend);
+	int (*super_backend_stop)(wbk_backend_t *backend);
+
+	char *device;
+
+	int running;
+	int fd;
+	int stop_fd[2];
+	pthread_t thread;
+
+	/**
+	 * Set by the reader thread, when the device vanished or the end of a
+	 * recording has been reached.
+	 */
+	int finished;
+
+	/**
+	 * Number of key, button and wheel events read from the device.
+	 */
+	long event_count;
+};
+
+/**
+ * @brief Creates a new evdev input backend
+ * @param device The path of the device, e.g. /dev/input/event3. The string is copied.
+ * @return A new evdev input backend or NULL if allocation failed
+ */
+extern wbk_backend_evdev_t *
+wbk_backend_evdev_new(int (*exec_fn)(wbk_backend_t *backend, wbk_b_t *b, void *param),
+                      void *param,
+                      const char *device);
+
+/**
+ * @brief Translates a Linux key code (KEY_* of linux/input.h) into a binding element.
+ * @return Non-0 if the key code cannot be used within key bindings.
+ */
+extern int
+wbk_backend_evdev_to_be(unsigned short code, wbk_be_t *be);
+
+/**
+ * @return Non-0 if the reader thread stopped on its own, because the device
+ * vanished or the recording ended.
+ */
+extern int
+wbk_backend_evdev_finished(const wbk_backend_evdev_t *evdev);
+
+#endif // WBK_BACKEND_EVDEV_H
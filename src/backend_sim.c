@@ -0,0 +1,250 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the simulated input backend class implementation and
+ * private methods
+ */
+
+#include "backend_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+#include "parser.h"
+
+#define WBK_BACKEND_SIM_LINE_LEN 256
+
+static wbk_logger_t logger =  { "backend_sim" };
+
+/**
+ * Implementation of wbk_backend_free().
+ */
+static int
+wbk_backend_sim_free_impl(wbk_backend_t *backend);
+
+/**
+ * Implementation of wbk_backend_start().
+ */
+static int
+wbk_backend_sim_start_impl(wbk_backend_t *backend);
+
+/**
+ * Implementation of wbk_backend_stop().
+ *
+ * Releases all keys still pressed, like a device being unplugged.
+ */
+static int
+wbk_backend_sim_stop_impl(wbk_backend_t *backend);
+
+/**
+ * Injects the event of a single line of an event file.
+ * @return Non-0 if the line is invalid.
+ */
+static int
+wbk_backend_sim_play_line(wbk_backend_sim_t *sim, char *line);
+
+wbk_backend_sim_t *
+wbk_backend_sim_new(int (*exec_fn)(wbk_backend_t *backend, wbk_b_t *b, void *param),
+                    void *param)
+{
+	wbk_backend_t *backend;
+	wbk_backend_sim_t *sim;
+
+	sim = NULL;
+	sim = malloc(sizeof(wbk_backend_sim_t));
+
+	if (sim) {
+		memset(sim, 0, sizeof(wbk_backend_sim_t));
+
+		backend = wbk_backend_new(exec_fn, param);
+		memcpy(sim, backend, sizeof(wbk_backend_t));
+		free(backend); /* Just free the top level element */
+
+		sim->super_backend_free = sim->backend.backend_free;
+		sim->super_backend_start = sim->backend.backend_start;
+		sim->super_backend_stop = sim->backend.backend_stop;
+
+		sim->backend.backend_free = wbk_backend_sim_free_impl;
+		sim->backend.backend_start = wbk_backend_sim_start_impl;
+		sim->backend.backend_stop = wbk_backend_sim_stop_impl;
+
+		sim->running = 0;
+		sim->event_count = 0;
+		sim->swallow_count = 0;
+	}
+
+	return sim;
+}
+
+int
+wbk_backend_sim_send(wbk_backend_sim_t *sim, const wbk_be_t *be, int pressed)
+{
+	int error;
+
+	error = 1;
+
+	if (sim->running) {
+		error = wbk_backend_feed((wbk_backend_t *) sim, be, pressed);
+
+		sim->event_count++;
+		if (!error) {
+			sim->swallow_count++;
+		}
+	}
+
+	return error;
+}
+
+int
+wbk_backend_sim_click(wbk_backend_sim_t *sim, const wbk_be_t *be)
+{
+	int error;
+
+	error = 1;
+
+	if (sim->running) {
+		error = wbk_backend_feed_click((wbk_backend_t *) sim, be);
+
+		sim->event_count++;
+		if (!error) {
+			sim->swallow_count++;
+		}
+	}
+
+	return error;
+}
+
+int
+wbk_backend_sim_wait(wbk_backend_sim_t *sim, unsigned long timeout)
+{
+	return wbk_backend_advance((wbk_backend_t *) sim,
+	                           wbk_backend_get_time((wbk_backend_t *) sim) + timeout);
+}
+
+int
+wbk_backend_sim_play(wbk_backend_sim_t *sim, const char *filename)
+{
+	FILE *file;
+	char line[WBK_BACKEND_SIM_LINE_LEN];
+	int line_no;
+	int error;
+
+	error = 0;
+
+	file = fopen(filename, "r");
+	if (file == NULL) {
+		wbk_logger_log(&logger, SEVERE, "Could not read events: %s\n", filename);
+		error = 1;
+	}
+
+	line_no = 0;
+	while (!error && fgets(line, sizeof(line), file)) {
+		line_no++;
+		error = wbk_backend_sim_play_line(sim, line);
+		if (error) {
+			wbk_logger_log(&logger, SEVERE, "Invalid event in %s, line %d\n", filename, line_no);
+		}
+	}
+
+	if (file) {
+		fclose(file);
+	}
+
+	return error;
+}
+
+int
+wbk_backend_sim_play_line(wbk_backend_sim_t *sim, char *line)
+{
+	char *action;
+	char *token;
+	char *rest;
+	wbk_be_t be;
+	int error;
+
+	error = 0;
+
+	action = strtok_r(line, " \t\r\n", &rest);
+	token = action ? strtok_r(NULL, " \t\r\n", &rest) : NULL;
+
+	if (action == NULL || action[0] == '#') {
+		/**
+		 * Empty lines and comments
+		 */
+	} else if (token && strcmp(action, "wait") == 0) {
+		wbk_backend_sim_wait(sim, strtoul(token, NULL, 10));
+	} else if (token == NULL || wbk_parser_parse_be(token, &be)) {
+		error = 1;
+	} else if (strcmp(action, "press") == 0) {
+		wbk_backend_sim_send(sim, &be, 1);
+	} else if (strcmp(action, "release") == 0) {
+		wbk_backend_sim_send(sim, &be, 0);
+	} else if (strcmp(action, "click") == 0) {
+		wbk_backend_sim_click(sim, &be);
+	} else {
+		error = 1;
+	}
+
+	return error;
+}
+
+int
+wbk_backend_sim_free_impl(wbk_backend_t *backend)
+{
+	wbk_backend_sim_t *sim;
+
+	sim = (wbk_backend_sim_t *) backend;
+
+	wbk_backend_sim_stop_impl(backend);
+
+	return sim->super_backend_free(backend);
+}
+
+int
+wbk_backend_sim_start_impl(wbk_backend_t *backend)
+{
+	wbk_backend_sim_t *sim;
+
+	sim = (wbk_backend_sim_t *) backend;
+	sim->running = 1;
+
+	return sim->super_backend_start(backend);
+}
+
+int
+wbk_backend_sim_stop_impl(wbk_backend_t *backend)
+{
+	wbk_backend_sim_t *sim;
+
+	sim = (wbk_backend_sim_t *) backend;
+	sim->running = 0;
+	wbk_backend_reset(backend);
+
+	return sim->super_backend_stop(backend);
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the simulated input backend class definition
+ *
+ * wbk_backend_sim_t inherits all methods of wbk_backend_t (see backend.h).
+ * Instead of listening to a device it injects key presses and releases passed
+ * from code or read from an event file. It runs on the thread of the caller,
+ * thus it is suited for tests and benchmarks on any platform.
+ *
+ * An event file contains one event per line, keys use the rc file notation:
+ *
+ *   # Opens the resize mode
+ *   press control
+ *   press r
+ *   release r
+ *   click wheel-up
+ *   release control
+ *   # Holds capslock
+ *   press capslock
+ *   wait 250
+ *   release capslock
+ *
+ * A click is a press immediately followed by a release, like a notch of a
+ * mouse wheel. Time only passes by waiting, given in milliseconds.
+ */
+
+#include "backend.h"
+
+#ifndef WBK_BACKEND_SIM_H
+#define WBK_BACKEND_SIM_H
+
+typedef struct wbk_backend_sim_s wbk_backend_sim_t;
+
+struct wbk_backend_sim_s
+{
+	wbk_backend_t backend;
+	int (*super_backend_free)(wbk_backend_t *backend);
+	int (*super_backend_start)(wbk_backend_t *backend);
+	int (*super_backend_stop)(wbk_backend_t *backend);
+
+	/**
+	 * Events are only injected while the backend is started.
+	 */
+	int running;
+
+	/**
+	 * Number of injected events and how many of them were swallowed.
+	 */
+	long event_count;
+	long swallow_count;
+};
+
+/**
+ * @brief Creates a new simulated input backend
+ * @return A new simulated input backend or NULL if allocation failed
+ */
+extern wbk_backend_sim_t *
+wbk_backend_sim_new(int (*exec_fn)(wbk_backend_t *backend, wbk_b_t *b, void *param),
+                    void *param);
+
+/**
+ * @brief Injects a key press or release.
+ * @param pressed Non-0 for a press, 0 for a release
+ * @return 0 if the event was swallowed. Non-0 otherwise.
+ */
+extern int
+wbk_backend_sim_send(wbk_backend_sim_t *sim, const wbk_be_t *be, int pressed);
+
+/**
+ * @brief Injects a press immediately followed by a release.
+ * @return 0 if the press was swallowed. Non-0 otherwise.
+ */
+extern int
+wbk_backend_sim_click(wbk_backend_sim_t *sim, const wbk_be_t *be);
+
+/**
+ * @brief Lets time pass until the next event.
+ * @param timeout Milliseconds to wait
+ */
+extern int
+wbk_backend_sim_wait(wbk_backend_sim_t *sim, unsigned long timeout);
+
+/**
+ * @brief Injects all events of an event file.
+ * @return Non-0 if the file cannot be read or contains an invalid line.
+ */
+extern int
+wbk_backend_sim_play(wbk_backend_sim_t *sim, const char *filename);
+
+#endif // WBK_BACKEND_SIM_H
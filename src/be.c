@@ -85,6 +85,46 @@ wbk_be_get_key(const wbk_be_t *be)
 	return be->key;
 }
 
+int
+wbk_be_mk_is_held(wbk_mk_t modifier)
+{
+	return modifier == WIN || modifier == ALT || modifier == CTRL || modifier == SHIFT
+	       || (modifier >= LWIN && modifier <= RSHIFT);
+}
+
+wbk_mk_t
+wbk_be_mk_get_generic(wbk_mk_t modifier)
+{
+	wbk_mk_t generic;
+
+	switch (modifier) {
+	case LWIN:
+	case RWIN:
+		generic = WIN;
+		break;
+
+	case LALT:
+	case RALT:
+		generic = ALT;
+		break;
+
+	case LCTRL:
+	case RCTRL:
+		generic = CTRL;
+		break;
+
+	case LSHIFT:
+	case RSHIFT:
+		generic = SHIFT;
+		break;
+
+	default:
+		generic = modifier;
+	}
+
+	return generic;
+}
+
 inline int
 wbk_be_compare(const wbk_be_t *be, const wbk_be_t *other)
 {
@@ -52,6 +52,28 @@
 #define F10_STR "F10"
 #define F11_STR "F11"
 #define F12_STR "F12"
+#define MOUSE_LEFT_STR "b:1"
+#define MOUSE_MIDDLE_STR "b:2"
+#define MOUSE_RIGHT_STR "b:3"
+#define WHEEL_UP_STR "b:4"
+#define WHEEL_DOWN_STR "b:5"
+#define WHEEL_LEFT_STR "b:6"
+#define WHEEL_RIGHT_STR "b:7"
+#define MOUSE_BACK_STR "b:8"
+#define MOUSE_FORWARD_STR "b:9"
+#define LEFT_STR "Left"
+#define RIGHT_STR "Right"
+#define UP_STR "Up"
+#define DOWN_STR "Down"
+#define ESCAPE_STR "Escape"
+#define LWIN_STR "LMod4"
+#define RWIN_STR "RMod4"
+#define LALT_STR "LMod1"
+#define RALT_STR "RMod1"
+#define LCTRL_STR "LCtrl"
+#define RCTRL_STR "RCtrl"
+#define LSHIFT_STR "LShift"
+#define RSHIFT_STR "RShift"
 
 /**
  * @brief Modifier key
@@ -78,7 +100,41 @@ typedef enum wbk_mk_e {
 	F9,
 	F10,
 	F11,
-	F12
+	F12,
+
+	/**
+	 * Mouse buttons and wheel directions, numbered like X11 buttons. Wheel
+	 * directions are pressed and released at once for every notch.
+	 */
+	MOUSE_LEFT,
+	MOUSE_MIDDLE,
+	MOUSE_RIGHT,
+	WHEEL_UP,
+	WHEEL_DOWN,
+	WHEEL_LEFT,
+	WHEEL_RIGHT,
+	MOUSE_BACK,
+	MOUSE_FORWARD,
+
+	LEFT,
+	RIGHT,
+	UP,
+	DOWN,
+	ESCAPE,
+
+	/**
+	 * Left and right variants of the held modifiers. A combination holding one
+	 * of them holds its generic modifier too (see wbk_b_add()), so bindings of
+	 * the generic modifier match either side.
+	 */
+	LWIN,
+	RWIN,
+	LALT,
+	RALT,
+	LCTRL,
+	RCTRL,
+	LSHIFT,
+	RSHIFT
 } wbk_mk_t;
 
 typedef struct wbk_be_s
@@ -99,6 +155,21 @@ wbk_be_get_modifier(const wbk_be_t *be);
 extern char
 wbk_be_get_key(const wbk_be_t *be);
 
+/**
+ * @return Non-0 if the modifier key modifies other keys while it is held
+ * (Mod4, Mod1, Control or Shift of either side). Other modifier keys like F1 are ordinary
+ * keys.
+ */
+extern int
+wbk_be_mk_is_held(wbk_mk_t modifier);
+
+/**
+ * @return The generic modifier of a left or right modifier, e.g. SHIFT for
+ * RSHIFT, or the modifier itself.
+ */
+extern wbk_mk_t
+wbk_be_mk_get_generic(wbk_mk_t modifier);
+
 /**
  * @param be
  * @param other
@@ -0,0 +1,375 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the binding scanner class implementation and private methods
+ */
+
+#include "bscan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define WBK_BSCAN_X86
+#include <immintrin.h>
+#endif
+
+#define WBK_BSCAN_TRIGGER_SHIFT 56
+
+static wbk_logger_t logger =  { "bscan" };
+
+/**
+ * @return Non-0 if the CPU supports the instruction set
+ */
+static int
+wbk_bscan_supports(wbk_bscan_isa_t isa);
+
+/**
+ * Finds the first binding by comparing one word at a time.
+ *
+ * @return The position of the binding or -1 if none matches
+ */
+static int
+wbk_bscan_find_scalar(const wbk_bscan_t *bscan, uint64_t word, unsigned char key);
+
+#ifdef WBK_BSCAN_X86
+/**
+ * Finds the first binding by comparing 2 words per instruction.
+ */
+static int
+wbk_bscan_find_sse2(const wbk_bscan_t *bscan, uint64_t word, unsigned char key);
+
+/**
+ * Finds the first binding by comparing 4 words per instruction.
+ */
+static int
+wbk_bscan_find_avx2(const wbk_bscan_t *bscan, uint64_t word, unsigned char key);
+#endif
+
+/**
+ * Checks the key ranges of the bindings set in a mask of matching words.
+ *
+ * @param i The position of the binding of bit 0
+ * @return The position of the first binding whose key range matches or -1
+ */
+static int
+wbk_bscan_check_keys(const wbk_bscan_t *bscan, int i, unsigned int mask,
+                     unsigned char key);
+
+wbk_bscan_t *
+wbk_bscan_new()
+{
+	wbk_bscan_t *bscan;
+
+	bscan = NULL;
+	bscan = malloc(sizeof(wbk_bscan_t));
+
+	if (bscan) {
+		memset(bscan, 0, sizeof(wbk_bscan_t));
+
+		if (wbk_bscan_set_isa(bscan, WBK_BSCAN_AVX2)
+		    && wbk_bscan_set_isa(bscan, WBK_BSCAN_SSE2)) {
+			wbk_bscan_set_isa(bscan, WBK_BSCAN_SCALAR);
+		}
+	}
+
+	return bscan;
+}
+
+int
+wbk_bscan_free(wbk_bscan_t *bscan)
+{
+	free(bscan->words);
+	bscan->words = NULL;
+
+	free(bscan->cares);
+	bscan->cares = NULL;
+
+	free(bscan->keys_first);
+	bscan->keys_first = NULL;
+
+	free(bscan->keys_last);
+	bscan->keys_last = NULL;
+
+	free(bscan->values);
+	bscan->values = NULL;
+
+	free(bscan);
+
+	return 0;
+}
+
+int
+wbk_bscan_add(wbk_bscan_t *bscan, const wbk_b_t *b, int value)
+{
+	int error;
+	int size;
+	unsigned char first;
+	int i;
+
+	error = 0;
+
+	first = (unsigned char) wbk_b_get_key(b);
+	for (i = first + 1; !error && i < WBK_B_KEY_MAP_LEN; i++) {
+		error = b->key_map[i] != 0;
+	}
+
+	if (error) {
+		wbk_logger_log(&logger, SEVERE, "Only bindings of a single key can be scanned\n");
+	} else if (bscan->len == bscan->size) {
+		size = bscan->size ? bscan->size * 2 : 8;
+		bscan->words = realloc(bscan->words, sizeof(uint64_t) * size);
+		bscan->cares = realloc(bscan->cares, sizeof(uint64_t) * size);
+		bscan->keys_first = realloc(bscan->keys_first, sizeof(unsigned char) * size);
+		bscan->keys_last = realloc(bscan->keys_last, sizeof(unsigned char) * size);
+		bscan->values = realloc(bscan->values, sizeof(int) * size);
+		error = !bscan->words || !bscan->cares || !bscan->keys_first || !bscan->keys_last || !bscan->values;
+		if (!error) {
+			bscan->size = size;
+		}
+	}
+
+	if (!error) {
+		bscan->words[bscan->len] = wbk_bscan_pack(b);
+		bscan->cares[bscan->len] = ~b->ignore_mask;
+		bscan->keys_first[bscan->len] = first;
+		bscan->keys_last[bscan->len] = b->key_last ? (unsigned char) b->key_last : first;
+		bscan->values[bscan->len] = value;
+		bscan->len++;
+	}
+
+	return error;
+}
+
+int
+wbk_bscan_find(const wbk_bscan_t *bscan, const wbk_b_t *b)
+{
+	unsigned char key;
+	int single;
+	int pos;
+	int i;
+
+	key = (unsigned char) wbk_b_get_key(b);
+
+	/**
+	 * Combinations of more than one key are never matched
+	 */
+	single = b->key_last == '\0';
+	for (i = key + 1; single && i < WBK_B_KEY_MAP_LEN; i++) {
+		single = b->key_map[i] == 0;
+	}
+
+	pos = single && bscan->len > 0 ? bscan->find(bscan, wbk_bscan_pack(b), key) : -1;
+
+	return pos >= 0 ? bscan->values[pos] : -1;
+}
+
+uint64_t
+wbk_bscan_pack(const wbk_b_t *b)
+{
+	uint64_t word;
+	int i;
+
+	word = (uint64_t) b->trigger << WBK_BSCAN_TRIGGER_SHIFT;
+	for (i = 0; i < WBK_B_MODIFER_MAP_LEN; i++) {
+		if (b->modifier_map[i]) {
+			word |= (uint64_t) 1 << i;
+		}
+	}
+
+	return word;
+}
+
+int
+wbk_bscan_set_isa(wbk_bscan_t *bscan, wbk_bscan_isa_t isa)
+{
+	int error;
+
+	error = !wbk_bscan_supports(isa);
+	if (!error) {
+		bscan->isa = isa;
+		switch (isa) {
+#ifdef WBK_BSCAN_X86
+		case WBK_BSCAN_AVX2:
+			bscan->find = wbk_bscan_find_avx2;
+			break;
+
+		case WBK_BSCAN_SSE2:
+			bscan->find = wbk_bscan_find_sse2;
+			break;
+#endif
+
+		default:
+			bscan->find = wbk_bscan_find_scalar;
+			break;
+		}
+	}
+
+	return error;
+}
+
+wbk_bscan_isa_t
+wbk_bscan_get_isa(const wbk_bscan_t *bscan)
+{
+	return bscan->isa;
+}
+
+int
+wbk_bscan_supports(wbk_bscan_isa_t isa)
+{
+	int supported;
+
+	supported = isa == WBK_BSCAN_SCALAR;
+#ifdef WBK_BSCAN_X86
+	__builtin_cpu_init();
+	if (isa == WBK_BSCAN_SSE2) {
+		supported = __builtin_cpu_supports("sse2");
+	} else if (isa == WBK_BSCAN_AVX2) {
+		supported = __builtin_cpu_supports("avx2");
+	}
+#endif
+
+	return supported;
+}
+
+int
+wbk_bscan_find_scalar(const wbk_bscan_t *bscan, uint64_t word, unsigned char key)
+{
+	int pos;
+	int i;
+
+	pos = -1;
+	for (i = 0; pos < 0 && i < bscan->len; i++) {
+		if ((word & bscan->cares[i]) == bscan->words[i]
+		    && key >= bscan->keys_first[i] && key <= bscan->keys_last[i]) {
+			pos = i;
+		}
+	}
+
+	return pos;
+}
+
+int
+wbk_bscan_check_keys(const wbk_bscan_t *bscan, int i, unsigned int mask,
+                     unsigned char key)
+{
+	int pos;
+	int j;
+
+	pos = -1;
+	while (pos < 0 && mask) {
+		j = i + __builtin_ctz(mask);
+		if (key >= bscan->keys_first[j] && key <= bscan->keys_last[j]) {
+			pos = j;
+		}
+		mask &= mask - 1;
+	}
+
+	return pos;
+}
+
+#ifdef WBK_BSCAN_X86
+__attribute__((target("sse2")))
+int
+wbk_bscan_find_sse2(const wbk_bscan_t *bscan, uint64_t word, unsigned char key)
+{
+	__m128i probe;
+	__m128i eq0;
+	__m128i eq1;
+	unsigned int mask;
+	int pos;
+	int i;
+
+	pos = -1;
+	probe = _mm_set1_epi64x((long long) word);
+
+	/**
+	 * SSE2 has no 64 bit compare. Both 32 bit halves of a word must be equal.
+	 */
+	for (i = 0; pos < 0 && i + 4 <= bscan->len; i += 4) {
+		eq0 = _mm_and_si128(probe, _mm_loadu_si128((const __m128i *) (bscan->cares + i)));
+		eq1 = _mm_and_si128(probe, _mm_loadu_si128((const __m128i *) (bscan->cares + i + 2)));
+		eq0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (bscan->words + i)), eq0);
+		eq1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (bscan->words + i + 2)), eq1);
+		eq0 = _mm_and_si128(eq0, _mm_shuffle_epi32(eq0, _MM_SHUFFLE(2, 3, 0, 1)));
+		eq1 = _mm_and_si128(eq1, _mm_shuffle_epi32(eq1, _MM_SHUFFLE(2, 3, 0, 1)));
+		mask = _mm_movemask_pd(_mm_castsi128_pd(eq0))
+		       | _mm_movemask_pd(_mm_castsi128_pd(eq1)) << 2;
+		if (mask) {
+			pos = wbk_bscan_check_keys(bscan, i, mask, key);
+		}
+	}
+
+	for (; pos < 0 && i < bscan->len; i++) {
+		if ((word & bscan->cares[i]) == bscan->words[i]
+		    && key >= bscan->keys_first[i] && key <= bscan->keys_last[i]) {
+			pos = i;
+		}
+	}
+
+	return pos;
+}
+
+__attribute__((target("avx2")))
+int
+wbk_bscan_find_avx2(const wbk_bscan_t *bscan, uint64_t word, unsigned char key)
+{
+	__m256i probe;
+	__m256i eq0;
+	__m256i eq1;
+	unsigned int mask;
+	int pos;
+	int i;
+
+	pos = -1;
+	probe = _mm256_set1_epi64x((long long) word);
+
+	for (i = 0; pos < 0 && i + 8 <= bscan->len; i += 8) {
+		eq0 = _mm256_and_si256(probe, _mm256_loadu_si256((const __m256i *) (bscan->cares + i)));
+		eq1 = _mm256_and_si256(probe, _mm256_loadu_si256((const __m256i *) (bscan->cares + i + 4)));
+		eq0 = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (bscan->words + i)), eq0);
+		eq1 = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (bscan->words + i + 4)), eq1);
+		mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq0))
+		       | _mm256_movemask_pd(_mm256_castsi256_pd(eq1)) << 4;
+		if (mask) {
+			pos = wbk_bscan_check_keys(bscan, i, mask, key);
+		}
+	}
+
+	for (; pos < 0 && i < bscan->len; i++) {
+		if ((word & bscan->cares[i]) == bscan->words[i]
+		    && key >= bscan->keys_first[i] && key <= bscan->keys_last[i]) {
+			pos = i;
+		}
+	}
+
+	return pos;
+}
+#endif
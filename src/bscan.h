@@ -0,0 +1,133 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the binding scanner class definition
+ *
+ * A binding scanner matches a binding against bindings which cannot be looked
+ * up by their hash, e.g. key ranges. Each binding is packed into a word of
+ * its modifiers and trigger plus the range of its keys:
+ *
+ *     bit 0 ... 47   modifier_map
+ *     bit 56 ... 63  trigger
+ *
+ * The words are kept in an array of their own, so SSE2 compares 2 and AVX2 4
+ * of them per instruction. Each word has a care mask, which clears the
+ * ignored modifiers (see wbk_b_t.ignore_mask) of the pressed binding before
+ * comparing. Only bindings with a matching word get their key range checked. The instruction set is picked when the scanner is created,
+ * depending on the CPU; the scalar loop is used on every other platform.
+ */
+
+#ifndef WBK_BSCAN_H
+#define WBK_BSCAN_H
+
+#include <stdint.h>
+
+#include "b.h"
+
+typedef enum wbk_bscan_isa_e
+{
+	WBK_BSCAN_SCALAR = 0,
+	WBK_BSCAN_SSE2,
+	WBK_BSCAN_AVX2
+} wbk_bscan_isa_t;
+
+typedef struct wbk_bscan_s wbk_bscan_t;
+
+struct wbk_bscan_s
+{
+	int len;
+	int size;
+
+	/**
+	 * The packed modifiers and triggers
+	 */
+	uint64_t *words;
+
+	/**
+	 * The bits of the words which must be equal
+	 */
+	uint64_t *cares;
+
+	unsigned char *keys_first;
+	unsigned char *keys_last;
+
+	/**
+	 * The values passed to wbk_bscan_add()
+	 */
+	int *values;
+
+	wbk_bscan_isa_t isa;
+	int (*find)(const wbk_bscan_t *bscan, uint64_t word, unsigned char key);
+};
+
+/**
+ * @brief Creates an empty binding scanner using the best instruction set of
+ * the CPU
+ * @return A new binding scanner or NULL if allocation failed
+ */
+extern wbk_bscan_t *
+wbk_bscan_new();
+
+extern int
+wbk_bscan_free(wbk_bscan_t *bscan);
+
+/**
+ * @brief Adds a binding. Bindings without key range match their lowest key
+ * only.
+ * @param value Is returned by wbk_bscan_find() if the binding matches
+ * @return Non-0 if the binding has more than one key or allocation failed
+ */
+extern int
+wbk_bscan_add(wbk_bscan_t *bscan, const wbk_b_t *b, int value);
+
+/**
+ * @brief Finds the first added binding matching a binding as by
+ * wbk_b_matches()
+ * @return The value of the binding or -1 if none matches
+ */
+extern int
+wbk_bscan_find(const wbk_bscan_t *bscan, const wbk_b_t *b);
+
+/**
+ * @brief Packs the modifiers and the trigger of a binding
+ */
+extern uint64_t
+wbk_bscan_pack(const wbk_b_t *b);
+
+/**
+ * @brief Selects the instruction set. Benchmarks and tests use it to compare
+ * them.
+ * @return Non-0 if the CPU or the build does not support it
+ */
+extern int
+wbk_bscan_set_isa(wbk_bscan_t *bscan, wbk_bscan_isa_t isa);
+
+extern wbk_bscan_isa_t
+wbk_bscan_get_isa(const wbk_bscan_t *bscan);
+
+#endif // WBK_BSCAN_H
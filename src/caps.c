@@ -0,0 +1,248 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the process caps implementation and private methods
+ */
+
+#include "caps.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+static wbk_logger_t logger =  { "caps" };
+
+static const char *WBK_CAPS_PRIORITY_NAMES[] = {
+	"default", "idle", "low", "normal", "high", NULL
+};
+
+#if defined(WIN32)
+static const DWORD WBK_CAPS_PRIORITY_CLASSES[] = {
+	0, IDLE_PRIORITY_CLASS, BELOW_NORMAL_PRIORITY_CLASS, NORMAL_PRIORITY_CLASS,
+	ABOVE_NORMAL_PRIORITY_CLASS
+};
+
+/**
+ * The job of the daemon, which kills the processes once it is closed by the
+ * exit of the daemon
+ */
+static HANDLE g_caps_job = NULL;
+
+/**
+ * Gets the job of the daemon and creates it on the first call.
+ */
+static HANDLE
+wbk_caps_get_job(void);
+#else
+static const int WBK_CAPS_NICE_VALUES[] = {
+	0, 19, 10, 0, -5
+};
+#endif
+
+void
+wbk_caps_init(wbk_caps_t *caps)
+{
+	memset(caps, 0, sizeof(wbk_caps_t));
+
+	caps->priority = WBK_CAPS_PRIORITY_DEFAULT;
+	caps->memory = 0;
+	caps->lifetime = 0;
+	caps->detach = 0;
+}
+
+int
+wbk_caps_parse(wbk_caps_t *caps, const char *option)
+{
+	char *unit;
+	unsigned long long memory;
+	int i;
+	int error;
+
+	error = 0;
+
+	if (strncmp(option, "priority=", 9) == 0) {
+		for (i = 1; WBK_CAPS_PRIORITY_NAMES[i] && strcmp(WBK_CAPS_PRIORITY_NAMES[i], option + 9); i++) {
+			/* Find the priority */
+		}
+		if (WBK_CAPS_PRIORITY_NAMES[i]) {
+			caps->priority = (wbk_caps_priority_t) i;
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Unknown priority: %s\n", option + 9);
+		}
+	} else if (strncmp(option, "memory=", 7) == 0) {
+		memory = strtoull(option + 7, &unit, 10);
+		if (*unit == 'K' || *unit == 'k') {
+			memory <<= 10;
+		} else if (*unit == 'M' || *unit == 'm') {
+			memory <<= 20;
+		} else if (*unit == 'G' || *unit == 'g') {
+			memory <<= 30;
+		}
+		caps->memory = memory;
+	} else if (strncmp(option, "lifetime=", 9) == 0) {
+		caps->lifetime = atoi(option + 9) * 1000;
+	} else if (strcmp(option, "detach") == 0) {
+		caps->detach = 1;
+	} else {
+		error = 1;
+	}
+
+	return error;
+}
+
+int
+wbk_caps_compare(const wbk_caps_t *caps, const wbk_caps_t *other)
+{
+	return caps->priority != other->priority
+	       || caps->memory != other->memory
+	       || caps->lifetime != other->lifetime
+	       || caps->detach != other->detach;
+}
+
+char *
+wbk_caps_to_str(const wbk_caps_t *caps)
+{
+	wbk_caps_t none;
+	char *str;
+	int length;
+
+	wbk_caps_init(&none);
+
+	str = NULL;
+	if (wbk_caps_compare(caps, &none)) {
+		str = malloc(sizeof(char) * 96);
+		str[0] = '\0';
+		length = 0;
+
+		if (caps->priority != WBK_CAPS_PRIORITY_DEFAULT) {
+			length += sprintf(str + length, " priority=%s", WBK_CAPS_PRIORITY_NAMES[caps->priority]);
+		}
+		if (caps->memory && caps->memory % (1 << 20) == 0) {
+			length += sprintf(str + length, " memory=%lluM", caps->memory >> 20);
+		} else if (caps->memory) {
+			length += sprintf(str + length, " memory=%llu", caps->memory);
+		}
+		if (caps->lifetime) {
+			length += sprintf(str + length, " lifetime=%d", caps->lifetime / 1000);
+		}
+		if (caps->detach) {
+			length += sprintf(str + length, " detach");
+		}
+
+		/**
+		 * Drop the leading space
+		 */
+		memmove(str, str + 1, sizeof(char) * length);
+	}
+
+	return str;
+}
+
+#if defined(WIN32)
+HANDLE
+wbk_caps_assign(const wbk_caps_t *caps, HANDLE process)
+{
+	JOBOBJECT_EXTENDED_LIMIT_INFORMATION info;
+	HANDLE job;
+
+	/**
+	 * The job of the caps becomes nested in the job of the daemon
+	 */
+	if (!caps->detach) {
+		job = wbk_caps_get_job();
+		if (job == NULL || !AssignProcessToJobObject(job, process)) {
+			wbk_logger_log(&logger, WARNING, "Cannot put a process in the job of the daemon\n");
+		}
+	}
+
+	job = NULL;
+	if (caps->priority != WBK_CAPS_PRIORITY_DEFAULT || caps->memory || caps->lifetime) {
+		memset(&info, 0, sizeof(JOBOBJECT_EXTENDED_LIMIT_INFORMATION));
+		if (caps->priority != WBK_CAPS_PRIORITY_DEFAULT) {
+			info.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_PRIORITY_CLASS;
+			info.BasicLimitInformation.PriorityClass = WBK_CAPS_PRIORITY_CLASSES[caps->priority];
+		}
+		if (caps->memory) {
+			info.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_PROCESS_MEMORY;
+			info.ProcessMemoryLimit = (size_t) caps->memory;
+		}
+
+		job = CreateJobObjectA(NULL, NULL);
+		if (job == NULL
+		    || !SetInformationJobObject(job, JobObjectExtendedLimitInformation, &info, sizeof(info))
+		    || !AssignProcessToJobObject(job, process)) {
+			wbk_logger_log(&logger, WARNING, "Cannot apply the caps to a process\n");
+			if (job) {
+				CloseHandle(job);
+				job = NULL;
+			}
+		}
+	}
+
+	return job;
+}
+
+HANDLE
+wbk_caps_get_job(void)
+{
+	JOBOBJECT_EXTENDED_LIMIT_INFORMATION info;
+	HANDLE job;
+	HANDLE expected;
+
+	job = __atomic_load_n(&g_caps_job, __ATOMIC_ACQUIRE);
+	if (job == NULL) {
+		memset(&info, 0, sizeof(JOBOBJECT_EXTENDED_LIMIT_INFORMATION));
+		info.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+
+		job = CreateJobObjectA(NULL, NULL);
+		if (job) {
+			SetInformationJobObject(job, JobObjectExtendedLimitInformation, &info, sizeof(info));
+
+			/**
+			 * Another thread may have created it meanwhile
+			 */
+			expected = NULL;
+			if (!__atomic_compare_exchange_n(&g_caps_job, &expected, job, 0,
+			                                 __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+				CloseHandle(job);
+				job = expected;
+			}
+		}
+	}
+
+	return job;
+}
+#else
+int
+wbk_caps_get_nice(const wbk_caps_t *caps)
+{
+	return WBK_CAPS_NICE_VALUES[caps->priority];
+}
+#endif
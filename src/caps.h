@@ -0,0 +1,128 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the process caps definition
+ *
+ * Process caps restrict the processes of a key binding system command (see
+ * kc_sys.h). They are written in the rc file after the command:
+ *
+ *     "build.bat" priority=low memory=2G lifetime=600
+ *     "notepad.exe" detach
+ *
+ * On WIN32 every process is put in a job object, which is nested in a job of
+ * the daemon, and the caps become limits of the job. Elsewhere the launcher
+ * (see launcher.h) puts every process in its own process group. The process
+ * group, or the job, is killed once its lifetime is over and when the daemon
+ * exits, unless the process is detached.
+ */
+
+#ifndef WBK_CAPS_H
+#define WBK_CAPS_H
+
+#if defined(WIN32)
+#include <windows.h>
+#endif
+
+typedef enum wbk_caps_priority_e
+{
+	/**
+	 * The priority of the daemon is inherited
+	 */
+	WBK_CAPS_PRIORITY_DEFAULT = 0,
+	WBK_CAPS_PRIORITY_IDLE,
+	WBK_CAPS_PRIORITY_LOW,
+	WBK_CAPS_PRIORITY_NORMAL,
+	WBK_CAPS_PRIORITY_HIGH
+} wbk_caps_priority_t;
+
+typedef struct wbk_caps_s
+{
+	wbk_caps_priority_t priority;
+
+	/**
+	 * Maximum bytes of memory a process may commit or 0 if unlimited
+	 */
+	unsigned long long memory;
+
+	/**
+	 * Milliseconds after which the process is killed or 0 if unlimited
+	 */
+	int lifetime;
+
+	/**
+	 * Non-0 if the process keeps running once the daemon exited
+	 */
+	int detach;
+} wbk_caps_t;
+
+/**
+ * @brief Sets the caps, which restrict nothing.
+ */
+extern void
+wbk_caps_init(wbk_caps_t *caps);
+
+/**
+ * @brief Parses an option of the rc file like "memory=512M".
+ * @return Non-0 if the option is no cap
+ */
+extern int
+wbk_caps_parse(wbk_caps_t *caps, const char *option);
+
+/**
+ * @brief Compares two caps.
+ * @return 0 if they are equal
+ */
+extern int
+wbk_caps_compare(const wbk_caps_t *caps, const wbk_caps_t *other);
+
+/**
+ * @brief Gets the options of caps as written in the rc file.
+ * @return The options or NULL if the caps restrict nothing. Free it by
+ *         yourself.
+ */
+extern char *
+wbk_caps_to_str(const wbk_caps_t *caps);
+
+#if defined(WIN32)
+/**
+ * @brief Puts a suspended process in the job of the daemon, unless it is
+ * detached, and in a job with the limits of the caps.
+ * @return The job with the limits or NULL if the caps restrict nothing. Close
+ *         it once the process exited.
+ */
+extern HANDLE
+wbk_caps_assign(const wbk_caps_t *caps, HANDLE process);
+#else
+/**
+ * @brief Gets the nice value of the priority.
+ */
+extern int
+wbk_caps_get_nice(const wbk_caps_t *caps);
+#endif
+
+#endif // WBK_CAPS_H
@@ -0,0 +1,508 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the output capture class implementation and private methods
+ */
+
+#include "capture.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#include "logger.h"
+
+/**
+ * Maximum number of bytes read from a pipe per call of the job
+ */
+#define WBK_CAPTURE_READ_MAX 65536
+
+static wbk_logger_t logger =  { "capture" };
+
+/**
+ * Reads the open pipes without blocking.
+ *
+ * @return WBK_CAPTURE_READ_INTERVAL or -1 if no pipe is open
+ */
+static long
+wbk_capture_job_fn(wbk_job_t *job, void *param);
+
+/**
+ * Reads the open pipes until they would block and closes the closed ones.
+ * The mutex must be locked.
+ */
+static void
+wbk_capture_drain(wbk_capture_t *capture);
+
+/**
+ * Reads from a pipe until it would block.
+ *
+ * @return Non-0 if the pipe is closed by the process
+ */
+static int
+wbk_capture_read_pipe(wbk_capture_t *capture, wbk_capture_pipe_t pipe);
+
+static void
+wbk_capture_close_pipe(wbk_capture_pipe_t pipe);
+
+/**
+ * Appends bytes to the ring. The mutex must be locked.
+ */
+static void
+wbk_capture_append(wbk_capture_t *capture, const char *data, int data_len);
+
+static void
+wbk_capture_mutex_lock(wbk_capture_t *capture);
+
+static void
+wbk_capture_mutex_unlock(wbk_capture_t *capture);
+
+wbk_capture_t *
+wbk_capture_new(int size, wbk_executor_t *executor)
+{
+	wbk_capture_t *capture;
+
+	capture = NULL;
+	capture = malloc(sizeof(wbk_capture_t));
+
+	if (capture) {
+		memset(capture, 0, sizeof(wbk_capture_t));
+
+		capture->ring = malloc(sizeof(char) * size);
+		if (capture->ring) {
+			capture->refcount = 1;
+			capture->size = size;
+			capture->start = 0;
+			capture->length = 0;
+			capture->status = 0;
+			capture->has_status = 0;
+			capture->pipes = NULL;
+			capture->pipes_len = 0;
+			capture->pipes_size = 0;
+			capture->executor = executor;
+			wbk_job_init(&(capture->job), wbk_capture_job_fn, capture);
+
+#if defined(WIN32)
+			InitializeCriticalSection(&(capture->mutex));
+#else
+			pthread_mutex_init(&(capture->mutex), NULL);
+#endif
+		} else {
+			free(capture);
+			capture = NULL;
+		}
+	}
+
+	return capture;
+}
+
+int
+wbk_capture_free(wbk_capture_t *capture)
+{
+	int i;
+
+	if (__atomic_sub_fetch(&(capture->refcount), 1, __ATOMIC_ACQ_REL) == 0) {
+		if (capture->executor) {
+			wbk_executor_cancel(capture->executor, &(capture->job));
+		}
+
+		for (i = 0; i < capture->pipes_len; i++) {
+			wbk_capture_close_pipe(capture->pipes[i]);
+		}
+
+#if defined(WIN32)
+		DeleteCriticalSection(&(capture->mutex));
+#else
+		pthread_mutex_destroy(&(capture->mutex));
+#endif
+
+		free(capture->pipes);
+		free(capture->ring);
+		free(capture);
+	}
+
+	return 0;
+}
+
+wbk_capture_t *
+wbk_capture_retain(wbk_capture_t *capture)
+{
+	__atomic_add_fetch(&(capture->refcount), 1, __ATOMIC_RELAXED);
+
+	return capture;
+}
+
+int
+wbk_capture_attach(wbk_capture_t *capture, wbk_capture_pipe_t pipe)
+{
+	wbk_capture_pipe_t *pipes;
+	int size;
+	int error;
+
+	error = 0;
+
+	if (!capture->executor) {
+		error = 1;
+	}
+
+	if (!error) {
+		wbk_capture_mutex_lock(capture);
+
+		if (capture->pipes_len == capture->pipes_size) {
+			size = capture->pipes_size ? capture->pipes_size * 2 : 4;
+			pipes = realloc(capture->pipes, sizeof(wbk_capture_pipe_t) * size);
+			if (pipes) {
+				capture->pipes = pipes;
+				capture->pipes_size = size;
+			} else {
+				error = 1;
+			}
+		}
+
+		if (!error) {
+			capture->pipes[capture->pipes_len++] = pipe;
+		}
+
+		wbk_capture_mutex_unlock(capture);
+	}
+
+	if (!error) {
+		error = wbk_executor_signal(capture->executor, &(capture->job));
+		/* Not running, the pipe is closed by wbk_capture_free() */
+	} else {
+		wbk_logger_log(&logger, WARNING, "Cannot capture output\n");
+		wbk_capture_close_pipe(pipe);
+	}
+
+	return error;
+}
+
+void
+wbk_capture_exit(wbk_capture_t *capture, int status)
+{
+	char buffer[32];
+
+	snprintf(buffer, sizeof(buffer), "[exit %d]\n", status);
+
+	wbk_capture_mutex_lock(capture);
+
+	/**
+	 * The output of the process precedes its exit code
+	 */
+	wbk_capture_drain(capture);
+
+	capture->status = status;
+	capture->has_status = 1;
+	wbk_capture_append(capture, buffer, strlen(buffer));
+
+	wbk_capture_mutex_unlock(capture);
+}
+
+void
+wbk_capture_write(wbk_capture_t *capture, const char *data, int data_len)
+{
+	wbk_capture_mutex_lock(capture);
+	wbk_capture_append(capture, data, data_len);
+	wbk_capture_mutex_unlock(capture);
+}
+
+int
+wbk_capture_read(wbk_capture_t *capture, char *buffer, int buffer_len)
+{
+	int length;
+	int skip;
+	int first;
+
+	length = 0;
+
+	if (buffer_len > 0) {
+		wbk_capture_mutex_lock(capture);
+
+		length = capture->length;
+		if (length > buffer_len - 1) {
+			length = buffer_len - 1;
+		}
+		skip = capture->length - length;
+
+		first = capture->size - (capture->start + skip) % capture->size;
+		if (first > length) {
+			first = length;
+		}
+		memcpy(buffer, capture->ring + (capture->start + skip) % capture->size, first);
+		memcpy(buffer + first, capture->ring, length - first);
+		buffer[length] = '\0';
+
+		wbk_capture_mutex_unlock(capture);
+	}
+
+	return length;
+}
+
+int
+wbk_capture_get_status(wbk_capture_t *capture, int *status)
+{
+	int error;
+
+	wbk_capture_mutex_lock(capture);
+
+	error = !capture->has_status;
+	if (!error) {
+		*status = capture->status;
+	}
+
+	wbk_capture_mutex_unlock(capture);
+
+	return error;
+}
+
+int
+wbk_capture_dump(wbk_capture_t *capture, const char *filename)
+{
+	FILE *file;
+	char *buffer;
+	int length;
+	int error;
+
+	error = 0;
+
+	buffer = malloc(sizeof(char) * (capture->size + 1));
+	if (!buffer) {
+		error = 1;
+	}
+
+	if (!error) {
+		length = wbk_capture_read(capture, buffer, capture->size + 1);
+
+		file = fopen(filename, "wb");
+		if (file) {
+			error = fwrite(buffer, sizeof(char), length, file) != (size_t) length;
+			error = fclose(file) || error;
+		} else {
+			error = 1;
+		}
+
+		if (error) {
+			wbk_logger_log(&logger, SEVERE, "Cannot write %s\n", filename);
+		}
+	}
+
+	free(buffer);
+
+	return error;
+}
+
+int
+wbk_capture_compare(const wbk_capture_t *capture, const wbk_capture_t *other)
+{
+	int result;
+
+	if (capture == NULL || other == NULL) {
+		result = capture != other;
+	} else {
+		result = capture->size != other->size;
+	}
+
+	return result;
+}
+
+char *
+wbk_capture_to_str(const wbk_capture_t *capture)
+{
+	char *str;
+
+	str = malloc(sizeof(char) * 24);
+
+	if (capture->size == WBK_CAPTURE_DEFAULT_SIZE) {
+		strcpy(str, "capture");
+	} else {
+		sprintf(str, "capture=%d", capture->size);
+	}
+
+	return str;
+}
+
+long
+wbk_capture_job_fn(wbk_job_t *job, void *param)
+{
+	wbk_capture_t *capture;
+	long delay;
+
+	capture = (wbk_capture_t *) param;
+
+	wbk_capture_mutex_lock(capture);
+
+	wbk_capture_drain(capture);
+	delay = capture->pipes_len ? WBK_CAPTURE_READ_INTERVAL : -1;
+
+	wbk_capture_mutex_unlock(capture);
+
+	return delay;
+}
+
+void
+wbk_capture_drain(wbk_capture_t *capture)
+{
+	int i;
+
+	i = 0;
+	while (i < capture->pipes_len) {
+		if (wbk_capture_read_pipe(capture, capture->pipes[i])) {
+			wbk_capture_close_pipe(capture->pipes[i]);
+			capture->pipes[i] = capture->pipes[--capture->pipes_len];
+		} else {
+			i++;
+		}
+	}
+}
+
+void
+wbk_capture_append(wbk_capture_t *capture, const char *data, int data_len)
+{
+	int end;
+	int first;
+
+	if (data_len > capture->size) {
+		data += data_len - capture->size;
+		data_len = capture->size;
+	}
+
+	end = (capture->start + capture->length) % capture->size;
+	first = capture->size - end;
+	if (first > data_len) {
+		first = data_len;
+	}
+	memcpy(capture->ring + end, data, first);
+	memcpy(capture->ring, data + first, data_len - first);
+
+	capture->length += data_len;
+	if (capture->length > capture->size) {
+		capture->start = (capture->start + capture->length - capture->size) % capture->size;
+		capture->length = capture->size;
+	}
+}
+
+#if defined(WIN32)
+int
+wbk_capture_read_pipe(wbk_capture_t *capture, wbk_capture_pipe_t pipe)
+{
+	char buffer[4096];
+	DWORD available;
+	DWORD length;
+	int total;
+	int closed;
+
+	closed = 0;
+	total = 0;
+
+	while (!closed && total < WBK_CAPTURE_READ_MAX) {
+		if (!PeekNamedPipe(pipe, NULL, 0, NULL, &available, NULL)) {
+			closed = 1;
+		} else if (available == 0) {
+			break;
+		} else if (!ReadFile(pipe, buffer,
+		                     available < sizeof(buffer) ? available : sizeof(buffer),
+		                     &length, NULL)) {
+			closed = 1;
+		} else {
+			wbk_capture_append(capture, buffer, length);
+			total += length;
+		}
+	}
+
+	return closed;
+}
+
+void
+wbk_capture_close_pipe(wbk_capture_pipe_t pipe)
+{
+	CloseHandle(pipe);
+}
+
+void
+wbk_capture_mutex_lock(wbk_capture_t *capture)
+{
+	EnterCriticalSection(&(capture->mutex));
+}
+
+void
+wbk_capture_mutex_unlock(wbk_capture_t *capture)
+{
+	LeaveCriticalSection(&(capture->mutex));
+}
+#else
+int
+wbk_capture_read_pipe(wbk_capture_t *capture, wbk_capture_pipe_t pipe)
+{
+	char buffer[4096];
+	ssize_t length;
+	int total;
+	int closed;
+
+	closed = 0;
+	total = 0;
+
+	while (!closed && total < WBK_CAPTURE_READ_MAX) {
+		length = read(pipe, buffer, sizeof(buffer));
+		if (length > 0) {
+			wbk_capture_append(capture, buffer, length);
+			total += length;
+		} else if (length == 0) {
+			closed = 1;
+		} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			break;
+		} else if (errno != EINTR) {
+			closed = 1;
+		}
+	}
+
+	return closed;
+}
+
+void
+wbk_capture_close_pipe(wbk_capture_pipe_t pipe)
+{
+	close(pipe);
+}
+
+void
+wbk_capture_mutex_lock(wbk_capture_t *capture)
+{
+	pthread_mutex_lock(&(capture->mutex));
+}
+
+void
+wbk_capture_mutex_unlock(wbk_capture_t *capture)
+{
+	pthread_mutex_unlock(&(capture->mutex));
+}
+#endif
@@ -0,0 +1,202 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the output capture class definition
+ *
+ * An output capture keeps the latest output and exit codes of the processes
+ * of a key binding system command (see kc_sys.h) in a ring of fixed size.
+ * Older output is overwritten, thus its memory is bounded whatever the
+ * command prints. It is enabled in the rc file after the command:
+ *
+ *     "backup.sh" capture
+ *     "build.bat" capture=64K
+ *
+ * The stdout and stderr of a process go to a pipe. The pipes are read
+ * without blocking by a job of an executor (see executor.h), never by the
+ * thread of an input backend. The job runs while pipes are open.
+ *
+ * Captures are shared by the clones of a key binding command, thus they are
+ * reference counted.
+ */
+
+#ifndef WBK_CAPTURE_H
+#define WBK_CAPTURE_H
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "executor.h"
+
+/**
+ * Bytes of a ring if the rc file does not give its size
+ */
+#define WBK_CAPTURE_DEFAULT_SIZE 4096
+
+/**
+ * Maximum bytes of a ring
+ */
+#define WBK_CAPTURE_MAX_SIZE (16 << 20)
+
+/**
+ * Milliseconds between reading the pipes while they are open
+ */
+#define WBK_CAPTURE_READ_INTERVAL 50
+
+#if defined(WIN32)
+typedef HANDLE wbk_capture_pipe_t;
+#else
+typedef int wbk_capture_pipe_t;
+#endif
+
+typedef struct wbk_capture_s
+{
+	int refcount;
+
+	/**
+	 * The ring. Guarded by mutex like everything below.
+	 */
+	char *ring;
+	int size;
+	int start;
+	int length;
+
+	/**
+	 * The exit code of the last exited process
+	 */
+	int status;
+	int has_status;
+
+	/**
+	 * The read ends of the pipes of the running processes
+	 */
+	wbk_capture_pipe_t *pipes;
+	int pipes_len;
+	int pipes_size;
+
+	/**
+	 * Not owned by the capture
+	 */
+	wbk_executor_t *executor;
+
+	wbk_job_t job;
+
+#if defined(WIN32)
+	CRITICAL_SECTION mutex;
+#else
+	pthread_mutex_t mutex;
+#endif
+} wbk_capture_t;
+
+/**
+ * @brief Creates a new output capture
+ * @param size Bytes of the ring
+ * @param executor The executor reading the pipes. It must outlive the capture.
+ * @return A new output capture or NULL if allocation failed
+ */
+extern wbk_capture_t *
+wbk_capture_new(int size, wbk_executor_t *executor);
+
+/**
+ * @brief Releases a reference. The last one closes the pipes and frees the
+ * output capture.
+ */
+extern int
+wbk_capture_free(wbk_capture_t *capture);
+
+/**
+ * @brief Adds a reference.
+ * @return The output capture
+ */
+extern wbk_capture_t *
+wbk_capture_retain(wbk_capture_t *capture);
+
+/**
+ * @brief Reads the output of a process from a pipe until it is closed.
+ * Returns at once.
+ * @param pipe The read end of the pipe. It is closed by the capture.
+ * @return Non-0 if the pipe cannot be read. It is closed by the capture
+ *         anyway.
+ */
+extern int
+wbk_capture_attach(wbk_capture_t *capture, wbk_capture_pipe_t pipe);
+
+/**
+ * @brief Records the exit code of a process. The output it wrote so far is
+ * read first.
+ * @param status The exit code, 128 plus the number of a signal which killed
+ *        the process or -1 if it could not be started
+ */
+extern void
+wbk_capture_exit(wbk_capture_t *capture, int status);
+
+/**
+ * @brief Appends bytes to the ring.
+ */
+extern void
+wbk_capture_write(wbk_capture_t *capture, const char *data, int data_len);
+
+/**
+ * @brief Copies the captured output, the oldest byte first.
+ * @param buffer Is set to the latest buffer_len - 1 bytes and a terminating
+ *        character
+ * @return The number of copied bytes
+ */
+extern int
+wbk_capture_read(wbk_capture_t *capture, char *buffer, int buffer_len);
+
+/**
+ * @brief Gets the exit code of the last exited process.
+ * @return Non-0 if no process exited yet
+ */
+extern int
+wbk_capture_get_status(wbk_capture_t *capture, int *status);
+
+/**
+ * @brief Writes the captured output to a file, replacing its content.
+ * @return Non-0 if the file cannot be written
+ */
+extern int
+wbk_capture_dump(wbk_capture_t *capture, const char *filename);
+
+/**
+ * @brief Compares the sizes of two output captures. Either may be NULL.
+ * @return 0 if both are NULL or of the same size
+ */
+extern int
+wbk_capture_compare(const wbk_capture_t *capture, const wbk_capture_t *other);
+
+/**
+ * @brief Gets the option of an output capture as written in the rc file.
+ */
+extern char *
+wbk_capture_to_str(const wbk_capture_t *capture);
+
+#endif // WBK_CAPTURE_H
@@ -0,0 +1,1329 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the control server class implementation and private methods
+ */
+
+#if !defined(WIN32) && !defined(_GNU_SOURCE)
+/**
+ * struct ucred
+ */
+#define _GNU_SOURCE
+#endif
+
+#include "ctl.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#endif
+
+#include "logger.h"
+#include "parser.h"
+
+#define WBK_CTL_NAME "w32bindkeys"
+
+/**
+ * Milliseconds a client waits for a busy control server.
+ */
+#define WBK_CTL_TIMEOUT 5000
+
+static wbk_logger_t logger =  { "ctl" };
+
+/**
+ * A growing string.
+ */
+typedef struct wbk_ctl_buf_s
+{
+	char *str;
+	int len;
+	int size;
+} wbk_ctl_buf_t;
+
+/**
+ * The state of a single client connection.
+ */
+typedef struct wbk_ctl_session_s
+{
+	int batch;
+	int mut_arr_len;
+	wbk_kbtable_mut_t **mut_arr;
+} wbk_ctl_session_t;
+
+#if defined(WIN32)
+struct wbk_ctl_security_s
+{
+	SECURITY_ATTRIBUTES attributes;
+	SECURITY_DESCRIPTOR descriptor;
+	ACL acl;
+
+	/**
+	 * The single entry of acl.
+	 */
+	BYTE ace[sizeof(ACCESS_ALLOWED_ACE) + SECURITY_MAX_SID_SIZE];
+};
+#endif
+
+static int
+wbk_ctl_buf_printf(wbk_ctl_buf_t *buf, const char *format, ...);
+
+/**
+ * Frees the changes of an unfinished batch.
+ */
+static int
+wbk_ctl_session_reset(wbk_ctl_session_t *session);
+
+/**
+ * @return The next word of rest or NULL if there is none. The word is
+ * terminated within rest and rest is set behind it.
+ */
+static char *
+wbk_ctl_next_word(char **rest);
+
+/**
+ * @return The binding of rest or NULL if rest contains no binding.
+ */
+static wbk_b_t *
+wbk_ctl_parse_binding(char *rest);
+
+/**
+ * Applies a single change or adds it to the batch of the session.
+ */
+static int
+wbk_ctl_handle_mut(wbk_ctl_t *ctl, wbk_ctl_session_t *session,
+                   wbk_kbtable_mut_t *mut, wbk_ctl_buf_t *out);
+
+static int
+wbk_ctl_handle_list(wbk_ctl_t *ctl, const char *mode, wbk_ctl_buf_t *out);
+
+static int
+wbk_ctl_handle_stats(wbk_ctl_t *ctl, wbk_ctl_buf_t *out);
+
+/**
+ * Answers a single request line.
+ */
+static int
+wbk_ctl_handle(wbk_ctl_t *ctl, wbk_ctl_session_t *session, char *line, wbk_ctl_buf_t *out);
+
+/**
+ * Answers all complete request lines of in and keeps the incomplete rest.
+ * @return Non-0 if in is full without containing a complete line.
+ */
+static int
+wbk_ctl_handle_input(wbk_ctl_t *ctl, wbk_ctl_session_t *session,
+                     char *in, int *in_len, wbk_ctl_buf_t *out);
+
+/**
+ * @param failed Is set to non-0 if any of the answers is an error.
+ * @return The number of answers (final response lines) within str.
+ */
+static int
+wbk_ctl_count_answers(const char *str, int *failed);
+
+/**
+ * @return The number of request lines within str.
+ */
+static int
+wbk_ctl_count_requests(const char *str);
+
+#if defined(WIN32)
+static DWORD WINAPI
+wbk_ctl_thread(LPVOID param);
+
+/**
+ * @return Security attributes, which grant access to the current user only,
+ * or NULL if the user cannot be determined.
+ */
+static wbk_ctl_security_t *
+wbk_ctl_security_new(void);
+
+/**
+ * @param flags FILE_FLAG_FIRST_PIPE_INSTANCE for the first instance, else 0
+ * @return Another instance of the pipe or NULL if it cannot be created
+ */
+static HANDLE
+wbk_ctl_pipe_new(wbk_ctl_t *ctl, DWORD flags);
+
+/**
+ * Waits for an overlapped operation on the pipe. It is cancelled once the
+ * timeout in milliseconds passed.
+ * @return Non-0 if the operation failed, timed out or the control server was
+ * stopped.
+ */
+static int
+wbk_ctl_wait(wbk_ctl_t *ctl, HANDLE pipe, OVERLAPPED *overlapped, DWORD *length,
+             DWORD timeout);
+
+/**
+ * Serves a connected client until it disconnects or is idle for
+ * WBK_CTL_IDLE_TIMEOUT.
+ */
+static int
+wbk_ctl_serve(wbk_ctl_t *ctl, HANDLE pipe, OVERLAPPED *overlapped);
+#else
+static void *
+wbk_ctl_thread(void *param);
+
+/**
+ * Serves a connected client until it disconnects or is idle for
+ * WBK_CTL_IDLE_TIMEOUT.
+ * @return Non-0 if the control server was stopped.
+ */
+static int
+wbk_ctl_serve(wbk_ctl_t *ctl, int fd);
+
+static int
+wbk_ctl_write(int fd, const char *str, int len);
+
+/**
+ * Removes a socket left behind by a control server of the same user, which is
+ * not running anymore.
+ * @return Non-0 if the address is taken by anything else.
+ */
+static int
+wbk_ctl_remove_stale(const struct sockaddr_un *addr);
+
+/**
+ * @return Non-0 if the peer of fd runs as the same user as the control server.
+ */
+static int
+wbk_ctl_is_trusted(int fd);
+#endif
+
+wbk_ctl_t *
+wbk_ctl_new(const char *address, wbk_kbtable_t *kbtable)
+{
+	wbk_ctl_t *ctl;
+
+	ctl = NULL;
+	ctl = malloc(sizeof(wbk_ctl_t));
+
+	if (ctl) {
+		memset(ctl, 0, sizeof(wbk_ctl_t));
+
+		ctl->address = malloc(sizeof(char) * (strlen(address) + 1));
+		strcpy(ctl->address, address);
+
+		ctl->kbtable = kbtable;
+		ctl->config_fn = NULL;
+		ctl->param = NULL;
+		ctl->running = 0;
+
+#if defined(WIN32)
+		ctl->stop_event = NULL;
+		ctl->thread = NULL;
+		ctl->pipe = NULL;
+		ctl->security = NULL;
+#else
+		ctl->fd = -1;
+		ctl->stop_fd[0] = -1;
+		ctl->stop_fd[1] = -1;
+		ctl->bound = 0;
+#endif
+	}
+
+	return ctl;
+}
+
+int
+wbk_ctl_free(wbk_ctl_t *ctl)
+{
+	wbk_ctl_stop(ctl);
+
+	free(ctl->address);
+	ctl->address = NULL;
+
+	free(ctl);
+
+	return 0;
+}
+
+int
+wbk_ctl_set_config_fn(wbk_ctl_t *ctl,
+                      int (*config_fn)(wbk_ctl_t *ctl, const char *filename, void *param),
+                      void *param)
+{
+	ctl->config_fn = config_fn;
+	ctl->param = param;
+
+	return 0;
+}
+
+char *
+wbk_ctl_default_address(void)
+{
+	char *address;
+	const char *dir;
+	const char *user;
+
+#if defined(WIN32)
+	dir = "\\\\.\\pipe";
+	user = getenv("USERNAME");
+	if (user == NULL) {
+		user = "default";
+	}
+
+	address = malloc(sizeof(char) * (strlen(dir) + strlen(WBK_CTL_NAME) + strlen(user) + 3));
+	sprintf(address, "%s\\%s-%s", dir, WBK_CTL_NAME, user);
+#else
+	char uid[32];
+
+	dir = getenv("XDG_RUNTIME_DIR");
+	if (dir == NULL) {
+		dir = "/tmp";
+	}
+	sprintf(uid, "%d", (int) getuid());
+	user = uid;
+
+	address = malloc(sizeof(char) * (strlen(dir) + strlen(WBK_CTL_NAME) + strlen(user) + 8));
+	sprintf(address, "%s/%s-%s.sock", dir, WBK_CTL_NAME, user);
+#endif
+
+	return address;
+}
+
+int
+wbk_ctl_buf_printf(wbk_ctl_buf_t *buf, const char *format, ...)
+{
+	va_list args;
+	int length;
+
+	va_start(args, format);
+	length = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+
+	if (buf->len + length + 1 > buf->size) {
+		buf->size = (buf->len + length + 1) * 2;
+		buf->str = realloc(buf->str, sizeof(char) * buf->size);
+	}
+
+	va_start(args, format);
+	vsnprintf(buf->str + buf->len, length + 1, format, args);
+	va_end(args);
+
+	buf->len += length;
+
+	return 0;
+}
+
+int
+wbk_ctl_session_reset(wbk_ctl_session_t *session)
+{
+	int i;
+
+	for (i = 0; i < session->mut_arr_len; i++) {
+		wbk_kbtable_mut_free(session->mut_arr[i]);
+		session->mut_arr[i] = NULL;
+	}
+	free(session->mut_arr);
+	session->mut_arr = NULL;
+	session->mut_arr_len = 0;
+	session->batch = 0;
+
+	return 0;
+}
+
+char *
+wbk_ctl_next_word(char **rest)
+{
+	char *word;
+
+	while (**rest == ' ' || **rest == '\t') {
+		(*rest)++;
+	}
+
+	word = NULL;
+	if (**rest != '\0') {
+		word = *rest;
+		while (**rest != '\0' && **rest != ' ' && **rest != '\t') {
+			(*rest)++;
+		}
+
+		if (**rest != '\0') {
+			**rest = '\0';
+			(*rest)++;
+		}
+	}
+
+	return word;
+}
+
+wbk_b_t *
+wbk_ctl_parse_binding(char *rest)
+{
+	wbk_b_t *binding;
+	int i;
+
+	binding = NULL;
+	for (i = 0; binding == NULL && rest[i] != '\0'; i++) {
+		if (rest[i] != ' ' && rest[i] != '\t' && rest[i] != '+') {
+			binding = wbk_parser_parse_binding(rest);
+		}
+	}
+
+	return binding;
+}
+
+int
+wbk_ctl_handle_mut(wbk_ctl_t *ctl, wbk_ctl_session_t *session,
+                   wbk_kbtable_mut_t *mut, wbk_ctl_buf_t *out)
+{
+	int error;
+
+	error = 0;
+	if (session->batch) {
+		session->mut_arr = realloc(session->mut_arr,
+		                           sizeof(wbk_kbtable_mut_t *) * (session->mut_arr_len + 1));
+		session->mut_arr[session->mut_arr_len++] = mut;
+	} else {
+		error = wbk_kbtable_mutate(ctl->kbtable, &mut, 1);
+	}
+
+	if (error) {
+		wbk_ctl_buf_printf(out, "error cannot apply the change\n");
+	} else {
+		wbk_ctl_buf_printf(out, "ok\n");
+	}
+
+	return error;
+}
+
+int
+wbk_ctl_handle_list(wbk_ctl_t *ctl, const char *mode, wbk_ctl_buf_t *out)
+{
+	const wbk_kbman_t *kbman;
+	const wbk_kbman_mode_t *kbman_mode;
+	char *binding;
+	char *cmd;
+	int found;
+	int i;
+	int j;
+
+	found = mode == NULL;
+
+	kbman = wbk_kbtable_lock(ctl->kbtable);
+	for (i = 0; kbman && i < kbman->mode_arr_len; i++) {
+		kbman_mode = kbman->mode_arr[i];
+		if (mode == NULL || strcmp(kbman_mode->name, mode) == 0) {
+			found = 1;
+
+			for (j = 0; j < kbman_mode->kc_arr_len; j++) {
+				binding = wbk_b_to_str(wbk_kc_get_binding(kbman_mode->kc_arr[j]));
+				cmd = wbk_kc_to_str(kbman_mode->kc_arr[j]);
+				wbk_ctl_buf_printf(out, " %s %s %s\n", kbman_mode->name, binding, cmd);
+				free(cmd);
+				free(binding);
+			}
+		}
+	}
+	wbk_kbtable_unlock(ctl->kbtable);
+
+	if (found) {
+		wbk_ctl_buf_printf(out, "ok\n");
+	} else {
+		wbk_ctl_buf_printf(out, "error unknown mode\n");
+	}
+
+	return !found;
+}
+
+int
+wbk_ctl_handle_stats(wbk_ctl_t *ctl, wbk_ctl_buf_t *out)
+{
+	const wbk_kbman_t *kbman;
+	wbk_kbtable_stats_t stats;
+	int binding_count;
+	int i;
+
+	wbk_kbtable_get_stats(ctl->kbtable, &stats);
+
+	kbman = wbk_kbtable_lock(ctl->kbtable);
+	binding_count = 0;
+	for (i = 0; kbman && i < kbman->mode_arr_len; i++) {
+		binding_count += kbman->mode_arr[i]->kc_arr_len;
+	}
+	if (kbman) {
+		wbk_ctl_buf_printf(out, " mode %s\n", wbk_kbman_get_mode(kbman));
+	}
+	wbk_kbtable_unlock(ctl->kbtable);
+
+	wbk_ctl_buf_printf(out, " bindings %d\n", binding_count);
+	wbk_ctl_buf_printf(out, " generation %d\n", stats.generation);
+	wbk_ctl_buf_printf(out, " execs %ld\n", stats.exec_count);
+	wbk_ctl_buf_printf(out, " hits %ld\n", stats.hit_count);
+	wbk_ctl_buf_printf(out, " changes %d\n", stats.mut_count);
+	wbk_ctl_buf_printf(out, " retired %d\n", stats.retired_count);
+	wbk_ctl_buf_printf(out, "ok\n");
+
+	return 0;
+}
+
+int
+wbk_ctl_handle(wbk_ctl_t *ctl, wbk_ctl_session_t *session, char *line, wbk_ctl_buf_t *out)
+{
+	char *rest;
+	char *request;
+	char *mode;
+	char *cmd;
+	wbk_b_t *binding;
+	int error;
+
+	error = 0;
+	binding = NULL;
+	rest = line;
+	request = wbk_ctl_next_word(&rest);
+
+	if (request == NULL) {
+		/**
+		 * Empty lines are not answered
+		 */
+	} else if (strcmp(request, "add") == 0) {
+		mode = wbk_ctl_next_word(&rest);
+		cmd = mode ? strchr(rest, '"') : NULL;
+		if (cmd) {
+			*cmd = '\0';
+			binding = wbk_ctl_parse_binding(rest);
+			*cmd = '"';
+		}
+
+		if (mode == NULL || cmd == NULL || binding == NULL) {
+			wbk_ctl_buf_printf(out, "error usage: add <mode> <binding> \"<command>\"\n");
+			error = 1;
+		} else {
+			error = wbk_ctl_handle_mut(ctl, session, wbk_kbtable_mut_new(mode, binding, cmd), out);
+		}
+	} else if (strcmp(request, "remove") == 0) {
+		mode = wbk_ctl_next_word(&rest);
+		binding = mode ? wbk_ctl_parse_binding(rest) : NULL;
+
+		if (binding == NULL) {
+			wbk_ctl_buf_printf(out, "error usage: remove <mode> <binding>\n");
+			error = 1;
+		} else {
+			error = wbk_ctl_handle_mut(ctl, session, wbk_kbtable_mut_new(mode, binding, NULL), out);
+		}
+	} else if (strcmp(request, "begin") == 0) {
+		if (session->batch) {
+			wbk_ctl_buf_printf(out, "error batch already begun\n");
+			error = 1;
+		} else {
+			session->batch = 1;
+			wbk_ctl_buf_printf(out, "ok\n");
+		}
+	} else if (strcmp(request, "commit") == 0) {
+		if (!session->batch) {
+			wbk_ctl_buf_printf(out, "error no batch begun\n");
+			error = 1;
+		} else {
+			/**
+			 * The key board table takes the changes, even if they fail
+			 */
+			error = wbk_kbtable_mutate(ctl->kbtable, session->mut_arr, session->mut_arr_len);
+			session->mut_arr_len = 0;
+			wbk_ctl_session_reset(session);
+
+			if (error) {
+				wbk_ctl_buf_printf(out, "error cannot apply the changes\n");
+			} else {
+				wbk_ctl_buf_printf(out, "ok\n");
+			}
+		}
+	} else if (strcmp(request, "abort") == 0) {
+		wbk_ctl_session_reset(session);
+		wbk_ctl_buf_printf(out, "ok\n");
+	} else if (strcmp(request, "list") == 0) {
+		error = wbk_ctl_handle_list(ctl, wbk_ctl_next_word(&rest), out);
+	} else if (strcmp(request, "stats") == 0) {
+		error = wbk_ctl_handle_stats(ctl, out);
+	} else if (strcmp(request, "mode") == 0) {
+		mode = wbk_ctl_next_word(&rest);
+		if (mode == NULL || wbk_kbtable_switch_mode(ctl->kbtable, mode)) {
+			wbk_ctl_buf_printf(out, "error unknown mode\n");
+			error = 1;
+		} else {
+			wbk_ctl_buf_printf(out, "ok\n");
+		}
+	} else if (strcmp(request, "reload") == 0) {
+		error = wbk_kbtable_reload(ctl->kbtable);
+		wbk_ctl_buf_printf(out, error ? "error cannot reload\n" : "ok\n");
+	} else if (strcmp(request, "config") == 0) {
+		/**
+		 * The path is the rest of the line as it may contain spaces
+		 */
+		while (*rest == ' ' || *rest == '\t') {
+			rest++;
+		}
+
+		if (*rest == '\0') {
+			wbk_ctl_buf_printf(out, "error usage: config <path>\n");
+			error = 1;
+		} else if (wbk_kbtable_load_file(ctl->kbtable, rest)) {
+			wbk_ctl_buf_printf(out, "error cannot load %s\n", rest);
+			error = 1;
+		} else {
+			if (ctl->config_fn) {
+				ctl->config_fn(ctl, rest, ctl->param);
+			}
+			wbk_ctl_buf_printf(out, "ok\n");
+		}
+	} else {
+		wbk_ctl_buf_printf(out, "error unknown request: %s\n", request);
+		error = 1;
+	}
+
+	return error;
+}
+
+int
+wbk_ctl_handle_input(wbk_ctl_t *ctl, wbk_ctl_session_t *session,
+                     char *in, int *in_len, wbk_ctl_buf_t *out)
+{
+	char *line;
+	char *end;
+	int length;
+	int error;
+
+	error = 0;
+	line = in;
+	while ((end = memchr(line, '\n', *in_len - (line - in)))) {
+		*end = '\0';
+		if (end > line && end[-1] == '\r') {
+			end[-1] = '\0';
+		}
+
+		wbk_logger_log(&logger, DEBUG, "Request: %s\n", line);
+		wbk_ctl_handle(ctl, session, line, out);
+
+		line = end + 1;
+	}
+
+	length = *in_len - (line - in);
+	if (length >= WBK_CTL_LINE_LEN) {
+		wbk_ctl_buf_printf(out, "error request too long\n");
+		error = 1;
+	}
+
+	memmove(in, line, length);
+	*in_len = length;
+
+	return error;
+}
+
+int
+wbk_ctl_count_answers(const char *str, int *failed)
+{
+	const char *line;
+	int count;
+
+	count = 0;
+	line = str;
+	while (line && *line) {
+		if (*line != ' ' && strchr(line, '\n')) {
+			count++;
+			if (strncmp(line, "error", 5) == 0) {
+				*failed = 1;
+			}
+		}
+
+		line = strchr(line, '\n');
+		if (line) {
+			line++;
+		}
+	}
+
+	return count;
+}
+
+int
+wbk_ctl_count_requests(const char *str)
+{
+	const char *line;
+	int count;
+	int i;
+
+	count = 0;
+	line = str;
+	while (line && *line) {
+		for (i = 0; line[i] == ' ' || line[i] == '\t' || line[i] == '\r'; i++) {
+		}
+		if (line[i] != '\n' && line[i] != '\0') {
+			count++;
+		}
+
+		line = strchr(line, '\n');
+		if (line) {
+			line++;
+		}
+	}
+
+	return count;
+}
+
+#if defined(WIN32)
+int
+wbk_ctl_start(wbk_ctl_t *ctl)
+{
+	int error;
+
+	error = 0;
+	wbk_ctl_stop(ctl);
+
+	ctl->security = wbk_ctl_security_new();
+	if (ctl->security == NULL) {
+		wbk_logger_log(&logger, SEVERE, "Could not restrict %s to the current user\n",
+		               ctl->address);
+		error = 1;
+	}
+
+	/**
+	 * Fails if another process already serves the name
+	 */
+	if (!error) {
+		ctl->pipe = wbk_ctl_pipe_new(ctl, FILE_FLAG_FIRST_PIPE_INSTANCE);
+		error = ctl->pipe == NULL;
+	}
+
+	if (!error) {
+		ctl->stop_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+		ctl->running = 1;
+		ctl->thread = CreateThread(NULL, 0, wbk_ctl_thread, ctl, 0, NULL);
+		if (ctl->thread == NULL) {
+			wbk_logger_log(&logger, SEVERE, "Could not start the control server thread\n");
+			ctl->running = 0;
+			error = 1;
+		}
+	}
+
+	if (error) {
+		wbk_ctl_stop(ctl);
+	}
+
+	return error;
+}
+
+int
+wbk_ctl_stop(wbk_ctl_t *ctl)
+{
+	if (ctl->thread) {
+		SetEvent(ctl->stop_event);
+		WaitForSingleObject(ctl->thread, INFINITE);
+		CloseHandle(ctl->thread);
+		ctl->thread = NULL;
+	}
+	ctl->running = 0;
+
+	if (ctl->stop_event) {
+		CloseHandle(ctl->stop_event);
+		ctl->stop_event = NULL;
+	}
+
+	if (ctl->pipe) {
+		CloseHandle(ctl->pipe);
+		ctl->pipe = NULL;
+	}
+
+	free(ctl->security);
+	ctl->security = NULL;
+
+	return 0;
+}
+
+DWORD WINAPI
+wbk_ctl_thread(LPVOID param)
+{
+	wbk_ctl_t *ctl;
+	OVERLAPPED overlapped;
+	HANDLE pipe;
+	DWORD length;
+	int connected;
+
+	ctl = (wbk_ctl_t *) param;
+
+	memset(&overlapped, 0, sizeof(OVERLAPPED));
+	overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	while (ctl->pipe && WaitForSingleObject(ctl->stop_event, 0) != WAIT_OBJECT_0) {
+		pipe = ctl->pipe;
+
+		connected = ConnectNamedPipe(pipe, &overlapped);
+		if (!connected) {
+			if (GetLastError() == ERROR_PIPE_CONNECTED) {
+				connected = 1;
+			} else if (GetLastError() == ERROR_IO_PENDING) {
+				connected = !wbk_ctl_wait(ctl, pipe, &overlapped, &length, INFINITE);
+			}
+		}
+
+		if (connected) {
+			/**
+			 * Clients arriving meanwhile connect to the next instance instead
+			 * of finding no pipe at all
+			 */
+			ctl->pipe = wbk_ctl_pipe_new(ctl, 0);
+
+			wbk_ctl_serve(ctl, pipe, &overlapped);
+			FlushFileBuffers(pipe);
+			DisconnectNamedPipe(pipe);
+			CloseHandle(pipe);
+		} else {
+			DisconnectNamedPipe(pipe);
+		}
+	}
+
+	CloseHandle(overlapped.hEvent);
+
+	return 0;
+}
+
+wbk_ctl_security_t *
+wbk_ctl_security_new(void)
+{
+	wbk_ctl_security_t *security;
+	TOKEN_USER *user;
+	HANDLE token;
+	DWORD length;
+	int error;
+
+	security = NULL;
+	user = NULL;
+	length = 0;
+
+	error = !OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token);
+	if (!error) {
+		GetTokenInformation(token, TokenUser, NULL, 0, &length);
+		user = length > 0 ? malloc(length) : NULL;
+		error = user == NULL
+		        || !GetTokenInformation(token, TokenUser, user, length, &length);
+		CloseHandle(token);
+	}
+
+	if (!error) {
+		security = malloc(sizeof(wbk_ctl_security_t));
+		error = security == NULL;
+	}
+
+	/**
+	 * The entry copies the SID of the user
+	 */
+	if (!error) {
+		error = !InitializeAcl(&(security->acl),
+		                       sizeof(ACL) + sizeof(security->ace), ACL_REVISION)
+		        || !AddAccessAllowedAce(&(security->acl), ACL_REVISION, GENERIC_ALL,
+		                                user->User.Sid)
+		        || !InitializeSecurityDescriptor(&(security->descriptor),
+		                                         SECURITY_DESCRIPTOR_REVISION)
+		        || !SetSecurityDescriptorDacl(&(security->descriptor), TRUE,
+		                                      &(security->acl), FALSE);
+	}
+
+	if (!error) {
+		security->attributes.nLength = sizeof(SECURITY_ATTRIBUTES);
+		security->attributes.lpSecurityDescriptor = &(security->descriptor);
+		security->attributes.bInheritHandle = FALSE;
+	} else {
+		free(security);
+		security = NULL;
+	}
+
+	free(user);
+
+	return security;
+}
+
+HANDLE
+wbk_ctl_pipe_new(wbk_ctl_t *ctl, DWORD flags)
+{
+	HANDLE pipe;
+
+	pipe = CreateNamedPipeA(ctl->address,
+	                        PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | flags,
+	                        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT
+	                        | PIPE_REJECT_REMOTE_CLIENTS,
+	                        2, WBK_CTL_LINE_LEN, WBK_CTL_LINE_LEN, 0,
+	                        &(ctl->security->attributes));
+	if (pipe == INVALID_HANDLE_VALUE) {
+		wbk_logger_log(&logger, SEVERE, "Could not create pipe %s\n", ctl->address);
+		pipe = NULL;
+	}
+
+	return pipe;
+}
+
+int
+wbk_ctl_wait(wbk_ctl_t *ctl, HANDLE pipe, OVERLAPPED *overlapped, DWORD *length,
+             DWORD timeout)
+{
+	HANDLE handles[2];
+	DWORD result;
+	int error;
+
+	handles[0] = ctl->stop_event;
+	handles[1] = overlapped->hEvent;
+
+	result = WaitForMultipleObjects(2, handles, FALSE, timeout);
+	if (result == WAIT_OBJECT_0 + 1) {
+		error = !GetOverlappedResult(pipe, overlapped, length, FALSE);
+	} else {
+		if (result == WAIT_TIMEOUT) {
+			wbk_logger_log(&logger, INFO, "Dropped an idle client\n");
+		}
+		CancelIo(pipe);
+		GetOverlappedResult(pipe, overlapped, length, TRUE);
+		error = 1;
+	}
+
+	return error;
+}
+
+int
+wbk_ctl_serve(wbk_ctl_t *ctl, HANDLE pipe, OVERLAPPED *overlapped)
+{
+	wbk_ctl_session_t session;
+	wbk_ctl_buf_t out;
+	char in[WBK_CTL_LINE_LEN];
+	int in_len;
+	int written;
+	DWORD length;
+	int error;
+
+	memset(&session, 0, sizeof(wbk_ctl_session_t));
+	memset(&out, 0, sizeof(wbk_ctl_buf_t));
+	in_len = 0;
+
+	error = 0;
+	while (!error) {
+		error = !ReadFile(pipe, in + in_len, WBK_CTL_LINE_LEN - in_len, NULL, overlapped)
+		        && GetLastError() != ERROR_IO_PENDING;
+		if (!error) {
+			error = wbk_ctl_wait(ctl, pipe, overlapped, &length, WBK_CTL_IDLE_TIMEOUT)
+			        || length == 0;
+		}
+
+		if (!error) {
+			in_len += length;
+			error = wbk_ctl_handle_input(ctl, &session, in, &in_len, &out);
+
+			written = 0;
+			while (written < out.len
+			       && (WriteFile(pipe, out.str + written, out.len - written, NULL, overlapped)
+			           || GetLastError() == ERROR_IO_PENDING)
+			       && !wbk_ctl_wait(ctl, pipe, overlapped, &length, WBK_CTL_IDLE_TIMEOUT)) {
+				written += length;
+			}
+			if (written < out.len) {
+				error = 1;
+			}
+			out.len = 0;
+		}
+	}
+
+	wbk_ctl_session_reset(&session);
+	free(out.str);
+
+	return 0;
+}
+
+int
+wbk_ctl_send(const char *address, const char *request, char **response)
+{
+	wbk_ctl_buf_t in;
+	HANDLE pipe;
+	DWORD length;
+	char buffer[WBK_CTL_LINE_LEN];
+	int expected;
+	int failed;
+	int error;
+
+	memset(&in, 0, sizeof(wbk_ctl_buf_t));
+	wbk_ctl_buf_printf(&in, "");
+
+	error = 0;
+	failed = 0;
+
+	pipe = CreateFileA(address, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	if (pipe == INVALID_HANDLE_VALUE
+	    && GetLastError() == ERROR_PIPE_BUSY
+	    && WaitNamedPipeA(address, WBK_CTL_TIMEOUT)) {
+		pipe = CreateFileA(address, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	}
+
+	if (pipe == INVALID_HANDLE_VALUE) {
+		error = 1;
+	}
+
+	if (!error) {
+		error = !WriteFile(pipe, request, strlen(request), &length, NULL)
+		        || length != strlen(request);
+	}
+
+	expected = wbk_ctl_count_requests(request);
+	while (!error && wbk_ctl_count_answers(in.str, &failed) < expected) {
+		if (ReadFile(pipe, buffer, sizeof(buffer) - 1, &length, NULL) && length > 0) {
+			buffer[length] = '\0';
+			wbk_ctl_buf_printf(&in, "%s", buffer);
+		} else {
+			error = 1;
+		}
+	}
+
+	if (pipe != INVALID_HANDLE_VALUE) {
+		CloseHandle(pipe);
+	}
+
+	*response = in.str;
+
+	return error || failed;
+}
+#else
+int
+wbk_ctl_start(wbk_ctl_t *ctl)
+{
+	struct sockaddr_un addr;
+	int error;
+
+	error = 0;
+	wbk_ctl_stop(ctl);
+
+	memset(&addr, 0, sizeof(struct sockaddr_un));
+	addr.sun_family = AF_UNIX;
+	if (strlen(ctl->address) >= sizeof(addr.sun_path)) {
+		error = 1;
+	} else {
+		strcpy(addr.sun_path, ctl->address);
+	}
+
+	if (!error) {
+		error = wbk_ctl_remove_stale(&addr);
+	}
+
+	if (!error) {
+		ctl->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		error = ctl->fd < 0
+		        || bind(ctl->fd, (struct sockaddr *) &addr, sizeof(struct sockaddr_un));
+	}
+
+	if (!error) {
+		ctl->bound = 1;
+		/**
+		 * Nobody can connect before listen(), so other users never get in
+		 */
+		error = chmod(ctl->address, S_IRUSR | S_IWUSR)
+		        || listen(ctl->fd, 4);
+	}
+
+	if (error) {
+		wbk_logger_log(&logger, SEVERE, "Could not listen on %s\n", ctl->address);
+	}
+
+	if (!error && pipe(ctl->stop_fd)) {
+		error = 1;
+	}
+
+	if (!error) {
+		ctl->running = 1;
+		if (pthread_create(&(ctl->thread), NULL, wbk_ctl_thread, ctl)) {
+			wbk_logger_log(&logger, SEVERE, "Could not start the control server thread\n");
+			ctl->running = 0;
+			error = 1;
+		}
+	}
+
+	if (error) {
+		wbk_ctl_stop(ctl);
+	}
+
+	return error;
+}
+
+int
+wbk_ctl_stop(wbk_ctl_t *ctl)
+{
+	if (ctl->running) {
+		if (write(ctl->stop_fd[1], "", 1) == 1) {
+			pthread_join(ctl->thread, NULL);
+		}
+		ctl->running = 0;
+	}
+
+	if (ctl->stop_fd[0] >= 0) {
+		close(ctl->stop_fd[0]);
+		close(ctl->stop_fd[1]);
+		ctl->stop_fd[0] = -1;
+		ctl->stop_fd[1] = -1;
+	}
+
+	if (ctl->fd >= 0) {
+		close(ctl->fd);
+		ctl->fd = -1;
+	}
+
+	if (ctl->bound) {
+		unlink(ctl->address);
+		ctl->bound = 0;
+	}
+
+	return 0;
+}
+
+void *
+wbk_ctl_thread(void *param)
+{
+	wbk_ctl_t *ctl;
+	struct pollfd fds[2];
+	int stopped;
+	int fd;
+
+	ctl = (wbk_ctl_t *) param;
+
+	fds[0].fd = ctl->stop_fd[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = ctl->fd;
+	fds[1].events = POLLIN;
+
+	stopped = 0;
+	while (!stopped) {
+		if (poll(fds, 2, -1) < 0) {
+			stopped = errno != EINTR;
+		} else if (fds[0].revents) {
+			stopped = 1;
+		} else if (fds[1].revents) {
+			fd = accept(ctl->fd, NULL, NULL);
+			if (fd >= 0 && wbk_ctl_is_trusted(fd)) {
+				stopped = wbk_ctl_serve(ctl, fd);
+			}
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+	}
+
+	return NULL;
+}
+
+int
+wbk_ctl_serve(wbk_ctl_t *ctl, int fd)
+{
+	wbk_ctl_session_t session;
+	wbk_ctl_buf_t out;
+	struct pollfd fds[2];
+	struct timeval timeout;
+	char in[WBK_CTL_LINE_LEN];
+	int in_len;
+	ssize_t length;
+	int result;
+	int stopped;
+	int error;
+
+	memset(&session, 0, sizeof(wbk_ctl_session_t));
+	memset(&out, 0, sizeof(wbk_ctl_buf_t));
+	in_len = 0;
+
+	fds[0].fd = ctl->stop_fd[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = fd;
+	fds[1].events = POLLIN;
+
+	/**
+	 * A client not reading its responses is dropped as well
+	 */
+	timeout.tv_sec = WBK_CTL_IDLE_TIMEOUT / 1000;
+	timeout.tv_usec = (WBK_CTL_IDLE_TIMEOUT % 1000) * 1000;
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+	stopped = 0;
+	error = 0;
+	while (!error && !stopped) {
+		result = poll(fds, 2, WBK_CTL_IDLE_TIMEOUT);
+		if (result < 0) {
+			error = errno != EINTR;
+		} else if (result == 0) {
+			wbk_logger_log(&logger, INFO, "Dropped an idle client\n");
+			error = 1;
+		} else if (fds[0].revents) {
+			stopped = 1;
+		} else if (fds[1].revents) {
+			length = read(fd, in + in_len, WBK_CTL_LINE_LEN - in_len);
+			if (length <= 0) {
+				error = 1;
+			} else {
+				in_len += length;
+				error = wbk_ctl_handle_input(ctl, &session, in, &in_len, &out);
+				error = wbk_ctl_write(fd, out.str, out.len) || error;
+				out.len = 0;
+			}
+		}
+	}
+
+	wbk_ctl_session_reset(&session);
+	free(out.str);
+
+	return stopped;
+}
+
+int
+wbk_ctl_write(int fd, const char *str, int len)
+{
+	ssize_t length;
+	int written;
+
+	written = 0;
+	while (written < len
+	       && (length = write(fd, str + written, len - written)) > 0) {
+		written += length;
+	}
+
+	return written < len;
+}
+
+int
+wbk_ctl_remove_stale(const struct sockaddr_un *addr)
+{
+	struct stat st;
+	int error;
+	int fd;
+
+	error = 0;
+	if (lstat(addr->sun_path, &st) == 0) {
+		error = !S_ISSOCK(st.st_mode) || st.st_uid != getuid();
+
+		if (!error) {
+			/**
+			 * Nobody listens on a stale socket
+			 */
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			error = fd < 0
+			        || connect(fd, (const struct sockaddr *) addr, sizeof(struct sockaddr_un)) == 0
+			        || errno != ECONNREFUSED;
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+
+		if (!error) {
+			error = unlink(addr->sun_path) != 0;
+		}
+
+		if (error) {
+			wbk_logger_log(&logger, SEVERE, "%s is in use or not a socket of this user\n",
+			               addr->sun_path);
+		}
+	}
+
+	return error;
+}
+
+int
+wbk_ctl_is_trusted(int fd)
+{
+	struct ucred cred;
+	socklen_t length;
+	int trusted;
+
+	length = sizeof(struct ucred);
+	trusted = getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &length) == 0
+	          && cred.uid == getuid();
+	if (!trusted) {
+		wbk_logger_log(&logger, WARNING, "Rejected a client of another user\n");
+	}
+
+	return trusted;
+}
+
+int
+wbk_ctl_send(const char *address, const char *request, char **response)
+{
+	struct sockaddr_un addr;
+	struct timeval timeout;
+	wbk_ctl_buf_t in;
+	char buffer[WBK_CTL_LINE_LEN];
+	ssize_t length;
+	int expected;
+	int failed;
+	int error;
+	int fd;
+
+	memset(&in, 0, sizeof(wbk_ctl_buf_t));
+	wbk_ctl_buf_printf(&in, "");
+
+	error = 0;
+	failed = 0;
+
+	memset(&addr, 0, sizeof(struct sockaddr_un));
+	addr.sun_family = AF_UNIX;
+	if (strlen(address) >= sizeof(addr.sun_path)) {
+		error = 1;
+	} else {
+		strcpy(addr.sun_path, address);
+	}
+
+	fd = -1;
+	if (!error) {
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		timeout.tv_sec = WBK_CTL_TIMEOUT / 1000;
+		timeout.tv_usec = 0;
+		error = fd < 0
+		        || setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout))
+		        || connect(fd, (struct sockaddr *) &addr, sizeof(struct sockaddr_un));
+	}
+
+	if (!error) {
+		error = wbk_ctl_write(fd, request, strlen(request));
+	}
+
+	expected = wbk_ctl_count_requests(request);
+	while (!error && wbk_ctl_count_answers(in.str, &failed) < expected) {
+		length = read(fd, buffer, sizeof(buffer) - 1);
+		if (length > 0) {
+			buffer[length] = '\0';
+			wbk_ctl_buf_printf(&in, "%s", buffer);
+		} else {
+			error = 1;
+		}
+	}
+
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	*response = in.str;
+
+	return error || failed;
+}
+#endif
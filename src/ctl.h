@@ -0,0 +1,179 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the control server class definition
+ *
+ * The control server lets other programs manage the key bindings of a running
+ * instance over a named pipe (Windows) or a Unix domain socket (Linux). It
+ * serves one client at a time on its own thread and only works on a key
+ * board table (see kbtable.h), thus it never blocks the keyboard hooks. A
+ * client idle for WBK_CTL_IDLE_TIMEOUT is dropped, so it does not keep others
+ * waiting. Only processes of the same user may connect.
+ *
+ * The protocol is line based. Each request is a single line. Each request is
+ * answered by any number of data lines starting with a space and a final line,
+ * which is either "ok" or "error <reason>".
+ *
+ *   add <mode> <binding> "<command>"   Adds or replaces a key binding
+ *   remove <mode> <binding>            Removes a key binding
+ *   begin                              Starts a batch of add and remove
+ *   commit                             Applies the batch as one change
+ *   abort                              Discards the batch
+ *   list [<mode>]                      Lists key bindings as " <mode> <binding> <command>"
+ *   stats                              Lists statistics as " <name> <value>"
+ *   mode <mode>                        Switches the active mode
+ *   reload                             Reloads the rc file
+ *   config <path>                      Loads another rc file
+ *
+ * Bindings and commands use the rc file notation, e.g.:
+ *
+ *   add default control + shift + q "start cmd.exe"
+ */
+
+#ifndef WBK_CTL_H
+#define WBK_CTL_H
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "kbtable.h"
+
+/**
+ * Maximum length of a request line.
+ */
+#define WBK_CTL_LINE_LEN 1024
+
+/**
+ * Milliseconds a connected client may neither send nor receive before it is
+ * dropped. A batch it has not committed is discarded. Well below the time a
+ * second instance tries to hand over its request.
+ */
+#define WBK_CTL_IDLE_TIMEOUT 1000
+
+typedef struct wbk_ctl_s wbk_ctl_t;
+
+#if defined(WIN32)
+typedef struct wbk_ctl_security_s wbk_ctl_security_t;
+#endif
+
+struct wbk_ctl_s
+{
+	char *address;
+
+	/**
+	 * Not owned by the control server.
+	 */
+	wbk_kbtable_t *kbtable;
+
+	/**
+	 * Called on the thread of the control server after another rc file has
+	 * been loaded. May be NULL.
+	 */
+	int (*config_fn)(wbk_ctl_t *ctl, const char *filename, void *param);
+	void *param;
+
+	int running;
+
+#if defined(WIN32)
+	HANDLE stop_event;
+	HANDLE thread;
+
+	/**
+	 * The pipe instance the next client connects to. It always exists while
+	 * serving, so no other process can take over the name.
+	 */
+	HANDLE pipe;
+
+	/**
+	 * Grants the current user only access to the pipe.
+	 */
+	wbk_ctl_security_t *security;
+#else
+	int fd;
+	int stop_fd[2];
+
+	/**
+	 * Non-0 if the socket file has been created by the control server, thus
+	 * it has to be removed again.
+	 */
+	int bound;
+	pthread_t thread;
+#endif
+};
+
+/**
+ * @param address The name of the pipe or the path of the socket
+ * @param kbtable The key board table to manage. It must outlive the control server.
+ */
+extern wbk_ctl_t *
+wbk_ctl_new(const char *address, wbk_kbtable_t *kbtable);
+
+extern int
+wbk_ctl_free(wbk_ctl_t *ctl);
+
+/**
+ * @brief Sets the function called after a "config" request loaded another rc
+ * file. Set it before starting the control server.
+ */
+extern int
+wbk_ctl_set_config_fn(wbk_ctl_t *ctl,
+                      int (*config_fn)(wbk_ctl_t *ctl, const char *filename, void *param),
+                      void *param);
+
+/**
+ * @brief Starts serving on a new thread.
+ * @return Non-0 if the address cannot be served.
+ */
+extern int
+wbk_ctl_start(wbk_ctl_t *ctl);
+
+/**
+ * @brief Stops serving and waits for the thread of the control server.
+ */
+extern int
+wbk_ctl_stop(wbk_ctl_t *ctl);
+
+/**
+ * @brief Creates the address of the control server of the current user.
+ * @return A new string. Free it by yourself!
+ */
+extern char *
+wbk_ctl_default_address(void);
+
+/**
+ * @brief Sends requests to a control server and waits for all responses.
+ * @param request One or more request lines. Each line must end with '\n'.
+ * @param response Is set to all response lines. Free it by yourself!
+ * @return 0 if all requests were answered with "ok". Non-0 otherwise.
+ */
+extern int
+wbk_ctl_send(const char *address, const char *request, char **response);
+
+#endif // WBK_CTL_H
@@ -46,7 +46,12 @@ wbk_datafinder_new(const char *datadir)
 {
 	wbk_datafinder_t *datafinder;
 	size_t size;
-	wchar_t w32_buffer[MAX_PATH];
+#if defined(WIN32)
+	char buffer[MAX_PATH];
+#else
+	char buffer[4096];
+#endif
+	long length;
 
 	datafinder = malloc(sizeof(wbk_datafinder_t));
 
@@ -54,12 +59,33 @@ wbk_datafinder_new(const char *datadir)
 
 	wbk_datafinder_add_datadir(datafinder, datadir);
 
-	GetModuleFileNameA(NULL, (LPSTR) w32_buffer, MAX_PATH);
+#if defined(WIN32)
+	length = GetModuleFileNameA(NULL, buffer, MAX_PATH);
+	if (length >= MAX_PATH) {
+		length = 0;
+	}
+#else
+	length = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+	if (length < 0) {
+		length = 0;
+	}
+#endif
+
+	/**
+	 * Only the directory of the executable. Without one files are looked up
+	 * relative to the working directory.
+	 */
+	while (length > 0 && buffer[length - 1] != '/' && buffer[length - 1] != '\\') {
+		length--;
+	}
+	if (length > 0) {
+		length--;
+	}
+	buffer[length] = '\0';
 
-	size = sizeof(char) * (sizeof(wchar_t) * wcslen(w32_buffer) + 1);
+	size = sizeof(char) * (length + 1);
 	datafinder->execdir = malloc(size);
-	memset(datafinder->execdir, 0, size);
-	wcstombs(datafinder->execdir, w32_buffer, size);
+	strcpy(datafinder->execdir, buffer);
 	datafinder->execdir_len = strlen(datafinder->execdir) + 1;
 
 	return datafinder;
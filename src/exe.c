@@ -0,0 +1,397 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the executable class implementation and private methods
+ */
+
+#include "exe.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#include "logger.h"
+#include "util.h"
+
+#if defined(WIN32)
+#define WBK_EXE_PATH_SEPARATOR ";"
+#define WBK_EXE_DIR_SEPARATOR '\\'
+#define WBK_EXE_DEFAULT_PATHEXT ".COM;.EXE;.BAT;.CMD"
+#else
+#define WBK_EXE_PATH_SEPARATOR ":"
+#define WBK_EXE_DIR_SEPARATOR '/'
+#endif
+
+static wbk_logger_t logger =  { "exe" };
+
+/**
+ * Searches the name and sets path, id and env_path. The mutex must be
+ * locked.
+ *
+ * @return Non-0 if the name was not found
+ */
+static int
+wbk_exe_resolve(wbk_exe_t *exe);
+
+/**
+ * Tries a directory of PATH. Tries every extension of PATHEXT on WIN32 if the
+ * name has none.
+ *
+ * @param dir The directory or NULL if the name contains one
+ * @return Non-0 if the name is not in the directory
+ */
+static int
+wbk_exe_try_dir(wbk_exe_t *exe, const char *dir, int dir_len);
+
+/**
+ * Sets path and id if a candidate is an executable file.
+ *
+ * @return Non-0 if the candidate is not an executable file
+ */
+static int
+wbk_exe_try(wbk_exe_t *exe, const char *candidate);
+
+/**
+ * @return Non-0 if the path is not an executable file
+ */
+static int
+wbk_exe_identify(const char *path, wbk_exe_id_t *id);
+
+/**
+ * @return Non-0 if the name contains a directory
+ */
+static int
+wbk_exe_has_dir(const char *name);
+
+static void
+wbk_exe_mutex_lock(wbk_exe_t *exe);
+
+static void
+wbk_exe_mutex_unlock(wbk_exe_t *exe);
+
+wbk_exe_t *
+wbk_exe_new(const char *name)
+{
+	wbk_exe_t *exe;
+
+	exe = NULL;
+	exe = malloc(sizeof(wbk_exe_t));
+
+	if (exe) {
+		memset(exe, 0, sizeof(wbk_exe_t));
+
+		exe->refcount = 1;
+		exe->name = malloc(sizeof(char) * (strlen(name) + 1));
+		strcpy(exe->name, name);
+		exe->path = NULL;
+		exe->env_path = NULL;
+
+#if defined(WIN32)
+		InitializeCriticalSection(&(exe->mutex));
+#else
+		pthread_mutex_init(&(exe->mutex), NULL);
+#endif
+
+		if (wbk_exe_resolve(exe)) {
+			wbk_logger_log(&logger, WARNING, "Executable not found: %s\n", name);
+		} else {
+			wbk_logger_log(&logger, INFO, "Resolved %s to %s\n", name, exe->path);
+		}
+	}
+
+	return exe;
+}
+
+int
+wbk_exe_free(wbk_exe_t *exe)
+{
+	if (__atomic_sub_fetch(&(exe->refcount), 1, __ATOMIC_ACQ_REL) == 0) {
+#if defined(WIN32)
+		DeleteCriticalSection(&(exe->mutex));
+#else
+		pthread_mutex_destroy(&(exe->mutex));
+#endif
+
+		free(exe->name);
+		free(exe->path);
+		free(exe->env_path);
+		free(exe);
+	}
+
+	return 0;
+}
+
+wbk_exe_t *
+wbk_exe_retain(wbk_exe_t *exe)
+{
+	__atomic_add_fetch(&(exe->refcount), 1, __ATOMIC_RELAXED);
+
+	return exe;
+}
+
+const char *
+wbk_exe_get_name(const wbk_exe_t *exe)
+{
+	return exe->name;
+}
+
+int
+wbk_exe_get_path(wbk_exe_t *exe, char *path, int path_len)
+{
+	const char *env_path;
+	wbk_exe_id_t id;
+	int stale;
+	int found;
+	int error;
+
+	wbk_exe_mutex_lock(exe);
+
+	env_path = getenv("PATH");
+	stale = !wbk_exe_has_dir(exe->name)
+	        && strcmp(env_path ? env_path : "", exe->env_path ? exe->env_path : "");
+	/**
+	 * A name which was not found is searched again, it may have been
+	 * installed meanwhile
+	 */
+	found = exe->path != NULL;
+	if (!stale) {
+		stale = !found
+		        || wbk_exe_identify(exe->path, &id)
+		        || memcmp(&id, &(exe->id), sizeof(wbk_exe_id_t));
+	}
+
+	if (stale) {
+		if (wbk_exe_resolve(exe)) {
+			if (found) {
+				wbk_logger_log(&logger, WARNING, "Executable not found anymore: %s\n", exe->name);
+			}
+		} else {
+			wbk_logger_log(&logger, INFO, "Resolved %s again to %s\n", exe->name, exe->path);
+		}
+	}
+
+	error = exe->path == NULL || strlen(exe->path) >= (size_t) path_len;
+	if (!error) {
+		strcpy(path, exe->path);
+	}
+
+	wbk_exe_mutex_unlock(exe);
+
+	return error;
+}
+
+int
+wbk_exe_resolve(wbk_exe_t *exe)
+{
+	const char *env_path;
+	const char *dir;
+	int dir_len;
+	int error;
+
+	free(exe->path);
+	exe->path = NULL;
+	free(exe->env_path);
+
+	env_path = getenv("PATH");
+	exe->env_path = malloc(sizeof(char) * (strlen(env_path ? env_path : "") + 1));
+	strcpy(exe->env_path, env_path ? env_path : "");
+
+	if (wbk_exe_has_dir(exe->name)) {
+		error = wbk_exe_try_dir(exe, NULL, 0);
+	} else {
+#if defined(WIN32)
+		/**
+		 * Like cmd.exe, the current directory comes first
+		 */
+		error = wbk_exe_try_dir(exe, ".", 1);
+#else
+		error = 1;
+#endif
+		dir = exe->env_path;
+		while (error && *dir != '\0') {
+			dir_len = strcspn(dir, WBK_EXE_PATH_SEPARATOR);
+			if (dir_len > 0) {
+				error = wbk_exe_try_dir(exe, dir, dir_len);
+			}
+			dir += dir_len;
+			if (*dir == WBK_EXE_PATH_SEPARATOR[0]) {
+				dir++;
+			}
+		}
+	}
+
+	return error;
+}
+
+int
+wbk_exe_try_dir(wbk_exe_t *exe, const char *dir, int dir_len)
+{
+	char candidate[WBK_EXE_PATH_LEN];
+	int length;
+	int error;
+#if defined(WIN32)
+	const char *pathext;
+	const char *ext;
+	int ext_len;
+#endif
+
+	error = 1;
+	length = dir ? dir_len + 1 : 0;
+	if (length + strlen(exe->name) + 1 <= WBK_EXE_PATH_LEN) {
+		if (dir) {
+			memcpy(candidate, dir, sizeof(char) * dir_len);
+			candidate[dir_len] = WBK_EXE_DIR_SEPARATOR;
+		}
+		strcpy(candidate + length, exe->name);
+		length += strlen(exe->name);
+
+#if defined(WIN32)
+		if (strchr(exe->name, '.')) {
+			error = wbk_exe_try(exe, candidate);
+		} else {
+			pathext = getenv("PATHEXT");
+			ext = pathext ? pathext : WBK_EXE_DEFAULT_PATHEXT;
+			while (error && *ext != '\0') {
+				ext_len = strcspn(ext, ";");
+				if (ext_len > 0 && length + ext_len < WBK_EXE_PATH_LEN) {
+					memcpy(candidate + length, ext, sizeof(char) * ext_len);
+					candidate[length + ext_len] = '\0';
+					error = wbk_exe_try(exe, candidate);
+				}
+				ext += ext_len;
+				if (*ext == ';') {
+					ext++;
+				}
+			}
+		}
+#else
+		error = wbk_exe_try(exe, candidate);
+#endif
+	}
+
+	return error;
+}
+
+int
+wbk_exe_try(wbk_exe_t *exe, const char *candidate)
+{
+	int error;
+
+	error = wbk_exe_identify(candidate, &(exe->id));
+	if (!error) {
+		exe->path = wbk_path_absolute(candidate);
+		error = exe->path == NULL || wbk_exe_identify(exe->path, &(exe->id));
+		if (error) {
+			free(exe->path);
+			exe->path = NULL;
+		}
+	}
+
+	return error;
+}
+
+#if defined(WIN32)
+int
+wbk_exe_identify(const char *path, wbk_exe_id_t *id)
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	int error;
+
+	memset(id, 0, sizeof(wbk_exe_id_t));
+
+	error = !GetFileAttributesExA(path, GetFileExInfoStandard, &data)
+	        || (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY);
+	if (!error) {
+		id->size = ((unsigned long long) data.nFileSizeHigh << 32) | data.nFileSizeLow;
+		id->mtime = ((long long) data.ftLastWriteTime.dwHighDateTime << 32)
+		            | data.ftLastWriteTime.dwLowDateTime;
+	}
+
+	return error;
+}
+
+int
+wbk_exe_has_dir(const char *name)
+{
+	return strpbrk(name, "\\/:") != NULL;
+}
+
+void
+wbk_exe_mutex_lock(wbk_exe_t *exe)
+{
+	EnterCriticalSection(&(exe->mutex));
+}
+
+void
+wbk_exe_mutex_unlock(wbk_exe_t *exe)
+{
+	LeaveCriticalSection(&(exe->mutex));
+}
+#else
+int
+wbk_exe_identify(const char *path, wbk_exe_id_t *id)
+{
+	struct stat st;
+	int error;
+
+	memset(id, 0, sizeof(wbk_exe_id_t));
+
+	error = stat(path, &st) || !S_ISREG(st.st_mode) || access(path, X_OK);
+	if (!error) {
+		id->dev = st.st_dev;
+		id->ino = st.st_ino;
+		id->size = st.st_size;
+		id->mtime = st.st_mtime;
+	}
+
+	return error;
+}
+
+int
+wbk_exe_has_dir(const char *name)
+{
+	return strchr(name, '/') != NULL;
+}
+
+void
+wbk_exe_mutex_lock(wbk_exe_t *exe)
+{
+	pthread_mutex_lock(&(exe->mutex));
+}
+
+void
+wbk_exe_mutex_unlock(wbk_exe_t *exe)
+{
+	pthread_mutex_unlock(&(exe->mutex));
+}
+#endif
@@ -0,0 +1,127 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the executable class definition
+ *
+ * An executable caches the absolute path a command name resolves to, e.g.
+ * "firefox" to "/usr/bin/firefox". The name is searched in PATH (and
+ * PATHEXT on WIN32) once, when the rc file is loaded. Afterwards getting the
+ * path only compares PATH and the identity of the file, thus starting a
+ * process does not search the file system again. The path is resolved again
+ * once PATH changed or the file was replaced or removed. A name which was not
+ * found is searched every time, like it would be without the cache.
+ *
+ * Executables are shared by the clones of a key binding command, thus they
+ * are reference counted.
+ */
+
+#ifndef WBK_EXE_H
+#define WBK_EXE_H
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/**
+ * Maximum length of a resolved path
+ */
+#define WBK_EXE_PATH_LEN 4096
+
+/**
+ * What identifies a file. A replaced file has another identity.
+ */
+typedef struct wbk_exe_id_s
+{
+	unsigned long long dev;
+	unsigned long long ino;
+	unsigned long long size;
+	long long mtime;
+} wbk_exe_id_t;
+
+typedef struct wbk_exe_s
+{
+	int refcount;
+
+	char *name;
+
+	/**
+	 * The resolved path or NULL if the name was not found. Guarded by mutex
+	 * like everything below.
+	 */
+	char *path;
+	wbk_exe_id_t id;
+
+	/**
+	 * The value of PATH the name was resolved with
+	 */
+	char *env_path;
+
+#if defined(WIN32)
+	CRITICAL_SECTION mutex;
+#else
+	pthread_mutex_t mutex;
+#endif
+} wbk_exe_t;
+
+/**
+ * @brief Creates a new executable and resolves its name.
+ * @param name A file name searched in PATH or a path containing a directory
+ * @return A new executable or NULL if allocation failed
+ */
+extern wbk_exe_t *
+wbk_exe_new(const char *name);
+
+/**
+ * @brief Releases a reference. The last one frees the executable.
+ */
+extern int
+wbk_exe_free(wbk_exe_t *exe);
+
+/**
+ * @brief Adds a reference.
+ * @return The executable
+ */
+extern wbk_exe_t *
+wbk_exe_retain(wbk_exe_t *exe);
+
+extern const char *
+wbk_exe_get_name(const wbk_exe_t *exe);
+
+/**
+ * @brief Gets the resolved path. Resolves it again if PATH changed or the
+ * file was replaced or removed. Thread safe.
+ * @param path Is set to the path
+ * @param path_len The size of path
+ * @return Non-0 if the name cannot be resolved or the path is too long
+ */
+extern int
+wbk_exe_get_path(wbk_exe_t *exe, char *path, int path_len);
+
+#endif // WBK_EXE_H
@@ -0,0 +1,448 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the executor class implementation and private methods
+ */
+
+#include "executor.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "logger.h"
+
+static wbk_logger_t logger =  { "executor" };
+
+static wbk_executor_t *g_default_executor = NULL;
+
+#if defined(WIN32)
+static DWORD WINAPI
+wbk_executor_thread(LPVOID param);
+#else
+static void *
+wbk_executor_thread(void *param);
+#endif
+
+/**
+ * Waits for a submitted job, a cancellation or until the timeout in
+ * milliseconds passed. The mutex must be locked.
+ *
+ * @param timeout A negative timeout waits infinitely
+ */
+static void
+wbk_executor_wait(wbk_executor_t *executor, long timeout);
+
+static void
+wbk_executor_wake(wbk_executor_t *executor);
+
+static void
+wbk_executor_mutex_lock(wbk_executor_t *executor);
+
+static void
+wbk_executor_mutex_unlock(wbk_executor_t *executor);
+
+/**
+ * Appends a job to the ready jobs. The mutex must be locked.
+ */
+static void
+wbk_executor_ready(wbk_executor_t *executor, wbk_job_t *job);
+
+/**
+ * Moves an expired job to the ready jobs. The job is found by the position
+ * of its timer.
+ */
+static void
+wbk_executor_expire_fn(wbk_timer_t *timer, void *param);
+
+wbk_executor_t *
+wbk_executor_new(void)
+{
+	wbk_executor_t *executor;
+#if !defined(WIN32)
+	pthread_condattr_t cond_attr;
+#endif
+
+	executor = NULL;
+	executor = malloc(sizeof(wbk_executor_t));
+
+	if (executor) {
+		memset(executor, 0, sizeof(wbk_executor_t));
+
+		executor->ready_head = NULL;
+		executor->ready_tail = NULL;
+		executor->twheel = wbk_twheel_new(wbk_executor_now());
+		executor->current = NULL;
+		executor->running = 1;
+
+#if defined(WIN32)
+		InitializeCriticalSection(&(executor->mutex));
+		InitializeConditionVariable(&(executor->cond));
+
+		executor->thread = CreateThread(NULL, 0, wbk_executor_thread, executor, 0, NULL);
+		if (executor->thread == NULL) {
+			executor->running = 0;
+		}
+#else
+		pthread_mutex_init(&(executor->mutex), NULL);
+
+		/**
+		 * Timed waits use the clock of the timer wheel, which does not jump
+		 * with the wall clock
+		 */
+		pthread_condattr_init(&cond_attr);
+		pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+		pthread_cond_init(&(executor->cond), &cond_attr);
+		pthread_condattr_destroy(&cond_attr);
+
+		if (pthread_create(&(executor->thread), NULL, wbk_executor_thread, executor)) {
+			executor->running = 0;
+		}
+#endif
+
+		if (!executor->running) {
+			wbk_logger_log(&logger, SEVERE, "Could not start the executor thread\n");
+		}
+	}
+
+	return executor;
+}
+
+int
+wbk_executor_free(wbk_executor_t *executor)
+{
+	int running;
+
+	wbk_executor_mutex_lock(executor);
+	running = executor->running;
+	executor->running = 0;
+	wbk_executor_wake(executor);
+	wbk_executor_mutex_unlock(executor);
+
+	if (running) {
+#if defined(WIN32)
+		WaitForSingleObject(executor->thread, INFINITE);
+		CloseHandle(executor->thread);
+		executor->thread = NULL;
+#else
+		pthread_join(executor->thread, NULL);
+#endif
+	}
+
+#if defined(WIN32)
+	DeleteCriticalSection(&(executor->mutex));
+#else
+	pthread_cond_destroy(&(executor->cond));
+	pthread_mutex_destroy(&(executor->mutex));
+#endif
+
+	wbk_twheel_free(executor->twheel);
+	executor->twheel = NULL;
+
+	free(executor);
+
+	return 0;
+}
+
+wbk_executor_t *
+wbk_executor_get_default(void)
+{
+	return __atomic_load_n(&g_default_executor, __ATOMIC_ACQUIRE);
+}
+
+void
+wbk_executor_set_default(wbk_executor_t *executor)
+{
+	__atomic_store_n(&g_default_executor, executor, __ATOMIC_RELEASE);
+}
+
+int
+wbk_job_init(wbk_job_t *job, long (*job_fn)(wbk_job_t *job, void *param), void *param)
+{
+	memset(job, 0, sizeof(wbk_job_t));
+
+	job->job_fn = job_fn;
+	job->param = param;
+	job->next = NULL;
+	job->queued = 0;
+	job->signaled = 0;
+
+	return 0;
+}
+
+int
+wbk_executor_submit(wbk_executor_t *executor, wbk_job_t *job)
+{
+	int error;
+
+	error = 0;
+
+	wbk_executor_mutex_lock(executor);
+
+	if (!executor->running || job->queued) {
+		error = 1;
+	} else {
+		__atomic_store_n(&(job->queued), 1, __ATOMIC_RELEASE);
+		wbk_timer_init(&(job->timer), wbk_executor_expire_fn, executor);
+		wbk_executor_ready(executor, job);
+		wbk_executor_wake(executor);
+	}
+
+	wbk_executor_mutex_unlock(executor);
+
+	return error;
+}
+
+int
+wbk_executor_signal(wbk_executor_t *executor, wbk_job_t *job)
+{
+	int error;
+
+	error = 0;
+
+	wbk_executor_mutex_lock(executor);
+
+	if (!executor->running) {
+		error = 1;
+	} else if (executor->current == job) {
+		job->signaled = 1;
+	} else if (!job->queued) {
+		__atomic_store_n(&(job->queued), 1, __ATOMIC_RELEASE);
+		wbk_timer_init(&(job->timer), wbk_executor_expire_fn, executor);
+		wbk_executor_ready(executor, job);
+		wbk_executor_wake(executor);
+	} else if (wbk_timer_pending(&(job->timer))) {
+		wbk_timer_cancel(executor->twheel, &(job->timer));
+		wbk_executor_ready(executor, job);
+		wbk_executor_wake(executor);
+	}
+
+	wbk_executor_mutex_unlock(executor);
+
+	return error;
+}
+
+int
+wbk_executor_cancel(wbk_executor_t *executor, wbk_job_t *job)
+{
+	wbk_job_t *prev;
+	wbk_job_t *cur;
+
+	wbk_executor_mutex_lock(executor);
+
+	while (executor->current == job) {
+		wbk_executor_wait(executor, -1);
+	}
+
+	if (job->queued) {
+		prev = NULL;
+		for (cur = executor->ready_head; cur && cur != job; cur = cur->next) {
+			prev = cur;
+		}
+
+		if (cur) {
+			if (prev) {
+				prev->next = job->next;
+			} else {
+				executor->ready_head = job->next;
+			}
+			if (executor->ready_tail == job) {
+				executor->ready_tail = prev;
+			}
+			job->next = NULL;
+		}
+
+		wbk_timer_cancel(executor->twheel, &(job->timer));
+		__atomic_store_n(&(job->queued), 0, __ATOMIC_RELEASE);
+	}
+	job->signaled = 0;
+
+	wbk_executor_mutex_unlock(executor);
+
+	return 0;
+}
+
+int
+wbk_job_queued(const wbk_job_t *job)
+{
+	return __atomic_load_n(&(job->queued), __ATOMIC_ACQUIRE);
+}
+
+#if defined(WIN32)
+DWORD WINAPI
+wbk_executor_thread(LPVOID param)
+#else
+void *
+wbk_executor_thread(void *param)
+#endif
+{
+	wbk_executor_t *executor;
+	wbk_job_t *job;
+	unsigned long timeout;
+	long delay;
+
+	executor = (wbk_executor_t *) param;
+
+	wbk_executor_mutex_lock(executor);
+
+	while (executor->running) {
+		wbk_twheel_advance(executor->twheel, wbk_executor_now());
+
+		job = executor->ready_head;
+		if (job) {
+			executor->ready_head = job->next;
+			if (executor->ready_head == NULL) {
+				executor->ready_tail = NULL;
+			}
+			job->next = NULL;
+
+			/**
+			 * Others may submit and cancel while the job is called
+			 */
+			executor->current = job;
+			wbk_executor_mutex_unlock(executor);
+
+			delay = job->job_fn(job, job->param);
+
+			wbk_executor_mutex_lock(executor);
+			executor->current = NULL;
+
+			if (job->signaled) {
+				job->signaled = 0;
+				wbk_executor_ready(executor, job);
+			} else if (delay < 0) {
+				__atomic_store_n(&(job->queued), 0, __ATOMIC_RELEASE);
+			} else {
+				wbk_timer_start(executor->twheel, &(job->timer), delay);
+			}
+
+			/**
+			 * Wakes cancellations waiting for the job
+			 */
+			wbk_executor_wake(executor);
+		} else if (wbk_twheel_next_timeout(executor->twheel, &timeout) == 0) {
+			wbk_executor_wait(executor, timeout);
+		} else {
+			wbk_executor_wait(executor, -1);
+		}
+	}
+
+	wbk_executor_mutex_unlock(executor);
+
+	return 0;
+}
+
+void
+wbk_executor_wait(wbk_executor_t *executor, long timeout)
+{
+#if defined(WIN32)
+	SleepConditionVariableCS(&(executor->cond), &(executor->mutex),
+	                         timeout < 0 ? INFINITE : (DWORD) timeout);
+#else
+	struct timespec deadline;
+
+	if (timeout < 0) {
+		pthread_cond_wait(&(executor->cond), &(executor->mutex));
+	} else {
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += timeout / 1000;
+		deadline.tv_nsec += (timeout % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+
+		pthread_cond_timedwait(&(executor->cond), &(executor->mutex), &deadline);
+	}
+#endif
+}
+
+void
+wbk_executor_wake(wbk_executor_t *executor)
+{
+#if defined(WIN32)
+	WakeAllConditionVariable(&(executor->cond));
+#else
+	pthread_cond_broadcast(&(executor->cond));
+#endif
+}
+
+void
+wbk_executor_mutex_lock(wbk_executor_t *executor)
+{
+#if defined(WIN32)
+	EnterCriticalSection(&(executor->mutex));
+#else
+	pthread_mutex_lock(&(executor->mutex));
+#endif
+}
+
+void
+wbk_executor_mutex_unlock(wbk_executor_t *executor)
+{
+#if defined(WIN32)
+	LeaveCriticalSection(&(executor->mutex));
+#else
+	pthread_mutex_unlock(&(executor->mutex));
+#endif
+}
+
+void
+wbk_executor_ready(wbk_executor_t *executor, wbk_job_t *job)
+{
+	job->next = NULL;
+	if (executor->ready_tail) {
+		executor->ready_tail->next = job;
+	} else {
+		executor->ready_head = job;
+	}
+	executor->ready_tail = job;
+}
+
+void
+wbk_executor_expire_fn(wbk_timer_t *timer, void *param)
+{
+	wbk_executor_ready((wbk_executor_t *) param,
+	                   (wbk_job_t *) ((char *) timer - offsetof(wbk_job_t, timer)));
+}
+
+unsigned long
+wbk_executor_now(void)
+{
+#if defined(WIN32)
+	return GetTickCount();
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000UL + now.tv_nsec / 1000000L;
+#endif
+}
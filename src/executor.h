@@ -0,0 +1,170 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the executor class definition
+ *
+ * An executor runs jobs on its own thread, so key binding commands never
+ * block the thread of an input backend. A job may ask to be called again
+ * after a delay; delayed jobs wait in a timer wheel instead of blocking the
+ * thread. Jobs are owned by their submitter, thus submitting one does not
+ * allocate.
+ */
+
+#ifndef WBK_EXECUTOR_H
+#define WBK_EXECUTOR_H
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "twheel.h"
+
+typedef struct wbk_job_s wbk_job_t;
+
+struct wbk_job_s
+{
+	/**
+	 * Function is called on the thread of the executor.
+	 *
+	 * @return Milliseconds until the function is called again or a negative
+	 *         value if the job is done.
+	 */
+	long (*job_fn)(wbk_job_t *job, void *param);
+	void *param;
+
+	/**
+	 * Everything below is owned by the executor.
+	 */
+	wbk_job_t *next;
+	wbk_timer_t timer;
+	int queued;
+	int signaled;
+};
+
+typedef struct wbk_executor_s
+{
+	int running;
+
+	/**
+	 * Jobs to call now, the oldest first. Guarded by mutex like everything
+	 * below.
+	 */
+	wbk_job_t *ready_head;
+	wbk_job_t *ready_tail;
+
+	/**
+	 * Delayed jobs
+	 */
+	wbk_twheel_t *twheel;
+
+	/**
+	 * The job being called outside of the mutex or NULL
+	 */
+	wbk_job_t *current;
+
+#if defined(WIN32)
+	CRITICAL_SECTION mutex;
+	CONDITION_VARIABLE cond;
+	HANDLE thread;
+#else
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	pthread_t thread;
+#endif
+} wbk_executor_t;
+
+/**
+ * @brief Creates a new executor and starts its thread
+ * @return A new executor or NULL if allocation failed
+ */
+extern wbk_executor_t *
+wbk_executor_new(void);
+
+/**
+ * @brief Stops the thread of an executor and frees it. Pending jobs are
+ * dropped.
+ */
+extern int
+wbk_executor_free(wbk_executor_t *executor);
+
+/**
+ * @brief Gets the executor used by loaded key binding commands.
+ * @return The executor or NULL if none is set.
+ */
+extern wbk_executor_t *
+wbk_executor_get_default(void);
+
+/**
+ * @brief Sets the executor used by key binding commands loaded afterwards.
+ * @param executor The executor is not owned. It must outlive all loaded
+ *                 key binding commands.
+ */
+extern void
+wbk_executor_set_default(wbk_executor_t *executor);
+
+extern int
+wbk_job_init(wbk_job_t *job, long (*job_fn)(wbk_job_t *job, void *param), void *param);
+
+/**
+ * @brief Queues a job. Returns at once.
+ * @return Non-0 if the job is still queued or the executor is not running.
+ */
+extern int
+wbk_executor_submit(wbk_executor_t *executor, wbk_job_t *job);
+
+/**
+ * @brief Calls a job as soon as possible. Unlike wbk_executor_submit() it
+ * also calls a delayed job at once and a job being called once more after
+ * the call returned, thus no signal is lost. Returns at once.
+ * @return Non-0 if the executor is not running.
+ */
+extern int
+wbk_executor_signal(wbk_executor_t *executor, wbk_job_t *job);
+
+/**
+ * @brief Removes a job from an executor. If the job is being called, the
+ * call is waited for. Afterwards the job may be freed.
+ */
+extern int
+wbk_executor_cancel(wbk_executor_t *executor, wbk_job_t *job);
+
+/**
+ * @return Non-0 if the job is queued, delayed or being called.
+ */
+extern int
+wbk_job_queued(const wbk_job_t *job);
+
+/**
+ * @return Milliseconds of the monotonic clock delays are measured with
+ */
+extern unsigned long
+wbk_executor_now(void);
+
+#endif // WBK_EXECUTOR_H
@@ -0,0 +1,433 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the file watcher class implementation and private methods
+ */
+
+#include "fwatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include "logger.h"
+
+#define WBK_FWATCH_BUFFER_LEN 4096
+
+static wbk_logger_t logger =  { "fwatch" };
+
+#if defined(WIN32)
+static DWORD WINAPI
+wbk_fwatch_thread(LPVOID param);
+#else
+static void *
+wbk_fwatch_thread(void *param);
+#endif
+
+/**
+ * @return Non-0 if the buffered directory changes touch the watched file.
+ */
+static int
+wbk_fwatch_matches(const wbk_fwatch_t *fwatch, const void *buffer, int length);
+
+wbk_fwatch_t *
+wbk_fwatch_new(const char *filename, int debounce,
+               int (*change_fn)(wbk_fwatch_t *fwatch, void *param), void *param)
+{
+	wbk_fwatch_t *fwatch;
+	const char *separator;
+	const char *backslash;
+	size_t length;
+
+	fwatch = NULL;
+	fwatch = malloc(sizeof(wbk_fwatch_t));
+
+	if (fwatch) {
+		memset(fwatch, 0, sizeof(wbk_fwatch_t));
+
+		separator = strrchr(filename, '/');
+		backslash = strrchr(filename, '\\');
+		if (backslash > separator) {
+			separator = backslash;
+		}
+
+		if (separator) {
+			length = separator - filename;
+			fwatch->dirname = malloc(sizeof(char) * (length + 2));
+			memcpy(fwatch->dirname, filename, length);
+			fwatch->dirname[length] = '\0';
+			if (length == 0) {
+				strcpy(fwatch->dirname, "/");
+			}
+			separator++;
+		} else {
+			fwatch->dirname = malloc(sizeof(char) * 2);
+			strcpy(fwatch->dirname, ".");
+			separator = filename;
+		}
+
+		fwatch->basename = malloc(sizeof(char) * (strlen(separator) + 1));
+		strcpy(fwatch->basename, separator);
+
+		fwatch->debounce = debounce;
+		fwatch->change_fn = change_fn;
+		fwatch->param = param;
+		fwatch->running = 0;
+
+#if defined(WIN32)
+		length = strlen(fwatch->basename) + 1;
+		fwatch->w32_basename = malloc(sizeof(wchar_t) * length);
+		mbstowcs(fwatch->w32_basename, fwatch->basename, length);
+
+		fwatch->dir = INVALID_HANDLE_VALUE;
+		fwatch->stop_event = NULL;
+		fwatch->thread = NULL;
+#else
+		fwatch->inotify_fd = -1;
+		fwatch->stop_fd[0] = -1;
+		fwatch->stop_fd[1] = -1;
+#endif
+	}
+
+	return fwatch;
+}
+
+int
+wbk_fwatch_free(wbk_fwatch_t *fwatch)
+{
+	wbk_fwatch_stop(fwatch);
+
+#if defined(WIN32)
+	free(fwatch->w32_basename);
+	fwatch->w32_basename = NULL;
+#endif
+
+	free(fwatch->basename);
+	fwatch->basename = NULL;
+
+	free(fwatch->dirname);
+	fwatch->dirname = NULL;
+
+	free(fwatch);
+
+	return 0;
+}
+
+#if defined(WIN32)
+int
+wbk_fwatch_start(wbk_fwatch_t *fwatch)
+{
+	int error;
+
+	error = 0;
+	wbk_fwatch_stop(fwatch);
+
+	fwatch->dir = CreateFileA(fwatch->dirname, FILE_LIST_DIRECTORY,
+	                          FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+	                          NULL, OPEN_EXISTING,
+	                          FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+	                          NULL);
+	if (fwatch->dir == INVALID_HANDLE_VALUE) {
+		wbk_logger_log(&logger, SEVERE, "Could not watch directory %s\n", fwatch->dirname);
+		error = 1;
+	}
+
+	if (!error) {
+		fwatch->stop_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+		fwatch->running = 1;
+		fwatch->thread = CreateThread(NULL, 0, wbk_fwatch_thread, fwatch, 0, NULL);
+		if (fwatch->thread == NULL) {
+			wbk_logger_log(&logger, SEVERE, "Could not start the file watcher thread\n");
+			fwatch->running = 0;
+			error = 1;
+		}
+	}
+
+	if (error) {
+		wbk_fwatch_stop(fwatch);
+	}
+
+	return error;
+}
+
+int
+wbk_fwatch_stop(wbk_fwatch_t *fwatch)
+{
+	if (fwatch->thread) {
+		SetEvent(fwatch->stop_event);
+		WaitForSingleObject(fwatch->thread, INFINITE);
+		CloseHandle(fwatch->thread);
+		fwatch->thread = NULL;
+	}
+	fwatch->running = 0;
+
+	if (fwatch->stop_event) {
+		CloseHandle(fwatch->stop_event);
+		fwatch->stop_event = NULL;
+	}
+
+	if (fwatch->dir != INVALID_HANDLE_VALUE) {
+		CloseHandle(fwatch->dir);
+		fwatch->dir = INVALID_HANDLE_VALUE;
+	}
+
+	return 0;
+}
+
+DWORD WINAPI
+wbk_fwatch_thread(LPVOID param)
+{
+	wbk_fwatch_t *fwatch;
+	DWORD buffer[WBK_FWATCH_BUFFER_LEN / sizeof(DWORD)];
+	OVERLAPPED overlapped;
+	HANDLE handles[2];
+	DWORD result;
+	DWORD length;
+	int reading;
+	int pending;
+
+	fwatch = (wbk_fwatch_t *) param;
+
+	memset(&overlapped, 0, sizeof(OVERLAPPED));
+	overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+
+	handles[0] = fwatch->stop_event;
+	handles[1] = overlapped.hEvent;
+
+	reading = 0;
+	pending = 0;
+	while (fwatch->running) {
+		if (!reading) {
+			ResetEvent(overlapped.hEvent);
+			reading = ReadDirectoryChangesW(fwatch->dir, buffer, sizeof(buffer), FALSE,
+			                                FILE_NOTIFY_CHANGE_FILE_NAME
+			                                | FILE_NOTIFY_CHANGE_LAST_WRITE
+			                                | FILE_NOTIFY_CHANGE_SIZE,
+			                                NULL, &overlapped, NULL);
+			if (!reading) {
+				wbk_logger_log(&logger, SEVERE, "Could not watch directory %s\n", fwatch->dirname);
+				fwatch->running = 0;
+			}
+		}
+
+		if (fwatch->running) {
+			result = WaitForMultipleObjects(2, handles, FALSE,
+			                                pending ? (DWORD) fwatch->debounce : INFINITE);
+
+			if (result == WAIT_OBJECT_0 + 1) {
+				reading = 0;
+				if (GetOverlappedResult(fwatch->dir, &overlapped, &length, FALSE)) {
+					/**
+					 * A length of 0 means the buffer overflowed. The file might
+					 * have changed.
+					 */
+					if (length == 0 || wbk_fwatch_matches(fwatch, buffer, length)) {
+						pending = 1;
+					}
+				}
+			} else if (result == WAIT_TIMEOUT) {
+				pending = 0;
+				wbk_logger_log(&logger, INFO, "%s changed\n", fwatch->basename);
+				fwatch->change_fn(fwatch, fwatch->param);
+			} else {
+				fwatch->running = 0;
+			}
+		}
+	}
+
+	if (reading) {
+		CancelIo(fwatch->dir);
+		GetOverlappedResult(fwatch->dir, &overlapped, &length, TRUE);
+	}
+	CloseHandle(overlapped.hEvent);
+
+	return 0;
+}
+
+int
+wbk_fwatch_matches(const wbk_fwatch_t *fwatch, const void *buffer, int length)
+{
+	const FILE_NOTIFY_INFORMATION *info;
+	size_t name_len;
+	int matches;
+	int offset;
+
+	name_len = wcslen(fwatch->w32_basename);
+
+	matches = 0;
+	offset = 0;
+	do {
+		info = (const FILE_NOTIFY_INFORMATION *) ((const char *) buffer + offset);
+		if (info->FileNameLength / sizeof(WCHAR) == name_len
+		    && _wcsnicmp(info->FileName, fwatch->w32_basename, name_len) == 0) {
+			matches = 1;
+		}
+		offset += info->NextEntryOffset;
+	} while (!matches && info->NextEntryOffset && offset < length);
+
+	return matches;
+}
+#else
+int
+wbk_fwatch_start(wbk_fwatch_t *fwatch)
+{
+	int error;
+
+	error = 0;
+	wbk_fwatch_stop(fwatch);
+
+	fwatch->inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	if (fwatch->inotify_fd < 0
+	    || inotify_add_watch(fwatch->inotify_fd, fwatch->dirname,
+	                         IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE
+	                         | IN_MOVED_TO | IN_DELETE) < 0) {
+		wbk_logger_log(&logger, SEVERE, "Could not watch directory %s\n", fwatch->dirname);
+		error = 1;
+	}
+
+	if (!error && pipe(fwatch->stop_fd)) {
+		error = 1;
+	}
+
+	if (!error) {
+		fwatch->running = 1;
+		if (pthread_create(&(fwatch->thread), NULL, wbk_fwatch_thread, fwatch)) {
+			wbk_logger_log(&logger, SEVERE, "Could not start the file watcher thread\n");
+			fwatch->running = 0;
+			error = 1;
+		}
+	}
+
+	if (error) {
+		wbk_fwatch_stop(fwatch);
+	}
+
+	return error;
+}
+
+int
+wbk_fwatch_stop(wbk_fwatch_t *fwatch)
+{
+	if (fwatch->running) {
+		if (write(fwatch->stop_fd[1], "", 1) == 1) {
+			pthread_join(fwatch->thread, NULL);
+		}
+		fwatch->running = 0;
+	}
+
+	if (fwatch->stop_fd[0] >= 0) {
+		close(fwatch->stop_fd[0]);
+		close(fwatch->stop_fd[1]);
+		fwatch->stop_fd[0] = -1;
+		fwatch->stop_fd[1] = -1;
+	}
+
+	if (fwatch->inotify_fd >= 0) {
+		close(fwatch->inotify_fd);
+		fwatch->inotify_fd = -1;
+	}
+
+	return 0;
+}
+
+void *
+wbk_fwatch_thread(void *param)
+{
+	wbk_fwatch_t *fwatch;
+	char buffer[WBK_FWATCH_BUFFER_LEN]
+		__attribute__ ((aligned(__alignof__(struct inotify_event))));
+	struct pollfd fds[2];
+	ssize_t length;
+	int running;
+	int pending;
+	int result;
+
+	fwatch = (wbk_fwatch_t *) param;
+
+	fds[0].fd = fwatch->stop_fd[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = fwatch->inotify_fd;
+	fds[1].events = POLLIN;
+
+	running = 1;
+	pending = 0;
+	while (running) {
+		result = poll(fds, 2, pending ? fwatch->debounce : -1);
+
+		if (result == 0) {
+			pending = 0;
+			wbk_logger_log(&logger, INFO, "%s changed\n", fwatch->basename);
+			fwatch->change_fn(fwatch, fwatch->param);
+		} else if (result < 0) {
+			running = errno == EINTR;
+		} else if (fds[0].revents) {
+			running = 0;
+		} else {
+			/**
+			 * Drain all queued events with as few reads as possible
+			 */
+			while ((length = read(fwatch->inotify_fd, buffer, sizeof(buffer))) > 0) {
+				if (wbk_fwatch_matches(fwatch, buffer, length)) {
+					pending = 1;
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
+int
+wbk_fwatch_matches(const wbk_fwatch_t *fwatch, const void *buffer, int length)
+{
+	const struct inotify_event *event;
+	int matches;
+	int offset;
+
+	matches = 0;
+	for (offset = 0; !matches && offset < length;
+	     offset += sizeof(struct inotify_event) + event->len) {
+		event = (const struct inotify_event *) ((const char *) buffer + offset);
+		if (event->mask & IN_Q_OVERFLOW
+		    || (event->len && strcmp(event->name, fwatch->basename) == 0)) {
+			matches = 1;
+		}
+	}
+
+	return matches;
+}
+#endif
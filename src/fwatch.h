@@ -0,0 +1,104 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the file watcher class definition
+ *
+ * A file watcher observes the directory of a file on its own thread
+ * (ReadDirectoryChangesW on Windows, inotify on Linux) and calls a function
+ * once the file changed. Bursts of changes, as caused by editors saving a
+ * file, are debounced into a single call.
+ */
+
+#ifndef WBK_FWATCH_H
+#define WBK_FWATCH_H
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/**
+ * Default milliseconds without further changes until the change function is
+ * called.
+ */
+#define WBK_FWATCH_DEBOUNCE 100
+
+typedef struct wbk_fwatch_s wbk_fwatch_t;
+
+struct wbk_fwatch_s
+{
+	char *dirname;
+	char *basename;
+	int debounce;
+
+	/**
+	 * Function is called on the thread of the file watcher, when the file
+	 * changed. Do not block within it.
+	 */
+	int (*change_fn)(wbk_fwatch_t *fwatch, void *param);
+	void *param;
+
+	int running;
+
+#if defined(WIN32)
+	wchar_t *w32_basename;
+	HANDLE dir;
+	HANDLE stop_event;
+	HANDLE thread;
+#else
+	int inotify_fd;
+	int stop_fd[2];
+	pthread_t thread;
+#endif
+};
+
+/**
+ * @param filename The file to watch. The directory of the file must exist.
+ * @param debounce Milliseconds without further changes until change_fn is called
+ */
+extern wbk_fwatch_t *
+wbk_fwatch_new(const char *filename, int debounce,
+               int (*change_fn)(wbk_fwatch_t *fwatch, void *param), void *param);
+
+extern int
+wbk_fwatch_free(wbk_fwatch_t *fwatch);
+
+/**
+ * @brief Starts watching on a new thread.
+ * @return Non-0 if the directory of the file cannot be watched.
+ */
+extern int
+wbk_fwatch_start(wbk_fwatch_t *fwatch);
+
+/**
+ * @brief Stops watching and waits for the thread of the file watcher.
+ */
+extern int
+wbk_fwatch_stop(wbk_fwatch_t *fwatch);
+
+#endif // WBK_FWATCH_H
@@ -0,0 +1 @@
+../../backend.h
\ No newline at end of file
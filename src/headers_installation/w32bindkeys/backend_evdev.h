@@ -0,0 +1 @@
+../../backend_evdev.h
\ No newline at end of file
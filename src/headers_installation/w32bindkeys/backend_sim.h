@@ -0,0 +1 @@
+../../backend_sim.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../bscan.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../caps.h
\ No newline at end of file
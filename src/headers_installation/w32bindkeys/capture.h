@@ -0,0 +1 @@
+../../capture.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../ctl.h
\ No newline at end of file
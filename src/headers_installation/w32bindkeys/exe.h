@@ -0,0 +1 @@
+../../exe.h
\ No newline at end of file
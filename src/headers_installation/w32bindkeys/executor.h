@@ -0,0 +1 @@
+../../executor.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../fwatch.h
\ No newline at end of file
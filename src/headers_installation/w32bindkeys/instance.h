@@ -0,0 +1 @@
+../../instance.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../ipc.h
\ No newline at end of file
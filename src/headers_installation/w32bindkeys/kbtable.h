@@ -0,0 +1 @@
+../../kbtable.h
\ No newline at end of file
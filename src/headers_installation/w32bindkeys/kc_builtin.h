@@ -0,0 +1 @@
+../../kc_builtin.h
\ No newline at end of file
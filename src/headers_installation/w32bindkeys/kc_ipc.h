@@ -0,0 +1 @@
+../../kc_ipc.h
\ No newline at end of file
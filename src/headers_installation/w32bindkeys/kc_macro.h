@@ -0,0 +1 @@
+../../kc_macro.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../kc_mode.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../kc_remap.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../launcher.h
\ No newline at end of file
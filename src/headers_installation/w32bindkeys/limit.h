@@ -0,0 +1 @@
+../../limit.h
\ No newline at end of file
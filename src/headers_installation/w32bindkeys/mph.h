@@ -0,0 +1 @@
+../../mph.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../sink.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../sink_win32.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../tmpl.h
\ No newline at end of file
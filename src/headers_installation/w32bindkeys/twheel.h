@@ -0,0 +1 @@
+../../twheel.h
\ No newline at end of file
@@ -0,0 +1,171 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the instance lock class implementation
+ */
+
+#include "instance.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#endif
+
+#include "logger.h"
+
+#define WBK_INSTANCE_NAME "w32bindkeys"
+
+static wbk_logger_t logger =  { "instance" };
+
+wbk_instance_t *
+wbk_instance_new(const char *name)
+{
+	wbk_instance_t *instance;
+
+	instance = NULL;
+	instance = malloc(sizeof(wbk_instance_t));
+
+	if (instance) {
+		instance->name = malloc(sizeof(char) * (strlen(name) + 1));
+		strcpy(instance->name, name);
+
+#if defined(WIN32)
+		instance->mutex = NULL;
+#else
+		instance->fd = -1;
+#endif
+	}
+
+	return instance;
+}
+
+int
+wbk_instance_free(wbk_instance_t *instance)
+{
+#if defined(WIN32)
+	if (instance->mutex) {
+		CloseHandle(instance->mutex);
+		instance->mutex = NULL;
+	}
+#else
+	/**
+	 * The lock file is not removed. Another instance may already wait for it.
+	 */
+	if (instance->fd >= 0) {
+		close(instance->fd);
+		instance->fd = -1;
+	}
+#endif
+
+	free(instance->name);
+	instance->name = NULL;
+
+	free(instance);
+
+	return 0;
+}
+
+int
+wbk_instance_acquire(wbk_instance_t *instance)
+{
+	int error;
+
+	error = 0;
+
+#if defined(WIN32)
+	if (instance->mutex == NULL) {
+		instance->mutex = CreateMutexA(NULL, FALSE, instance->name);
+		if (instance->mutex == NULL) {
+			wbk_logger_log(&logger, SEVERE, "Could not create mutex %s\n", instance->name);
+			error = 1;
+		} else if (GetLastError() == ERROR_ALREADY_EXISTS) {
+			CloseHandle(instance->mutex);
+			instance->mutex = NULL;
+			error = 1;
+		}
+	}
+#else
+	if (instance->fd < 0) {
+		instance->fd = open(instance->name, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+		if (instance->fd < 0) {
+			wbk_logger_log(&logger, SEVERE, "Could not open lock file %s\n", instance->name);
+			error = 1;
+		} else if (flock(instance->fd, LOCK_EX | LOCK_NB)) {
+			if (errno != EWOULDBLOCK) {
+				wbk_logger_log(&logger, SEVERE, "Could not lock %s\n", instance->name);
+			}
+			close(instance->fd);
+			instance->fd = -1;
+			error = 1;
+		}
+	}
+#endif
+
+	return error;
+}
+
+char *
+wbk_instance_default_name(void)
+{
+	char *name;
+	const char *user;
+
+#if defined(WIN32)
+	/**
+	 * The Local namespace is per session, thus other users logged in at the
+	 * same time do not interfere.
+	 */
+	user = getenv("USERNAME");
+	if (user == NULL) {
+		user = "default";
+	}
+
+	name = malloc(sizeof(char) * (strlen(WBK_INSTANCE_NAME) + strlen(user) + 8));
+	sprintf(name, "Local\\%s-%s", WBK_INSTANCE_NAME, user);
+#else
+	const char *dir;
+	char uid[32];
+
+	dir = getenv("XDG_RUNTIME_DIR");
+	if (dir == NULL) {
+		dir = "/tmp";
+	}
+	sprintf(uid, "%d", (int) getuid());
+	user = uid;
+
+	name = malloc(sizeof(char) * (strlen(dir) + strlen(WBK_INSTANCE_NAME) + strlen(user) + 8));
+	sprintf(name, "%s/%s-%s.lock", dir, WBK_INSTANCE_NAME, user);
+#endif
+
+	return name;
+}
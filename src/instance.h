@@ -0,0 +1,80 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the instance lock class definition
+ *
+ * An instance lock makes sure only a single instance installs its keyboard
+ * hooks per user. It is a named mutex on Windows and a locked file on Linux.
+ * Both are released by the operating system if the instance dies.
+ */
+
+#ifndef WBK_INSTANCE_H
+#define WBK_INSTANCE_H
+
+#if defined(WIN32)
+#include <windows.h>
+#endif
+
+typedef struct wbk_instance_s
+{
+	char *name;
+
+#if defined(WIN32)
+	HANDLE mutex;
+#else
+	int fd;
+#endif
+} wbk_instance_t;
+
+/**
+ * @param name The name of the mutex or the path of the lock file
+ */
+extern wbk_instance_t *
+wbk_instance_new(const char *name);
+
+/**
+ * @brief Releases the lock if it was acquired.
+ */
+extern int
+wbk_instance_free(wbk_instance_t *instance);
+
+/**
+ * @brief Acquires the lock without waiting.
+ * @return 0 if this is the only instance. Non-0 if another instance holds the
+ * lock or the lock cannot be created.
+ */
+extern int
+wbk_instance_acquire(wbk_instance_t *instance);
+
+/**
+ * @brief Creates the name of the instance lock of the current user.
+ * @return A new string. Free it by yourself!
+ */
+extern char *
+wbk_instance_default_name(void);
+
+#endif // WBK_INSTANCE_H
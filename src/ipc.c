@@ -0,0 +1,525 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the IPC channel class implementation and private methods
+ */
+
+#include "ipc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#endif
+
+#include "logger.h"
+
+/**
+ * Number of bytes of the length of a frame
+ */
+#define WBK_IPC_HEADER_LEN 4
+
+static wbk_logger_t logger =  { "ipc" };
+
+/**
+ * All channels in use
+ */
+static wbk_ipc_t *g_ipc_registry = NULL;
+
+#if defined(WIN32)
+static SRWLOCK g_ipc_registry_lock = SRWLOCK_INIT;
+#else
+static pthread_mutex_t g_ipc_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static wbk_ipc_t *
+wbk_ipc_new(const char *address, wbk_executor_t *executor);
+
+/**
+ * Cancels the job, closes the connection and frees the channel.
+ */
+static int
+wbk_ipc_free(wbk_ipc_t *ipc);
+
+/**
+ * Writes the queued frames. Connects first if needed.
+ *
+ * @return A delay until connecting again or -1 if all frames are written
+ */
+static long
+wbk_ipc_job_fn(wbk_job_t *job, void *param);
+
+/**
+ * @return Non-0 if the consumer cannot be connected
+ */
+static int
+wbk_ipc_connect(wbk_ipc_t *ipc);
+
+static void
+wbk_ipc_disconnect(wbk_ipc_t *ipc);
+
+static int
+wbk_ipc_connected(const wbk_ipc_t *ipc);
+
+/**
+ * @return The number of written bytes or a negative value if the connection
+ *         failed
+ */
+static long
+wbk_ipc_write(wbk_ipc_t *ipc, const char *buffer, int length);
+
+/**
+ * @return The offset of the frame containing the byte at an offset
+ */
+static int
+wbk_ipc_frame_start(const char *buffer, int offset);
+
+static void
+wbk_ipc_mutex_lock(wbk_ipc_t *ipc);
+
+static void
+wbk_ipc_mutex_unlock(wbk_ipc_t *ipc);
+
+static void
+wbk_ipc_registry_lock(void);
+
+static void
+wbk_ipc_registry_unlock(void);
+
+wbk_ipc_t *
+wbk_ipc_get(const char *address, wbk_executor_t *executor)
+{
+	wbk_ipc_t *ipc;
+
+	wbk_ipc_registry_lock();
+
+	ipc = g_ipc_registry;
+	while (ipc && strcmp(ipc->address, address)) {
+		ipc = ipc->next;
+	}
+
+	if (ipc) {
+		ipc->refcount++;
+	} else {
+		ipc = wbk_ipc_new(address, executor);
+		if (ipc) {
+			ipc->next = g_ipc_registry;
+			g_ipc_registry = ipc;
+		}
+	}
+
+	wbk_ipc_registry_unlock();
+
+	return ipc;
+}
+
+int
+wbk_ipc_release(wbk_ipc_t *ipc)
+{
+	wbk_ipc_t **link;
+	int unused;
+
+	wbk_ipc_registry_lock();
+
+	unused = --(ipc->refcount) == 0;
+	if (unused) {
+		link = &g_ipc_registry;
+		while (*link != ipc) {
+			link = &((*link)->next);
+		}
+		*link = ipc->next;
+	}
+
+	wbk_ipc_registry_unlock();
+
+	if (unused) {
+		wbk_ipc_free(ipc);
+	}
+
+	return 0;
+}
+
+int
+wbk_ipc_post(wbk_ipc_t *ipc, const char *message, int message_len)
+{
+	char *pending;
+	int size;
+	int error;
+	int i;
+
+	error = ipc->executor == NULL;
+
+	wbk_ipc_mutex_lock(ipc);
+
+	size = ipc->pending_len + WBK_IPC_HEADER_LEN + message_len;
+	if (!error && size > WBK_IPC_QUEUE_LEN) {
+		error = 1;
+	} else if (!error && size > ipc->pending_size) {
+		size = size > ipc->pending_size * 2 ? size : ipc->pending_size * 2;
+		pending = realloc(ipc->pending, sizeof(char) * size);
+		if (pending) {
+			ipc->pending = pending;
+			ipc->pending_size = size;
+		} else {
+			error = 1;
+		}
+	}
+
+	if (!error) {
+		for (i = 0; i < WBK_IPC_HEADER_LEN; i++) {
+			ipc->pending[ipc->pending_len++] = (char) ((message_len >> (8 * i)) & 0xFF);
+		}
+		memcpy(ipc->pending + ipc->pending_len, message, sizeof(char) * message_len);
+		ipc->pending_len += message_len;
+	}
+
+	wbk_ipc_mutex_unlock(ipc);
+
+	if (!error) {
+		error = wbk_executor_signal(ipc->executor, &(ipc->job));
+	}
+
+	return error;
+}
+
+wbk_ipc_t *
+wbk_ipc_new(const char *address, wbk_executor_t *executor)
+{
+	wbk_ipc_t *ipc;
+
+	ipc = NULL;
+	ipc = malloc(sizeof(wbk_ipc_t));
+
+	if (ipc) {
+		memset(ipc, 0, sizeof(wbk_ipc_t));
+
+		ipc->address = malloc(sizeof(char) * (strlen(address) + 1));
+		strcpy(ipc->address, address);
+
+		ipc->refcount = 1;
+		ipc->next = NULL;
+		ipc->executor = executor;
+		wbk_job_init(&(ipc->job), wbk_ipc_job_fn, ipc);
+
+		ipc->pending = NULL;
+		ipc->pending_len = 0;
+		ipc->pending_size = 0;
+		ipc->flushing = NULL;
+		ipc->flushing_len = 0;
+		ipc->flushing_size = 0;
+		ipc->flushed = 0;
+		ipc->retry_at = 0;
+
+#if defined(WIN32)
+		InitializeCriticalSection(&(ipc->mutex));
+		ipc->pipe = INVALID_HANDLE_VALUE;
+#else
+		pthread_mutex_init(&(ipc->mutex), NULL);
+		ipc->fd = -1;
+#endif
+	}
+
+	return ipc;
+}
+
+int
+wbk_ipc_free(wbk_ipc_t *ipc)
+{
+	if (ipc->executor) {
+		wbk_executor_cancel(ipc->executor, &(ipc->job));
+	}
+
+	wbk_ipc_disconnect(ipc);
+
+#if defined(WIN32)
+	DeleteCriticalSection(&(ipc->mutex));
+#else
+	pthread_mutex_destroy(&(ipc->mutex));
+#endif
+
+	free(ipc->pending);
+	free(ipc->flushing);
+	free(ipc->address);
+	free(ipc);
+
+	return 0;
+}
+
+long
+wbk_ipc_job_fn(wbk_job_t *job, void *param)
+{
+	wbk_ipc_t *ipc;
+	char *buffer;
+	unsigned long now;
+	long written;
+	long delay;
+	int failures;
+	int size;
+
+	ipc = (wbk_ipc_t *) param;
+
+	/**
+	 * Take all pending frames, unless the last ones are still unwritten
+	 */
+	if (ipc->flushing_len == 0) {
+		wbk_ipc_mutex_lock(ipc);
+
+		buffer = ipc->flushing;
+		size = ipc->flushing_size;
+		ipc->flushing = ipc->pending;
+		ipc->flushing_len = ipc->pending_len;
+		ipc->flushing_size = ipc->pending_size;
+		ipc->flushed = 0;
+		ipc->pending = buffer;
+		ipc->pending_len = 0;
+		ipc->pending_size = size;
+
+		wbk_ipc_mutex_unlock(ipc);
+	}
+
+	delay = -1;
+	failures = 0;
+	while (delay < 0 && ipc->flushed < ipc->flushing_len) {
+		now = wbk_executor_now();
+		if (!wbk_ipc_connected(ipc)) {
+			if ((long) (ipc->retry_at - now) > 0) {
+				delay = ipc->retry_at - now;
+			} else if (wbk_ipc_connect(ipc)) {
+				wbk_logger_log(&logger, INFO, "Cannot connect to %s\n", ipc->address);
+				ipc->retry_at = now + WBK_IPC_RETRY_DELAY;
+				delay = WBK_IPC_RETRY_DELAY;
+			}
+		}
+
+		if (delay < 0) {
+			written = wbk_ipc_write(ipc, ipc->flushing + ipc->flushed,
+			                        ipc->flushing_len - ipc->flushed);
+			if (written >= 0) {
+				ipc->flushed += written;
+			} else {
+				/**
+				 * The consumer went away. A new connection starts with a
+				 * whole frame; the first failure is retried at once.
+				 */
+				wbk_ipc_disconnect(ipc);
+				ipc->flushed = wbk_ipc_frame_start(ipc->flushing, ipc->flushed);
+				if (++failures > 1) {
+					ipc->retry_at = now + WBK_IPC_RETRY_DELAY;
+					delay = WBK_IPC_RETRY_DELAY;
+				}
+			}
+		}
+	}
+
+	if (delay < 0) {
+		ipc->flushing_len = 0;
+		ipc->flushed = 0;
+
+		/**
+		 * Frames posted while waiting to connect again are written at once
+		 */
+		wbk_ipc_mutex_lock(ipc);
+		if (ipc->pending_len > 0) {
+			delay = 0;
+		}
+		wbk_ipc_mutex_unlock(ipc);
+	}
+
+	return delay;
+}
+
+int
+wbk_ipc_frame_start(const char *buffer, int offset)
+{
+	const unsigned char *header;
+	int start;
+	int next;
+
+	start = 0;
+	next = 0;
+	while (next <= offset) {
+		start = next;
+		header = (const unsigned char *) (buffer + start);
+		next = start + WBK_IPC_HEADER_LEN
+		       + (header[0] | (header[1] << 8) | (header[2] << 16) | (header[3] << 24));
+	}
+
+	return start;
+}
+
+#if defined(WIN32)
+int
+wbk_ipc_connect(wbk_ipc_t *ipc)
+{
+	ipc->pipe = CreateFileA(ipc->address, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+
+	return ipc->pipe == INVALID_HANDLE_VALUE;
+}
+
+void
+wbk_ipc_disconnect(wbk_ipc_t *ipc)
+{
+	if (ipc->pipe != INVALID_HANDLE_VALUE) {
+		CloseHandle(ipc->pipe);
+		ipc->pipe = INVALID_HANDLE_VALUE;
+	}
+}
+
+int
+wbk_ipc_connected(const wbk_ipc_t *ipc)
+{
+	return ipc->pipe != INVALID_HANDLE_VALUE;
+}
+
+long
+wbk_ipc_write(wbk_ipc_t *ipc, const char *buffer, int length)
+{
+	DWORD written;
+
+	return WriteFile(ipc->pipe, buffer, length, &written, NULL) ? (long) written : -1;
+}
+
+void
+wbk_ipc_mutex_lock(wbk_ipc_t *ipc)
+{
+	EnterCriticalSection(&(ipc->mutex));
+}
+
+void
+wbk_ipc_mutex_unlock(wbk_ipc_t *ipc)
+{
+	LeaveCriticalSection(&(ipc->mutex));
+}
+
+void
+wbk_ipc_registry_lock(void)
+{
+	AcquireSRWLockExclusive(&g_ipc_registry_lock);
+}
+
+void
+wbk_ipc_registry_unlock(void)
+{
+	ReleaseSRWLockExclusive(&g_ipc_registry_lock);
+}
+#else
+int
+wbk_ipc_connect(wbk_ipc_t *ipc)
+{
+	struct sockaddr_un addr;
+	struct timeval timeout;
+	int error;
+
+	error = 0;
+
+	memset(&addr, 0, sizeof(struct sockaddr_un));
+	addr.sun_family = AF_UNIX;
+	if (strlen(ipc->address) >= sizeof(addr.sun_path)) {
+		error = 1;
+	} else {
+		strcpy(addr.sun_path, ipc->address);
+	}
+
+	if (!error) {
+		ipc->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		timeout.tv_sec = WBK_IPC_TIMEOUT / 1000;
+		timeout.tv_usec = (WBK_IPC_TIMEOUT % 1000) * 1000;
+		error = ipc->fd < 0
+		        || setsockopt(ipc->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout))
+		        || connect(ipc->fd, (struct sockaddr *) &addr, sizeof(struct sockaddr_un));
+	}
+
+	if (error) {
+		wbk_ipc_disconnect(ipc);
+	}
+
+	return error;
+}
+
+void
+wbk_ipc_disconnect(wbk_ipc_t *ipc)
+{
+	if (ipc->fd >= 0) {
+		close(ipc->fd);
+		ipc->fd = -1;
+	}
+}
+
+int
+wbk_ipc_connected(const wbk_ipc_t *ipc)
+{
+	return ipc->fd >= 0;
+}
+
+long
+wbk_ipc_write(wbk_ipc_t *ipc, const char *buffer, int length)
+{
+	ssize_t written;
+
+	/**
+	 * A consumer, which went away, must not raise SIGPIPE
+	 */
+	written = send(ipc->fd, buffer, length, MSG_NOSIGNAL);
+	if (written < 0 && errno == EINTR) {
+		written = 0;
+	}
+
+	return written;
+}
+
+void
+wbk_ipc_mutex_lock(wbk_ipc_t *ipc)
+{
+	pthread_mutex_lock(&(ipc->mutex));
+}
+
+void
+wbk_ipc_mutex_unlock(wbk_ipc_t *ipc)
+{
+	pthread_mutex_unlock(&(ipc->mutex));
+}
+
+void
+wbk_ipc_registry_lock(void)
+{
+	pthread_mutex_lock(&g_ipc_registry_lock);
+}
+
+void
+wbk_ipc_registry_unlock(void)
+{
+	pthread_mutex_unlock(&g_ipc_registry_lock);
+}
+#endif
@@ -0,0 +1,142 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the IPC channel class definition
+ *
+ * An IPC channel delivers messages to a long running consumer over a named
+ * pipe (Windows) or a Unix domain socket (Linux). The connection is kept
+ * open between messages and is opened again once the consumer went away.
+ *
+ * Each message is framed by its length as 4 byte little endian integer,
+ * followed by the bytes of the message. Posting a message only appends the
+ * frame to a queue; the queue is written by a job of an executor (see
+ * executor.h). Messages posted while the job writes, e.g. during a burst of
+ * key strokes, are written together by a single write.
+ *
+ * Channels are shared by address. All commands sending to the same consumer
+ * use a single connection.
+ */
+
+#ifndef WBK_IPC_H
+#define WBK_IPC_H
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "executor.h"
+
+/**
+ * Maximum number of bytes queued while the consumer is away. Messages
+ * beyond are dropped.
+ */
+#define WBK_IPC_QUEUE_LEN 65536
+
+/**
+ * Milliseconds to wait before connecting again after a failed attempt
+ */
+#define WBK_IPC_RETRY_DELAY 1000
+
+/**
+ * Milliseconds a write may block on a consumer that does not read
+ */
+#define WBK_IPC_TIMEOUT 1000
+
+typedef struct wbk_ipc_s wbk_ipc_t;
+
+struct wbk_ipc_s
+{
+	char *address;
+
+	/**
+	 * Guarded by the lock of the registry of channels.
+	 */
+	int refcount;
+	wbk_ipc_t *next;
+
+	/**
+	 * Not owned by the channel.
+	 */
+	wbk_executor_t *executor;
+
+	wbk_job_t job;
+
+	/**
+	 * Frames posted but not taken by the job yet. Guarded by mutex.
+	 */
+	char *pending;
+	int pending_len;
+	int pending_size;
+
+	/**
+	 * Frames being written. Only used by the job, like everything below.
+	 */
+	char *flushing;
+	int flushing_len;
+	int flushing_size;
+	int flushed;
+
+	unsigned long retry_at;
+
+#if defined(WIN32)
+	CRITICAL_SECTION mutex;
+	HANDLE pipe;
+#else
+	pthread_mutex_t mutex;
+	int fd;
+#endif
+};
+
+/**
+ * @brief Gets the channel to an address, creating it if needed. The channel
+ * does not connect before the first message is posted.
+ * @param address The name of the pipe or the path of the socket
+ * @param executor The executor writing the messages. Only used if the channel is created. It must outlive the channel.
+ * @return The channel or NULL if allocation failed. Release it by wbk_ipc_release().
+ */
+extern wbk_ipc_t *
+wbk_ipc_get(const char *address, wbk_executor_t *executor);
+
+/**
+ * @brief Releases a channel got by wbk_ipc_get(). The last release closes
+ * the connection and drops unwritten messages.
+ */
+extern int
+wbk_ipc_release(wbk_ipc_t *ipc);
+
+/**
+ * @brief Queues a message. Returns at once.
+ * @return Non-0 if the message was dropped, because the queue is full or the
+ *         channel has no executor.
+ */
+extern int
+wbk_ipc_post(wbk_ipc_t *ipc, const char *message, int message_len);
+
+#endif // WBK_IPC_H
@@ -29,12 +29,15 @@
  * private methods
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <windows.h>
 #include <wtsapi32.h>
 #include <time.h>
 
 #include "logger.h"
 #include "kbdaemon.h"
+#include "sink_win32.h"
 
 static wbk_logger_t logger =  { "kbdaemon" };
 
@@ -44,7 +47,6 @@ typedef struct kbhook_s
 	wbk_kbdaemon_t **arr;
 	HHOOK hook_id;
 	LRESULT CALLBACK (*hook_fn)(int , WPARAM , LPARAM );
-	wbk_b_t *cur_b;
 	int hook_entered;
 	int hook_left;
 } kbhook_t;
@@ -55,6 +57,36 @@ typedef struct kbhook_s
 static int
 wbk_kbhook_reset_all_b(void);
 
+/**
+ * Reset the tracked pressed keys of all keyboard daemons of a hook.
+ */
+static int
+wbk_kbhook_reset_b(kbhook_t *kbhook);
+
+/**
+ * Implementation of wbk_backend_free().
+ */
+static int
+wbk_kbdaemon_free_impl(wbk_backend_t *backend);
+
+/**
+ * Implementation of wbk_backend_start().
+ */
+static int
+wbk_kbdaemon_start_impl(wbk_backend_t *backend);
+
+/**
+ * Implementation of wbk_backend_stop().
+ */
+static int
+wbk_kbdaemon_stop_impl(wbk_backend_t *backend);
+
+/**
+ * Passes the combinations tracked by the backend to wbk_kbdaemon_exec().
+ */
+static int
+wbk_kbdaemon_backend_exec_fn(wbk_backend_t *backend, wbk_b_t *b, void *param);
+
 static int
 wbk_kbhook_any_hook_broken(void);
 
@@ -111,6 +143,31 @@ wbk_kbhook_stop();
 static LRESULT CALLBACK
 wbk_kbhook_windows_hook0(int nCode, WPARAM wParam, LPARAM lParam);
 
+/**
+ * The low level mouse hook started and stopped by wbk_kbhook_start() and
+ * wbk_kbhook_stop(). It feeds mouse buttons and wheel notches to the keyboard
+ * daemons of all keyboard hooks. Low level hooks are called on the thread,
+ * which installed them, thus keys and mouse buttons share the tracked
+ * combinations without locking.
+ */
+static LRESULT CALLBACK
+wbk_kbhook_windows_mouse(int nCode, WPARAM wParam, LPARAM lParam);
+
+/**
+ * Arms the tick timer if a keyboard daemon waits for a timeout (e.g. a key
+ * being held), otherwise the tick timer is killed. Hooks and the tick timer
+ * run on the same thread.
+ */
+static void
+wbk_kbhook_schedule_tick(void);
+
+/**
+ * Advances all keyboard daemons to the current time, which fires the expired
+ * timeouts. GetTickCount() uses the clock of the hook timestamps.
+ */
+static VOID CALLBACK
+wbk_kbhook_tick(HWND window_handler, UINT msg, UINT_PTR id, DWORD time);
+
 /**
  * A low level keyboard hook started and stopped by wbk_kbhook_start() and
  * wbk_kbhook_stop(). It is used for the 1st global element.
@@ -503,62 +560,66 @@ wbk_kbhook_remove_kbdaemon(wbk_kbdaemon_t *kbdaemon);
 static int g_kbhook_arr_len = W32_KBHOOK_ARR_LEN;
 static int g_kbhook_arr_i = 0;
 static struct kbhook_s g_kbhook_arr[] = {
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook0,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook1,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook2,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook3,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook4,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook5,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook6,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook7,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook8,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook9,  NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook10, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook11, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook12, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook13, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook14, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook15, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook16, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook17, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook18, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook19, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook20, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook21, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook22, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook23, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook24, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook25, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook26, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook27, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook28, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook29, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook30, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook31, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook32, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook33, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook34, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook35, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook36, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook37, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook38, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook39, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook40, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook41, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook42, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook43, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook44, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook45, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook46, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook47, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook48, NULL, 0, 0 },
-		{ 0, NULL, NULL, wbk_kbhook_windows_hook49, NULL, 0, 0 }
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook0,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook1,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook2,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook3,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook4,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook5,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook6,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook7,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook8,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook9,  0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook10, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook11, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook12, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook13, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook14, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook15, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook16, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook17, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook18, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook19, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook20, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook21, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook22, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook23, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook24, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook25, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook26, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook27, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook28, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook29, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook30, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook31, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook32, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook33, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook34, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook35, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook36, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook37, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook38, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook39, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook40, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook41, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook42, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook43, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook44, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook45, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook46, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook47, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook48, 0, 0 },
+		{ 0, NULL, NULL, wbk_kbhook_windows_hook49, 0, 0 }
 };
 
 static char g_session_watcher_created = 0;
 
 static HANDLE g_active_win_watcher_handler = NULL;
 
+static HHOOK g_mousehook_id = NULL;
+
+static UINT_PTR g_tick_timer_id = 0;
+
 int
 wbk_kbhook_reset_all_b(void)
 {
@@ -573,13 +634,13 @@ wbk_kbhook_reset_all_b(void)
 	Sleep(5);
 
   for (i = 0; i < g_kbhook_arr_len; i++) {
-		wbk_b_reset(g_kbhook_arr[i].cur_b);
+		wbk_kbhook_reset_b(&(g_kbhook_arr[i]));
 	}
 
 	Sleep(10);
 
 	for (i = 0; i < g_kbhook_arr_len; i++) {
-		wbk_b_reset(g_kbhook_arr[i].cur_b);
+		wbk_kbhook_reset_b(&(g_kbhook_arr[i]));
 		g_kbhook_arr[i].hook_entered = 0;
 	}
 
@@ -590,6 +651,20 @@ wbk_kbhook_reset_all_b(void)
 	return 0;
 }
 
+int
+wbk_kbhook_reset_b(kbhook_t *kbhook)
+{
+	int i;
+
+	for (i = 0; i < kbhook->arr_len; i++) {
+		if (kbhook->arr[i]) {
+			wbk_backend_reset((wbk_backend_t *) kbhook->arr[i]);
+		}
+	}
+
+	return 0;
+}
+
 int
 wbk_kbhook_any_hook_broken(void)
 {
@@ -727,7 +802,7 @@ wbk_kbhook_hook_watcher(LPVOID param) {
 	  last[i] = g_kbhook_arr[i].hook_entered;
 
 	  if (last_was_same[i] >= W32_KBHOOK_LAST_WAS_SAME_STREAK) {
-		wbk_b_reset(g_kbhook_arr[i].cur_b);
+		wbk_kbhook_reset_b(&(g_kbhook_arr[i]));
 		g_kbhook_arr[i].hook_entered = 0;
 		wbk_logger_log(&logger, DEBUG, "Resetting a KBHOOK\n");
         last_was_same[i] = 0;
@@ -861,15 +936,11 @@ wbk_kbhook_start()
 
 	error = 0;
 
-  /**
-   * Init all kbhooks
-   */
-	for (i = 0; i < g_kbhook_arr_len; i++) {
-		if (g_kbhook_arr[i].cur_b == NULL) {
-			g_kbhook_arr[i].cur_b = wbk_b_new();
-		}
-	}
-
+	/**
+	 * The hooks are called on this thread. Processes started by bindings
+	 * must not delay them.
+	 */
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
 
   /**
    * Start all kbhooks
@@ -881,6 +952,10 @@ wbk_kbhook_start()
      }
   }
 
+	if (g_mousehook_id == NULL) {
+		g_mousehook_id = SetWindowsHookExA(WH_MOUSE_LL, wbk_kbhook_windows_mouse, GetModuleHandle(NULL), 0);
+	}
+
 	return error;
 }
 
@@ -894,9 +969,16 @@ wbk_kbhook_stop()
 			UnhookWindowsHookEx(g_kbhook_arr[i].hook_id);
 			g_kbhook_arr[i].hook_id = NULL;
 		}
+	}
 
-		wbk_b_free(g_kbhook_arr[i].cur_b);
-		g_kbhook_arr[i].cur_b = NULL;
+	if (g_mousehook_id) {
+		UnhookWindowsHookEx(g_mousehook_id);
+		g_mousehook_id = NULL;
+	}
+
+	if (g_tick_timer_id) {
+		KillTimer(NULL, g_tick_timer_id);
+		g_tick_timer_id = 0;
 	}
 
 	return 0;
@@ -906,14 +988,13 @@ static LRESULT CALLBACK
 wbk_kbhook_windows(int nCode, WPARAM wParam, LPARAM lParam,
 				   int *g_kbdaemon_arr_len,
 				   wbk_kbdaemon_t ***g_kbdaemon_arr,
-				   wbk_b_t **g_cur_b,
 				   int *hook_entered,
 				   int *hook_left)
 {
 	int ret;
 	KBDLLHOOKSTRUCT *hookstruct;
 	wbk_be_t be;
-	int changed_any;
+	int pressed;
 	int i;
 
 	(*hook_entered)++;
@@ -929,41 +1010,97 @@ wbk_kbhook_windows(int nCode, WPARAM wParam, LPARAM lParam,
 		case WM_SYSKEYUP:
 			hookstruct = (KBDLLHOOKSTRUCT *)lParam;
 
-			changed_any = 0;
+			/**
+			 * Remapped key strokes must not execute bindings again
+			 */
+			if (wbk_sink_win32_is_injected(hookstruct->flags, hookstruct->dwExtraInfo)) {
+				break;
+			}
+
+			/**
+			 * AltGr is reported as a left control with a fake scan code
+			 * followed by the right alt. It is only the right alt.
+			 */
+			if (hookstruct->vkCode == VK_LCONTROL && (hookstruct->scanCode & 0x200)) {
+				break;
+			}
 
 			be.modifier = wbk_kbdaemon_win32_to_mk(hookstruct->vkCode);
 			be.key = wbk_kbdaemon_win32_to_char(hookstruct->vkCode);
-
-			switch (wParam) {
-				case WM_KEYDOWN:
-				case WM_SYSKEYDOWN:
-					if (wbk_b_add(*g_cur_b, &be) == 0) {
-						changed_any = 1;
-					}
-					break;
-
-				case WM_KEYUP:
-				case WM_SYSKEYUP:
-					be.modifier = wbk_kbdaemon_win32_to_mk(hookstruct->vkCode);
-					be.key = wbk_kbdaemon_win32_to_char(hookstruct->vkCode);
-					if (wbk_b_remove(*g_cur_b, &be) == 0) {
-						changed_any = 1;
-					}
-					break;
+			pressed = wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN;
+
+			/**
+			 * Tracking and matching is done by the portable backend core
+			 */
+			for (i = 0; i < *g_kbdaemon_arr_len; i++) {
+				if ((*g_kbdaemon_arr)[i]
+					&& wbk_backend_feed_at((wbk_backend_t *) (*g_kbdaemon_arr)[i], &be, pressed,
+					                       hookstruct->time) == 0) {
+					ret = 1;
+				}
 			}
 
-			if (changed_any) {
-				for (i = 0; i < *g_kbdaemon_arr_len; i++) {
-					if ((*g_kbdaemon_arr)[i]
-						&& wbk_kbdaemon_exec((*g_kbdaemon_arr)[i], *g_cur_b) == 0) {
+			wbk_kbhook_schedule_tick();
+		}
+	}
+
+  /* *hook_entered--; */
+
+	if (!ret) {
+		ret = CallNextHookEx(NULL, nCode, wParam, lParam);
+	}
+
+	return ret;
+}
+
+LRESULT CALLBACK
+wbk_kbhook_windows_mouse(int nCode, WPARAM wParam, LPARAM lParam)
+{
+	int ret;
+	MSLLHOOKSTRUCT *hookstruct;
+	wbk_be_t be;
+	int pressed;
+	int i;
+	int j;
+
+	ret = 0;
+
+	/**
+	 * Mouse moves are by far the most frequent messages. Pass them on without
+	 * looking at them.
+	 */
+	if (nCode >= 0 && wParam != WM_MOUSEMOVE) {
+		hookstruct = (MSLLHOOKSTRUCT *) lParam;
+
+		if (wbk_sink_win32_is_injected(hookstruct->flags, hookstruct->dwExtraInfo)) {
+			be.modifier = NOT_A_MODIFIER;
+		} else {
+			be.modifier = wbk_kbdaemon_win32_mouse_to_mk(wParam, hookstruct->mouseData);
+		}
+		be.key = '\0';
+		pressed = wParam == WM_LBUTTONDOWN || wParam == WM_MBUTTONDOWN
+			|| wParam == WM_RBUTTONDOWN || wParam == WM_XBUTTONDOWN;
+
+		for (i = 0; be.modifier != NOT_A_MODIFIER && i < g_kbhook_arr_len; i++) {
+			for (j = 0; j < g_kbhook_arr[i].arr_len; j++) {
+				if (g_kbhook_arr[i].arr[j] == NULL) {
+					/* Removed keyboard daemon */
+				} else if (wParam == WM_MOUSEWHEEL || wParam == WM_MOUSEHWHEEL) {
+					wbk_backend_advance((wbk_backend_t *) g_kbhook_arr[i].arr[j], hookstruct->time);
+					if (wbk_backend_feed_click((wbk_backend_t *) g_kbhook_arr[i].arr[j], &be) == 0) {
 						ret = 1;
 					}
+				} else if (wbk_backend_feed_at((wbk_backend_t *) g_kbhook_arr[i].arr[j], &be, pressed,
+				                               hookstruct->time) == 0) {
+					ret = 1;
 				}
 			}
 		}
-	}
 
-  /* *hook_entered--; */
+		if (be.modifier != NOT_A_MODIFIER) {
+			wbk_kbhook_schedule_tick();
+		}
+	}
 
 	if (!ret) {
 		ret = CallNextHookEx(NULL, nCode, wParam, lParam);
@@ -972,13 +1109,64 @@ wbk_kbhook_windows(int nCode, WPARAM wParam, LPARAM lParam,
 	return ret;
 }
 
+void
+wbk_kbhook_schedule_tick(void)
+{
+	unsigned long timeout;
+	unsigned long min;
+	int pending;
+	int i;
+	int j;
+
+	pending = 0;
+	min = 0;
+	for (i = 0; i < g_kbhook_arr_len; i++) {
+		for (j = 0; j < g_kbhook_arr[i].arr_len; j++) {
+			if (g_kbhook_arr[i].arr[j]
+			    && wbk_backend_next_timeout((wbk_backend_t *) g_kbhook_arr[i].arr[j], &timeout) == 0
+			    && (!pending || timeout < min)) {
+				min = timeout;
+				pending = 1;
+			}
+		}
+	}
+
+	if (pending) {
+		/**
+		 * Setting an existing timer again only changes its timeout
+		 */
+		g_tick_timer_id = SetTimer(NULL, g_tick_timer_id, min > 0 ? min : USER_TIMER_MINIMUM, wbk_kbhook_tick);
+	} else if (g_tick_timer_id) {
+		KillTimer(NULL, g_tick_timer_id);
+		g_tick_timer_id = 0;
+	}
+}
+
+VOID CALLBACK
+wbk_kbhook_tick(HWND window_handler, UINT msg, UINT_PTR id, DWORD time)
+{
+	DWORD now;
+	int i;
+	int j;
+
+	now = GetTickCount();
+	for (i = 0; i < g_kbhook_arr_len; i++) {
+		for (j = 0; j < g_kbhook_arr[i].arr_len; j++) {
+			if (g_kbhook_arr[i].arr[j]) {
+				wbk_backend_advance((wbk_backend_t *) g_kbhook_arr[i].arr[j], now);
+			}
+		}
+	}
+
+	wbk_kbhook_schedule_tick();
+}
+
 LRESULT CALLBACK
 wbk_kbhook_windows_hook0(int nCode, WPARAM wParam, LPARAM lParam)
 {
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[0].arr_len),
 						   &(g_kbhook_arr[0].arr),
-						   &(g_kbhook_arr[0].cur_b),
 						   &(g_kbhook_arr[0].hook_entered),
 						   &(g_kbhook_arr[0].hook_left));
 }
@@ -989,7 +1177,6 @@ wbk_kbhook_windows_hook1(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[1].arr_len),
 						   &(g_kbhook_arr[1].arr),
-						   &(g_kbhook_arr[1].cur_b),
 						   &(g_kbhook_arr[1].hook_entered),
 						   &(g_kbhook_arr[1].hook_left));
 }
@@ -1000,7 +1187,6 @@ wbk_kbhook_windows_hook2(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[2].arr_len),
 						   &(g_kbhook_arr[2].arr),
-						   &(g_kbhook_arr[2].cur_b),
 						   &(g_kbhook_arr[2].hook_entered),
 						   &(g_kbhook_arr[2].hook_left));
 }
@@ -1011,7 +1197,6 @@ wbk_kbhook_windows_hook3(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[3].arr_len),
                             &(g_kbhook_arr[3].arr),
-                            &(g_kbhook_arr[3].cur_b),
                             &(g_kbhook_arr[3].hook_entered),
                             &(g_kbhook_arr[3].hook_left));
 }
@@ -1022,7 +1207,6 @@ wbk_kbhook_windows_hook4(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[4].arr_len),
                             &(g_kbhook_arr[4].arr),
-                            &(g_kbhook_arr[4].cur_b),
                             &(g_kbhook_arr[4].hook_entered),
                             &(g_kbhook_arr[4].hook_left));
 }
@@ -1033,7 +1217,6 @@ wbk_kbhook_windows_hook5(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[5].arr_len),
                             &(g_kbhook_arr[5].arr),
-                            &(g_kbhook_arr[5].cur_b),
                             &(g_kbhook_arr[5].hook_entered),
                             &(g_kbhook_arr[5].hook_left));
 }
@@ -1044,7 +1227,6 @@ wbk_kbhook_windows_hook6(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[6].arr_len),
                             &(g_kbhook_arr[6].arr),
-                            &(g_kbhook_arr[6].cur_b),
                             &(g_kbhook_arr[6].hook_entered),
                             &(g_kbhook_arr[6].hook_left));
 }
@@ -1055,7 +1237,6 @@ wbk_kbhook_windows_hook7(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[7].arr_len),
                             &(g_kbhook_arr[7].arr),
-                            &(g_kbhook_arr[7].cur_b),
                             &(g_kbhook_arr[7].hook_entered),
                             &(g_kbhook_arr[7].hook_left));
 }
@@ -1066,7 +1247,6 @@ wbk_kbhook_windows_hook8(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[8].arr_len),
                             &(g_kbhook_arr[8].arr),
-                            &(g_kbhook_arr[8].cur_b),
                             &(g_kbhook_arr[8].hook_entered),
                             &(g_kbhook_arr[8].hook_left));
 }
@@ -1077,7 +1257,6 @@ wbk_kbhook_windows_hook9(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[9].arr_len),
                             &(g_kbhook_arr[9].arr),
-                            &(g_kbhook_arr[9].cur_b),
                             &(g_kbhook_arr[9].hook_entered),
                             &(g_kbhook_arr[9].hook_left));
 }
@@ -1088,7 +1267,6 @@ wbk_kbhook_windows_hook10(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[10].arr_len),
 						   &(g_kbhook_arr[10].arr),
-						   &(g_kbhook_arr[10].cur_b),
 						   &(g_kbhook_arr[10].hook_entered),
 						   &(g_kbhook_arr[10].hook_left));
 }
@@ -1099,7 +1277,6 @@ wbk_kbhook_windows_hook11(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[11].arr_len),
 						   &(g_kbhook_arr[11].arr),
-						   &(g_kbhook_arr[11].cur_b),
 						   &(g_kbhook_arr[11].hook_entered),
 						   &(g_kbhook_arr[11].hook_left));
 }
@@ -1110,7 +1287,6 @@ wbk_kbhook_windows_hook12(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[12].arr_len),
 						   &(g_kbhook_arr[12].arr),
-						   &(g_kbhook_arr[12].cur_b),
 						   &(g_kbhook_arr[12].hook_entered),
 						   &(g_kbhook_arr[12].hook_left));
 }
@@ -1121,7 +1297,6 @@ wbk_kbhook_windows_hook13(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[13].arr_len),
                             &(g_kbhook_arr[13].arr),
-                            &(g_kbhook_arr[13].cur_b),
                             &(g_kbhook_arr[13].hook_entered),
                             &(g_kbhook_arr[13].hook_left));
 }
@@ -1132,7 +1307,6 @@ wbk_kbhook_windows_hook14(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[14].arr_len),
                             &(g_kbhook_arr[14].arr),
-                            &(g_kbhook_arr[14].cur_b),
                             &(g_kbhook_arr[14].hook_entered),
                             &(g_kbhook_arr[14].hook_left));
 }
@@ -1143,7 +1317,6 @@ wbk_kbhook_windows_hook15(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[15].arr_len),
                             &(g_kbhook_arr[15].arr),
-                            &(g_kbhook_arr[15].cur_b),
                             &(g_kbhook_arr[15].hook_entered),
                             &(g_kbhook_arr[15].hook_left));
 }
@@ -1154,7 +1327,6 @@ wbk_kbhook_windows_hook16(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[16].arr_len),
                             &(g_kbhook_arr[16].arr),
-                            &(g_kbhook_arr[16].cur_b),
                             &(g_kbhook_arr[16].hook_entered),
                             &(g_kbhook_arr[16].hook_left));
 }
@@ -1165,7 +1337,6 @@ wbk_kbhook_windows_hook17(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[17].arr_len),
                             &(g_kbhook_arr[17].arr),
-                            &(g_kbhook_arr[17].cur_b),
                             &(g_kbhook_arr[17].hook_entered),
                             &(g_kbhook_arr[17].hook_left));
 }
@@ -1176,7 +1347,6 @@ wbk_kbhook_windows_hook18(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[18].arr_len),
                             &(g_kbhook_arr[18].arr),
-                            &(g_kbhook_arr[18].cur_b),
                             &(g_kbhook_arr[18].hook_entered),
                             &(g_kbhook_arr[18].hook_left));
 }
@@ -1187,7 +1357,6 @@ wbk_kbhook_windows_hook19(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[19].arr_len),
                             &(g_kbhook_arr[19].arr),
-                            &(g_kbhook_arr[19].cur_b),
                             &(g_kbhook_arr[19].hook_entered),
                             &(g_kbhook_arr[19].hook_left));
 }
@@ -1198,7 +1367,6 @@ wbk_kbhook_windows_hook20(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[20].arr_len),
 						   &(g_kbhook_arr[20].arr),
-						   &(g_kbhook_arr[20].cur_b),
 						   &(g_kbhook_arr[20].hook_entered),
 						   &(g_kbhook_arr[20].hook_left));
 }
@@ -1209,7 +1377,6 @@ wbk_kbhook_windows_hook21(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[21].arr_len),
 						   &(g_kbhook_arr[21].arr),
-						   &(g_kbhook_arr[21].cur_b),
 						   &(g_kbhook_arr[21].hook_entered),
 						   &(g_kbhook_arr[21].hook_left));
 }
@@ -1220,7 +1387,6 @@ wbk_kbhook_windows_hook22(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[22].arr_len),
 						   &(g_kbhook_arr[22].arr),
-						   &(g_kbhook_arr[22].cur_b),
 						   &(g_kbhook_arr[22].hook_entered),
 						   &(g_kbhook_arr[22].hook_left));
 }
@@ -1231,7 +1397,6 @@ wbk_kbhook_windows_hook23(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[23].arr_len),
                             &(g_kbhook_arr[23].arr),
-                            &(g_kbhook_arr[23].cur_b),
                             &(g_kbhook_arr[23].hook_entered),
                             &(g_kbhook_arr[23].hook_left));
 }
@@ -1242,7 +1407,6 @@ wbk_kbhook_windows_hook24(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[24].arr_len),
                             &(g_kbhook_arr[24].arr),
-                            &(g_kbhook_arr[24].cur_b),
                             &(g_kbhook_arr[24].hook_entered),
                             &(g_kbhook_arr[24].hook_left));
 }
@@ -1253,7 +1417,6 @@ wbk_kbhook_windows_hook25(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[25].arr_len),
                             &(g_kbhook_arr[25].arr),
-                            &(g_kbhook_arr[25].cur_b),
                             &(g_kbhook_arr[25].hook_entered),
                             &(g_kbhook_arr[25].hook_left));
 }
@@ -1264,7 +1427,6 @@ wbk_kbhook_windows_hook26(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[26].arr_len),
                             &(g_kbhook_arr[26].arr),
-                            &(g_kbhook_arr[26].cur_b),
                             &(g_kbhook_arr[26].hook_entered),
                             &(g_kbhook_arr[26].hook_left));
 }
@@ -1275,7 +1437,6 @@ wbk_kbhook_windows_hook27(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[27].arr_len),
                             &(g_kbhook_arr[27].arr),
-                            &(g_kbhook_arr[27].cur_b),
                             &(g_kbhook_arr[27].hook_entered),
                             &(g_kbhook_arr[27].hook_left));
 }
@@ -1286,7 +1447,6 @@ wbk_kbhook_windows_hook28(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[28].arr_len),
                             &(g_kbhook_arr[28].arr),
-                            &(g_kbhook_arr[28].cur_b),
                             &(g_kbhook_arr[28].hook_entered),
                             &(g_kbhook_arr[28].hook_left));
 }
@@ -1297,7 +1457,6 @@ wbk_kbhook_windows_hook29(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[29].arr_len),
                             &(g_kbhook_arr[29].arr),
-                            &(g_kbhook_arr[29].cur_b),
                             &(g_kbhook_arr[29].hook_entered),
                             &(g_kbhook_arr[29].hook_left));
 }
@@ -1308,7 +1467,6 @@ wbk_kbhook_windows_hook30(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[30].arr_len),
 						   &(g_kbhook_arr[30].arr),
-						   &(g_kbhook_arr[30].cur_b),
 						   &(g_kbhook_arr[30].hook_entered),
 						   &(g_kbhook_arr[30].hook_left));
 }
@@ -1319,7 +1477,6 @@ wbk_kbhook_windows_hook31(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[31].arr_len),
 						   &(g_kbhook_arr[31].arr),
-						   &(g_kbhook_arr[31].cur_b),
 						   &(g_kbhook_arr[31].hook_entered),
 						   &(g_kbhook_arr[31].hook_left));
 }
@@ -1330,7 +1487,6 @@ wbk_kbhook_windows_hook32(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[32].arr_len),
 						   &(g_kbhook_arr[32].arr),
-						   &(g_kbhook_arr[32].cur_b),
 						   &(g_kbhook_arr[32].hook_entered),
 						   &(g_kbhook_arr[32].hook_left));
 }
@@ -1341,7 +1497,6 @@ wbk_kbhook_windows_hook33(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[33].arr_len),
                             &(g_kbhook_arr[33].arr),
-                            &(g_kbhook_arr[33].cur_b),
                             &(g_kbhook_arr[33].hook_entered),
                             &(g_kbhook_arr[33].hook_left));
 }
@@ -1352,7 +1507,6 @@ wbk_kbhook_windows_hook34(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[34].arr_len),
                             &(g_kbhook_arr[34].arr),
-                            &(g_kbhook_arr[34].cur_b),
                             &(g_kbhook_arr[34].hook_entered),
                             &(g_kbhook_arr[34].hook_left));
 }
@@ -1363,7 +1517,6 @@ wbk_kbhook_windows_hook35(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[35].arr_len),
                             &(g_kbhook_arr[35].arr),
-                            &(g_kbhook_arr[35].cur_b),
                             &(g_kbhook_arr[35].hook_entered),
                             &(g_kbhook_arr[35].hook_left));
 }
@@ -1374,7 +1527,6 @@ wbk_kbhook_windows_hook36(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[36].arr_len),
                             &(g_kbhook_arr[36].arr),
-                            &(g_kbhook_arr[36].cur_b),
                             &(g_kbhook_arr[36].hook_entered),
                             &(g_kbhook_arr[36].hook_left));
 }
@@ -1385,7 +1537,6 @@ wbk_kbhook_windows_hook37(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[37].arr_len),
                             &(g_kbhook_arr[37].arr),
-                            &(g_kbhook_arr[37].cur_b),
                             &(g_kbhook_arr[37].hook_entered),
                             &(g_kbhook_arr[37].hook_left));
 }
@@ -1396,7 +1547,6 @@ wbk_kbhook_windows_hook38(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[38].arr_len),
                             &(g_kbhook_arr[38].arr),
-                            &(g_kbhook_arr[38].cur_b),
                             &(g_kbhook_arr[38].hook_entered),
                             &(g_kbhook_arr[38].hook_left));
 }
@@ -1407,7 +1557,6 @@ wbk_kbhook_windows_hook39(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[39].arr_len),
                             &(g_kbhook_arr[39].arr),
-                            &(g_kbhook_arr[39].cur_b),
                             &(g_kbhook_arr[39].hook_entered),
                             &(g_kbhook_arr[39].hook_left));
 }
@@ -1418,7 +1567,6 @@ wbk_kbhook_windows_hook40(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[40].arr_len),
 						   &(g_kbhook_arr[40].arr),
-						   &(g_kbhook_arr[40].cur_b),
 						   &(g_kbhook_arr[40].hook_entered),
 						   &(g_kbhook_arr[40].hook_left));
 }
@@ -1429,7 +1577,6 @@ wbk_kbhook_windows_hook41(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[41].arr_len),
 						   &(g_kbhook_arr[41].arr),
-						   &(g_kbhook_arr[41].cur_b),
 						   &(g_kbhook_arr[41].hook_entered),
 						   &(g_kbhook_arr[41].hook_left));
 }
@@ -1440,7 +1587,6 @@ wbk_kbhook_windows_hook42(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
 						   &(g_kbhook_arr[42].arr_len),
 						   &(g_kbhook_arr[42].arr),
-						   &(g_kbhook_arr[42].cur_b),
 						   &(g_kbhook_arr[42].hook_entered),
 						   &(g_kbhook_arr[42].hook_left));
 }
@@ -1451,7 +1597,6 @@ wbk_kbhook_windows_hook43(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[43].arr_len),
                             &(g_kbhook_arr[43].arr),
-                            &(g_kbhook_arr[43].cur_b),
                             &(g_kbhook_arr[43].hook_entered),
                             &(g_kbhook_arr[43].hook_left));
 }
@@ -1462,7 +1607,6 @@ wbk_kbhook_windows_hook44(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[44].arr_len),
                             &(g_kbhook_arr[44].arr),
-                            &(g_kbhook_arr[44].cur_b),
                             &(g_kbhook_arr[44].hook_entered),
                             &(g_kbhook_arr[44].hook_left));
 }
@@ -1473,7 +1617,6 @@ wbk_kbhook_windows_hook45(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[45].arr_len),
                             &(g_kbhook_arr[45].arr),
-                            &(g_kbhook_arr[45].cur_b),
                             &(g_kbhook_arr[45].hook_entered),
                             &(g_kbhook_arr[45].hook_left));
 }
@@ -1484,7 +1627,6 @@ wbk_kbhook_windows_hook46(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[46].arr_len),
                             &(g_kbhook_arr[46].arr),
-                            &(g_kbhook_arr[46].cur_b),
                             &(g_kbhook_arr[46].hook_entered),
                             &(g_kbhook_arr[46].hook_left));
 }
@@ -1495,7 +1637,6 @@ wbk_kbhook_windows_hook47(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[47].arr_len),
                             &(g_kbhook_arr[47].arr),
-                            &(g_kbhook_arr[47].cur_b),
                             &(g_kbhook_arr[47].hook_entered),
                             &(g_kbhook_arr[47].hook_left));
 }
@@ -1506,7 +1647,6 @@ wbk_kbhook_windows_hook48(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[48].arr_len),
                             &(g_kbhook_arr[48].arr),
-                            &(g_kbhook_arr[48].cur_b),
                             &(g_kbhook_arr[48].hook_entered),
                             &(g_kbhook_arr[48].hook_left));
 }
@@ -1517,7 +1657,6 @@ wbk_kbhook_windows_hook49(int nCode, WPARAM wParam, LPARAM lParam)
 	return wbk_kbhook_windows(nCode, wParam, lParam,
                             &(g_kbhook_arr[49].arr_len),
                             &(g_kbhook_arr[49].arr),
-                            &(g_kbhook_arr[49].cur_b),
                             &(g_kbhook_arr[49].hook_entered),
                             &(g_kbhook_arr[49].hook_left));
 }
@@ -1525,14 +1664,31 @@ wbk_kbhook_windows_hook49(int nCode, WPARAM wParam, LPARAM lParam)
 wbk_kbdaemon_t *
 wbk_kbdaemon_new(int (*exec_fn)(wbk_kbdaemon_t *kbdaemon, wbk_b_t *b))
 {
+	wbk_backend_t *backend;
 	wbk_kbdaemon_t *kbdaemon;
 
 	kbdaemon = NULL;
 	kbdaemon = malloc(sizeof(wbk_kbdaemon_t));
 
-	kbdaemon->global_mutex = CreateMutex(NULL, FALSE, NULL);
+	if (kbdaemon) {
+		memset(kbdaemon, 0, sizeof(wbk_kbdaemon_t));
+
+		backend = wbk_backend_new(wbk_kbdaemon_backend_exec_fn, NULL);
+		memcpy(kbdaemon, backend, sizeof(wbk_backend_t));
+		free(backend); /* Just free the top level element */
 
-	kbdaemon->exec_fn = exec_fn;
+		kbdaemon->super_backend_free = kbdaemon->backend.backend_free;
+		kbdaemon->super_backend_start = kbdaemon->backend.backend_start;
+		kbdaemon->super_backend_stop = kbdaemon->backend.backend_stop;
+
+		kbdaemon->backend.backend_free = wbk_kbdaemon_free_impl;
+		kbdaemon->backend.backend_start = wbk_kbdaemon_start_impl;
+		kbdaemon->backend.backend_stop = wbk_kbdaemon_stop_impl;
+
+		kbdaemon->global_mutex = CreateMutex(NULL, FALSE, NULL);
+
+		kbdaemon->exec_fn = exec_fn;
+	}
 
 	return kbdaemon;
 }
@@ -1540,16 +1696,30 @@ wbk_kbdaemon_new(int (*exec_fn)(wbk_kbdaemon_t *kbdaemon, wbk_b_t *b))
 int
 wbk_kbdaemon_free(wbk_kbdaemon_t *kbdaemon)
 {
-	wbk_kbdaemon_stop(kbdaemon);
+	return wbk_backend_free((wbk_backend_t *) kbdaemon);
+}
+
+int
+wbk_kbdaemon_free_impl(wbk_backend_t *backend)
+{
+	wbk_kbdaemon_t *kbdaemon;
+
+	kbdaemon = (wbk_kbdaemon_t *) backend;
+
+	wbk_kbdaemon_stop_impl(backend);
 
 	ReleaseMutex(kbdaemon->global_mutex);
 	CloseHandle(kbdaemon->global_mutex);
 
 	kbdaemon->exec_fn = NULL;
 
-	free(kbdaemon);
+	return kbdaemon->super_backend_free(backend);
+}
 
-	return 0;
+int
+wbk_kbdaemon_backend_exec_fn(wbk_backend_t *backend, wbk_b_t *b, void *param)
+{
+	return wbk_kbdaemon_exec((wbk_kbdaemon_t *) backend, b);
 }
 
 inline int
@@ -1561,6 +1731,16 @@ wbk_kbdaemon_exec(wbk_kbdaemon_t *kbdaemon, wbk_b_t *b)
 int
 wbk_kbdaemon_start(wbk_kbdaemon_t *kbdaemon)
 {
+	return wbk_backend_start((wbk_backend_t *) kbdaemon);
+}
+
+int
+wbk_kbdaemon_start_impl(wbk_backend_t *backend)
+{
+	wbk_kbdaemon_t *kbdaemon;
+
+	kbdaemon = (wbk_kbdaemon_t *) backend;
+
 	WaitForSingleObject(kbdaemon->global_mutex, INFINITE);
 
 	if (!g_session_watcher_created) {
@@ -1573,25 +1753,36 @@ wbk_kbdaemon_start(wbk_kbdaemon_t *kbdaemon)
 		wbk_kbhook_hook_watcher_start();
 	}
 
-	wbk_kbdaemon_stop(kbdaemon);
+	wbk_kbdaemon_stop_impl(backend);
 	wbk_kbhook_add_kbdaemon(kbdaemon);
 	wbk_kbhook_start();
 
 	ReleaseMutex(kbdaemon->global_mutex);
 
-	return 0;
+	return kbdaemon->super_backend_start(backend);
 }
 
 int
 wbk_kbdaemon_stop(wbk_kbdaemon_t *kbdaemon)
 {
+	return wbk_backend_stop((wbk_backend_t *) kbdaemon);
+}
+
+int
+wbk_kbdaemon_stop_impl(wbk_backend_t *backend)
+{
+	wbk_kbdaemon_t *kbdaemon;
+
+	kbdaemon = (wbk_kbdaemon_t *) backend;
+
 	WaitForSingleObject(kbdaemon->global_mutex, INFINITE);
 
 	wbk_kbhook_remove_kbdaemon(kbdaemon);
+	wbk_backend_reset(backend);
 
 	ReleaseMutex(kbdaemon->global_mutex);
 
-	return 0;
+	return kbdaemon->super_backend_stop(backend);
 }
 
 wbk_mk_t
@@ -1603,14 +1794,19 @@ wbk_kbdaemon_win32_to_mk(unsigned char c)
 
 	if (c == 13)
 		modifier = ENTER;
-	else if (c == 16 || c == 160 || c == 161)
-		modifier = SHIFT;
-	else if (c == 17 || c == 162 || c == 163)
-		modifier = CTRL;
-	else if (c == 18 || c == 164 || c == 165)
-		modifier = ALT;
+	else if (c == 16)  modifier = SHIFT;
+	else if (c == 160) modifier = LSHIFT;
+	else if (c == 161) modifier = RSHIFT;
+	else if (c == 17)  modifier = CTRL;
+	else if (c == 162) modifier = LCTRL;
+	else if (c == 163) modifier = RCTRL;
+	else if (c == 18)  modifier = ALT;
+	else if (c == 164) modifier = LALT;
+	else if (c == 165) modifier = RALT;
 	else if (c == VK_SPACE) modifier = SPACE;
-	else if (c == 91 || c == 92)  modifier = WIN;
+	else if (c == VK_ESCAPE) modifier = ESCAPE;
+	else if (c == 91)  modifier = LWIN;
+	else if (c == 92)  modifier = RWIN;
 	else if (c == 112) modifier = F1;
 	else if (c == 113) modifier = F2;
 	else if (c == 114) modifier = F3;
@@ -1623,11 +1819,55 @@ wbk_kbdaemon_win32_to_mk(unsigned char c)
 	else if (c == 121) modifier = F10;
 	else if (c == 122) modifier = F11;
 	else if (c == 123) modifier = F12;
+	else if (c == VK_LEFT) modifier = LEFT;
+	else if (c == VK_RIGHT) modifier = RIGHT;
+	else if (c == VK_UP) modifier = UP;
+	else if (c == VK_DOWN) modifier = DOWN;
 
 	return modifier;
 }
 
 
+wbk_mk_t
+wbk_kbdaemon_win32_mouse_to_mk(WPARAM msg, DWORD mouse_data)
+{
+	wbk_mk_t modifier;
+
+	modifier = NOT_A_MODIFIER;
+
+	switch (msg) {
+	case WM_LBUTTONDOWN:
+	case WM_LBUTTONUP:
+		modifier = MOUSE_LEFT;
+		break;
+
+	case WM_MBUTTONDOWN:
+	case WM_MBUTTONUP:
+		modifier = MOUSE_MIDDLE;
+		break;
+
+	case WM_RBUTTONDOWN:
+	case WM_RBUTTONUP:
+		modifier = MOUSE_RIGHT;
+		break;
+
+	case WM_XBUTTONDOWN:
+	case WM_XBUTTONUP:
+		modifier = HIWORD(mouse_data) == XBUTTON1 ? MOUSE_BACK : MOUSE_FORWARD;
+		break;
+
+	case WM_MOUSEWHEEL:
+		modifier = (short) HIWORD(mouse_data) > 0 ? WHEEL_UP : WHEEL_DOWN;
+		break;
+
+	case WM_MOUSEHWHEEL:
+		modifier = (short) HIWORD(mouse_data) > 0 ? WHEEL_RIGHT : WHEEL_LEFT;
+		break;
+	}
+
+	return modifier;
+}
+
 char
 wbk_kbdaemon_win32_to_char(unsigned char c)
 {
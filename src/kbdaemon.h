@@ -26,6 +26,9 @@
  * @author Richard Bck
  * @date 2020-05-17
  * @brief File contains interpreter keyboard daemon class definition
+ *
+ * wbk_kbdaemon_t inherits all methods of wbk_backend_t (see backend.h). It is
+ * the input backend of the WIN32 low level keyboard hooks.
  */
 
 #ifndef WBK_DAEMON_H
@@ -33,14 +36,17 @@
 
 #include <windows.h>
 
-#include "b.h"
-
-struct wbk_kbdaemon_s;
+#include "backend.h"
 
 typedef struct wbk_kbdaemon_s wbk_kbdaemon_t;
 
-typedef struct wbk_kbdaemon_s
+struct wbk_kbdaemon_s
 {
+	wbk_backend_t backend;
+	int (*super_backend_free)(wbk_backend_t *backend);
+	int (*super_backend_start)(wbk_backend_t *backend);
+	int (*super_backend_stop)(wbk_backend_t *backend);
+
 	HANDLE global_mutex;
 
 	/**
@@ -52,7 +58,7 @@ typedef struct wbk_kbdaemon_s
 	 * behavior for that key combination.
 	 */
 	int (*exec_fn)(wbk_kbdaemon_t *kbdaemon, wbk_b_t *b);
-} wbk_kbdaemon_t;
+};
 
 /**
  */
@@ -84,6 +90,14 @@ wbk_kbdaemon_stop(wbk_kbdaemon_t *kbdaemon);
 extern wbk_mk_t
 wbk_kbdaemon_win32_to_mk(unsigned char c);
 
+/**
+ * @param msg The mouse message of a low level mouse hook (e.g. WM_LBUTTONDOWN).
+ * @param mouse_data The mouseData of the MSLLHOOKSTRUCT.
+ * @return The mouse button or wheel direction or NOT_A_MODIFIER for other messages.
+ */
+extern wbk_mk_t
+wbk_kbdaemon_win32_mouse_to_mk(WPARAM msg, DWORD mouse_data);
+
 /**
  * @param c The result of GetAsyncKeyState (a virtual key code).
  * @return An actual character (e.g. 'a').
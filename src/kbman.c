@@ -22,11 +22,11 @@
   SOFTWARE.
 *******************************************************************************/
 
-#include <windows.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "logger.h"
 #include "kbman.h"
-#include "kbman.h"
 
 static wbk_logger_t logger =  { "kbman" };
 
@@ -36,12 +36,112 @@ wbk_kbman_free_impl(wbk_kbman_t *kbman);
 static int
 wbk_kbman_add_impl(wbk_kbman_t *kbman, wbk_kc_t *kc);
 
+static int
+wbk_kbman_add_mode_impl(wbk_kbman_t *kbman, const char *mode);
+
+static int
+wbk_kbman_add_to_mode_impl(wbk_kbman_t *kbman, const char *mode, wbk_kc_t *kc);
+
+static int
+wbk_kbman_remove_impl(wbk_kbman_t *kbman, const char *mode, const wbk_b_t *b);
+
+static int
+wbk_kbman_switch_mode_impl(wbk_kbman_t *kbman, const char *mode);
+
+static const char *
+wbk_kbman_get_mode_impl(const wbk_kbman_t *kbman);
+
+static int
+wbk_kbman_diff_impl(const wbk_kbman_t *kbman, const wbk_kbman_t *other,
+                    int *added, int *removed);
+
 static wbk_kbman_t **
 wbk_kbman_split_impl(wbk_kbman_t *kbman, int nominator);
 
 static int
 wbk_kbman_exec_impl(wbk_kbman_t *kbman, wbk_b_t *b);
 
+static int
+wbk_kbman_compile_impl(wbk_kbman_t *kbman);
+
+static int
+wbk_kbman_adopt_impl(wbk_kbman_t *kbman, const wbk_kbman_t *other);
+
+static wbk_kbman_mode_t *
+wbk_kbman_mode_new(const char *name);
+
+static int
+wbk_kbman_mode_free(wbk_kbman_mode_t *mode);
+
+/**
+ * Adds a key binding command to a mode and registers it in the lookup table
+ * of the mode. The lookup table is grown if it is filled by more than 3/4.
+ */
+static int
+wbk_kbman_mode_add(wbk_kbman_mode_t *mode, wbk_kc_t *kc);
+
+/**
+ * Rebuilds the lookup table of a mode from scratch.
+ */
+static int
+wbk_kbman_mode_reindex(wbk_kbman_mode_t *mode);
+
+/**
+ * @return The key binding command of the mode whose binding is equal to b or
+ *         NULL.
+ */
+static wbk_kc_t *
+wbk_kbman_mode_find(const wbk_kbman_mode_t *mode, const wbk_b_t *b);
+
+/**
+ * Finds the key binding command of a mode matching a pressed combination. The
+ * combination is looked up once per ignore mask of the mode, with the ignored
+ * modifiers cleared. Bindings ignoring fewer modifiers win.
+ *
+ * @return The key binding command or NULL.
+ */
+static wbk_kc_t *
+wbk_kbman_mode_match(const wbk_kbman_mode_t *mode, const wbk_b_t *b);
+
+/**
+ * Adds the ignore mask of a binding to the masks of a mode unless it is
+ * already known.
+ */
+static int
+wbk_kbman_mode_add_mask(wbk_kbman_mode_t *mode, const wbk_b_t *b);
+
+/**
+ * Builds the minimal perfect hash of a mode over the key binding commands its
+ * index points to, i.e. the first added one of each binding.
+ *
+ * @return Non-0 if it could not be built
+ */
+static int
+wbk_kbman_mode_compile(wbk_kbman_mode_t *mode);
+
+/**
+ * Finds the first added key binding command of a mode whose key range binding
+ * matches a binding.
+ *
+ * @return The key binding command or NULL if no key range matches.
+ */
+static wbk_kc_t *
+wbk_kbman_mode_find_range(const wbk_kbman_mode_t *mode, const wbk_b_t *b);
+
+/**
+ * @return The position of the mode within the key board manager or -1 if it
+ * does not exist.
+ */
+static int
+wbk_kbman_find_mode(const wbk_kbman_t *kbman, const char *mode);
+
+/**
+ * @return The number of key binding commands of kbman, which have no equal
+ * key binding command within the same mode of other.
+ */
+static int
+wbk_kbman_count_missing(const wbk_kbman_t *kbman, const wbk_kbman_t *other);
+
 wbk_kbman_t *
 wbk_kbman_new()
 {
@@ -53,11 +153,23 @@ wbk_kbman_new()
   if (kbman) {
     kbman->kbman_free = wbk_kbman_free_impl;
     kbman->kbman_add = wbk_kbman_add_impl;
+    kbman->kbman_add_mode = wbk_kbman_add_mode_impl;
+    kbman->kbman_add_to_mode = wbk_kbman_add_to_mode_impl;
+    kbman->kbman_remove = wbk_kbman_remove_impl;
+    kbman->kbman_switch_mode = wbk_kbman_switch_mode_impl;
+    kbman->kbman_get_mode = wbk_kbman_get_mode_impl;
+    kbman->kbman_diff = wbk_kbman_diff_impl;
     kbman->kbman_split = wbk_kbman_split_impl;
     kbman->kbman_exec = wbk_kbman_exec_impl;
+    kbman->kbman_compile = wbk_kbman_compile_impl;
+    kbman->kbman_adopt = wbk_kbman_adopt_impl;
 
-    kbman->kc_arr_len = 0;
-    kbman->kc_arr = NULL;
+    kbman->mode_arr_len = 0;
+    kbman->mode_arr = NULL;
+    kbman->mode_owner = kbman;
+    kbman->active_mode = 0;
+
+    wbk_kbman_add_mode(kbman, WBK_KBMAN_DEFAULT_MODE);
   }
 
   return kbman;
@@ -75,6 +187,43 @@ wbk_kbman_add(wbk_kbman_t *kbman, wbk_kc_t *kc)
   return kbman->kbman_add(kbman, kc);
 }
 
+int
+wbk_kbman_add_mode(wbk_kbman_t *kbman, const char *mode)
+{
+  return kbman->kbman_add_mode(kbman, mode);
+}
+
+int
+wbk_kbman_add_to_mode(wbk_kbman_t *kbman, const char *mode, wbk_kc_t *kc)
+{
+  return kbman->kbman_add_to_mode(kbman, mode, kc);
+}
+
+int
+wbk_kbman_remove(wbk_kbman_t *kbman, const char *mode, const wbk_b_t *b)
+{
+  return kbman->kbman_remove(kbman, mode, b);
+}
+
+int
+wbk_kbman_switch_mode(wbk_kbman_t *kbman, const char *mode)
+{
+  return kbman->kbman_switch_mode(kbman, mode);
+}
+
+const char *
+wbk_kbman_get_mode(const wbk_kbman_t *kbman)
+{
+  return kbman->kbman_get_mode(kbman);
+}
+
+int
+wbk_kbman_diff(const wbk_kbman_t *kbman, const wbk_kbman_t *other,
+               int *added, int *removed)
+{
+  return kbman->kbman_diff(kbman, other, added, removed);
+}
+
 wbk_kbman_t **
 wbk_kbman_split(wbk_kbman_t *kbman, int nominator)
 {
@@ -87,45 +236,170 @@ wbk_kbman_exec(wbk_kbman_t *kbman, wbk_b_t *b)
   return kbman->kbman_exec(kbman, b);
 }
 
+int
+wbk_kbman_compile(wbk_kbman_t *kbman)
+{
+  return kbman->kbman_compile(kbman);
+}
+
+int
+wbk_kbman_adopt(wbk_kbman_t *kbman, const wbk_kbman_t *other)
+{
+  return kbman->kbman_adopt(kbman, other);
+}
+
 wbk_kbman_t *
 wbk_kbman_free_impl(wbk_kbman_t *kbman)
 {
 	int i;
 
-	for (i = 0; i < kbman->kc_arr_len; i++) {
-		wbk_kc_free((wbk_kc_t *) kbman->kc_arr[i]);
-		kbman->kc_arr[i] = NULL;
+	for (i = 0; i < kbman->mode_arr_len; i++) {
+		wbk_kbman_mode_free(kbman->mode_arr[i]);
+		kbman->mode_arr[i] = NULL;
 	}
-	free(kbman->kc_arr);
-	kbman->kc_arr = NULL;
+	free(kbman->mode_arr);
+	kbman->mode_arr = NULL;
 
 	free(kbman);
+
+	return NULL;
 }
 
 int
 wbk_kbman_add_impl(wbk_kbman_t *kbman, wbk_kc_t *kc)
 {
-	kbman->kc_arr_len++;
-	kbman->kc_arr = realloc(kbman->kc_arr,
-                          sizeof(wbk_kc_t **) * kbman->kc_arr_len);
-	kbman->kc_arr[kbman->kc_arr_len - 1] = kc;
-	return 0;
+	return wbk_kbman_mode_add(kbman->mode_arr[0], kc);
+}
+
+int
+wbk_kbman_add_mode_impl(wbk_kbman_t *kbman, const char *mode)
+{
+	int error;
+
+	error = 1;
+	if (wbk_kbman_find_mode(kbman, mode) < 0) {
+		kbman->mode_arr = realloc(kbman->mode_arr,
+		                          sizeof(wbk_kbman_mode_t *) * (kbman->mode_arr_len + 1));
+		kbman->mode_arr[kbman->mode_arr_len] = wbk_kbman_mode_new(mode);
+		kbman->mode_arr_len++;
+		error = 0;
+	}
+
+	return error;
+}
+
+int
+wbk_kbman_add_to_mode_impl(wbk_kbman_t *kbman, const char *mode, wbk_kc_t *kc)
+{
+	int error;
+	int pos;
+
+	error = 1;
+	pos = wbk_kbman_find_mode(kbman, mode);
+	if (pos >= 0) {
+		error = wbk_kbman_mode_add(kbman->mode_arr[pos], kc);
+	}
+
+	return error;
+}
+
+int
+wbk_kbman_remove_impl(wbk_kbman_t *kbman, const char *mode, const wbk_b_t *b)
+{
+	wbk_kbman_mode_t *kbman_mode;
+	int error;
+	int pos;
+	int i;
+	int j;
+
+	error = 1;
+	pos = wbk_kbman_find_mode(kbman, mode);
+	if (pos >= 0) {
+		kbman_mode = kbman->mode_arr[pos];
+
+		j = 0;
+		for (i = 0; i < kbman_mode->kc_arr_len; i++) {
+			if (wbk_b_compare(wbk_kc_get_binding(kbman_mode->kc_arr[i]), b) == 0) {
+				wbk_kc_free(kbman_mode->kc_arr[i]);
+				error = 0;
+			} else {
+				kbman_mode->kc_arr[j++] = kbman_mode->kc_arr[i];
+			}
+		}
+		kbman_mode->kc_arr_len = j;
+
+		if (!error) {
+			wbk_kbman_mode_reindex(kbman_mode);
+		}
+	}
+
+	return error;
+}
+
+int
+wbk_kbman_switch_mode_impl(wbk_kbman_t *kbman, const char *mode)
+{
+	int error;
+	int pos;
+
+	error = 1;
+	pos = wbk_kbman_find_mode(kbman->mode_owner, mode);
+	if (pos >= 0) {
+		/**
+		 * A single atomic store. Concurrently running wbk_kbman_exec() calls
+		 * either see the old or the new mode.
+		 */
+		__atomic_store_n(&(kbman->mode_owner->active_mode), pos, __ATOMIC_RELEASE);
+		error = 0;
+	}
+
+	return error;
+}
+
+const char *
+wbk_kbman_get_mode_impl(const wbk_kbman_t *kbman)
+{
+	int active_mode;
+
+	active_mode = __atomic_load_n(&(kbman->mode_owner->active_mode), __ATOMIC_ACQUIRE);
+
+	return kbman->mode_arr[active_mode]->name;
+}
+
+int
+wbk_kbman_diff_impl(const wbk_kbman_t *kbman, const wbk_kbman_t *other,
+                    int *added, int *removed)
+{
+	*added = wbk_kbman_count_missing(other, kbman);
+	*removed = wbk_kbman_count_missing(kbman, other);
+
+	return *added || *removed;
 }
 
 wbk_kbman_t **
 wbk_kbman_split_impl(wbk_kbman_t *kbman, int nominator)
 {
 	wbk_kbman_t **kbmans;
+	wbk_kbman_mode_t *mode;
 	int i;
 	int j;
+	int k;
 
 	kbmans = malloc(sizeof(wbk_kbman_t **) * nominator);
 
 	for (i = 0; i < nominator; i++) {
 		kbmans[i] = wbk_kbman_new();
-		for (j = 0; j < kbman->kc_arr_len; j++) {
-			if (j % nominator == i) {
-				wbk_kbman_add(kbmans[i], wbk_kc_clone((wbk_kc_t *) kbman->kc_arr[j]));
+		kbmans[i]->mode_owner = kbman->mode_owner;
+
+		for (k = 0; k < kbman->mode_arr_len; k++) {
+			mode = kbman->mode_arr[k];
+			wbk_kbman_add_mode(kbmans[i], mode->name);
+
+			for (j = 0; j < mode->kc_arr_len; j++) {
+				if (j % nominator == i) {
+					wbk_kbman_add_to_mode(kbmans[i], mode->name,
+					                      wbk_kc_clone((wbk_kc_t *) mode->kc_arr[j]));
+				}
 			}
 		}
 	}
@@ -137,21 +411,473 @@ int
 wbk_kbman_exec_impl(wbk_kbman_t *kbman, wbk_b_t *b)
 {
 	int error;
-	int i;
-	int found_at;
+	int active_mode;
+	wbk_kbman_mode_t *mode;
+	wbk_kc_t *kc;
+	wbk_b_t probe;
+	int trigger;
 
 	error = 1;
 
-	found_at = -1;
-	for (i = 0; found_at < 0 && i < kbman->kc_arr_len; i++) {
-		if (wbk_b_compare(wbk_kc_get_binding((wbk_kc_t *) kbman->kc_arr[i]), b) == 0) {
-			found_at = i;
+	active_mode = __atomic_load_n(&(kbman->mode_owner->active_mode), __ATOMIC_ACQUIRE);
+	mode = kbman->mode_arr[active_mode];
+
+	if (b->trigger == TRIGGER_HOLD_END) {
+		/**
+		 * Ends the Hold binding of the combination
+		 */
+		probe = *b;
+		probe.trigger = TRIGGER_HOLD;
+		kc = wbk_kbman_mode_match(mode, &probe);
+		if (kc == NULL) {
+			kc = wbk_kbman_mode_find_range(mode, &probe);
+		}
+		if (kc) {
+			error = wbk_kc_exec_end(kc);
+		}
+	} else {
+		kc = wbk_kbman_mode_match(mode, b);
+
+		if (kc == NULL && mode->ranges) {
+			/**
+			 * Exact bindings win over key ranges
+			 */
+			kc = wbk_kbman_mode_find_range(mode, b);
+			if (kc) {
+				error = wbk_kc_exec_key(kc, wbk_b_get_key(b));
+			}
+		} else if (kc) {
+			error = wbk_kc_exec(kc);
 		}
 	}
 
-	if (found_at >= 0) {
-		error = wbk_kc_exec((wbk_kc_t *) kbman->kc_arr[found_at]);
+	if (kc == NULL && b->trigger == TRIGGER_PRESS && mode->trigger_mask & ~(1 << TRIGGER_PRESS)) {
+		/**
+		 * Only modes using other triggers pay for probing them
+		 */
+		probe = *b;
+		for (trigger = TRIGGER_TAP; error && trigger <= TRIGGER_RELEASE; trigger++) {
+			probe.trigger = trigger;
+			if (mode->trigger_mask & (1 << trigger)
+			    && (wbk_kbman_mode_match(mode, &probe)
+			        || wbk_kbman_mode_find_range(mode, &probe))) {
+				error = 0;
+			}
+		}
 	}
 
 	return error;
 }
+
+int
+wbk_kbman_compile_impl(wbk_kbman_t *kbman)
+{
+	int error;
+	int i;
+
+	error = 0;
+	for (i = 0; i < kbman->mode_arr_len; i++) {
+		error |= wbk_kbman_mode_compile(kbman->mode_arr[i]);
+	}
+
+	return error;
+}
+
+int
+wbk_kbman_adopt_impl(wbk_kbman_t *kbman, const wbk_kbman_t *other)
+{
+	wbk_kbman_mode_t *mode;
+	wbk_kc_t *kc;
+	int error;
+	int pos;
+	int i;
+	int j;
+
+	error = 0;
+	for (i = 0; i < kbman->mode_arr_len; i++) {
+		mode = kbman->mode_arr[i];
+		pos = wbk_kbman_find_mode(other, mode->name);
+
+		for (j = 0; pos >= 0 && j < mode->kc_arr_len; j++) {
+			kc = wbk_kbman_mode_find(other->mode_arr[pos],
+			                         wbk_kc_get_binding(mode->kc_arr[j]));
+
+			if (kc && wbk_kc_compare(kc, mode->kc_arr[j]) == 0) {
+				error |= wbk_kc_adopt(mode->kc_arr[j], kc);
+			}
+		}
+	}
+
+	return error;
+}
+
+wbk_kbman_mode_t *
+wbk_kbman_mode_new(const char *name)
+{
+	wbk_kbman_mode_t *mode;
+
+	mode = NULL;
+	mode = malloc(sizeof(wbk_kbman_mode_t));
+
+	if (mode) {
+		mode->name = malloc(sizeof(char) * (strlen(name) + 1));
+		strcpy(mode->name, name);
+
+		mode->kc_arr_len = 0;
+		mode->kc_arr = NULL;
+
+		mode->index_len = 0;
+		mode->index = NULL;
+
+		mode->ranges = NULL;
+		mode->mph = NULL;
+
+		mode->masks_len = 0;
+		mode->masks = NULL;
+
+		mode->trigger_mask = 0;
+	}
+
+	return mode;
+}
+
+int
+wbk_kbman_mode_free(wbk_kbman_mode_t *mode)
+{
+	int i;
+
+	for (i = 0; i < mode->kc_arr_len; i++) {
+		wbk_kc_free(mode->kc_arr[i]);
+		mode->kc_arr[i] = NULL;
+	}
+	free(mode->kc_arr);
+	mode->kc_arr = NULL;
+
+	free(mode->index);
+	mode->index = NULL;
+
+	if (mode->ranges) {
+		wbk_bscan_free(mode->ranges);
+		mode->ranges = NULL;
+	}
+
+	if (mode->mph) {
+		wbk_mph_free(mode->mph);
+		mode->mph = NULL;
+	}
+
+	free(mode->masks);
+	mode->masks = NULL;
+
+	free(mode->name);
+	mode->name = NULL;
+
+	free(mode);
+
+	return 0;
+}
+
+int
+wbk_kbman_mode_add(wbk_kbman_mode_t *mode, wbk_kc_t *kc)
+{
+	int i;
+	int slot;
+	int mask;
+
+	mode->kc_arr_len++;
+	mode->kc_arr = realloc(mode->kc_arr,
+	                       sizeof(wbk_kc_t **) * mode->kc_arr_len);
+	mode->kc_arr[mode->kc_arr_len - 1] = kc;
+	mode->trigger_mask |= 1 << wbk_kc_get_binding(kc)->trigger;
+
+	if (mode->mph) {
+		wbk_mph_free(mode->mph);
+		mode->mph = NULL;
+	}
+
+	wbk_kbman_mode_add_mask(mode, wbk_kc_get_binding(kc));
+
+	if (wbk_kc_get_binding(kc)->key_last != '\0') {
+		if (mode->ranges == NULL) {
+			mode->ranges = wbk_bscan_new();
+		}
+		wbk_bscan_add(mode->ranges, wbk_kc_get_binding(kc), mode->kc_arr_len - 1);
+	}
+
+	if (mode->kc_arr_len * 4 > mode->index_len * 3) {
+		/**
+		 * Grow and rebuild the whole lookup table
+		 */
+		mode->index_len = mode->index_len ? mode->index_len * 2 : 16;
+		wbk_kbman_mode_reindex(mode);
+	} else {
+		i = mode->kc_arr_len - 1;
+		mask = mode->index_len - 1;
+		slot = wbk_b_hash(wbk_kc_get_binding(kc)) & mask;
+		while (mode->index[slot]
+		       && wbk_b_compare(wbk_kc_get_binding(mode->kc_arr[mode->index[slot] - 1]),
+		                        wbk_kc_get_binding(kc))) {
+			slot = (slot + 1) & mask;
+		}
+
+		/**
+		 * The first added key binding command wins if a binding was added twice
+		 */
+		if (!mode->index[slot]) {
+			mode->index[slot] = i + 1;
+		}
+	}
+
+	return 0;
+}
+
+int
+wbk_kbman_mode_reindex(wbk_kbman_mode_t *mode)
+{
+	int i;
+	int slot;
+	int mask;
+
+	free(mode->index);
+	mode->index = NULL;
+	if (mode->index_len > 0) {
+		mode->index = malloc(sizeof(int) * mode->index_len);
+		memset(mode->index, 0, sizeof(int) * mode->index_len);
+	}
+
+	if (mode->ranges) {
+		wbk_bscan_free(mode->ranges);
+		mode->ranges = NULL;
+	}
+
+	if (mode->mph) {
+		wbk_mph_free(mode->mph);
+		mode->mph = NULL;
+	}
+
+	free(mode->masks);
+	mode->masks = NULL;
+	mode->masks_len = 0;
+
+	mode->trigger_mask = 0;
+	mask = mode->index_len - 1;
+	for (i = 0; i < mode->kc_arr_len; i++) {
+		mode->trigger_mask |= 1 << wbk_kc_get_binding(mode->kc_arr[i])->trigger;
+		wbk_kbman_mode_add_mask(mode, wbk_kc_get_binding(mode->kc_arr[i]));
+
+		if (wbk_kc_get_binding(mode->kc_arr[i])->key_last != '\0') {
+			if (mode->ranges == NULL) {
+				mode->ranges = wbk_bscan_new();
+			}
+			wbk_bscan_add(mode->ranges, wbk_kc_get_binding(mode->kc_arr[i]), i);
+		}
+
+		slot = wbk_b_hash(wbk_kc_get_binding(mode->kc_arr[i])) & mask;
+		while (mode->index[slot]
+		       && wbk_b_compare(wbk_kc_get_binding(mode->kc_arr[mode->index[slot] - 1]),
+		                        wbk_kc_get_binding(mode->kc_arr[i]))) {
+			slot = (slot + 1) & mask;
+		}
+
+		/**
+		 * The first added key binding command wins if a binding was added twice
+		 */
+		if (!mode->index[slot]) {
+			mode->index[slot] = i + 1;
+		}
+	}
+
+	return 0;
+}
+
+wbk_kc_t *
+wbk_kbman_mode_find(const wbk_kbman_mode_t *mode, const wbk_b_t *b)
+{
+	wbk_kc_t *kc;
+	int slot;
+	int mask;
+	int pos;
+
+	kc = NULL;
+	if (mode->mph) {
+		pos = wbk_mph_find(mode->mph, b);
+		if (pos >= 0 && wbk_b_compare(wbk_kc_get_binding(mode->kc_arr[pos]), b) == 0) {
+			kc = mode->kc_arr[pos];
+		}
+	} else if (mode->index_len > 0) {
+		mask = mode->index_len - 1;
+		slot = wbk_b_hash(b) & mask;
+		while (kc == NULL && mode->index[slot]) {
+			if (wbk_b_compare(wbk_kc_get_binding(mode->kc_arr[mode->index[slot] - 1]), b) == 0) {
+				kc = mode->kc_arr[mode->index[slot] - 1];
+			} else {
+				slot = (slot + 1) & mask;
+			}
+		}
+	}
+
+	return kc;
+}
+
+wbk_kc_t *
+wbk_kbman_mode_match(const wbk_kbman_mode_t *mode, const wbk_b_t *b)
+{
+	wbk_kc_t *kc;
+	wbk_b_t masked;
+	int i;
+	int j;
+
+	kc = NULL;
+	for (i = 0; kc == NULL && i < mode->masks_len; i++) {
+		if (mode->masks[i] == b->ignore_mask) {
+			kc = wbk_kbman_mode_find(mode, b);
+		} else {
+			masked = *b;
+			masked.ignore_mask = mode->masks[i];
+			/**
+			 * Modifiers set the empty key. It stays set only if a modifier
+			 * remains after masking.
+			 */
+			masked.key_map[0] = 0;
+			for (j = NOT_A_MODIFIER + 1; j < WBK_B_MODIFER_MAP_LEN; j++) {
+				if (mode->masks[i] & (uint64_t) 1 << j) {
+					masked.modifier_map[j] = 0;
+				} else if (masked.modifier_map[j]) {
+					masked.key_map[0] = 1;
+				}
+			}
+			kc = wbk_kbman_mode_find(mode, &masked);
+		}
+	}
+
+	return kc;
+}
+
+int
+wbk_kbman_mode_add_mask(wbk_kbman_mode_t *mode, const wbk_b_t *b)
+{
+	int known;
+	int pos;
+	int i;
+
+	known = b->key_last != '\0';
+	for (i = 0; !known && i < mode->masks_len; i++) {
+		known = mode->masks[i] == b->ignore_mask;
+	}
+
+	if (!known) {
+		/**
+		 * Insertion sort by the number of ignored modifiers
+		 */
+		mode->masks = realloc(mode->masks, sizeof(uint64_t) * (mode->masks_len + 1));
+		for (pos = mode->masks_len;
+		     pos > 0 && __builtin_popcountll(mode->masks[pos - 1])
+		                > __builtin_popcountll(b->ignore_mask);
+		     pos--) {
+			mode->masks[pos] = mode->masks[pos - 1];
+		}
+		mode->masks[pos] = b->ignore_mask;
+		mode->masks_len++;
+	}
+
+	return known;
+}
+
+int
+wbk_kbman_mode_compile(wbk_kbman_mode_t *mode)
+{
+	const wbk_b_t **b_arr;
+	int *values;
+	int len;
+	int error;
+	int i;
+
+	if (mode->mph) {
+		wbk_mph_free(mode->mph);
+		mode->mph = NULL;
+	}
+
+	b_arr = malloc(sizeof(wbk_b_t *) * (mode->index_len > 0 ? mode->index_len : 1));
+	values = malloc(sizeof(int) * (mode->index_len > 0 ? mode->index_len : 1));
+
+	error = !b_arr || !values;
+	len = 0;
+	for (i = 0; !error && i < mode->index_len; i++) {
+		if (mode->index[i]) {
+			values[len] = mode->index[i] - 1;
+			b_arr[len] = wbk_kc_get_binding(mode->kc_arr[values[len]]);
+			len++;
+		}
+	}
+
+	if (!error) {
+		mode->mph = wbk_mph_new(b_arr, values, len);
+		error = mode->mph == NULL;
+	}
+
+	if (error) {
+		wbk_logger_log(&logger, WARNING, "Failed compiling mode: %s\n", mode->name);
+	}
+
+	free(b_arr);
+	free(values);
+
+	return error;
+}
+
+wbk_kc_t *
+wbk_kbman_mode_find_range(const wbk_kbman_mode_t *mode, const wbk_b_t *b)
+{
+	int pos;
+
+	pos = mode->ranges ? wbk_bscan_find(mode->ranges, b) : -1;
+
+	return pos >= 0 ? mode->kc_arr[pos] : NULL;
+}
+
+int
+wbk_kbman_find_mode(const wbk_kbman_t *kbman, const char *mode)
+{
+	int pos;
+	int i;
+
+	pos = -1;
+	for (i = 0; pos < 0 && i < kbman->mode_arr_len; i++) {
+		if (strcmp(kbman->mode_arr[i]->name, mode) == 0) {
+			pos = i;
+		}
+	}
+
+	return pos;
+}
+
+int
+wbk_kbman_count_missing(const wbk_kbman_t *kbman, const wbk_kbman_t *other)
+{
+	wbk_kbman_mode_t *mode;
+	wbk_kc_t *kc;
+	int missing;
+	int pos;
+	int i;
+	int j;
+
+	missing = 0;
+	for (i = 0; i < kbman->mode_arr_len; i++) {
+		mode = kbman->mode_arr[i];
+		pos = wbk_kbman_find_mode(other, mode->name);
+
+		for (j = 0; j < mode->kc_arr_len; j++) {
+			kc = NULL;
+			if (pos >= 0) {
+				kc = wbk_kbman_mode_find(other->mode_arr[pos],
+				                         wbk_kc_get_binding(mode->kc_arr[j]));
+			}
+
+			if (kc == NULL || wbk_kc_compare(kc, mode->kc_arr[j])) {
+				missing++;
+			}
+		}
+	}
+
+	return missing;
+}
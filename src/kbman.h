@@ -31,20 +31,98 @@
 #ifndef WBK_KBMAN_H
 #define WBK_KBMAN_H
 
-#include <windows.h>
-
+#include "bscan.h"
 #include "kc.h"
+#include "mph.h"
+
+#define WBK_KBMAN_DEFAULT_MODE "default"
+
 typedef struct wbk_kbman_s wbk_kbman_t;
 
+/**
+ * A named set of key binding commands. Each mode owns a prebuilt lookup table
+ * over its key binding commands.
+ */
+typedef struct wbk_kbman_mode_s
+{
+	char *name;
+
+	int kc_arr_len;
+	wbk_kc_t **kc_arr;
+
+	/**
+	 * Open addressing hash table over kc_arr. A slot contains the position of a
+	 * key binding command in kc_arr plus 1. Empty slots contain 0. The length
+	 * is always a power of 2.
+	 */
+	int index_len;
+	int *index;
+
+	/**
+	 * Scans the key binding commands whose bindings are key ranges for their
+	 * positions in kc_arr. It is used if no binding matches exactly. NULL if
+	 * the mode has no key range.
+	 */
+	wbk_bscan_t *ranges;
+
+	/**
+	 * Minimal perfect hash over the bindings of the mode, mapping them to
+	 * their positions in kc_arr. It replaces index once the key board manager
+	 * is compiled (see wbk_kbman_compile()) and is dropped by any change of
+	 * the mode. NULL otherwise.
+	 */
+	wbk_mph_t *mph;
+
+	/**
+	 * The distinct ignore masks (see wbk_b_t.ignore_mask) of the bindings of
+	 * the mode, except key ranges, fewest ignored modifiers first. A pressed
+	 * combination is looked up once per mask.
+	 */
+	int masks_len;
+	uint64_t *masks;
+
+	/**
+	 * Bit (1 << trigger) is set for every trigger used by a key binding
+	 * command of the mode.
+	 */
+	int trigger_mask;
+} wbk_kbman_mode_t;
+
 struct wbk_kbman_s
 {
   wbk_kbman_t *(*kbman_free)(wbk_kbman_t *kbman);
   int (*kbman_add)(wbk_kbman_t *kbman, wbk_kc_t *kc);
+  int (*kbman_add_mode)(wbk_kbman_t *kbman, const char *mode);
+  int (*kbman_add_to_mode)(wbk_kbman_t *kbman, const char *mode, wbk_kc_t *kc);
+  int (*kbman_remove)(wbk_kbman_t *kbman, const char *mode, const wbk_b_t *b);
+  int (*kbman_switch_mode)(wbk_kbman_t *kbman, const char *mode);
+  const char *(*kbman_get_mode)(const wbk_kbman_t *kbman);
+  int (*kbman_diff)(const wbk_kbman_t *kbman, const wbk_kbman_t *other,
+                    int *added, int *removed);
   wbk_kbman_t **(*kbman_split)(wbk_kbman_t *kbman, int nominator);
   int (*kbman_exec)(wbk_kbman_t *kbman, wbk_b_t *b);
-
-	int kc_arr_len;
-	wbk_kc_t **kc_arr;
+  int (*kbman_compile)(wbk_kbman_t *kbman);
+  int (*kbman_adopt)(wbk_kbman_t *kbman, const wbk_kbman_t *other);
+
+	/**
+	 * The 0th mode is always WBK_KBMAN_DEFAULT_MODE.
+	 */
+	int mode_arr_len;
+	wbk_kbman_mode_t **mode_arr;
+
+	/**
+	 * The key board manager holding the active mode. It is the key board
+	 * manager itself, except for key board managers created by
+	 * wbk_kbman_split(). Those share the active mode of the split key board
+	 * manager.
+	 */
+	wbk_kbman_t *mode_owner;
+
+	/**
+	 * Position of the active mode in mode_arr. Only valid for the mode owner.
+	 * It is written atomically, thus switching modes never blocks the matching.
+	 */
+	int active_mode;
 };
 
 /**
@@ -56,25 +134,102 @@ extern wbk_kbman_t *
 wbk_kbman_free(wbk_kbman_t *kbman);
 
 /**
+ * @brief Adds a key binding command to the default mode
  * @param kb The key binding to add. The added key binding will be freed by the key binding manager
  */
 extern int
 wbk_kbman_add(wbk_kbman_t *kbman, wbk_kc_t *kc);
 
+/**
+ * @brief Adds a new empty mode
+ * @return 0 if the mode was added. Non-0 if it already exists.
+ */
+extern int
+wbk_kbman_add_mode(wbk_kbman_t *kbman, const char *mode);
+
+/**
+ * @brief Adds a key binding command to a mode
+ * @param kb The key binding to add. The added key binding will be freed by the key binding manager
+ * @return 0 if the key binding command was added. Non-0 if the mode does not exist.
+ */
+extern int
+wbk_kbman_add_to_mode(wbk_kbman_t *kbman, const char *mode, wbk_kc_t *kc);
+
+/**
+ * @brief Removes and frees all key binding commands of a mode matching a
+ * binding
+ * @return 0 if a key binding command was removed. Non-0 otherwise.
+ */
+extern int
+wbk_kbman_remove(wbk_kbman_t *kbman, const char *mode, const wbk_b_t *b);
+
+/**
+ * @brief Makes a mode the active one. Only the key binding commands of the
+ * active mode are executed by wbk_kbman_exec().
+ * @return 0 if the mode was switched. Non-0 if the mode does not exist.
+ */
+extern int
+wbk_kbman_switch_mode(wbk_kbman_t *kbman, const char *mode);
+
+/**
+ * @brief Gets the name of the active mode
+ * @return The name of the active mode. Do not free the returned string.
+ */
+extern const char *
+wbk_kbman_get_mode(const wbk_kbman_t *kbman);
+
+/**
+ * @brief Compares the key binding commands of two key board managers mode by
+ * mode (see wbk_kc_compare()).
+ * @param added Is set to the number of key binding commands of other missing in kbman
+ * @param removed Is set to the number of key binding commands of kbman missing in other
+ * @return 0 if both key board managers contain equal key binding commands. Non-0 otherwise.
+ */
+extern int
+wbk_kbman_diff(const wbk_kbman_t *kbman, const wbk_kbman_t *other,
+               int *added, int *removed);
+
 /**
  * Create an array of nominator new key board managers and divide the internal
  * key commands by nominator over those new key board managers. The key commands
  * are copied during this processes. The returned array and the returned key
  * board managers need to be freed by yourself!
+ *
+ * The new key board managers contain the same modes and share the active mode
+ * with kbman. Therefore kbman must be freed after them.
  */
 extern wbk_kbman_t **
 wbk_kbman_split(wbk_kbman_t *kbman, int nominator);
 
 /**
  * @brief Execute a key binding matching a combination
+ *
+ * A pressed combination without a key binding, which is bound to another
+ * trigger (e.g. hold + capslock), counts as found. Thus it is swallowed and
+ * its timed key bindings get their chance.
+ *
  * @return Non-0 if the combination was not found.
  */
 extern int
 wbk_kbman_exec(wbk_kbman_t *kbman, wbk_b_t *b);
 
+/**
+ * @brief Builds a minimal perfect hash over the bindings of each mode. Lookups
+ * of a compiled mode hash once and compare once instead of probing. Call it
+ * once the key binding commands are added; adding or removing one drops the
+ * hash of its mode again.
+ * @return Non-0 if the hash of a mode could not be built. Its mode keeps
+ *         working by its open addressing index.
+ */
+extern int
+wbk_kbman_compile(wbk_kbman_t *kbman);
+
+/**
+ * @brief Lets each key binding command take over the state of the equal key
+ * binding command within the same mode of other (see wbk_kc_adopt()). Call it
+ * before kbman is split.
+ */
+extern int
+wbk_kbman_adopt(wbk_kbman_t *kbman, const wbk_kbman_t *other);
+
 #endif // WBK_KBMAN_H
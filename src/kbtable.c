@@ -0,0 +1,804 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the key board table class implementation and private methods
+ */
+
+#include "kbtable.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <errno.h>
+#include <time.h>
+#endif
+
+#include "logger.h"
+
+static wbk_logger_t logger =  { "kbtable" };
+
+/**
+ * Runs wbk_kbtable_load() for each reload request and frees retired
+ * generations in between.
+ */
+#if defined(WIN32)
+static DWORD WINAPI
+wbk_kbtable_thread(LPVOID param);
+#else
+static void *
+wbk_kbtable_thread(void *param);
+#endif
+
+static void
+wbk_kbtable_mutex_lock(wbk_kbtable_t *kbtable);
+
+static void
+wbk_kbtable_mutex_unlock(wbk_kbtable_t *kbtable);
+
+/**
+ * Waits for a reload request, but timeout milliseconds at most.
+ * @return Non-0 if a reload was requested.
+ */
+static int
+wbk_kbtable_wait_reload(wbk_kbtable_t *kbtable, int timeout);
+
+/**
+ * @return Milliseconds of a monotonic clock.
+ */
+static unsigned long
+wbk_kbtable_now(void);
+
+/**
+ * Replaces the live generation by a new one created from kbman. The caller
+ * must hold the mutex.
+ */
+static int
+wbk_kbtable_swap(wbk_kbtable_t *kbtable, wbk_kbman_t *kbman);
+
+/**
+ * Parses the rc file and applies the runtime changes on top of it. The caller
+ * must hold the mutex.
+ * @return A new key board manager or NULL if the rc file cannot be parsed or
+ * a change cannot be applied.
+ */
+static wbk_kbman_t *
+wbk_kbtable_build(wbk_kbtable_t *kbtable, wbk_kbtable_mut_t **mut_arr, int mut_arr_len);
+
+/**
+ * @return The position of the change of the same mode and binding or -1.
+ */
+static int
+wbk_kbtable_mut_find(wbk_kbtable_mut_t **mut_arr, int mut_arr_len, const wbk_kbtable_mut_t *mut);
+
+static wbk_kbtable_gen_t *
+wbk_kbtable_gen_new(wbk_kbman_t *kbman, int kbman_arr_len);
+
+static int
+wbk_kbtable_gen_free(wbk_kbtable_gen_t *gen, int kbman_arr_len);
+
+wbk_kbtable_t *
+wbk_kbtable_new(wbk_parser_t *parser, int kbman_arr_len)
+{
+	wbk_kbtable_t *kbtable;
+
+	kbtable = NULL;
+	kbtable = malloc(sizeof(wbk_kbtable_t));
+
+	if (kbtable) {
+		memset(kbtable, 0, sizeof(wbk_kbtable_t));
+
+		kbtable->parser = parser;
+		kbtable->kbman_arr_len = kbman_arr_len;
+		kbtable->grace_period = WBK_KBTABLE_GRACE_PERIOD;
+
+		kbtable->live = NULL;
+		kbtable->readers = 0;
+		kbtable->retired = NULL;
+
+		kbtable->mut_arr_len = 0;
+		kbtable->mut_arr = NULL;
+
+		kbtable->generation = 0;
+		kbtable->exec_count = 0;
+		kbtable->hit_count = 0;
+
+		kbtable->running = 1;
+
+#if defined(WIN32)
+		kbtable->mutex = CreateMutex(NULL, FALSE, NULL);
+		kbtable->reload_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+
+		kbtable->thread = CreateThread(NULL, 0, wbk_kbtable_thread, kbtable, 0, NULL);
+		if (kbtable->thread == NULL) {
+			kbtable->running = 0;
+		}
+#else
+		pthread_mutexattr_t attr;
+		pthread_condattr_t cond_attr;
+
+		/**
+		 * Recursive like the mutexes of Windows
+		 */
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(&(kbtable->mutex), &attr);
+		pthread_mutexattr_destroy(&attr);
+
+		/**
+		 * Waiting for a reload does not jump with the wall clock
+		 */
+		pthread_condattr_init(&cond_attr);
+		pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+		pthread_cond_init(&(kbtable->reload_cond), &cond_attr);
+		pthread_condattr_destroy(&cond_attr);
+		kbtable->reload_requested = 0;
+
+		if (pthread_create(&(kbtable->thread), NULL, wbk_kbtable_thread, kbtable)) {
+			kbtable->running = 0;
+		}
+#endif
+
+		if (!kbtable->running) {
+			wbk_logger_log(&logger, SEVERE, "Could not start the reload thread\n");
+		}
+	}
+
+	return kbtable;
+}
+
+int
+wbk_kbtable_free(wbk_kbtable_t *kbtable)
+{
+	wbk_kbtable_gen_t *gen;
+	int i;
+
+	if (kbtable->running) {
+		__atomic_store_n(&(kbtable->running), 0, __ATOMIC_SEQ_CST);
+		wbk_kbtable_reload(kbtable);
+#if defined(WIN32)
+		WaitForSingleObject(kbtable->thread, INFINITE);
+		CloseHandle(kbtable->thread);
+		kbtable->thread = NULL;
+#else
+		pthread_join(kbtable->thread, NULL);
+#endif
+	}
+
+	while (kbtable->retired) {
+		gen = kbtable->retired;
+		kbtable->retired = gen->next;
+		wbk_kbtable_gen_free(gen, kbtable->kbman_arr_len);
+	}
+
+	if (kbtable->live) {
+		wbk_kbtable_gen_free(kbtable->live, kbtable->kbman_arr_len);
+		kbtable->live = NULL;
+	}
+
+	for (i = 0; i < kbtable->mut_arr_len; i++) {
+		wbk_kbtable_mut_free(kbtable->mut_arr[i]);
+		kbtable->mut_arr[i] = NULL;
+	}
+	free(kbtable->mut_arr);
+	kbtable->mut_arr = NULL;
+
+#if defined(WIN32)
+	CloseHandle(kbtable->reload_event);
+	CloseHandle(kbtable->mutex);
+#else
+	pthread_cond_destroy(&(kbtable->reload_cond));
+	pthread_mutex_destroy(&(kbtable->mutex));
+#endif
+
+	free(kbtable);
+
+	return 0;
+}
+
+int
+wbk_kbtable_load(wbk_kbtable_t *kbtable)
+{
+	wbk_kbman_t *kbman;
+	wbk_kbtable_gen_t *live;
+	int added;
+	int removed;
+	int error;
+
+	error = 0;
+
+	wbk_kbtable_mutex_lock(kbtable);
+
+	kbman = wbk_kbtable_build(kbtable, kbtable->mut_arr, kbtable->mut_arr_len);
+	if (kbman == NULL) {
+		wbk_logger_log(&logger, SEVERE, "Could not load %s, keeping the current key bindings\n",
+		               wbk_parser_get_filename(kbtable->parser));
+		error = 1;
+	}
+
+	if (!error) {
+		/**
+		 * Only writers replace the live generation and they hold the mutex.
+		 */
+		live = kbtable->live;
+		if (live == NULL) {
+			wbk_kbtable_swap(kbtable, kbman);
+		} else if (wbk_kbman_diff(live->kbman, kbman, &added, &removed)) {
+			wbk_logger_log(&logger, INFO, "Reloaded %s: %d key bindings added, %d removed\n",
+			               wbk_parser_get_filename(kbtable->parser), added, removed);
+			wbk_kbtable_swap(kbtable, kbman);
+		} else {
+			wbk_logger_log(&logger, INFO, "Reloaded %s: key bindings unchanged\n",
+			               wbk_parser_get_filename(kbtable->parser));
+			wbk_kbman_free(kbman);
+		}
+	}
+
+	wbk_kbtable_mutex_unlock(kbtable);
+
+	return error;
+}
+
+int
+wbk_kbtable_load_file(wbk_kbtable_t *kbtable, const char *filename)
+{
+	wbk_kbman_t *kbman;
+	char *old_filename;
+	int error;
+
+	error = 0;
+	kbman = NULL;
+
+	wbk_kbtable_mutex_lock(kbtable);
+
+	old_filename = malloc(sizeof(char) * (strlen(wbk_parser_get_filename(kbtable->parser)) + 1));
+	strcpy(old_filename, wbk_parser_get_filename(kbtable->parser));
+
+	error = wbk_parser_set_filename(kbtable->parser, filename);
+	if (!error) {
+		kbman = wbk_kbtable_build(kbtable, kbtable->mut_arr, kbtable->mut_arr_len);
+	}
+
+	if (kbman == NULL) {
+		wbk_logger_log(&logger, SEVERE, "Could not load %s, keeping %s\n",
+		               filename, old_filename);
+		wbk_parser_set_filename(kbtable->parser, old_filename);
+		error = 1;
+	} else {
+		wbk_logger_log(&logger, INFO, "Loaded %s\n", filename);
+		wbk_kbtable_swap(kbtable, kbman);
+	}
+
+	free(old_filename);
+
+	wbk_kbtable_mutex_unlock(kbtable);
+
+	return error;
+}
+
+int
+wbk_kbtable_reload(wbk_kbtable_t *kbtable)
+{
+#if defined(WIN32)
+	return !SetEvent(kbtable->reload_event);
+#else
+	wbk_kbtable_mutex_lock(kbtable);
+	kbtable->reload_requested = 1;
+	pthread_cond_signal(&(kbtable->reload_cond));
+	wbk_kbtable_mutex_unlock(kbtable);
+
+	return 0;
+#endif
+}
+
+int
+wbk_kbtable_publish(wbk_kbtable_t *kbtable, wbk_kbman_t *kbman)
+{
+	int error;
+
+	wbk_kbtable_mutex_lock(kbtable);
+	error = wbk_kbtable_swap(kbtable, kbman);
+	wbk_kbtable_mutex_unlock(kbtable);
+
+	return error;
+}
+
+int
+wbk_kbtable_mutate(wbk_kbtable_t *kbtable, wbk_kbtable_mut_t **mut_arr, int mut_arr_len)
+{
+	wbk_kbtable_mut_t **new_mut_arr;
+	wbk_kbtable_mut_t **replaced_arr;
+	wbk_kbman_t *kbman;
+	int new_mut_arr_len;
+	int replaced_arr_len;
+	int error;
+	int pos;
+	int i;
+
+	error = 0;
+
+	wbk_kbtable_mutex_lock(kbtable);
+
+	/**
+	 * Merge the changes into a copy of the current ones. A later change of a
+	 * binding replaces an earlier one.
+	 */
+	new_mut_arr = malloc(sizeof(wbk_kbtable_mut_t *) * (kbtable->mut_arr_len + mut_arr_len));
+	new_mut_arr_len = kbtable->mut_arr_len;
+	if (new_mut_arr_len > 0) {
+		memcpy(new_mut_arr, kbtable->mut_arr, sizeof(wbk_kbtable_mut_t *) * new_mut_arr_len);
+	}
+
+	replaced_arr = malloc(sizeof(wbk_kbtable_mut_t *) * (mut_arr_len + 1));
+	replaced_arr_len = 0;
+
+	for (i = 0; i < mut_arr_len; i++) {
+		pos = wbk_kbtable_mut_find(new_mut_arr, new_mut_arr_len, mut_arr[i]);
+		if (pos >= 0) {
+			replaced_arr[replaced_arr_len++] = new_mut_arr[pos];
+			new_mut_arr[pos] = mut_arr[i];
+		} else {
+			new_mut_arr[new_mut_arr_len++] = mut_arr[i];
+		}
+	}
+
+	kbman = wbk_kbtable_build(kbtable, new_mut_arr, new_mut_arr_len);
+	if (kbman == NULL) {
+		wbk_logger_log(&logger, SEVERE, "Could not apply %d changes to %s, discarding them\n",
+		               mut_arr_len, wbk_parser_get_filename(kbtable->parser));
+		error = 1;
+	}
+
+	if (!error) {
+		wbk_kbtable_swap(kbtable, kbman);
+
+		for (i = 0; i < replaced_arr_len; i++) {
+			wbk_kbtable_mut_free(replaced_arr[i]);
+		}
+		free(kbtable->mut_arr);
+		kbtable->mut_arr = new_mut_arr;
+		kbtable->mut_arr_len = new_mut_arr_len;
+
+		wbk_logger_log(&logger, INFO, "Applied %d changes\n", mut_arr_len);
+	} else {
+		for (i = 0; i < mut_arr_len; i++) {
+			wbk_kbtable_mut_free(mut_arr[i]);
+		}
+		free(new_mut_arr);
+	}
+	free(replaced_arr);
+
+	wbk_kbtable_mutex_unlock(kbtable);
+
+	return error;
+}
+
+int
+wbk_kbtable_switch_mode(wbk_kbtable_t *kbtable, const char *mode)
+{
+	wbk_kbtable_gen_t *gen;
+	int error;
+
+	error = 1;
+
+	__atomic_add_fetch(&(kbtable->readers), 1, __ATOMIC_SEQ_CST);
+
+	gen = __atomic_load_n(&(kbtable->live), __ATOMIC_SEQ_CST);
+	if (gen) {
+		error = wbk_kbman_switch_mode(gen->kbman, mode);
+	}
+
+	__atomic_sub_fetch(&(kbtable->readers), 1, __ATOMIC_SEQ_CST);
+
+	return error;
+}
+
+const wbk_kbman_t *
+wbk_kbtable_lock(wbk_kbtable_t *kbtable)
+{
+	wbk_kbtable_mutex_lock(kbtable);
+
+	return kbtable->live ? kbtable->live->kbman : NULL;
+}
+
+int
+wbk_kbtable_unlock(wbk_kbtable_t *kbtable)
+{
+	wbk_kbtable_mutex_unlock(kbtable);
+	return 0;
+}
+
+int
+wbk_kbtable_get_stats(wbk_kbtable_t *kbtable, wbk_kbtable_stats_t *stats)
+{
+	wbk_kbtable_gen_t *gen;
+
+	wbk_kbtable_mutex_lock(kbtable);
+
+	stats->generation = kbtable->generation;
+	stats->exec_count = __atomic_load_n(&(kbtable->exec_count), __ATOMIC_RELAXED);
+	stats->hit_count = __atomic_load_n(&(kbtable->hit_count), __ATOMIC_RELAXED);
+	stats->mut_count = kbtable->mut_arr_len;
+
+	stats->retired_count = 0;
+	for (gen = kbtable->retired; gen; gen = gen->next) {
+		stats->retired_count++;
+	}
+
+	wbk_kbtable_mutex_unlock(kbtable);
+
+	return 0;
+}
+
+int
+wbk_kbtable_reclaim(wbk_kbtable_t *kbtable)
+{
+	wbk_kbtable_gen_t **gen_ptr;
+	wbk_kbtable_gen_t *gen;
+	unsigned long now;
+	int pending;
+
+	pending = 0;
+
+	wbk_kbtable_mutex_lock(kbtable);
+
+	now = wbk_kbtable_now();
+	gen_ptr = &(kbtable->retired);
+	while (*gen_ptr) {
+		gen = *gen_ptr;
+
+		/**
+		 * A retired generation is not reachable by wbk_kbtable_exec() calls
+		 * starting after the swap. Once no call runs, none can still use it.
+		 */
+		if (now - gen->retired_at >= kbtable->grace_period
+		    && __atomic_load_n(&(kbtable->readers), __ATOMIC_SEQ_CST) == 0) {
+			*gen_ptr = gen->next;
+			wbk_kbtable_gen_free(gen, kbtable->kbman_arr_len);
+		} else {
+			gen_ptr = &(gen->next);
+			pending++;
+		}
+	}
+
+	wbk_kbtable_mutex_unlock(kbtable);
+
+	return pending;
+}
+
+int
+wbk_kbtable_exec(wbk_kbtable_t *kbtable, int i, wbk_b_t *b)
+{
+	wbk_kbtable_gen_t *gen;
+	int error;
+
+	error = 1;
+
+	__atomic_add_fetch(&(kbtable->readers), 1, __ATOMIC_SEQ_CST);
+
+	gen = __atomic_load_n(&(kbtable->live), __ATOMIC_SEQ_CST);
+	if (gen && i >= 0 && i < kbtable->kbman_arr_len) {
+		error = wbk_kbman_exec(gen->kbman_arr[i], b);
+	}
+
+	/**
+	 * Statistics only, thus no ordering is needed
+	 */
+	__atomic_add_fetch(&(kbtable->exec_count), 1, __ATOMIC_RELAXED);
+	if (!error) {
+		__atomic_add_fetch(&(kbtable->hit_count), 1, __ATOMIC_RELAXED);
+	}
+
+	__atomic_sub_fetch(&(kbtable->readers), 1, __ATOMIC_SEQ_CST);
+
+	return error;
+}
+
+int
+wbk_kbtable_set_grace_period(wbk_kbtable_t *kbtable, unsigned long grace_period)
+{
+	kbtable->grace_period = grace_period;
+	return 0;
+}
+
+#if defined(WIN32)
+DWORD WINAPI
+wbk_kbtable_thread(LPVOID param)
+#else
+void *
+wbk_kbtable_thread(void *param)
+#endif
+{
+	wbk_kbtable_t *kbtable;
+	int requested;
+
+	kbtable = (wbk_kbtable_t *) param;
+
+	while (__atomic_load_n(&(kbtable->running), __ATOMIC_SEQ_CST)) {
+		requested = wbk_kbtable_wait_reload(kbtable, WBK_KBTABLE_RECLAIM_INTERVAL);
+
+		if (requested && __atomic_load_n(&(kbtable->running), __ATOMIC_SEQ_CST)) {
+			wbk_kbtable_load(kbtable);
+		}
+
+		wbk_kbtable_reclaim(kbtable);
+	}
+
+	return 0;
+}
+
+void
+wbk_kbtable_mutex_lock(wbk_kbtable_t *kbtable)
+{
+#if defined(WIN32)
+	WaitForSingleObject(kbtable->mutex, INFINITE);
+#else
+	pthread_mutex_lock(&(kbtable->mutex));
+#endif
+}
+
+void
+wbk_kbtable_mutex_unlock(wbk_kbtable_t *kbtable)
+{
+#if defined(WIN32)
+	ReleaseMutex(kbtable->mutex);
+#else
+	pthread_mutex_unlock(&(kbtable->mutex));
+#endif
+}
+
+int
+wbk_kbtable_wait_reload(wbk_kbtable_t *kbtable, int timeout)
+{
+	int requested;
+
+#if defined(WIN32)
+	requested = WaitForSingleObject(kbtable->reload_event, timeout) == WAIT_OBJECT_0;
+#else
+	struct timespec deadline;
+	int result;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout / 1000;
+	deadline.tv_nsec += (timeout % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&(kbtable->mutex));
+
+	result = 0;
+	while (!kbtable->reload_requested && result != ETIMEDOUT) {
+		result = pthread_cond_timedwait(&(kbtable->reload_cond), &(kbtable->mutex), &deadline);
+	}
+
+	/**
+	 * Like an auto reset event
+	 */
+	requested = kbtable->reload_requested;
+	kbtable->reload_requested = 0;
+
+	pthread_mutex_unlock(&(kbtable->mutex));
+#endif
+
+	return requested;
+}
+
+unsigned long
+wbk_kbtable_now(void)
+{
+#if defined(WIN32)
+	return GetTickCount();
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000UL + now.tv_nsec / 1000000L;
+#endif
+}
+
+int
+wbk_kbtable_swap(wbk_kbtable_t *kbtable, wbk_kbman_t *kbman)
+{
+	wbk_kbtable_gen_t *gen;
+	wbk_kbtable_gen_t *old;
+
+	old = kbtable->live;
+	if (old) {
+		/**
+		 * Falls back to the default mode if the active mode was removed
+		 */
+		wbk_kbman_switch_mode(kbman, wbk_kbman_get_mode(old->kbman));
+
+		/**
+		 * Unchanged commands keep counting their running processes
+		 */
+		wbk_kbman_adopt(kbman, old->kbman);
+	}
+
+	gen = wbk_kbtable_gen_new(kbman, kbtable->kbman_arr_len);
+
+	old = __atomic_exchange_n(&(kbtable->live), gen, __ATOMIC_SEQ_CST);
+	kbtable->generation++;
+	if (old) {
+		old->retired_at = wbk_kbtable_now();
+		old->next = kbtable->retired;
+		kbtable->retired = old;
+	}
+
+	return 0;
+}
+
+wbk_kbman_t *
+wbk_kbtable_build(wbk_kbtable_t *kbtable, wbk_kbtable_mut_t **mut_arr, int mut_arr_len)
+{
+	wbk_kbman_t *kbman;
+	wbk_kc_t *kc;
+	char *cmd;
+	char *binding;
+	int i;
+
+	kbman = wbk_parser_parse(kbtable->parser);
+
+	for (i = 0; kbman && i < mut_arr_len; i++) {
+		wbk_kbman_remove(kbman, mut_arr[i]->mode, mut_arr[i]->binding);
+
+		if (mut_arr[i]->cmd) {
+			wbk_kbman_add_mode(kbman, mut_arr[i]->mode);
+
+			cmd = malloc(sizeof(char) * (strlen(mut_arr[i]->cmd) + 1));
+			strcpy(cmd, mut_arr[i]->cmd);
+
+			kc = wbk_parser_parse_kc(kbman, wbk_b_clone(mut_arr[i]->binding), cmd);
+			if (kc) {
+				wbk_kbman_add_to_mode(kbman, mut_arr[i]->mode, kc);
+			} else {
+				/**
+				 * Either all changes are applied or none
+				 */
+				binding = wbk_b_to_str(mut_arr[i]->binding);
+				wbk_logger_log(&logger, SEVERE, "Could not apply the change of %s in mode %s\n",
+				               binding, mut_arr[i]->mode);
+				free(binding);
+
+				wbk_kbman_free(kbman);
+				kbman = NULL;
+			}
+		}
+	}
+
+	return kbman;
+}
+
+int
+wbk_kbtable_mut_find(wbk_kbtable_mut_t **mut_arr, int mut_arr_len, const wbk_kbtable_mut_t *mut)
+{
+	int pos;
+	int i;
+
+	pos = -1;
+	for (i = 0; pos < 0 && i < mut_arr_len; i++) {
+		if (strcmp(mut_arr[i]->mode, mut->mode) == 0
+		    && wbk_b_compare(mut_arr[i]->binding, mut->binding) == 0) {
+			pos = i;
+		}
+	}
+
+	return pos;
+}
+
+wbk_kbtable_mut_t *
+wbk_kbtable_mut_new(const char *mode, wbk_b_t *binding, const char *cmd)
+{
+	wbk_kbtable_mut_t *mut;
+
+	mut = NULL;
+	mut = malloc(sizeof(wbk_kbtable_mut_t));
+
+	if (mut) {
+		mut->mode = malloc(sizeof(char) * (strlen(mode) + 1));
+		strcpy(mut->mode, mode);
+
+		mut->binding = binding;
+
+		mut->cmd = NULL;
+		if (cmd) {
+			mut->cmd = malloc(sizeof(char) * (strlen(cmd) + 1));
+			strcpy(mut->cmd, cmd);
+		}
+	}
+
+	return mut;
+}
+
+int
+wbk_kbtable_mut_free(wbk_kbtable_mut_t *mut)
+{
+	free(mut->mode);
+	mut->mode = NULL;
+
+	wbk_b_free(mut->binding);
+	mut->binding = NULL;
+
+	free(mut->cmd);
+	mut->cmd = NULL;
+
+	free(mut);
+
+	return 0;
+}
+
+wbk_kbtable_gen_t *
+wbk_kbtable_gen_new(wbk_kbman_t *kbman, int kbman_arr_len)
+{
+	wbk_kbtable_gen_t *gen;
+	int i;
+
+	gen = NULL;
+	gen = malloc(sizeof(wbk_kbtable_gen_t));
+
+	if (gen) {
+		gen->kbman = kbman;
+		gen->kbman_arr = wbk_kbman_split(kbman, kbman_arr_len);
+		gen->retired_at = 0;
+		gen->next = NULL;
+
+		/**
+		 * A generation never changes, thus its lookups can use perfect hashes
+		 */
+		for (i = 0; i < kbman_arr_len; i++) {
+			wbk_kbman_compile(gen->kbman_arr[i]);
+		}
+	}
+
+	return gen;
+}
+
+int
+wbk_kbtable_gen_free(wbk_kbtable_gen_t *gen, int kbman_arr_len)
+{
+	int i;
+
+	/**
+	 * The split key board managers share the active mode of kbman
+	 */
+	for (i = 0; i < kbman_arr_len; i++) {
+		wbk_kbman_free(gen->kbman_arr[i]);
+		gen->kbman_arr[i] = NULL;
+	}
+	free(gen->kbman_arr);
+	gen->kbman_arr = NULL;
+
+	wbk_kbman_free(gen->kbman);
+	gen->kbman = NULL;
+
+	free(gen);
+
+	return 0;
+}
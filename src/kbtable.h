@@ -0,0 +1,286 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the key board table class definition
+ *
+ * A key board table holds the parsed key board manager together with its
+ * split key board managers (see wbk_kbman_split()) as one generation. The
+ * keyboard daemons execute key bindings of the live generation only. A reload
+ * parses the rc file again and replaces the live generation by a single
+ * atomic pointer swap. Hence executing key bindings never waits for a reload.
+ *
+ * Key bindings can be added and removed at runtime (see wbk_kbtable_mutate()).
+ * Those runtime changes are applied on top of the rc file, thus they survive
+ * reloads.
+ *
+ * Replaced generations are retired. They are freed after a grace period and
+ * only while no key binding is executed, because executed key binding
+ * commands may still use them.
+ */
+
+#ifndef WBK_KBTABLE_H
+#define WBK_KBTABLE_H
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "kbman.h"
+#include "parser.h"
+
+/**
+ * Milliseconds a retired generation is kept at least.
+ */
+#define WBK_KBTABLE_GRACE_PERIOD 5000
+
+/**
+ * Milliseconds between two tries to free retired generations.
+ */
+#define WBK_KBTABLE_RECLAIM_INTERVAL 1000
+
+typedef struct wbk_kbtable_gen_s wbk_kbtable_gen_t;
+
+struct wbk_kbtable_gen_s
+{
+	wbk_kbman_t *kbman;
+	wbk_kbman_t **kbman_arr;
+
+	/**
+	 * Milliseconds of a monotonic clock at the time the generation was
+	 * replaced.
+	 */
+	unsigned long retired_at;
+	wbk_kbtable_gen_t *next;
+};
+
+/**
+ * A runtime change of a key binding.
+ */
+typedef struct wbk_kbtable_mut_s
+{
+	char *mode;
+	wbk_b_t *binding;
+
+	/**
+	 * The command in the rc file notation or NULL to remove the binding.
+	 */
+	char *cmd;
+} wbk_kbtable_mut_t;
+
+typedef struct wbk_kbtable_stats_s
+{
+	/**
+	 * Number of published generations.
+	 */
+	int generation;
+
+	/**
+	 * Number of executed combinations and how many of them matched a key
+	 * binding.
+	 */
+	long exec_count;
+	long hit_count;
+
+	int retired_count;
+	int mut_count;
+} wbk_kbtable_stats_t;
+
+typedef struct wbk_kbtable_s
+{
+	/**
+	 * Not owned by the key board table.
+	 */
+	wbk_parser_t *parser;
+
+	int kbman_arr_len;
+	unsigned long grace_period;
+
+	/**
+	 * Accessed atomically only.
+	 */
+	wbk_kbtable_gen_t *live;
+
+	/**
+	 * Number of currently running wbk_kbtable_exec() calls. Accessed
+	 * atomically only.
+	 */
+	int readers;
+
+	/**
+	 * Retired generations, the newest first. Guarded by mutex.
+	 */
+	wbk_kbtable_gen_t *retired;
+
+	/**
+	 * Runtime changes applied on top of the rc file. Each binding of a mode
+	 * occurs at most once. Guarded by mutex.
+	 */
+	int mut_arr_len;
+	wbk_kbtable_mut_t **mut_arr;
+
+	int generation;
+
+	/**
+	 * Accessed atomically only.
+	 */
+	long exec_count;
+	long hit_count;
+
+	int running;
+
+#if defined(WIN32)
+	/**
+	 * Serializes loading, publishing and reclaiming.
+	 */
+	HANDLE mutex;
+
+	HANDLE reload_event;
+	HANDLE thread;
+#else
+	pthread_mutex_t mutex;
+
+	/**
+	 * Signals reload_requested. Guarded by mutex.
+	 */
+	pthread_cond_t reload_cond;
+	int reload_requested;
+	pthread_t thread;
+#endif
+} wbk_kbtable_t;
+
+/**
+ * @brief Creates a new key board table without a live generation and starts
+ * its reload thread.
+ * @param parser The parser used to (re)load the rc file. It must outlive the key board table.
+ * @param kbman_arr_len Number of split key board managers per generation
+ */
+extern wbk_kbtable_t *
+wbk_kbtable_new(wbk_parser_t *parser, int kbman_arr_len);
+
+/**
+ * @brief Stops the reload thread and frees all generations. No key binding may
+ * be executed anymore.
+ */
+extern int
+wbk_kbtable_free(wbk_kbtable_t *kbtable);
+
+/**
+ * @brief Parses the rc file and publishes it as the new live generation if it
+ * differs from the live one. The live generation is kept if parsing fails.
+ * @return 0 if the rc file was parsed. Non-0 otherwise.
+ */
+extern int
+wbk_kbtable_load(wbk_kbtable_t *kbtable);
+
+/**
+ * @brief Switches the parser to another rc file and publishes it as the new
+ * live generation. The parser and the live generation are kept if parsing
+ * fails.
+ * @return 0 if the rc file was parsed. Non-0 otherwise.
+ */
+extern int
+wbk_kbtable_load_file(wbk_kbtable_t *kbtable, const char *filename);
+
+/**
+ * @brief Requests wbk_kbtable_load() on the reload thread. Returns
+ * immediately. Requests arriving while a reload is pending are merged.
+ */
+extern int
+wbk_kbtable_reload(wbk_kbtable_t *kbtable);
+
+/**
+ * @brief Publishes a key board manager as the new live generation. The active
+ * mode is kept if the new key board manager contains it.
+ * @param kbman The key board manager will be freed by the key board table.
+ */
+extern int
+wbk_kbtable_publish(wbk_kbtable_t *kbtable, wbk_kbman_t *kbman);
+
+/**
+ * @brief Applies runtime changes of key bindings as a single new generation.
+ * Either all changes are applied or none.
+ * @param mut_arr The changes will be freed by the key board table. The array itself not.
+ * @return 0 if the changes were applied. Non-0 otherwise.
+ */
+extern int
+wbk_kbtable_mutate(wbk_kbtable_t *kbtable, wbk_kbtable_mut_t **mut_arr, int mut_arr_len);
+
+/**
+ * @brief Switches the active mode of the live generation.
+ * @return 0 if the mode was switched. Non-0 if the mode does not exist.
+ */
+extern int
+wbk_kbtable_switch_mode(wbk_kbtable_t *kbtable, const char *mode);
+
+/**
+ * @brief Locks the key board table against reloads and changes.
+ * @return The key board manager of the live generation or NULL. Do not modify it.
+ */
+extern const wbk_kbman_t *
+wbk_kbtable_lock(wbk_kbtable_t *kbtable);
+
+extern int
+wbk_kbtable_unlock(wbk_kbtable_t *kbtable);
+
+extern int
+wbk_kbtable_get_stats(wbk_kbtable_t *kbtable, wbk_kbtable_stats_t *stats);
+
+/**
+ * @brief Frees the retired generations, whose grace period passed.
+ * @return The number of retired generations not freed yet.
+ */
+extern int
+wbk_kbtable_reclaim(wbk_kbtable_t *kbtable);
+
+/**
+ * @brief Execute a key binding matching a combination with the i-th split key
+ * board manager of the live generation. Never blocks.
+ * @return Non-0 if the combination was not found.
+ */
+extern int
+wbk_kbtable_exec(wbk_kbtable_t *kbtable, int i, wbk_b_t *b);
+
+/**
+ * @brief Sets the grace period of retired generations in milliseconds.
+ */
+extern int
+wbk_kbtable_set_grace_period(wbk_kbtable_t *kbtable, unsigned long grace_period);
+
+/**
+ * @param mode The name of the mode. It is copied.
+ * @param binding The binding will be freed by the change.
+ * @param cmd The command in the rc file notation or NULL to remove the binding. It is copied.
+ */
+extern wbk_kbtable_mut_t *
+wbk_kbtable_mut_new(const char *mode, wbk_b_t *binding, const char *cmd);
+
+extern int
+wbk_kbtable_mut_free(wbk_kbtable_mut_t *mut);
+
+#endif // WBK_KBTABLE_H
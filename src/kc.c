@@ -31,9 +31,9 @@
 #include "kc.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
-#include <windows.h>
 
 #include "logger.h"
 
@@ -60,9 +60,36 @@ wbk_kc_get_binding_impl(const wbk_kc_t *kc);
 static int
 wbk_kc_exec_impl(const wbk_kc_t *kc);
 
+/**
+ * Implementation of wbk_kc_exec_key().
+ */
+static int
+wbk_kc_exec_key_impl(const wbk_kc_t *kc, char key);
+
+/**
+ * Implementation of wbk_kc_exec_end().
+ */
+static int
+wbk_kc_exec_end_impl(const wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_adopt().
+ */
+static int
+wbk_kc_adopt_impl(wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_compare().
+ */
+static int
+wbk_kc_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_to_str().
+ */
+static char *
+wbk_kc_to_str_impl(const wbk_kc_t *kc);
 
-static DWORD WINAPI
-wbk_kbthread_exec(LPVOID param);
 
 wbk_kc_t *
 wbk_kc_new(wbk_b_t *comb)
@@ -78,6 +105,11 @@ wbk_kc_new(wbk_b_t *comb)
   kc->kc_free = wbk_kc_free_impl;
   kc->kc_get_binding = wbk_kc_get_binding_impl;
   kc->kc_exec = wbk_kc_exec_impl;
+  kc->kc_exec_key = wbk_kc_exec_key_impl;
+  kc->kc_exec_end = wbk_kc_exec_end_impl;
+  kc->kc_adopt = wbk_kc_adopt_impl;
+  kc->kc_compare = wbk_kc_compare_impl;
+  kc->kc_to_str = wbk_kc_to_str_impl;
 
 	if (kc != NULL) {
 		kc->binding = comb;
@@ -110,6 +142,36 @@ wbk_kc_exec(const wbk_kc_t *kc)
   return kc->kc_exec(kc);
 }
 
+int
+wbk_kc_exec_key(const wbk_kc_t *kc, char key)
+{
+  return kc->kc_exec_key(kc, key);
+}
+
+int
+wbk_kc_exec_end(const wbk_kc_t *kc)
+{
+  return kc->kc_exec_end(kc);
+}
+
+int
+wbk_kc_adopt(wbk_kc_t *kc, const wbk_kc_t *other)
+{
+  return kc->kc_adopt(kc, other);
+}
+
+int
+wbk_kc_compare(const wbk_kc_t *kc, const wbk_kc_t *other)
+{
+  return kc->kc_compare(kc, other);
+}
+
+char *
+wbk_kc_to_str(const wbk_kc_t *kc)
+{
+  return kc->kc_to_str(kc);
+}
+
 wbk_kc_t *
 wbk_kc_clone_impl(const wbk_kc_t *other)
 {
@@ -148,3 +210,42 @@ wbk_kc_exec_impl(const wbk_kc_t *kc)
 {
 	return 1;
 }
+
+int
+wbk_kc_exec_key_impl(const wbk_kc_t *kc, char key)
+{
+	return wbk_kc_exec(kc);
+}
+
+int
+wbk_kc_exec_end_impl(const wbk_kc_t *kc)
+{
+	return 0;
+}
+
+int
+wbk_kc_adopt_impl(wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	return 0;
+}
+
+int
+wbk_kc_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	/**
+	 * Key binding commands of the same class share their implementations
+	 */
+	return kc->kc_exec != other->kc_exec
+		   || wbk_b_compare(wbk_kc_get_binding(kc), wbk_kc_get_binding(other));
+}
+
+char *
+wbk_kc_to_str_impl(const wbk_kc_t *kc)
+{
+	char *str;
+
+	str = malloc(sizeof(char) * 3);
+	strcpy(str, "\"\"");
+
+	return str;
+}
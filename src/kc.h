@@ -41,6 +41,11 @@ struct wbk_kc_s
   int (*kc_free)(wbk_kc_t *kc);
   const wbk_b_t *(*kc_get_binding)(const wbk_kc_t *kc);
   int (*kc_exec)(const wbk_kc_t *kc);
+  int (*kc_exec_key)(const wbk_kc_t *kc, char key);
+  int (*kc_exec_end)(const wbk_kc_t *kc);
+  int (*kc_adopt)(wbk_kc_t *kc, const wbk_kc_t *other);
+  int (*kc_compare)(const wbk_kc_t *kc, const wbk_kc_t *other);
+  char *(*kc_to_str)(const wbk_kc_t *kc);
 
 	wbk_b_t *binding;
 };
@@ -81,4 +86,47 @@ wbk_kc_get_binding(const wbk_kc_t *kc);
 extern int
 wbk_kc_exec(const wbk_kc_t *kc);
 
+/**
+ * @brief Execute the command of a key binding command for a pressed key. Key
+ * range bindings (e.g. Mod4+[1-9]) pass the key which matched the range.
+ * Commands which do not depend on the key execute as by wbk_kc_exec().
+ * @return Non-0 if the execution failed
+ */
+extern int
+wbk_kc_exec_key(const wbk_kc_t *kc, char key);
+
+/**
+ * @brief Ends the command of a Hold binding once its combination is released.
+ * Commands which act once when executed have nothing to end.
+ * @return Non-0 if the ending failed
+ */
+extern int
+wbk_kc_exec_end(const wbk_kc_t *kc);
+
+/**
+ * @brief Takes over the state of an equal key binding command (see
+ * wbk_kc_compare()) of the previous generation of key bindings, e.g. the
+ * processes counted by its concurrency limit. Call it before the key binding
+ * command is executed for the first time. Commands without state do nothing.
+ * @return Non-0 if the state could not be taken over
+ */
+extern int
+wbk_kc_adopt(wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * @brief Compares two key binding commands. Key binding commands are equal if
+ * they are of the same class, have the same binding and do the same.
+ * @return 0 if both key binding commands are equal. Non-0 otherwise.
+ */
+extern int
+wbk_kc_compare(const wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * @brief Creates the rc file notation of the command of a key binding command
+ * (e.g. "notepad.exe").
+ * @return A new string. Free it by yourself!
+ */
+extern char *
+wbk_kc_to_str(const wbk_kc_t *kc);
+
 #endif // WBK_KB_H
@@ -0,0 +1,419 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the built-in action command class implementation and private methods
+ */
+
+#include "kc_builtin.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+#if !defined(WIN32)
+#include "launcher.h"
+#endif
+
+static wbk_logger_t logger =  { "kc_builtin" };
+
+/**
+ * Writes the rest of the argument as a line to the file named by its first
+ * word.
+ */
+static int
+wbk_builtin_write_fn(const char *arg, void *param);
+
+/**
+ * Sets an environment variable. The argument is NAME=value. An empty value
+ * removes the variable.
+ */
+static int
+wbk_builtin_setenv_fn(const char *arg, void *param);
+
+static wbk_builtin_t g_builtin_arr[WBK_BUILTIN_ARR_LEN] = {
+	{ "write", wbk_builtin_write_fn, NULL },
+	{ "setenv", wbk_builtin_setenv_fn, NULL }
+};
+
+static int g_builtin_arr_len = 2;
+
+/**
+ * Implementation of wbk_kc_clone().
+ *
+ * The clone runs the same action on the same executor.
+ */
+static wbk_kc_t *
+wbk_kc_builtin_clone_impl(const wbk_kc_t *super_other);
+
+/**
+ * Implementation of wbk_kc_free().
+ *
+ * A pending action is cancelled.
+ */
+static int
+wbk_kc_builtin_free_impl(wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_builtin_get_name().
+ */
+static const char *
+wbk_kc_builtin_get_name_impl(const wbk_kc_builtin_t *kc_builtin);
+
+/**
+ * Implementation of wbk_kc_builtin_get_arg().
+ */
+static const char *
+wbk_kc_builtin_get_arg_impl(const wbk_kc_builtin_t *kc_builtin);
+
+/**
+ * Implementation of wbk_kc_exec().
+ *
+ * @brief Submits the action to the executor
+ * @return Non-0 if the action failed. Only known without an executor.
+ */
+static int
+wbk_kc_builtin_exec_impl(const wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_compare().
+ *
+ * Built-in action commands are equal if they run the same action with the
+ * same argument.
+ */
+static int
+wbk_kc_builtin_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_to_str().
+ */
+static char *
+wbk_kc_builtin_to_str_impl(const wbk_kc_t *kc);
+
+/**
+ * Job of a pending action
+ */
+static long
+wbk_kc_builtin_job_fn(wbk_job_t *job, void *param);
+
+static int
+wbk_kc_builtin_run(const wbk_kc_builtin_t *kc_builtin);
+
+int
+wbk_builtin_register(const char *name, int (*builtin_fn)(const char *arg, void *param),
+                     void *param)
+{
+	wbk_builtin_t *builtin;
+	int error;
+
+	error = 0;
+	builtin = (wbk_builtin_t *) wbk_builtin_find(name, strlen(name));
+	if (builtin == NULL) {
+		if (g_builtin_arr_len < WBK_BUILTIN_ARR_LEN) {
+			builtin = &(g_builtin_arr[g_builtin_arr_len++]);
+			builtin->name = name;
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Too many built-in actions: %s\n", name);
+			error = 1;
+		}
+	}
+
+	if (builtin) {
+		builtin->builtin_fn = builtin_fn;
+		builtin->param = param;
+	}
+
+	return error;
+}
+
+const wbk_builtin_t *
+wbk_builtin_find(const char *name, int name_len)
+{
+	const wbk_builtin_t *builtin;
+	int i;
+
+	builtin = NULL;
+	for (i = 0; builtin == NULL && i < g_builtin_arr_len; i++) {
+		if (strncmp(g_builtin_arr[i].name, name, name_len) == 0
+		    && g_builtin_arr[i].name[name_len] == '\0') {
+			builtin = &(g_builtin_arr[i]);
+		}
+	}
+
+	return builtin;
+}
+
+wbk_kc_builtin_t *
+wbk_kc_builtin_new(wbk_b_t *comb, const wbk_builtin_t *builtin, char *arg,
+                   wbk_executor_t *executor)
+{
+	wbk_kc_t *kc;
+	wbk_kc_builtin_t *kc_builtin;
+
+	kc_builtin = NULL;
+	kc_builtin = malloc(sizeof(wbk_kc_builtin_t));
+
+	if (kc_builtin) {
+		memset(kc_builtin, 0, sizeof(wbk_kc_builtin_t));
+
+		kc = wbk_kc_new(comb);
+		memcpy(kc_builtin, kc, sizeof(wbk_kc_t));
+		free(kc); /* Just free the top level element */
+
+		kc_builtin->super_kc_clone = kc_builtin->kc.kc_clone;
+		kc_builtin->super_kc_free = kc_builtin->kc.kc_free;
+		kc_builtin->super_kc_exec = kc_builtin->kc.kc_exec;
+		kc_builtin->super_kc_compare = kc_builtin->kc.kc_compare;
+		kc_builtin->super_kc_to_str = kc_builtin->kc.kc_to_str;
+
+		kc_builtin->kc.kc_clone = wbk_kc_builtin_clone_impl;
+		kc_builtin->kc.kc_free = wbk_kc_builtin_free_impl;
+		kc_builtin->kc.kc_exec = wbk_kc_builtin_exec_impl;
+		kc_builtin->kc.kc_compare = wbk_kc_builtin_compare_impl;
+		kc_builtin->kc.kc_to_str = wbk_kc_builtin_to_str_impl;
+		kc_builtin->kc_builtin_get_name = wbk_kc_builtin_get_name_impl;
+		kc_builtin->kc_builtin_get_arg = wbk_kc_builtin_get_arg_impl;
+
+		kc_builtin->builtin = builtin;
+		kc_builtin->arg = arg;
+		kc_builtin->executor = executor;
+
+		kc_builtin->job = malloc(sizeof(wbk_job_t));
+		wbk_job_init(kc_builtin->job, wbk_kc_builtin_job_fn, kc_builtin);
+	}
+
+	return kc_builtin;
+}
+
+const char *
+wbk_kc_builtin_get_name(const wbk_kc_builtin_t *kc_builtin)
+{
+	return kc_builtin->kc_builtin_get_name(kc_builtin);
+}
+
+const char *
+wbk_kc_builtin_get_arg(const wbk_kc_builtin_t *kc_builtin)
+{
+	return kc_builtin->kc_builtin_get_arg(kc_builtin);
+}
+
+wbk_kc_t *
+wbk_kc_builtin_clone_impl(const wbk_kc_t *super_other)
+{
+	const wbk_kc_builtin_t *other;
+	char *arg;
+	wbk_kc_builtin_t *kc_builtin;
+
+	other = (const wbk_kc_builtin_t *) super_other;
+
+	kc_builtin = NULL;
+	if (other) {
+		arg = malloc(sizeof(char) * (strlen(other->arg) + 1));
+		strcpy(arg, other->arg);
+
+		kc_builtin = wbk_kc_builtin_new(wbk_b_clone(wbk_kc_get_binding((wbk_kc_t *) other)),
+		                                other->builtin, arg, other->executor);
+	}
+
+	return (wbk_kc_t *) kc_builtin;
+}
+
+int
+wbk_kc_builtin_free_impl(wbk_kc_t *kc)
+{
+	wbk_kc_builtin_t *kc_builtin;
+
+	kc_builtin = (wbk_kc_builtin_t *) kc;
+
+	if (kc_builtin->executor) {
+		wbk_executor_cancel(kc_builtin->executor, kc_builtin->job);
+	}
+	free(kc_builtin->job);
+	kc_builtin->job = NULL;
+
+	free(kc_builtin->arg);
+	kc_builtin->arg = NULL;
+	kc_builtin->builtin = NULL;
+
+	return kc_builtin->super_kc_free(kc);
+}
+
+const char *
+wbk_kc_builtin_get_name_impl(const wbk_kc_builtin_t *kc_builtin)
+{
+	return kc_builtin->builtin->name;
+}
+
+const char *
+wbk_kc_builtin_get_arg_impl(const wbk_kc_builtin_t *kc_builtin)
+{
+	return kc_builtin->arg;
+}
+
+int
+wbk_kc_builtin_exec_impl(const wbk_kc_t *kc)
+{
+	const wbk_kc_builtin_t *kc_builtin;
+	int error;
+
+	kc_builtin = (const wbk_kc_builtin_t *) kc;
+
+	error = 0;
+	if (kc_builtin->executor == NULL) {
+		error = wbk_kc_builtin_run(kc_builtin);
+	} else if (wbk_executor_submit(kc_builtin->executor, kc_builtin->job)) {
+		wbk_logger_log(&logger, INFO, "Action is still pending: @%s\n",
+		               kc_builtin->builtin->name);
+	}
+
+	return error;
+}
+
+int
+wbk_kc_builtin_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	const wbk_kc_builtin_t *kc_builtin;
+	const wbk_kc_builtin_t *other_builtin;
+
+	kc_builtin = (const wbk_kc_builtin_t *) kc;
+	other_builtin = (const wbk_kc_builtin_t *) other;
+
+	return kc_builtin->super_kc_compare(kc, other)
+		   || strcmp(wbk_kc_builtin_get_name(kc_builtin),
+		             wbk_kc_builtin_get_name(other_builtin))
+		   || strcmp(wbk_kc_builtin_get_arg(kc_builtin),
+		             wbk_kc_builtin_get_arg(other_builtin));
+}
+
+char *
+wbk_kc_builtin_to_str_impl(const wbk_kc_t *kc)
+{
+	const char *name;
+	const char *arg;
+	char *str;
+
+	name = wbk_kc_builtin_get_name((const wbk_kc_builtin_t *) kc);
+	arg = wbk_kc_builtin_get_arg((const wbk_kc_builtin_t *) kc);
+	str = malloc(sizeof(char) * (strlen(name) + strlen(arg) + 5));
+	if (arg[0] == '\0') {
+		sprintf(str, "\"@%s\"", name);
+	} else {
+		sprintf(str, "\"@%s %s\"", name, arg);
+	}
+
+	return str;
+}
+
+long
+wbk_kc_builtin_job_fn(wbk_job_t *job, void *param)
+{
+	wbk_kc_builtin_run((const wbk_kc_builtin_t *) param);
+
+	return -1;
+}
+
+int
+wbk_kc_builtin_run(const wbk_kc_builtin_t *kc_builtin)
+{
+	int error;
+
+	error = kc_builtin->builtin->builtin_fn(kc_builtin->arg, kc_builtin->builtin->param);
+	if (error) {
+		wbk_logger_log(&logger, WARNING, "Action failed: @%s %s\n",
+		               kc_builtin->builtin->name, kc_builtin->arg);
+	}
+
+	return error;
+}
+
+int
+wbk_builtin_write_fn(const char *arg, void *param)
+{
+	char *filename;
+	const char *line;
+	int length;
+	FILE *file;
+	int error;
+
+	length = strcspn(arg, " \t");
+	line = arg + length;
+	line += strspn(line, " \t");
+
+	filename = malloc(sizeof(char) * (length + 1));
+	memcpy(filename, arg, sizeof(char) * length);
+	filename[length] = '\0';
+
+	error = 0;
+	file = length > 0 ? fopen(filename, "w") : NULL;
+	if (file) {
+		error = fprintf(file, "%s\n", line) < 0;
+		error = fclose(file) || error;
+	} else {
+		wbk_logger_log(&logger, WARNING, "Cannot open %s\n", filename);
+		error = 1;
+	}
+
+	free(filename);
+
+	return error;
+}
+
+int
+wbk_builtin_setenv_fn(const char *arg, void *param)
+{
+	const char *value;
+	char *name;
+	int error;
+
+	value = strchr(arg, '=');
+	if (value && value != arg) {
+		name = malloc(sizeof(char) * (value - arg + 1));
+		memcpy(name, arg, sizeof(char) * (value - arg));
+		name[value - arg] = '\0';
+		value++;
+
+#if defined(WIN32)
+		/**
+		 * Unlike SetEnvironmentVariable() it updates the C runtime too
+		 */
+		error = _putenv(arg) != 0;
+#else
+		error = value[0] == '\0' ? unsetenv(name) : setenv(name, value, 1);
+		if (!error && wbk_launcher_get_default()) {
+			error = wbk_launcher_setenv(wbk_launcher_get_default(), arg);
+		}
+#endif
+
+		free(name);
+	} else {
+		wbk_logger_log(&logger, WARNING, "Expected NAME=value: %s\n", arg);
+		error = 1;
+	}
+
+	return error;
+}
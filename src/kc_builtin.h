@@ -0,0 +1,155 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the built-in action command class definition
+ *
+ * wbk_kc_builtin_t inherits all methods of wkb_kc_t (see kc.h). Executing it
+ * runs a native action of the daemon instead of spawning a process. Actions
+ * are looked up by name in a registry, when the command is created:
+ *
+ *   "@reload"
+ *   "@write \\.\pipe\status toggled"
+ *   "@setenv THEME=dark"
+ *
+ * "write" writes a line to a named pipe or replaces the content of a file.
+ * "setenv" sets an environment variable of the daemon, thus of the processes
+ * it spawns afterwards. Both are always registered. The daemon registers
+ * further actions, for example "reload", on start up. Executing submits a job
+ * to an executor (see executor.h), so the action never blocks the thread of
+ * an input backend and no thread is created per action. Executing a pending
+ * action again is ignored.
+ */
+
+#include "kc.h"
+#include "executor.h"
+
+#ifndef WBK_KC_BUILTIN_H
+#define WBK_KC_BUILTIN_H
+
+/**
+ * Maximum number of registered actions
+ */
+#define WBK_BUILTIN_ARR_LEN 32
+
+typedef struct wbk_kc_builtin_s wbk_kc_builtin_t;
+
+/**
+ * A registered action
+ */
+typedef struct wbk_builtin_s
+{
+	const char *name;
+
+	/**
+	 * Runs the action.
+	 *
+	 * @param arg The argument written after the name. Empty if there is none.
+	 * @param param The parameter passed on registration
+	 * @return Non-0 if the action failed
+	 */
+	int (*builtin_fn)(const char *arg, void *param);
+
+	void *param;
+} wbk_builtin_t;
+
+struct wbk_kc_builtin_s
+{
+	wbk_kc_t kc;
+	wbk_kc_t *(*super_kc_clone)(const wbk_kc_t *other);
+	int (*super_kc_free)(wbk_kc_t *kc);
+	int (*super_kc_exec)(const wbk_kc_t *kc);
+	int (*super_kc_compare)(const wbk_kc_t *kc, const wbk_kc_t *other);
+	char *(*super_kc_to_str)(const wbk_kc_t *kc);
+
+	const char *(*kc_builtin_get_name)(const wbk_kc_builtin_t *kc_builtin);
+	const char *(*kc_builtin_get_arg)(const wbk_kc_builtin_t *kc_builtin);
+
+	/**
+	 * An entry of the registry
+	 */
+	const wbk_builtin_t *builtin;
+
+	char *arg;
+
+	/**
+	 * It is not owned by the key binding.
+	 */
+	wbk_executor_t *executor;
+
+	wbk_job_t *job;
+};
+
+/**
+ * @brief Registers an action
+ *
+ * Registering an existing name replaces the action. Actions are registered
+ * before the rc file is loaded; registering is not thread safe.
+ *
+ * @param name The name without "@". The string is not copied and must outlive the registry.
+ * @param builtin_fn The action
+ * @param param Passed to the action
+ * @return Non-0 if the registry is full
+ */
+extern int
+wbk_builtin_register(const char *name, int (*builtin_fn)(const char *arg, void *param),
+                     void *param);
+
+/**
+ * @brief Finds a registered action
+ * @param name The name without "@"
+ * @param name_len The number of characters of name to compare
+ * @return The action or NULL if no action has that name
+ */
+extern const wbk_builtin_t *
+wbk_builtin_find(const char *name, int name_len);
+
+/**
+ * @brief Creates a new built-in action command
+ * @param comb The binding of the key command. The object will be freed by the key binding.
+ * @param builtin The action to run. See wbk_builtin_find().
+ * @param arg The argument of the action. The passed string will be freed by the key binding.
+ * @param executor The executor running the action or NULL to run it on the calling thread. It will not be freed by the key binding and must outlive it.
+ * @return A new key binding command or NULL if allocation failed
+ */
+extern wbk_kc_builtin_t *
+wbk_kc_builtin_new(wbk_b_t *comb, const wbk_builtin_t *builtin, char *arg,
+                   wbk_executor_t *executor);
+
+/**
+ * @brief Gets the name of the action of a built-in action command.
+ */
+extern const char *
+wbk_kc_builtin_get_name(const wbk_kc_builtin_t *kc_builtin);
+
+/**
+ * @brief Gets the argument of a built-in action command.
+ */
+extern const char *
+wbk_kc_builtin_get_arg(const wbk_kc_builtin_t *kc_builtin);
+
+#endif // WBK_KC_BUILTIN_H
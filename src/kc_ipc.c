@@ -0,0 +1,238 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the IPC message command class implementation and private methods
+ */
+
+#include "kc_ipc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+static wbk_logger_t logger =  { "kc_ipc" };
+
+/**
+ * Implementation of wbk_kc_clone().
+ *
+ * The clone shares the channel to the consumer.
+ */
+static wbk_kc_t *
+wbk_kc_ipc_clone_impl(const wbk_kc_t *super_other);
+
+/**
+ * Implementation of wbk_kc_free().
+ */
+static int
+wbk_kc_ipc_free_impl(wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_ipc_get_address().
+ */
+static const char *
+wbk_kc_ipc_get_address_impl(const wbk_kc_ipc_t *kc_ipc);
+
+/**
+ * Implementation of wbk_kc_ipc_get_message().
+ */
+static const char *
+wbk_kc_ipc_get_message_impl(const wbk_kc_ipc_t *kc_ipc);
+
+/**
+ * Implementation of wbk_kc_exec().
+ *
+ * @brief Queues the message on the channel
+ * @return Non-0 if the message was dropped
+ */
+static int
+wbk_kc_ipc_exec_impl(const wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_compare().
+ *
+ * IPC message commands are equal if they send the same message to the same
+ * consumer.
+ */
+static int
+wbk_kc_ipc_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_to_str().
+ */
+static char *
+wbk_kc_ipc_to_str_impl(const wbk_kc_t *kc);
+
+wbk_kc_ipc_t *
+wbk_kc_ipc_new(wbk_b_t *comb, const char *address, char *message, wbk_executor_t *executor)
+{
+	wbk_kc_t *kc;
+	wbk_kc_ipc_t *kc_ipc;
+
+	kc_ipc = NULL;
+	kc_ipc = malloc(sizeof(wbk_kc_ipc_t));
+
+	if (kc_ipc) {
+		memset(kc_ipc, 0, sizeof(wbk_kc_ipc_t));
+
+		kc = wbk_kc_new(comb);
+		memcpy(kc_ipc, kc, sizeof(wbk_kc_t));
+		free(kc); /* Just free the top level element */
+
+		kc_ipc->super_kc_clone = kc_ipc->kc.kc_clone;
+		kc_ipc->super_kc_free = kc_ipc->kc.kc_free;
+		kc_ipc->super_kc_exec = kc_ipc->kc.kc_exec;
+		kc_ipc->super_kc_compare = kc_ipc->kc.kc_compare;
+		kc_ipc->super_kc_to_str = kc_ipc->kc.kc_to_str;
+
+		kc_ipc->kc.kc_clone = wbk_kc_ipc_clone_impl;
+		kc_ipc->kc.kc_free = wbk_kc_ipc_free_impl;
+		kc_ipc->kc.kc_exec = wbk_kc_ipc_exec_impl;
+		kc_ipc->kc.kc_compare = wbk_kc_ipc_compare_impl;
+		kc_ipc->kc.kc_to_str = wbk_kc_ipc_to_str_impl;
+		kc_ipc->kc_ipc_get_address = wbk_kc_ipc_get_address_impl;
+		kc_ipc->kc_ipc_get_message = wbk_kc_ipc_get_message_impl;
+
+		kc_ipc->ipc = wbk_ipc_get(address, executor);
+		kc_ipc->message = message;
+	}
+
+	return kc_ipc;
+}
+
+const char *
+wbk_kc_ipc_get_address(const wbk_kc_ipc_t *kc_ipc)
+{
+	return kc_ipc->kc_ipc_get_address(kc_ipc);
+}
+
+const char *
+wbk_kc_ipc_get_message(const wbk_kc_ipc_t *kc_ipc)
+{
+	return kc_ipc->kc_ipc_get_message(kc_ipc);
+}
+
+wbk_kc_t *
+wbk_kc_ipc_clone_impl(const wbk_kc_t *super_other)
+{
+	const wbk_kc_ipc_t *other;
+	char *message;
+	wbk_kc_ipc_t *kc_ipc;
+
+	other = (const wbk_kc_ipc_t *) super_other;
+
+	kc_ipc = NULL;
+	if (other) {
+		message = malloc(sizeof(char) * (strlen(other->message) + 1));
+		strcpy(message, other->message);
+
+		kc_ipc = wbk_kc_ipc_new(wbk_b_clone(wbk_kc_get_binding((wbk_kc_t *) other)),
+		                        wbk_kc_ipc_get_address(other), message,
+		                        other->ipc ? other->ipc->executor : NULL);
+	}
+
+	return (wbk_kc_t *) kc_ipc;
+}
+
+int
+wbk_kc_ipc_free_impl(wbk_kc_t *kc)
+{
+	wbk_kc_ipc_t *kc_ipc;
+
+	kc_ipc = (wbk_kc_ipc_t *) kc;
+
+	if (kc_ipc->ipc) {
+		wbk_ipc_release(kc_ipc->ipc);
+		kc_ipc->ipc = NULL;
+	}
+
+	free(kc_ipc->message);
+	kc_ipc->message = NULL;
+
+	return kc_ipc->super_kc_free(kc);
+}
+
+const char *
+wbk_kc_ipc_get_address_impl(const wbk_kc_ipc_t *kc_ipc)
+{
+	return kc_ipc->ipc ? kc_ipc->ipc->address : "";
+}
+
+const char *
+wbk_kc_ipc_get_message_impl(const wbk_kc_ipc_t *kc_ipc)
+{
+	return kc_ipc->message;
+}
+
+int
+wbk_kc_ipc_exec_impl(const wbk_kc_t *kc)
+{
+	const wbk_kc_ipc_t *kc_ipc;
+	int error;
+
+	kc_ipc = (const wbk_kc_ipc_t *) kc;
+
+	error = kc_ipc->ipc == NULL
+	        || wbk_ipc_post(kc_ipc->ipc, kc_ipc->message, strlen(kc_ipc->message));
+	if (error) {
+		wbk_logger_log(&logger, WARNING, "Dropped message to %s: %s\n",
+		               wbk_kc_ipc_get_address(kc_ipc), kc_ipc->message);
+	}
+
+	return error;
+}
+
+int
+wbk_kc_ipc_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	const wbk_kc_ipc_t *kc_ipc;
+	const wbk_kc_ipc_t *other_ipc;
+
+	kc_ipc = (const wbk_kc_ipc_t *) kc;
+	other_ipc = (const wbk_kc_ipc_t *) other;
+
+	return kc_ipc->super_kc_compare(kc, other)
+		   || strcmp(wbk_kc_ipc_get_address(kc_ipc), wbk_kc_ipc_get_address(other_ipc))
+		   || strcmp(wbk_kc_ipc_get_message(kc_ipc), wbk_kc_ipc_get_message(other_ipc));
+}
+
+char *
+wbk_kc_ipc_to_str_impl(const wbk_kc_t *kc)
+{
+	const char *address;
+	const char *message;
+	char *str;
+
+	address = wbk_kc_ipc_get_address((const wbk_kc_ipc_t *) kc);
+	message = wbk_kc_ipc_get_message((const wbk_kc_ipc_t *) kc);
+	str = malloc(sizeof(char) * (strlen(address) + strlen(message) + 9));
+	sprintf(str, "\"@ipc %s %s\"", address, message);
+
+	return str;
+}
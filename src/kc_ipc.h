@@ -0,0 +1,92 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the IPC message command class definition
+ *
+ * wbk_kc_ipc_t inherits all methods of wkb_kc_t (see kc.h). Executing it
+ * sends a message to a long running consumer, e.g. a window manager, over a
+ * persistent connection (see ipc.h) instead of spawning a client process:
+ *
+ *   "@ipc \\.\pipe\wm focus left"
+ *
+ * The first word is the address of the consumer, the rest is the message.
+ */
+
+#include "kc.h"
+#include "executor.h"
+#include "ipc.h"
+
+#ifndef WBK_KC_IPC_H
+#define WBK_KC_IPC_H
+
+typedef struct wbk_kc_ipc_s wbk_kc_ipc_t;
+
+struct wbk_kc_ipc_s
+{
+	wbk_kc_t kc;
+	wbk_kc_t *(*super_kc_clone)(const wbk_kc_t *other);
+	int (*super_kc_free)(wbk_kc_t *kc);
+	int (*super_kc_exec)(const wbk_kc_t *kc);
+	int (*super_kc_compare)(const wbk_kc_t *kc, const wbk_kc_t *other);
+	char *(*super_kc_to_str)(const wbk_kc_t *kc);
+
+	const char *(*kc_ipc_get_address)(const wbk_kc_ipc_t *kc_ipc);
+	const char *(*kc_ipc_get_message)(const wbk_kc_ipc_t *kc_ipc);
+
+	/**
+	 * The shared channel to the consumer
+	 */
+	wbk_ipc_t *ipc;
+
+	char *message;
+};
+
+/**
+ * @brief Creates a new IPC message command
+ * @param comb The binding of the key command. The object will be freed by the key binding.
+ * @param address The name of the pipe or the path of the socket of the consumer. The string is copied.
+ * @param message The message. The passed string will be freed by the key binding.
+ * @param executor The executor writing the message. It will not be freed by the key binding and must outlive it.
+ * @return A new key binding command or NULL if allocation failed
+ */
+extern wbk_kc_ipc_t *
+wbk_kc_ipc_new(wbk_b_t *comb, const char *address, char *message, wbk_executor_t *executor);
+
+/**
+ * @brief Gets the address of the consumer of an IPC message command.
+ */
+extern const char *
+wbk_kc_ipc_get_address(const wbk_kc_ipc_t *kc_ipc);
+
+/**
+ * @brief Gets the message of an IPC message command.
+ */
+extern const char *
+wbk_kc_ipc_get_message(const wbk_kc_ipc_t *kc_ipc);
+
+#endif // WBK_KC_IPC_H
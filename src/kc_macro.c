@@ -0,0 +1,527 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the macro command class implementation and private methods
+ */
+
+#include "kc_macro.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+#include "parser.h"
+
+#define WBK_KC_MACRO_WAIT "wait "
+#define WBK_KC_MACRO_TYPE "type "
+
+static wbk_logger_t logger =  { "kc_macro" };
+
+/**
+ * State of the compilation of a macro
+ */
+typedef struct wbk_kc_macro_compiler_s
+{
+	wbk_kc_macro_t *kc_macro;
+	wbk_sink_event_t event_arr[WBK_KC_MACRO_BATCH_LEN];
+	int event_arr_len;
+	int error;
+} wbk_kc_macro_compiler_t;
+
+/**
+ * Implementation of wbk_kc_clone().
+ *
+ * The clone emits into the same injection sink and runs on the same
+ * executor.
+ */
+static wbk_kc_t *
+wbk_kc_macro_clone_impl(const wbk_kc_t *super_other);
+
+/**
+ * Implementation of wbk_kc_free().
+ *
+ * A running macro is cancelled.
+ */
+static int
+wbk_kc_macro_free_impl(wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_macro_get_macro().
+ */
+static const char *
+wbk_kc_macro_get_macro_impl(const wbk_kc_macro_t *kc_macro);
+
+/**
+ * Implementation of wbk_kc_exec().
+ *
+ * @brief Starts the macro on the executor
+ * @return Non-0 if the macro cannot be run
+ */
+static int
+wbk_kc_macro_exec_impl(const wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_compare().
+ *
+ * Macro commands are equal if their steps are equal.
+ */
+static int
+wbk_kc_macro_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_to_str().
+ */
+static char *
+wbk_kc_macro_to_str_impl(const wbk_kc_t *kc);
+
+/**
+ * Job of a running macro. Sends batches until the next delay.
+ */
+static long
+wbk_kc_macro_job_fn(wbk_job_t *job, void *param);
+
+/**
+ * Compiles the steps of a macro into its program.
+ *
+ * @return Non-0 if the macro is malformed or cannot be emitted.
+ */
+static int
+wbk_kc_macro_compile(wbk_kc_macro_t *kc_macro);
+
+/**
+ * Compiles a single step. The step is trimmed in place.
+ */
+static void
+wbk_kc_macro_compile_step(wbk_kc_macro_compiler_t *compiler, char *step);
+
+static void
+wbk_kc_macro_add_op(wbk_kc_macro_compiler_t *compiler, wbk_sink_batch_t *batch,
+                    unsigned long delay);
+
+/**
+ * Compiles the collected events into a batch.
+ */
+static void
+wbk_kc_macro_flush(wbk_kc_macro_compiler_t *compiler);
+
+static void
+wbk_kc_macro_emit(wbk_kc_macro_compiler_t *compiler, wbk_mk_t modifier, char key,
+                  int pressed);
+
+/**
+ * Presses all keys of a combination or releases them in reverse order.
+ *
+ * @return The number of emitted events
+ */
+static int
+wbk_kc_macro_emit_b(wbk_kc_macro_compiler_t *compiler, const wbk_b_t *b, int pressed);
+
+static int
+wbk_kc_macro_free_program(wbk_kc_macro_t *kc_macro);
+
+wbk_kc_macro_t *
+wbk_kc_macro_new(wbk_b_t *comb, char *macro, wbk_sink_t *sink, wbk_executor_t *executor)
+{
+	wbk_kc_t *kc;
+	wbk_kc_macro_t *kc_macro;
+
+	kc_macro = NULL;
+	kc_macro = malloc(sizeof(wbk_kc_macro_t));
+
+	if (kc_macro) {
+		memset(kc_macro, 0, sizeof(wbk_kc_macro_t));
+
+		kc = wbk_kc_new(comb);
+		memcpy(kc_macro, kc, sizeof(wbk_kc_t));
+		free(kc); /* Just free the top level element */
+
+		kc_macro->super_kc_clone = kc_macro->kc.kc_clone;
+		kc_macro->super_kc_free = kc_macro->kc.kc_free;
+		kc_macro->super_kc_exec = kc_macro->kc.kc_exec;
+		kc_macro->super_kc_compare = kc_macro->kc.kc_compare;
+		kc_macro->super_kc_to_str = kc_macro->kc.kc_to_str;
+
+		kc_macro->kc.kc_clone = wbk_kc_macro_clone_impl;
+		kc_macro->kc.kc_free = wbk_kc_macro_free_impl;
+		kc_macro->kc.kc_exec = wbk_kc_macro_exec_impl;
+		kc_macro->kc.kc_compare = wbk_kc_macro_compare_impl;
+		kc_macro->kc.kc_to_str = wbk_kc_macro_to_str_impl;
+		kc_macro->kc_macro_get_macro = wbk_kc_macro_get_macro_impl;
+
+		kc_macro->macro = macro;
+		kc_macro->sink = sink;
+		kc_macro->executor = executor;
+
+		kc_macro->run = malloc(sizeof(wbk_kc_macro_run_t));
+		wbk_job_init(&(kc_macro->run->job), wbk_kc_macro_job_fn, kc_macro);
+		kc_macro->run->op = 0;
+
+		kc_macro->op_arr = NULL;
+		kc_macro->op_arr_len = 0;
+		if (sink && wbk_kc_macro_compile(kc_macro)) {
+			wbk_logger_log(&logger, WARNING, "Cannot compile macro: %s\n", macro);
+		}
+	}
+
+	return kc_macro;
+}
+
+const char *
+wbk_kc_macro_get_macro(const wbk_kc_macro_t *kc_macro)
+{
+	return kc_macro->kc_macro_get_macro(kc_macro);
+}
+
+wbk_kc_t *
+wbk_kc_macro_clone_impl(const wbk_kc_t *super_other)
+{
+	const wbk_kc_macro_t *other;
+	char *macro;
+	wbk_kc_macro_t *kc_macro;
+
+	other = (const wbk_kc_macro_t *) super_other;
+
+	kc_macro = NULL;
+	if (other) {
+		macro = malloc(sizeof(char) * (strlen(other->macro) + 1));
+		strcpy(macro, other->macro);
+
+		kc_macro = wbk_kc_macro_new(wbk_b_clone(wbk_kc_get_binding((wbk_kc_t *) other)),
+		                            macro, other->sink, other->executor);
+	}
+
+	return (wbk_kc_t *) kc_macro;
+}
+
+int
+wbk_kc_macro_free_impl(wbk_kc_t *kc)
+{
+	wbk_kc_macro_t *kc_macro;
+
+	kc_macro = (wbk_kc_macro_t *) kc;
+
+	if (kc_macro->executor) {
+		wbk_executor_cancel(kc_macro->executor, &(kc_macro->run->job));
+	}
+	free(kc_macro->run);
+	kc_macro->run = NULL;
+
+	wbk_kc_macro_free_program(kc_macro);
+
+	free(kc_macro->macro);
+	kc_macro->macro = NULL;
+
+	return kc_macro->super_kc_free(kc);
+}
+
+const char *
+wbk_kc_macro_get_macro_impl(const wbk_kc_macro_t *kc_macro)
+{
+	return kc_macro->macro;
+}
+
+int
+wbk_kc_macro_exec_impl(const wbk_kc_t *kc)
+{
+	const wbk_kc_macro_t *kc_macro;
+	int error;
+
+	kc_macro = (const wbk_kc_macro_t *) kc;
+
+	error = 0;
+	if (kc_macro->op_arr == NULL) {
+		wbk_logger_log(&logger, WARNING, "No injection sink or malformed macro: %s\n",
+		               kc_macro->macro);
+		error = 1;
+	} else if (kc_macro->executor == NULL) {
+		wbk_logger_log(&logger, WARNING, "No executor to run the macro: %s\n", kc_macro->macro);
+		error = 1;
+	} else if (wbk_executor_submit(kc_macro->executor, &(kc_macro->run->job))) {
+		wbk_logger_log(&logger, INFO, "Macro is still running: %s\n", kc_macro->macro);
+	}
+
+	return error;
+}
+
+int
+wbk_kc_macro_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	const wbk_kc_macro_t *kc_macro;
+
+	kc_macro = (const wbk_kc_macro_t *) kc;
+
+	return kc_macro->super_kc_compare(kc, other)
+		   || strcmp(wbk_kc_macro_get_macro(kc_macro),
+		             wbk_kc_macro_get_macro((const wbk_kc_macro_t *) other));
+}
+
+char *
+wbk_kc_macro_to_str_impl(const wbk_kc_t *kc)
+{
+	const char *macro;
+	char *str;
+
+	macro = wbk_kc_macro_get_macro((const wbk_kc_macro_t *) kc);
+	str = malloc(sizeof(char) * (strlen(macro) + 10));
+	sprintf(str, "\"@macro %s\"", macro);
+
+	return str;
+}
+
+long
+wbk_kc_macro_job_fn(wbk_job_t *job, void *param)
+{
+	wbk_kc_macro_t *kc_macro;
+	wbk_kc_macro_run_t *run;
+	const wbk_kc_macro_op_t *op;
+	long delay;
+
+	kc_macro = (wbk_kc_macro_t *) param;
+	run = kc_macro->run;
+
+	delay = -1;
+	while (delay < 0 && run->op < kc_macro->op_arr_len) {
+		op = &(kc_macro->op_arr[run->op++]);
+		if (op->batch) {
+			wbk_sink_batch_send(op->batch);
+		} else {
+			delay = op->delay;
+		}
+	}
+
+	if (delay < 0) {
+		run->op = 0;
+	}
+
+	return delay;
+}
+
+int
+wbk_kc_macro_compile(wbk_kc_macro_t *kc_macro)
+{
+	wbk_kc_macro_compiler_t compiler;
+	const wbk_b_t *comb;
+	char *copy;
+	char *rest;
+	char *step;
+	int i;
+
+	compiler.kc_macro = kc_macro;
+	compiler.event_arr_len = 0;
+	compiler.error = 0;
+
+	/**
+	 * The modifiers of the binding are still held. They are released
+	 * meanwhile.
+	 */
+	comb = wbk_kc_get_binding((wbk_kc_t *) kc_macro);
+	for (i = 1; i < WBK_B_MODIFER_MAP_LEN; i++) {
+		if (comb->modifier_map[i] == 1 && wbk_be_mk_is_held(i)
+		    && wbk_b_is_implied(comb, i) == 0) {
+			wbk_kc_macro_emit(&compiler, i, '\0', 0);
+		}
+	}
+
+	copy = malloc(sizeof(char) * (strlen(kc_macro->macro) + 1));
+	strcpy(copy, kc_macro->macro);
+
+	rest = copy;
+	while (!compiler.error && (step = strtok_r(rest, ";", &rest))) {
+		wbk_kc_macro_compile_step(&compiler, step);
+	}
+
+	free(copy);
+
+	for (i = WBK_B_MODIFER_MAP_LEN - 1; i > 0; i--) {
+		if (comb->modifier_map[i] == 1 && wbk_be_mk_is_held(i)
+		    && wbk_b_is_implied(comb, i) == 0) {
+			wbk_kc_macro_emit(&compiler, i, '\0', 1);
+		}
+	}
+	wbk_kc_macro_flush(&compiler);
+
+	if (compiler.error) {
+		wbk_kc_macro_free_program(kc_macro);
+	}
+
+	return compiler.error;
+}
+
+void
+wbk_kc_macro_compile_step(wbk_kc_macro_compiler_t *compiler, char *step)
+{
+	wbk_b_t *b;
+	char *end;
+	char key;
+
+	while (*step == ' ' || *step == '\t') {
+		step++;
+	}
+	end = step + strlen(step);
+	while (end > step && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+		end--;
+	}
+	*end = '\0';
+
+	if (*step == '\0') {
+		/**
+		 * Empty steps
+		 */
+	} else if (strncmp(step, WBK_KC_MACRO_WAIT, strlen(WBK_KC_MACRO_WAIT)) == 0) {
+		wbk_kc_macro_flush(compiler);
+		wbk_kc_macro_add_op(compiler, NULL, strtoul(step + strlen(WBK_KC_MACRO_WAIT), NULL, 10));
+	} else if (strncmp(step, WBK_KC_MACRO_TYPE, strlen(WBK_KC_MACRO_TYPE)) == 0) {
+		for (step += strlen(WBK_KC_MACRO_TYPE); *step; step++) {
+			key = (char) tolower((unsigned char) *step);
+			if (isupper((unsigned char) *step)) {
+				wbk_kc_macro_emit(compiler, SHIFT, '\0', 1);
+			}
+			wbk_kc_macro_emit(compiler, NOT_A_MODIFIER, key, 1);
+			wbk_kc_macro_emit(compiler, NOT_A_MODIFIER, key, 0);
+			if (isupper((unsigned char) *step)) {
+				wbk_kc_macro_emit(compiler, SHIFT, '\0', 0);
+			}
+		}
+	} else {
+		b = wbk_parser_parse_binding(step);
+		if (wbk_kc_macro_emit_b(compiler, b, 1) == 0) {
+			compiler->error = 1;
+		}
+		wbk_kc_macro_emit_b(compiler, b, 0);
+		wbk_b_free(b);
+	}
+}
+
+void
+wbk_kc_macro_add_op(wbk_kc_macro_compiler_t *compiler, wbk_sink_batch_t *batch,
+                    unsigned long delay)
+{
+	wbk_kc_macro_t *kc_macro;
+
+	kc_macro = compiler->kc_macro;
+
+	kc_macro->op_arr = realloc(kc_macro->op_arr,
+	                           sizeof(wbk_kc_macro_op_t) * (kc_macro->op_arr_len + 1));
+	kc_macro->op_arr[kc_macro->op_arr_len].batch = batch;
+	kc_macro->op_arr[kc_macro->op_arr_len].delay = delay;
+	kc_macro->op_arr_len++;
+}
+
+void
+wbk_kc_macro_flush(wbk_kc_macro_compiler_t *compiler)
+{
+	wbk_sink_batch_t *batch;
+
+	if (!compiler->error && compiler->event_arr_len > 0) {
+		batch = wbk_sink_batch_new(compiler->kc_macro->sink,
+		                           compiler->event_arr, compiler->event_arr_len);
+		if (batch) {
+			wbk_kc_macro_add_op(compiler, batch, 0);
+		} else {
+			compiler->error = 1;
+		}
+	}
+	compiler->event_arr_len = 0;
+}
+
+void
+wbk_kc_macro_emit(wbk_kc_macro_compiler_t *compiler, wbk_mk_t modifier, char key,
+                  int pressed)
+{
+	if (compiler->event_arr_len == WBK_KC_MACRO_BATCH_LEN) {
+		wbk_kc_macro_flush(compiler);
+	}
+
+	compiler->event_arr[compiler->event_arr_len].be.modifier = modifier;
+	compiler->event_arr[compiler->event_arr_len].be.key = key;
+	compiler->event_arr[compiler->event_arr_len].pressed = pressed;
+	compiler->event_arr_len++;
+}
+
+int
+wbk_kc_macro_emit_b(wbk_kc_macro_compiler_t *compiler, const wbk_b_t *b, int pressed)
+{
+	int count;
+	int i;
+
+	count = 0;
+
+	/**
+	 * Keys are tracked as NOT_A_MODIFIER and modifiers as the key 0 too.
+	 * Skip both. Generic modifiers held along with a side are sent as the
+	 * side only.
+	 */
+	if (pressed) {
+		for (i = 1; i < WBK_B_MODIFER_MAP_LEN; i++) {
+			if (b->modifier_map[i] == 1 && wbk_b_is_implied(b, i) == 0) {
+				wbk_kc_macro_emit(compiler, i, '\0', 1);
+				count++;
+			}
+		}
+		for (i = 1; i < WBK_B_KEY_MAP_LEN; i++) {
+			if (b->key_map[i] == 1) {
+				wbk_kc_macro_emit(compiler, NOT_A_MODIFIER, i, 1);
+				count++;
+			}
+		}
+	} else {
+		for (i = WBK_B_KEY_MAP_LEN - 1; i > 0; i--) {
+			if (b->key_map[i] == 1) {
+				wbk_kc_macro_emit(compiler, NOT_A_MODIFIER, i, 0);
+				count++;
+			}
+		}
+		for (i = WBK_B_MODIFER_MAP_LEN - 1; i > 0; i--) {
+			if (b->modifier_map[i] == 1 && wbk_b_is_implied(b, i) == 0) {
+				wbk_kc_macro_emit(compiler, i, '\0', 0);
+				count++;
+			}
+		}
+	}
+
+	return count;
+}
+
+int
+wbk_kc_macro_free_program(wbk_kc_macro_t *kc_macro)
+{
+	int i;
+
+	for (i = 0; i < kc_macro->op_arr_len; i++) {
+		if (kc_macro->op_arr[i].batch) {
+			wbk_sink_batch_free(kc_macro->op_arr[i].batch);
+		}
+	}
+	free(kc_macro->op_arr);
+	kc_macro->op_arr = NULL;
+	kc_macro->op_arr_len = 0;
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the macro command class definition
+ *
+ * wbk_kc_macro_t inherits all methods of wkb_kc_t (see kc.h). Executing it
+ * types a sequence of combinations, delays and text. Steps are separated by
+ * semicolons:
+ *
+ *   "@macro control + a; control + c; wait 100; type Hello; Return"
+ *
+ * The macro is compiled into a program of event batches (see sink.h) and
+ * delays, when the command is created. Executing it submits a job to an
+ * executor (see executor.h), which sends the batches and waits the delays on
+ * its own thread. Executing does not allocate. Executing a running macro
+ * again is ignored.
+ */
+
+#include "kc.h"
+#include "executor.h"
+#include "sink.h"
+
+#ifndef WBK_KC_MACRO_H
+#define WBK_KC_MACRO_H
+
+/**
+ * Maximum number of events sent at once. Longer sequences are streamed in
+ * several batches.
+ */
+#define WBK_KC_MACRO_BATCH_LEN 32
+
+typedef struct wbk_kc_macro_s wbk_kc_macro_t;
+
+/**
+ * An instruction of a compiled macro. Either sends a batch or waits.
+ */
+typedef struct wbk_kc_macro_op_s
+{
+	wbk_sink_batch_t *batch;
+	unsigned long delay;
+} wbk_kc_macro_op_t;
+
+/**
+ * The state of a running macro
+ */
+typedef struct wbk_kc_macro_run_s
+{
+	wbk_job_t job;
+	int op;
+} wbk_kc_macro_run_t;
+
+struct wbk_kc_macro_s
+{
+	wbk_kc_t kc;
+	wbk_kc_t *(*super_kc_clone)(const wbk_kc_t *other);
+	int (*super_kc_free)(wbk_kc_t *kc);
+	int (*super_kc_exec)(const wbk_kc_t *kc);
+	int (*super_kc_compare)(const wbk_kc_t *kc, const wbk_kc_t *other);
+	char *(*super_kc_to_str)(const wbk_kc_t *kc);
+
+	const char *(*kc_macro_get_macro)(const wbk_kc_macro_t *kc_macro);
+
+	/**
+	 * The steps as written in the rc file
+	 */
+	char *macro;
+
+	/**
+	 * The compiled program. NULL if the macro is malformed or the sink cannot
+	 * emit it.
+	 */
+	wbk_kc_macro_op_t *op_arr;
+	int op_arr_len;
+
+	/**
+	 * Neither is owned by the key binding.
+	 */
+	wbk_sink_t *sink;
+	wbk_executor_t *executor;
+
+	wbk_kc_macro_run_t *run;
+};
+
+/**
+ * @brief Creates a new macro command
+ * @param comb The binding of the key command. The object will be freed by the key binding.
+ * @param macro The steps of the macro. The passed string will be freed by the key binding.
+ * @param sink The injection sink to emit the macro into or NULL. It will not be freed by the key binding and must outlive it.
+ * @param executor The executor running the macro or NULL. It will not be freed by the key binding and must outlive it.
+ * @return A new key binding command or NULL if allocation failed
+ */
+extern wbk_kc_macro_t *
+wbk_kc_macro_new(wbk_b_t *comb, char *macro, wbk_sink_t *sink, wbk_executor_t *executor);
+
+/**
+ * @brief Gets the steps of a macro command.
+ */
+extern const char *
+wbk_kc_macro_get_macro(const wbk_kc_macro_t *kc_macro);
+
+#endif // WBK_KC_MACRO_H
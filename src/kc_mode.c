@@ -0,0 +1,211 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the key binding mode switch command class implementation and private methods
+ */
+
+#include "kc_mode.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+static wbk_logger_t logger =  { "kc_mode" };
+
+/**
+ * Implementation of wbk_kc_clone().
+ *
+ * Clones a key binding mode switch command. The clone switches the same key
+ * board manager.
+ */
+static wbk_kc_t *
+wbk_kc_mode_clone_impl(const wbk_kc_t *super_other);
+
+/**
+ * Implementation of wbk_kc_free().
+ */
+static int
+wbk_kc_mode_free_impl(wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_mode_get_mode().
+ */
+static const char *
+wbk_kc_mode_get_mode_impl(const wbk_kc_mode_t *kc_mode);
+
+/**
+ * Implementation of wbk_kc_exec().
+ *
+ * @brief Switches the key board manager to the mode
+ * @return Non-0 if the mode does not exist
+ */
+static int
+wbk_kc_mode_exec_impl(const wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_compare().
+ *
+ * Key binding mode switch commands are equal if they switch to the same mode.
+ */
+static int
+wbk_kc_mode_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_to_str().
+ */
+static char *
+wbk_kc_mode_to_str_impl(const wbk_kc_t *kc);
+
+wbk_kc_mode_t *
+wbk_kc_mode_new(wbk_b_t *comb, wbk_kbman_t *kbman, char *mode)
+{
+  wbk_kc_t *kc;
+	wbk_kc_mode_t *kc_mode;
+
+	kc_mode = NULL;
+	kc_mode = malloc(sizeof(wbk_kc_mode_t));
+
+  if (kc_mode) {
+    memset(kc_mode, 0, sizeof(wbk_kc_mode_t));
+
+    kc = wbk_kc_new(comb);
+    memcpy(kc_mode, kc, sizeof(wbk_kc_t));
+    free(kc); /* Just free the top level element */
+
+    kc_mode->super_kc_clone = kc_mode->kc.kc_clone;
+    kc_mode->super_kc_free = kc_mode->kc.kc_free;
+    kc_mode->super_kc_exec = kc_mode->kc.kc_exec;
+    kc_mode->super_kc_compare = kc_mode->kc.kc_compare;
+    kc_mode->super_kc_to_str = kc_mode->kc.kc_to_str;
+
+    kc_mode->kc.kc_clone = wbk_kc_mode_clone_impl;
+    kc_mode->kc.kc_free = wbk_kc_mode_free_impl;
+    kc_mode->kc.kc_exec = wbk_kc_mode_exec_impl;
+    kc_mode->kc.kc_compare = wbk_kc_mode_compare_impl;
+    kc_mode->kc.kc_to_str = wbk_kc_mode_to_str_impl;
+    kc_mode->kc_mode_get_mode = wbk_kc_mode_get_mode_impl;
+
+		kc_mode->kbman = kbman;
+		kc_mode->mode = mode;
+  }
+
+	return kc_mode;
+}
+
+const char *
+wbk_kc_mode_get_mode(const wbk_kc_mode_t *kc_mode)
+{
+	return kc_mode->kc_mode_get_mode(kc_mode);
+}
+
+wbk_kc_t *
+wbk_kc_mode_clone_impl(const wbk_kc_t *super_other)
+{
+	const wbk_kc_mode_t *other;
+	wbk_b_t *comb;
+	char *mode;
+	wbk_kc_mode_t *kc_mode;
+
+	other = (const wbk_kc_mode_t *) super_other;
+
+	kc_mode = NULL;
+	if (other) {
+		comb = wbk_b_clone(wbk_kc_get_binding((wbk_kc_t *) other));
+
+		mode = malloc(sizeof(char) * (strlen(other->mode) + 1));
+		strcpy(mode, other->mode);
+
+		kc_mode = wbk_kc_mode_new(comb, other->kbman, mode);
+	}
+
+	return (wbk_kc_t *) kc_mode;
+}
+
+int
+wbk_kc_mode_free_impl(wbk_kc_t *kc)
+{
+	wbk_kc_mode_t *kc_mode;
+
+	kc_mode = (wbk_kc_mode_t *) kc;
+
+	free(kc_mode->mode);
+	kc_mode->mode = NULL;
+	kc_mode->kbman = NULL;
+
+	return kc_mode->super_kc_free(kc);
+}
+
+const char *
+wbk_kc_mode_get_mode_impl(const wbk_kc_mode_t *kc_mode)
+{
+	return kc_mode->mode;
+}
+
+int
+wbk_kc_mode_exec_impl(const wbk_kc_t *kc)
+{
+	const wbk_kc_mode_t *kc_mode;
+	int error;
+
+	kc_mode = (const wbk_kc_mode_t *) kc;
+
+	error = wbk_kbman_switch_mode(kc_mode->kbman, kc_mode->mode);
+	if (error) {
+		wbk_logger_log(&logger, WARNING, "Unknown mode: %s\n", kc_mode->mode);
+	} else {
+		wbk_logger_log(&logger, INFO, "Switched to mode: %s\n", kc_mode->mode);
+	}
+
+	return error;
+}
+
+int
+wbk_kc_mode_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	const wbk_kc_mode_t *kc_mode;
+
+	kc_mode = (const wbk_kc_mode_t *) kc;
+
+	return kc_mode->super_kc_compare(kc, other)
+		   || strcmp(wbk_kc_mode_get_mode(kc_mode),
+					 wbk_kc_mode_get_mode((const wbk_kc_mode_t *) other));
+}
+
+char *
+wbk_kc_mode_to_str_impl(const wbk_kc_t *kc)
+{
+	const char *mode;
+	char *str;
+
+	mode = wbk_kc_mode_get_mode((const wbk_kc_mode_t *) kc);
+	str = malloc(sizeof(char) * (strlen(mode) + 9));
+	sprintf(str, "\"@mode %s\"", mode);
+
+	return str;
+}
@@ -0,0 +1,79 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the key binding mode switch command class definition
+ *
+ * wbk_kc_mode_t inherits all methods of wkb_kc_t (see kc.h). Executing it
+ * switches the active mode of a key board manager instead of spawning a
+ * process.
+ */
+
+#include "kc.h"
+#include "kbman.h"
+
+#ifndef WBK_KC_MODE_H
+#define WBK_KC_MODE_H
+
+typedef struct wbk_kc_mode_s wbk_kc_mode_t;
+
+struct wbk_kc_mode_s
+{
+	wbk_kc_t kc;
+  wbk_kc_t *(*super_kc_clone)(const wbk_kc_t *other);
+  int (*super_kc_free)(wbk_kc_t *kc);
+  int (*super_kc_exec)(const wbk_kc_t *kc);
+  int (*super_kc_compare)(const wbk_kc_t *kc, const wbk_kc_t *other);
+  char *(*super_kc_to_str)(const wbk_kc_t *kc);
+
+  const char *(*kc_mode_get_mode)(const wbk_kc_mode_t *kc_mode);
+
+	/**
+	 * The key board manager whose mode is switched. It is not owned by the
+	 * key binding command.
+	 */
+	wbk_kbman_t *kbman;
+
+	char *mode;
+};
+
+/**
+ * @brief Creates a new key binding mode switch command
+ * @param comb The binding of the key command. The object will be freed by the key binding.
+ * @param kbman The key board manager to switch. It will not be freed by the key binding and must outlive it.
+ * @param mode The name of the mode to switch to. The passed string will be freed by the key binding.
+ * @return A new key binding command or NULL if allocation failed
+ */
+extern wbk_kc_mode_t *
+wbk_kc_mode_new(wbk_b_t *comb, wbk_kbman_t *kbman, char *mode);
+
+/**
+ * @brief Gets the name of the mode a key binding mode switch command switches to.
+ */
+extern const char *
+wbk_kc_mode_get_mode(const wbk_kc_mode_t *kc_mode);
+
+#endif // WBK_KC_MODE_H
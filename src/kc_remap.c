@@ -0,0 +1,348 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the key remapping command class implementation and private methods
+ */
+
+#include "kc_remap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+static wbk_logger_t logger =  { "kc_remap" };
+
+/**
+ * Implementation of wbk_kc_clone().
+ *
+ * The clone emits into the same injection sink.
+ */
+static wbk_kc_t *
+wbk_kc_remap_clone_impl(const wbk_kc_t *super_other);
+
+/**
+ * Implementation of wbk_kc_free().
+ */
+static int
+wbk_kc_remap_free_impl(wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_remap_get_target().
+ */
+static const wbk_b_t *
+wbk_kc_remap_get_target_impl(const wbk_kc_remap_t *kc_remap);
+
+/**
+ * Implementation of wbk_kc_exec().
+ *
+ * @brief Emits the key strokes of the replacement combination
+ * @return Non-0 if they could not be emitted
+ */
+static int
+wbk_kc_remap_exec_impl(const wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_exec_end().
+ *
+ * @brief Releases the replacement combination of a Hold binding
+ * @return Non-0 if the key strokes could not be emitted
+ */
+static int
+wbk_kc_remap_exec_end_impl(const wbk_kc_t *kc);
+
+/**
+ * Implementation of wbk_kc_compare().
+ *
+ * Key remapping commands are equal if they emit the same combination.
+ */
+static int
+wbk_kc_remap_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_to_str().
+ */
+static char *
+wbk_kc_remap_to_str_impl(const wbk_kc_t *kc);
+
+/**
+ * Generates the key strokes replacing comb by target.
+ *
+ * @param event_arr Must hold 2 * (WBK_B_MODIFER_MAP_LEN + WBK_B_KEY_MAP_LEN) events.
+ * @return The number of generated events
+ */
+static int
+wbk_kc_remap_gen_events(const wbk_b_t *comb, const wbk_b_t *target,
+                        wbk_sink_event_t *event_arr);
+
+/**
+ * @return Non-0 if comb is a Hold binding and target holds modifiers only.
+ */
+static int
+wbk_kc_remap_is_held(const wbk_b_t *comb, const wbk_b_t *target);
+
+wbk_kc_remap_t *
+wbk_kc_remap_new(wbk_b_t *comb, wbk_b_t *target, wbk_sink_t *sink)
+{
+	wbk_kc_t *kc;
+	wbk_kc_remap_t *kc_remap;
+	wbk_sink_event_t *event_arr;
+	int event_arr_len;
+
+	kc_remap = NULL;
+	kc_remap = malloc(sizeof(wbk_kc_remap_t));
+
+	if (kc_remap) {
+		memset(kc_remap, 0, sizeof(wbk_kc_remap_t));
+
+		kc = wbk_kc_new(comb);
+		memcpy(kc_remap, kc, sizeof(wbk_kc_t));
+		free(kc); /* Just free the top level element */
+
+		kc_remap->super_kc_clone = kc_remap->kc.kc_clone;
+		kc_remap->super_kc_free = kc_remap->kc.kc_free;
+		kc_remap->super_kc_exec = kc_remap->kc.kc_exec;
+		kc_remap->super_kc_compare = kc_remap->kc.kc_compare;
+		kc_remap->super_kc_to_str = kc_remap->kc.kc_to_str;
+
+		kc_remap->kc.kc_clone = wbk_kc_remap_clone_impl;
+		kc_remap->kc.kc_free = wbk_kc_remap_free_impl;
+		kc_remap->kc.kc_exec = wbk_kc_remap_exec_impl;
+		kc_remap->kc.kc_exec_end = wbk_kc_remap_exec_end_impl;
+		kc_remap->kc.kc_compare = wbk_kc_remap_compare_impl;
+		kc_remap->kc.kc_to_str = wbk_kc_remap_to_str_impl;
+		kc_remap->kc_remap_get_target = wbk_kc_remap_get_target_impl;
+
+		kc_remap->target = target;
+		kc_remap->batch = NULL;
+		kc_remap->end_batch = NULL;
+
+		if (sink) {
+			event_arr = malloc(sizeof(wbk_sink_event_t) * 2 * (WBK_B_MODIFER_MAP_LEN + WBK_B_KEY_MAP_LEN));
+			event_arr_len = wbk_kc_remap_gen_events(comb, target, event_arr);
+			if (wbk_kc_remap_is_held(comb, target)) {
+				/**
+				 * Split into the press and the release half
+				 */
+				kc_remap->batch = wbk_sink_batch_new(sink, event_arr, event_arr_len / 2);
+				kc_remap->end_batch = wbk_sink_batch_new(sink, event_arr + event_arr_len / 2,
+				                                         event_arr_len / 2);
+			} else {
+				kc_remap->batch = wbk_sink_batch_new(sink, event_arr, event_arr_len);
+			}
+			free(event_arr);
+		}
+	}
+
+	return kc_remap;
+}
+
+const wbk_b_t *
+wbk_kc_remap_get_target(const wbk_kc_remap_t *kc_remap)
+{
+	return kc_remap->kc_remap_get_target(kc_remap);
+}
+
+wbk_kc_t *
+wbk_kc_remap_clone_impl(const wbk_kc_t *super_other)
+{
+	const wbk_kc_remap_t *other;
+	wbk_kc_remap_t *kc_remap;
+
+	other = (const wbk_kc_remap_t *) super_other;
+
+	kc_remap = NULL;
+	if (other) {
+		kc_remap = wbk_kc_remap_new(wbk_b_clone(wbk_kc_get_binding((wbk_kc_t *) other)),
+		                            wbk_b_clone(other->target),
+		                            other->batch ? other->batch->sink : NULL);
+	}
+
+	return (wbk_kc_t *) kc_remap;
+}
+
+int
+wbk_kc_remap_free_impl(wbk_kc_t *kc)
+{
+	wbk_kc_remap_t *kc_remap;
+
+	kc_remap = (wbk_kc_remap_t *) kc;
+
+	if (kc_remap->batch) {
+		wbk_sink_batch_free(kc_remap->batch);
+		kc_remap->batch = NULL;
+	}
+	if (kc_remap->end_batch) {
+		wbk_sink_batch_free(kc_remap->end_batch);
+		kc_remap->end_batch = NULL;
+	}
+	wbk_b_free(kc_remap->target);
+	kc_remap->target = NULL;
+
+	return kc_remap->super_kc_free(kc);
+}
+
+const wbk_b_t *
+wbk_kc_remap_get_target_impl(const wbk_kc_remap_t *kc_remap)
+{
+	return kc_remap->target;
+}
+
+int
+wbk_kc_remap_exec_impl(const wbk_kc_t *kc)
+{
+	const wbk_kc_remap_t *kc_remap;
+	int error;
+
+	kc_remap = (const wbk_kc_remap_t *) kc;
+
+	if (kc_remap->batch) {
+		error = wbk_sink_batch_send(kc_remap->batch);
+	} else {
+		wbk_logger_log(&logger, WARNING, "No injection sink to remap to\n");
+		error = 1;
+	}
+
+	return error;
+}
+
+int
+wbk_kc_remap_exec_end_impl(const wbk_kc_t *kc)
+{
+	const wbk_kc_remap_t *kc_remap;
+	int error;
+
+	kc_remap = (const wbk_kc_remap_t *) kc;
+
+	error = 0;
+	if (kc_remap->end_batch) {
+		error = wbk_sink_batch_send(kc_remap->end_batch);
+	}
+
+	return error;
+}
+
+int
+wbk_kc_remap_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	const wbk_kc_remap_t *kc_remap;
+
+	kc_remap = (const wbk_kc_remap_t *) kc;
+
+	return kc_remap->super_kc_compare(kc, other)
+		   || wbk_b_compare(wbk_kc_remap_get_target(kc_remap),
+		                    wbk_kc_remap_get_target((const wbk_kc_remap_t *) other));
+}
+
+char *
+wbk_kc_remap_to_str_impl(const wbk_kc_t *kc)
+{
+	char *target;
+	char *str;
+
+	target = wbk_b_to_str(wbk_kc_remap_get_target((const wbk_kc_remap_t *) kc));
+	str = malloc(sizeof(char) * (strlen(target) + 10));
+	sprintf(str, "\"@remap %s\"", target);
+	free(target);
+
+	return str;
+}
+
+int
+wbk_kc_remap_gen_events(const wbk_b_t *comb, const wbk_b_t *target,
+                        wbk_sink_event_t *event_arr)
+{
+	int len;
+	int first;
+	int i;
+
+	len = 0;
+
+	/**
+	 * Keys are tracked as NOT_A_MODIFIER and modifiers as the key 0 too.
+	 * Skip both. Generic modifiers held along with a side are sent as the
+	 * side only, and a side is kept if the replacement holds its generic
+	 * modifier.
+	 */
+	for (i = 1; i < WBK_B_MODIFER_MAP_LEN; i++) {
+		if (comb->modifier_map[i] == 1 && wbk_b_is_implied(comb, i) == 0
+		    && target->modifier_map[i] != 1 && wbk_be_mk_is_held(i)
+		    && (wbk_be_mk_get_generic(i) == (wbk_mk_t) i
+		        || target->modifier_map[wbk_be_mk_get_generic(i)] != 1
+		        || wbk_b_is_implied(target, wbk_be_mk_get_generic(i)))) {
+			event_arr[len].be.modifier = i;
+			event_arr[len].be.key = '\0';
+			event_arr[len++].pressed = 0;
+		}
+	}
+	first = len;
+
+	for (i = 1; i < WBK_B_MODIFER_MAP_LEN; i++) {
+		if (target->modifier_map[i] == 1 && wbk_b_is_implied(target, i) == 0
+		    && comb->modifier_map[i] != 1) {
+			event_arr[len].be.modifier = i;
+			event_arr[len].be.key = '\0';
+			event_arr[len++].pressed = 1;
+		}
+	}
+	for (i = 1; i < WBK_B_KEY_MAP_LEN; i++) {
+		if (target->key_map[i] == 1) {
+			event_arr[len].be.modifier = NOT_A_MODIFIER;
+			event_arr[len].be.key = i;
+			event_arr[len++].pressed = 1;
+		}
+	}
+
+	/**
+	 * Release the replacement and press the modifiers of the binding again
+	 * in reverse order
+	 */
+	for (i = len - 1; i >= 0; i--) {
+		event_arr[len + (len - 1 - i)] = event_arr[i];
+		event_arr[len + (len - 1 - i)].pressed = i < first;
+	}
+
+	return 2 * len;
+}
+
+int
+wbk_kc_remap_is_held(const wbk_b_t *comb, const wbk_b_t *target)
+{
+	int held;
+	int i;
+
+	held = comb->trigger == TRIGGER_HOLD && wbk_b_get_key(target) == '\0';
+	for (i = 1; held && i < WBK_B_MODIFER_MAP_LEN; i++) {
+		if (target->modifier_map[i] == 1 && wbk_be_mk_is_held(i) == 0) {
+			held = 0;
+		}
+	}
+
+	return held;
+}
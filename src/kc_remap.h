@@ -0,0 +1,97 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the key remapping command class definition
+ *
+ * wbk_kc_remap_t inherits all methods of wkb_kc_t (see kc.h). Executing it
+ * emits the key strokes of another combination through an injection sink
+ * (see sink.h) instead of spawning a process. Example: "@remap Left" bound to
+ * Mod4 + h.
+ *
+ * The modifiers of the binding are still held while it executes. Those not
+ * part of the replacement are released before and pressed again after it.
+ *
+ * A Hold binding remapped to held modifiers only keeps them held until the
+ * binding is released, e.g. "@remap control" bound to hold + Capslock. Keys
+ * pressed meanwhile reach the system along with the replacement.
+ */
+
+#include "kc.h"
+#include "sink.h"
+
+#ifndef WBK_KC_REMAP_H
+#define WBK_KC_REMAP_H
+
+typedef struct wbk_kc_remap_s wbk_kc_remap_t;
+
+struct wbk_kc_remap_s
+{
+	wbk_kc_t kc;
+	wbk_kc_t *(*super_kc_clone)(const wbk_kc_t *other);
+	int (*super_kc_free)(wbk_kc_t *kc);
+	int (*super_kc_exec)(const wbk_kc_t *kc);
+	int (*super_kc_compare)(const wbk_kc_t *kc, const wbk_kc_t *other);
+	char *(*super_kc_to_str)(const wbk_kc_t *kc);
+
+	const wbk_b_t *(*kc_remap_get_target)(const wbk_kc_remap_t *kc_remap);
+
+	/**
+	 * The replacement combination
+	 */
+	wbk_b_t *target;
+
+	/**
+	 * The key strokes, compiled when the command is created. NULL if there is
+	 * no sink or it cannot emit the replacement.
+	 */
+	wbk_sink_batch_t *batch;
+
+	/**
+	 * The key strokes releasing the replacement of a Hold binding, which
+	 * batch only pressed (see wbk_kc_exec_end()). NULL otherwise.
+	 */
+	wbk_sink_batch_t *end_batch;
+};
+
+/**
+ * @brief Creates a new key remapping command
+ * @param comb The binding of the key command. The object will be freed by the key binding.
+ * @param target The replacement combination. The object will be freed by the key binding.
+ * @param sink The injection sink to emit the replacement into or NULL. It will not be freed by the key binding and must outlive it.
+ * @return A new key binding command or NULL if allocation failed
+ */
+extern wbk_kc_remap_t *
+wbk_kc_remap_new(wbk_b_t *comb, wbk_b_t *target, wbk_sink_t *sink);
+
+/**
+ * @brief Gets the replacement combination of a key remapping command.
+ */
+extern const wbk_b_t *
+wbk_kc_remap_get_target(const wbk_kc_remap_t *kc_remap);
+
+#endif // WBK_KC_REMAP_H
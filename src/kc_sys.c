@@ -30,15 +30,98 @@
 
 #include "kc_sys.h"
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
+
+#if defined(WIN32)
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#endif
 
 #include "logger.h"
+#include "limit.h"
+#if !defined(WIN32)
+#include "launcher.h"
+#endif
+
+#if defined(WIN32)
+/**
+ * Runs commands which are no executables
+ */
+#define WBK_KC_SYS_SHELL "cmd.exe /c "
+
+/**
+ * Commands containing one of these characters are run by cmd.exe
+ */
+#define WBK_KC_SYS_SHELL_CHARS "&|<>()^%!\"\n"
+#else
+/**
+ * Commands containing one of these characters are run by a shell
+ */
+#define WBK_KC_SYS_SHELL_CHARS "|&;<>()$`\\\"'*?[]#~=%{}!\n"
+#endif
 
 static wbk_logger_t logger =  { "kc_sys" };
 
+#if defined(WIN32)
+/**
+ * Commands of cmd.exe, which are no executables
+ */
+static const char *WBK_KC_SYS_SHELL_CMDS[] = {
+	"assoc", "call", "cd", "chdir", "cls", "color", "copy", "date", "del", "dir",
+	"echo", "erase", "exit", "md", "mkdir", "mklink", "move", "popd", "pushd",
+	"rd", "ren", "rename", "rmdir", "set", "start", "time", "title", "type",
+	"ver", "vol", NULL
+};
+#endif
+
+/**
+ * A process to start on another thread
+ */
+typedef struct wbk_kc_sys_process_s
+{
+	/**
+	 * The executable or NULL to search it
+	 */
+	char *path;
+	char *cmd_line;
+
+	/**
+	 * The concurrency limit which admitted the process or NULL
+	 */
+	wbk_limit_t *limit;
+
+	wbk_caps_t caps;
+
+	/**
+	 * The output capture of the command or NULL. Retained by the process.
+	 */
+	wbk_capture_t *capture;
+} wbk_kc_sys_process_t;
+
+/**
+ * Creates a key binding system command with an already resolved executable.
+ */
+static wbk_kc_sys_t *
+wbk_kc_sys_new_with_exe(wbk_b_t *comb, char *cmd, wbk_exe_t *exe);
+
+/**
+ * Resolves the executable of a command.
+ *
+ * @param templated Non-0 if the % of the command are slots of a template,
+ *        which are expanded before a shell sees the command
+ * @return The executable or NULL if the command needs a shell or its
+ *         executable is a slot
+ */
+static wbk_exe_t *
+wbk_kc_sys_resolve(const char *cmd, int templated);
+
 /**
  * Implementation of wbk_kc_clone().
  *
@@ -72,15 +155,91 @@ wbk_kc_sys_get_cmd_impl(const wbk_kc_sys_t *kc_sys);
 static int
 wbk_kc_sys_exec_impl(const wbk_kc_t *kc);
 
+/**
+ * Implementation of wbk_kc_exec_key().
+ *
+ * @brief Execute the system command of a key binding system command. Its
+ * template is expanded with the passed key.
+ * @return Non-0 if the execution failed
+ */
+static int
+wbk_kc_sys_exec_key_impl(const wbk_kc_t *kc, char key);
+
+/**
+ * Implementation of wbk_kc_compare().
+ *
+ * Key binding system commands are equal if their commands are equal too.
+ */
+static int
+wbk_kc_sys_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_adopt().
+ *
+ * The concurrency limit and the output capture of other are shared, so its
+ * running processes are still counted and their output is kept.
+ */
+static int
+wbk_kc_sys_adopt_impl(wbk_kc_t *kc, const wbk_kc_t *other);
+
+/**
+ * Implementation of wbk_kc_to_str().
+ */
+static char *
+wbk_kc_sys_to_str_impl(const wbk_kc_t *kc);
+
+/**
+ * Creates a wbk_kc_sys_process_t.
+ *
+ * @param cmd The command as written in the rc file or its expansion
+ * @param prefix Is put in front of the command
+ */
+static wbk_kc_sys_process_t *
+wbk_kc_sys_process_new(const wbk_kc_sys_t *kc_sys, const char *cmd, const char *path,
+                       const char *prefix);
+
+static void
+wbk_kc_sys_process_free(wbk_kc_sys_process_t *process);
+
+/**
+ * Records the exit code of a wbk_kc_sys_process_t, releases its concurrency
+ * limit and frees it.
+ */
+static void
+wbk_kc_sys_done(void *param, int status);
+
+#if defined(WIN32)
+/**
+ * Creates the process of a wbk_kc_sys_process_t and frees it.
+ */
 static DWORD WINAPI
-wbk_kbthread_exec(LPVOID param);
+wbk_kbthread_create_process(LPVOID param);
+#else
+/**
+ * Runs the command of a wbk_kc_sys_process_t by a shell and frees it.
+ */
+static void *
+wbk_kbthread_exec(void *param);
+#endif
 
 wbk_kc_sys_t *
 wbk_kc_sys_new(wbk_b_t *comb, char *cmd)
+{
+	wbk_kc_sys_t *kc_sys;
+
+	kc_sys = wbk_kc_sys_new_with_exe(comb, cmd, NULL);
+	if (kc_sys) {
+		kc_sys->exe = wbk_kc_sys_resolve(cmd, kc_sys->tmpl != NULL);
+	}
+
+	return kc_sys;
+}
+
+wbk_kc_sys_t *
+wbk_kc_sys_new_with_exe(wbk_b_t *comb, char *cmd, wbk_exe_t *exe)
 {
   wbk_kc_t *kc;
 	wbk_kc_sys_t *kc_sys;
-	int length;
 
 	kc_sys = NULL;
 	kc_sys = malloc(sizeof(wbk_kc_sys_t));
@@ -94,20 +253,88 @@ wbk_kc_sys_new(wbk_b_t *comb, char *cmd)
     kc_sys->super_kc_clone = kc_sys->kc.kc_clone;
     kc_sys->super_kc_free = kc_sys->kc.kc_free;
     kc_sys->super_kc_exec = kc_sys->kc.kc_exec;
+    kc_sys->super_kc_compare = kc_sys->kc.kc_compare;
+    kc_sys->super_kc_to_str = kc_sys->kc.kc_to_str;
 
     kc_sys->kc.kc_clone = wbk_kc_sys_clone_impl;
     kc_sys->kc.kc_free = wbk_kc_sys_free_impl;
     kc_sys->kc.kc_exec = wbk_kc_sys_exec_impl;
+    kc_sys->kc.kc_exec_key = wbk_kc_sys_exec_key_impl;
+    kc_sys->kc.kc_compare = wbk_kc_sys_compare_impl;
+    kc_sys->kc.kc_adopt = wbk_kc_sys_adopt_impl;
+    kc_sys->kc.kc_to_str = wbk_kc_sys_to_str_impl;
     kc_sys->kc_sys_get_cmd = wbk_kc_sys_get_cmd_impl;
   }
 
 	if (kc_sys) {
 		kc_sys->cmd = cmd;
+		kc_sys->exe = exe;
+
+		/**
+		 * Commands without slots are executed as they are
+		 */
+		kc_sys->tmpl = strchr(cmd, '%') ? wbk_tmpl_new(cmd) : NULL;
+		if (kc_sys->tmpl && !wbk_tmpl_has_slots(kc_sys->tmpl)) {
+			wbk_tmpl_free(kc_sys->tmpl);
+			kc_sys->tmpl = NULL;
+		}
+		wbk_caps_init(&(kc_sys->caps));
 	}
 
 	return kc_sys;
 }
 
+wbk_exe_t *
+wbk_kc_sys_resolve(const char *cmd, int templated)
+{
+	char name[WBK_EXE_PATH_LEN];
+	int length;
+	int shell;
+	int i;
+	wbk_exe_t *exe;
+
+	/**
+	 * Only the surrounding quotes of the rc file are no shell syntax
+	 */
+	length = strlen(cmd);
+	if (length >= 2 && cmd[0] == '"' && cmd[length - 1] == '"') {
+		cmd++;
+		length -= 2;
+	}
+	shell = 0;
+	for (i = 0; i < length; i++) {
+		if (strchr(WBK_KC_SYS_SHELL_CHARS, cmd[i]) && (cmd[i] != '%' || !templated)) {
+			shell = 1;
+		}
+	}
+
+	cmd += strspn(cmd, " \t");
+	length = strcspn(cmd, " \t\"");
+
+	/**
+	 * A slot within the executable is only known once it is expanded
+	 */
+	exe = NULL;
+	if (!shell && length > 0 && length < WBK_EXE_PATH_LEN
+	    && !(templated && memchr(cmd, '%', length))) {
+		memcpy(name, cmd, sizeof(char) * length);
+		name[length] = '\0';
+
+#if defined(WIN32)
+		for (i = 0; WBK_KC_SYS_SHELL_CMDS[i] && _stricmp(WBK_KC_SYS_SHELL_CMDS[i], name); i++) {
+			/* Find the command of cmd.exe */
+		}
+		if (WBK_KC_SYS_SHELL_CMDS[i] == NULL) {
+			exe = wbk_exe_new(name);
+		}
+#else
+		exe = wbk_exe_new(name);
+#endif
+	}
+
+	return exe;
+}
+
 wbk_kc_t *
 wbk_kc_sys_clone_impl(const wbk_kc_t *super_other)
 {
@@ -127,7 +354,16 @@ wbk_kc_sys_clone_impl(const wbk_kc_t *super_other)
 		cmd = malloc(sizeof(char) * cmd_len);
 		memcpy(cmd, wbk_kc_sys_get_cmd(other), sizeof(char) * cmd_len);
 
-		kc_sys = wbk_kc_sys_new(comb, cmd);
+		kc_sys = wbk_kc_sys_new_with_exe(comb, cmd, other->exe ? wbk_exe_retain(other->exe) : NULL);
+		if (kc_sys && other->limit) {
+			wbk_kc_sys_set_limit(kc_sys, wbk_limit_retain(other->limit));
+		}
+		if (kc_sys) {
+			wbk_kc_sys_set_caps(kc_sys, &(other->caps));
+		}
+		if (kc_sys && other->capture) {
+			wbk_kc_sys_set_capture(kc_sys, wbk_capture_retain(other->capture));
+		}
 	}
 
 	return (wbk_kc_t *) kc_sys;
@@ -139,6 +375,48 @@ wbk_kc_sys_get_cmd(const wbk_kc_sys_t *kc_sys)
 	return kc_sys->kc_sys_get_cmd(kc_sys);
 }
 
+void
+wbk_kc_sys_set_limit(wbk_kc_sys_t *kc_sys, wbk_limit_t *limit)
+{
+	if (kc_sys->limit) {
+		wbk_limit_free(kc_sys->limit);
+	}
+	kc_sys->limit = limit;
+}
+
+wbk_limit_t *
+wbk_kc_sys_get_limit(const wbk_kc_sys_t *kc_sys)
+{
+	return kc_sys->limit;
+}
+
+void
+wbk_kc_sys_set_caps(wbk_kc_sys_t *kc_sys, const wbk_caps_t *caps)
+{
+	kc_sys->caps = *caps;
+}
+
+const wbk_caps_t *
+wbk_kc_sys_get_caps(const wbk_kc_sys_t *kc_sys)
+{
+	return &(kc_sys->caps);
+}
+
+void
+wbk_kc_sys_set_capture(wbk_kc_sys_t *kc_sys, wbk_capture_t *capture)
+{
+	if (kc_sys->capture) {
+		wbk_capture_free(kc_sys->capture);
+	}
+	kc_sys->capture = capture;
+}
+
+wbk_capture_t *
+wbk_kc_sys_get_capture(const wbk_kc_sys_t *kc_sys)
+{
+	return kc_sys->capture;
+}
+
 
 int
 wbk_kc_sys_free_impl(wbk_kc_t *kc)
@@ -150,6 +428,23 @@ wbk_kc_sys_free_impl(wbk_kc_t *kc)
   free(kc_sys->cmd);
 	kc_sys->cmd = NULL;
 
+	if (kc_sys->exe) {
+		wbk_exe_free(kc_sys->exe);
+		kc_sys->exe = NULL;
+	}
+	if (kc_sys->tmpl) {
+		wbk_tmpl_free(kc_sys->tmpl);
+		kc_sys->tmpl = NULL;
+	}
+	if (kc_sys->limit) {
+		wbk_limit_free(kc_sys->limit);
+		kc_sys->limit = NULL;
+	}
+	if (kc_sys->capture) {
+		wbk_capture_free(kc_sys->capture);
+		kc_sys->capture = NULL;
+	}
+
   kc_sys->super_kc_free(kc);
 
 	return 0;
@@ -161,22 +456,246 @@ wbk_kc_sys_get_cmd_impl(const wbk_kc_sys_t *kc_sys)
 	return kc_sys->cmd;
 }
 
+int
+wbk_kc_sys_compare_impl(const wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	const wbk_kc_sys_t *kc_sys;
+
+	kc_sys = (const wbk_kc_sys_t *) kc;
+
+	return kc_sys->super_kc_compare(kc, other)
+		   || strcmp(wbk_kc_sys_get_cmd(kc_sys),
+					 wbk_kc_sys_get_cmd((const wbk_kc_sys_t *) other))
+		   || wbk_limit_compare(kc_sys->limit, ((const wbk_kc_sys_t *) other)->limit)
+		   || wbk_caps_compare(&(kc_sys->caps), &(((const wbk_kc_sys_t *) other)->caps))
+		   || wbk_capture_compare(kc_sys->capture, ((const wbk_kc_sys_t *) other)->capture);
+}
+
+int
+wbk_kc_sys_adopt_impl(wbk_kc_t *kc, const wbk_kc_t *other)
+{
+	wbk_kc_sys_t *kc_sys;
+	const wbk_kc_sys_t *other_sys;
+
+	kc_sys = (wbk_kc_sys_t *) kc;
+	other_sys = (const wbk_kc_sys_t *) other;
+
+	if (other_sys->limit) {
+		wbk_kc_sys_set_limit(kc_sys, wbk_limit_retain(other_sys->limit));
+	}
+	if (other_sys->capture) {
+		wbk_kc_sys_set_capture(kc_sys, wbk_capture_retain(other_sys->capture));
+	}
+
+	return 0;
+}
+
+wbk_kc_sys_process_t *
+wbk_kc_sys_process_new(const wbk_kc_sys_t *kc_sys, const char *cmd, const char *path,
+                       const char *prefix)
+{
+	wbk_kc_sys_process_t *process;
+	int prefix_len;
+	int length;
+
+	process = malloc(sizeof(wbk_kc_sys_process_t));
+	memset(process, 0, sizeof(wbk_kc_sys_process_t));
+
+	if (path) {
+		process->path = malloc(sizeof(char) * (strlen(path) + 1));
+		strcpy(process->path, path);
+	}
+
+	/**
+	 * Shells get the command as written in the rc file
+	 */
+	length = strlen(cmd);
+	if (prefix == NULL && length >= 2 && cmd[0] == '"' && cmd[length - 1] == '"') {
+		cmd++;
+		length -= 2;
+	}
+	prefix_len = prefix ? strlen(prefix) : 0;
+	process->cmd_line = malloc(sizeof(char) * (prefix_len + length + 1));
+	if (prefix) {
+		memcpy(process->cmd_line, prefix, sizeof(char) * prefix_len);
+	}
+	memcpy(process->cmd_line + prefix_len, cmd, sizeof(char) * length);
+	process->cmd_line[prefix_len + length] = '\0';
+
+	process->limit = kc_sys->limit;
+	process->caps = kc_sys->caps;
+	process->capture = kc_sys->capture ? wbk_capture_retain(kc_sys->capture) : NULL;
+
+	return process;
+}
+
+void
+wbk_kc_sys_process_free(wbk_kc_sys_process_t *process)
+{
+	if (process->capture) {
+		wbk_capture_free(process->capture);
+	}
+	free(process->path);
+	free(process->cmd_line);
+	free(process);
+}
+
+void
+wbk_kc_sys_done(void *param, int status)
+{
+	wbk_kc_sys_process_t *process;
+
+	process = (wbk_kc_sys_process_t *) param;
+
+	if (process->capture) {
+		wbk_capture_exit(process->capture, status);
+	}
+	if (process->limit) {
+		wbk_limit_release(process->limit);
+	}
+
+	wbk_kc_sys_process_free(process);
+}
+
+#if defined(WIN32)
 DWORD WINAPI
-wbk_kbthread_exec(LPVOID param)
+wbk_kbthread_create_process(LPVOID param)
 {
-	char *cmd;
+	wbk_kc_sys_process_t *process;
+	STARTUPINFOEXA startup_info;
+	PROCESS_INFORMATION process_info;
+	SECURITY_ATTRIBUTES security;
+	SIZE_T size;
+	HANDLE output_read;
+	HANDLE output_write;
+	HANDLE job;
+	DWORD flags;
+	int captured;
+	DWORD error;
+
+	process = (wbk_kc_sys_process_t *) param;
+
+	memset(&startup_info, 0, sizeof(STARTUPINFOEXA));
+	startup_info.StartupInfo.cb = sizeof(STARTUPINFOA);
+	flags = CREATE_SUSPENDED;
+
+	/**
+	 * Only the write end of the pipe is inherited, thus it is closed once the
+	 * process and its children exited
+	 */
+	captured = 0;
+	security.nLength = sizeof(SECURITY_ATTRIBUTES);
+	security.lpSecurityDescriptor = NULL;
+	security.bInheritHandle = TRUE;
+	if (process->capture && CreatePipe(&output_read, &output_write, &security, 0)) {
+		SetHandleInformation(output_read, HANDLE_FLAG_INHERIT, 0);
+
+		size = 0;
+		InitializeProcThreadAttributeList(NULL, 1, 0, &size);
+		startup_info.lpAttributeList = malloc(size);
+		captured = startup_info.lpAttributeList
+		           && InitializeProcThreadAttributeList(startup_info.lpAttributeList, 1, 0, &size);
+		if (captured
+		    && !UpdateProcThreadAttribute(startup_info.lpAttributeList, 0,
+		                                  PROC_THREAD_ATTRIBUTE_HANDLE_LIST, &output_write,
+		                                  sizeof(HANDLE), NULL, NULL)) {
+			DeleteProcThreadAttributeList(startup_info.lpAttributeList);
+			captured = 0;
+		}
+
+		if (!captured) {
+			free(startup_info.lpAttributeList);
+			startup_info.lpAttributeList = NULL;
+			CloseHandle(output_read);
+			CloseHandle(output_write);
+		}
+	}
 
-	cmd = (char *) param;
+	if (captured) {
+		startup_info.StartupInfo.cb = sizeof(STARTUPINFOEXA);
+		startup_info.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+		startup_info.StartupInfo.hStdInput = NULL;
+		startup_info.StartupInfo.hStdOutput = output_write;
+		startup_info.StartupInfo.hStdError = output_write;
+		flags |= EXTENDED_STARTUPINFO_PRESENT;
+	} else if (process->capture) {
+		wbk_logger_log(&logger, WARNING, "Cannot capture output: %s\n", process->cmd_line);
+	}
 
-	return system(cmd);
+	/**
+	 * The process is put in its jobs before it runs, thus its children are
+	 * in them too
+	 */
+	error = !CreateProcessA(process->path, process->cmd_line, NULL, NULL, captured, flags,
+	                        NULL, NULL, &(startup_info.StartupInfo), &process_info);
+
+	if (captured) {
+		DeleteProcThreadAttributeList(startup_info.lpAttributeList);
+		free(startup_info.lpAttributeList);
+		CloseHandle(output_write);
+		if (error) {
+			CloseHandle(output_read);
+		} else {
+			wbk_capture_attach(process->capture, output_read);
+		}
+	}
+
+	if (error) {
+		wbk_logger_log(&logger, SEVERE, "Exec failed: %s\n", process->cmd_line);
+		wbk_kc_sys_done(process, -1);
+	} else {
+		job = wbk_caps_assign(&(process->caps), process_info.hProcess);
+		ResumeThread(process_info.hThread);
+		CloseHandle(process_info.hThread);
+
+		if (process->limit || process->capture || job) {
+			wbk_limit_track(process->limit, process_info.hProcess, job, process->caps.lifetime,
+			                wbk_kc_sys_done, process);
+		} else {
+			CloseHandle(process_info.hProcess);
+			wbk_kc_sys_process_free(process);
+		}
+	}
+
+	return error;
 }
+#else
+void *
+wbk_kbthread_exec(void *param)
+{
+	wbk_kc_sys_process_t *process;
+	int status;
+
+	process = (wbk_kc_sys_process_t *) param;
+
+	/**
+	 * Only the exit code is captured, the output goes where the output of
+	 * the daemon goes
+	 */
+	status = system(process->cmd_line);
+	if (status != -1) {
+		status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+	}
+
+	wbk_kc_sys_done(process, status);
+
+	return NULL;
+}
+#endif
 
 int
 wbk_kc_sys_exec_impl(const wbk_kc_t *kc)
+{
+	return wbk_kc_sys_exec_key_impl(kc, wbk_b_get_key(wbk_kc_get_binding(kc)));
+}
+
+int
+wbk_kc_sys_exec_key_impl(const wbk_kc_t *kc, char key)
 {
   const wbk_kc_sys_t *kc_sys;
 
   kc_sys = (const wbk_kc_sys_t *) kc;
+
 #ifdef DEBUG_ENABLED
 	char *binding;
 
@@ -186,20 +705,170 @@ wbk_kc_sys_exec_impl(const wbk_kc_t *kc)
 	binding = NULL;
 #endif
 
+	int created;
+	char path[WBK_EXE_PATH_LEN];
+	int resolved;
+	wbk_limit_admit_t admit;
+	wbk_kc_sys_process_t *process;
+	char expanded[WBK_TMPL_EXPAND_LEN];
+	char key_str[2];
+	const char *cmd;
+#if defined(WIN32)
 	HANDLE thread_handler;
+#else
+	pthread_t thread_handler;
+	pthread_attr_t attr;
+	wbk_launcher_t *launcher;
+	int output[2];
+#endif
 
-	thread_handler = CreateThread(NULL,
-					 0,
-					 wbk_kbthread_exec,
-					 kc_sys->cmd,
-					 0,
-					 NULL);
-	if (thread_handler) {
-		wbk_logger_log(&logger, INFO, "Exec: %s\n", kc_sys->cmd);
+	/**
+	 * Templates are expanded on the stack
+	 */
+	cmd = kc_sys->cmd;
+	if (kc_sys->tmpl) {
+		key_str[0] = key;
+		key_str[1] = '\0';
+		if (wbk_tmpl_expand(kc_sys->tmpl, key_str, expanded, WBK_TMPL_EXPAND_LEN) < 0) {
+			wbk_logger_log(&logger, SEVERE, "Expanded command is too long: %s\n", kc_sys->cmd);
+			return 1;
+		}
+		cmd = expanded;
+	}
+
+	admit = kc_sys->limit ? wbk_limit_acquire(kc_sys->limit) : WBK_LIMIT_ADMIT;
+	if (admit == WBK_LIMIT_DENY) {
+		wbk_logger_log(&logger, INFO, "Still running, skipped: %s\n", cmd);
+		return 0;
+	} else if (admit == WBK_LIMIT_ADMIT_RESTART) {
+		wbk_logger_log(&logger, INFO, "Restarting: %s\n", cmd);
+		wbk_limit_kill(kc_sys->limit);
+	}
+
+	resolved = kc_sys->exe && wbk_exe_get_path(kc_sys->exe, path, WBK_EXE_PATH_LEN) == 0;
+
+#if defined(WIN32)
+	/**
+	 * A resolved executable is created directly instead of searching it by
+	 * cmd.exe
+	 */
+	if (resolved) {
+		process = wbk_kc_sys_process_new(kc_sys, cmd, path, NULL);
 	} else {
-		wbk_logger_log(&logger, SEVERE, "Exec failed: %s\n", kc_sys->cmd);
+		process = wbk_kc_sys_process_new(kc_sys, cmd, NULL, WBK_KC_SYS_SHELL);
+	}
+
+	thread_handler = CreateThread(NULL, 0, wbk_kbthread_create_process, process, 0, NULL);
+	created = thread_handler != NULL;
+	if (created) {
+		CloseHandle(thread_handler);
+	} else {
+		wbk_kc_sys_process_free(process);
+	}
+#else
+	/**
+	 * Neither a thread nor a shell is needed, if a launcher starts the
+	 * process. A resolved executable is not searched again. Tracked
+	 * processes carry the concurrency limit and the output capture.
+	 */
+	launcher = wbk_launcher_get_default();
+	created = 0;
+	if (launcher) {
+		process = NULL;
+		if (kc_sys->limit || kc_sys->capture) {
+			process = wbk_kc_sys_process_new(kc_sys, cmd, NULL, NULL);
+		}
+
+		/**
+		 * The read end is attached first, thus the output precedes the exit
+		 * code even if the process exits at once
+		 */
+		output[1] = -1;
+		if (kc_sys->capture && pipe(output) == 0) {
+			fcntl(output[0], F_SETFD, FD_CLOEXEC);
+			fcntl(output[1], F_SETFD, FD_CLOEXEC);
+			fcntl(output[0], F_SETFL, fcntl(output[0], F_GETFL) | O_NONBLOCK);
+			wbk_capture_attach(kc_sys->capture, output[0]);
+		} else if (kc_sys->capture) {
+			wbk_logger_log(&logger, WARNING, "Cannot capture output: %s\n", cmd);
+		}
+
+		created = wbk_launcher_spawn_exe(launcher, resolved ? path : NULL, cmd,
+		                                 &(kc_sys->caps), kc_sys->limit, output[1],
+		                                 process ? wbk_kc_sys_done : NULL, process) == 0;
+
+		if (output[1] >= 0) {
+			close(output[1]);
+		}
+		if (!created && process) {
+			wbk_kc_sys_process_free(process);
+		}
+	}
+
+	/**
+	 * The shell of system() neither applies the priority nor the memory limit
+	 * nor the lifetime, thus such commands are not started at all
+	 */
+	if (!created && (kc_sys->caps.priority != WBK_CAPS_PRIORITY_DEFAULT
+	                 || kc_sys->caps.memory || kc_sys->caps.lifetime)) {
+		wbk_logger_log(&logger, SEVERE, "Cannot apply the caps without a launcher: %s\n",
+		               cmd);
+	} else if (!created) {
+		process = wbk_kc_sys_process_new(kc_sys, cmd, NULL, NULL);
+
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		created = !pthread_create(&thread_handler, &attr, wbk_kbthread_exec, process);
+		pthread_attr_destroy(&attr);
+
+		if (!created) {
+			wbk_kc_sys_process_free(process);
+		}
+	}
+#endif
+
+	if (created) {
+		wbk_logger_log(&logger, INFO, "Exec: %s\n", cmd);
+	} else {
+		wbk_logger_log(&logger, SEVERE, "Exec failed: %s\n", cmd);
+		if (kc_sys->limit) {
+			wbk_limit_release(kc_sys->limit);
+		}
 	}
 
 	return 0;
 }
 
+char *
+wbk_kc_sys_to_str_impl(const wbk_kc_t *kc)
+{
+	const wbk_kc_sys_t *kc_sys;
+	const char *cmd;
+	char *limit;
+	char *caps;
+	char *capture;
+	char *str;
+
+	kc_sys = (const wbk_kc_sys_t *) kc;
+
+	/**
+	 * The parsed command already contains its quotes. The options of the
+	 * concurrency limit, of the caps and of the output capture follow them
+	 * like in the rc file.
+	 */
+	cmd = wbk_kc_sys_get_cmd(kc_sys);
+	limit = kc_sys->limit ? wbk_limit_to_str(kc_sys->limit) : NULL;
+	caps = wbk_caps_to_str(&(kc_sys->caps));
+	capture = kc_sys->capture ? wbk_capture_to_str(kc_sys->capture) : NULL;
+
+	str = malloc(sizeof(char) * (strlen(cmd) + (limit ? strlen(limit) : 0) + (caps ? strlen(caps) : 0)
+	                             + (capture ? strlen(capture) : 0) + 4));
+	sprintf(str, "%s%s%s%s%s%s%s", cmd, limit ? " " : "", limit ? limit : "", caps ? " " : "",
+	        caps ? caps : "", capture ? " " : "", capture ? capture : "");
+
+	free(limit);
+	free(caps);
+	free(capture);
+
+	return str;
+}
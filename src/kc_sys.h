@@ -28,9 +28,24 @@
  * @brief File contains the key binding system command class definition
  *
  * wbk_kc_sys_t inherits all methods of wkb_kc_t (see kc.h).
+ *
+ * On platforms other than WIN32 the process is started by the default
+ * launcher (see launcher.h), if one is set.
+ *
+ * A concurrency limit (see limit.h) can restrict how many processes of the
+ * command run at once. Caps (see caps.h) restrict each of them. An output
+ * capture (see capture.h) keeps their latest output and exit codes.
+ *
+ * A command with slots like %key% is compiled into a template (see tmpl.h),
+ * which is expanded whenever the command is executed.
  */
 
 #include "kc.h"
+#include "exe.h"
+#include "limit.h"
+#include "caps.h"
+#include "capture.h"
+#include "tmpl.h"
 
 #ifndef WBK_KC_SYS_H
 #define WBK_KC_SYS_H
@@ -43,10 +58,37 @@ struct wbk_kc_sys_s
   wbk_kc_t *(*super_kc_clone)(const wbk_kc_t *other);
   int (*super_kc_free)(wbk_kc_t *kc);
   int (*super_kc_exec)(const wbk_kc_t *kc);
+  int (*super_kc_compare)(const wbk_kc_t *kc, const wbk_kc_t *other);
+  char *(*super_kc_to_str)(const wbk_kc_t *kc);
 
   const char *(*kc_sys_get_cmd)(const wbk_kc_sys_t *kc_sys);
 
 	char *cmd;
+
+	/**
+	 * The compiled command or NULL if it has no slot
+	 */
+	wbk_tmpl_t *tmpl;
+
+	/**
+	 * The executable of the command, resolved when the command was created.
+	 * NULL if the command needs a shell. Shared by the clones.
+	 */
+	wbk_exe_t *exe;
+
+	/**
+	 * The concurrency limit or NULL if the command may run any number of
+	 * times. Shared by the clones.
+	 */
+	wbk_limit_t *limit;
+
+	wbk_caps_t caps;
+
+	/**
+	 * The output capture or NULL if the output is not captured. Shared by the
+	 * clones.
+	 */
+	wbk_capture_t *capture;
 };
 
 /**
@@ -65,4 +107,46 @@ wbk_kc_sys_new(wbk_b_t *comb, char *cmd);
 extern const char *
 wbk_kc_sys_get_cmd(const wbk_kc_sys_t *kc_sys);
 
+/**
+ * @brief Sets the concurrency limit of a key binding system command.
+ * @param limit The concurrency limit or NULL. Its reference is taken over by
+ *        the key binding.
+ */
+extern void
+wbk_kc_sys_set_limit(wbk_kc_sys_t *kc_sys, wbk_limit_t *limit);
+
+/**
+ * @brief Gets the concurrency limit of a key binding system command.
+ * @return The concurrency limit or NULL if there is none
+ */
+extern wbk_limit_t *
+wbk_kc_sys_get_limit(const wbk_kc_sys_t *kc_sys);
+
+/**
+ * @brief Sets the caps of the processes of a key binding system command.
+ */
+extern void
+wbk_kc_sys_set_caps(wbk_kc_sys_t *kc_sys, const wbk_caps_t *caps);
+
+/**
+ * @brief Gets the caps of the processes of a key binding system command.
+ */
+extern const wbk_caps_t *
+wbk_kc_sys_get_caps(const wbk_kc_sys_t *kc_sys);
+
+/**
+ * @brief Sets the output capture of a key binding system command.
+ * @param capture The output capture or NULL. Its reference is taken over by
+ *        the key binding.
+ */
+extern void
+wbk_kc_sys_set_capture(wbk_kc_sys_t *kc_sys, wbk_capture_t *capture);
+
+/**
+ * @brief Gets the output capture of a key binding system command.
+ * @return The output capture or NULL if the output is not captured
+ */
+extern wbk_capture_t *
+wbk_kc_sys_get_capture(const wbk_kc_sys_t *kc_sys);
+
 #endif // WBK_KC_SYS_H
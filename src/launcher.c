@@ -0,0 +1,780 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the launcher class implementation and private methods
+ */
+
+#include "launcher.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "executor.h"
+#include "logger.h"
+
+/**
+ * Request to start a command
+ */
+#define WBK_LAUNCHER_SPAWN 'x'
+
+/**
+ * Request to set an environment variable
+ */
+#define WBK_LAUNCHER_SETENV 'e'
+
+/**
+ * Request to start a command with an already resolved executable
+ */
+#define WBK_LAUNCHER_SPAWN_EXE 'p'
+
+/**
+ * Request to terminate the processes tracked with a context
+ */
+#define WBK_LAUNCHER_KILL 'k'
+
+/**
+ * Report of the helper that a tracked process exited
+ */
+#define WBK_LAUNCHER_DONE 'd'
+
+/**
+ * Commands containing one of these characters are started by a shell
+ */
+#define WBK_LAUNCHER_SHELL_CHARS "|&;<>()$`\\\"'*?[]#~=%{}!\n"
+
+#define WBK_LAUNCHER_SHELL "/bin/sh"
+
+/**
+ * Starts a process with another nice value.
+ */
+#define WBK_LAUNCHER_NICE "nice"
+
+extern char **environ;
+
+/**
+ * Leads every request and report
+ */
+typedef struct wbk_launcher_header_s
+{
+	char type;
+	wbk_launcher_done_fn done;
+	void *ctx;
+	void *group;
+	wbk_caps_t caps;
+
+	/**
+	 * The exit code of a done report
+	 */
+	int status;
+} wbk_launcher_header_t;
+
+/**
+ * A started process of the helper. It leads its process group.
+ */
+typedef struct wbk_launcher_child_s
+{
+	pid_t pid;
+	wbk_launcher_done_fn done;
+	void *ctx;
+	void *group;
+
+	/**
+	 * When the lifetime is over (see wbk_executor_now()) or 0
+	 */
+	unsigned long deadline;
+	int detach;
+} wbk_launcher_child_t;
+
+static wbk_logger_t logger =  { "launcher" };
+
+static wbk_launcher_t *g_default_launcher = NULL;
+
+/**
+ * The end of the pipe the SIGCHLD handler of the helper writes to
+ */
+static int g_sigchld_fd = -1;
+
+/**
+ * Sends a request without blocking.
+ *
+ * @param fd A descriptor passed along with the request or -1
+ */
+static int
+wbk_launcher_request(wbk_launcher_t *launcher, const wbk_launcher_header_t *header,
+                     const char *str, int length, int fd);
+
+/**
+ * Receives a request within the helper process.
+ *
+ * @param fd Is set to the descriptor passed along with the request or -1
+ * @return The length of the request like recv()
+ */
+static ssize_t
+wbk_launcher_receive(int socket, char *request, int size, int *fd);
+
+/**
+ * Main loop of the reader thread. Calls the done callbacks reported by the
+ * helper.
+ */
+static void *
+wbk_launcher_read(void *param);
+
+/**
+ * Main loop of the helper process. Returns once the daemon closed its end of
+ * the socket pair.
+ */
+static void
+wbk_launcher_serve(int fd);
+
+/**
+ * Reaps the exited children of the helper and reports the tracked ones.
+ */
+static void
+wbk_launcher_reap(int fd, wbk_launcher_child_t *children, int *children_len);
+
+/**
+ * Kills the process groups whose lifetime is over.
+ *
+ * @return Milliseconds until the next lifetime is over or -1
+ */
+static int
+wbk_launcher_expire(wbk_launcher_child_t *children, int children_len);
+
+/**
+ * Wakes up the main loop of the helper.
+ */
+static void
+wbk_launcher_sigchld(int signal);
+
+/**
+ * Starts a command in a new process group within the helper process.
+ *
+ * @param path The executable to start or NULL to search it in PATH
+ * @param output The stdout and stderr of the process or -1 to inherit them
+ * @param pid Is set to the started process
+ */
+static int
+wbk_launcher_exec(const char *path, const char *cmd, const wbk_caps_t *caps, int output,
+                  pid_t *pid);
+
+/**
+ * Sets an environment variable within the helper process.
+ */
+static int
+wbk_launcher_putenv(const char *name_value);
+
+wbk_launcher_t *
+wbk_launcher_new(void)
+{
+	wbk_launcher_t *launcher;
+	int fds[2];
+	int error;
+
+	launcher = NULL;
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds)) {
+		wbk_logger_log(&logger, SEVERE, "Cannot create the socket pair of the launcher\n");
+	} else {
+		launcher = malloc(sizeof(wbk_launcher_t));
+		error = launcher == NULL;
+		if (!error) {
+			memset(launcher, 0, sizeof(wbk_launcher_t));
+
+			launcher->fd = fds[0];
+			launcher->pid = fork();
+			if (launcher->pid == 0) {
+				close(fds[0]);
+				wbk_launcher_serve(fds[1]);
+				_exit(0);
+			}
+			error = launcher->pid < 0;
+		}
+		close(fds[1]);
+
+		if (!error && pthread_create(&(launcher->reader), NULL, wbk_launcher_read, launcher)) {
+			/**
+			 * The helper exits, once it reads the end of the socket pair
+			 */
+			close(fds[0]);
+			waitpid(launcher->pid, NULL, 0);
+			error = 1;
+		} else if (error) {
+			close(fds[0]);
+		}
+
+		if (error) {
+			wbk_logger_log(&logger, SEVERE, "Cannot start the launcher\n");
+			free(launcher);
+			launcher = NULL;
+		}
+	}
+
+	return launcher;
+}
+
+int
+wbk_launcher_free(wbk_launcher_t *launcher)
+{
+	/**
+	 * The helper exits, once it reads the end of the socket pair. The reader
+	 * thread reads it too.
+	 */
+	shutdown(launcher->fd, SHUT_RDWR);
+	pthread_join(launcher->reader, NULL);
+	close(launcher->fd);
+	waitpid(launcher->pid, NULL, 0);
+
+	free(launcher);
+
+	return 0;
+}
+
+wbk_launcher_t *
+wbk_launcher_get_default(void)
+{
+	return __atomic_load_n(&g_default_launcher, __ATOMIC_ACQUIRE);
+}
+
+void
+wbk_launcher_set_default(wbk_launcher_t *launcher)
+{
+	__atomic_store_n(&g_default_launcher, launcher, __ATOMIC_RELEASE);
+}
+
+int
+wbk_launcher_spawn(wbk_launcher_t *launcher, const char *cmd)
+{
+	return wbk_launcher_spawn_exe(launcher, NULL, cmd, NULL, NULL, -1, NULL, NULL);
+}
+
+int
+wbk_launcher_spawn_exe(wbk_launcher_t *launcher, const char *path, const char *cmd,
+                       const wbk_caps_t *caps, void *group, int output,
+                       wbk_launcher_done_fn done, void *ctx)
+{
+	wbk_launcher_header_t header;
+	char str[WBK_LAUNCHER_REQUEST_LEN + 1];
+	int path_length;
+	int length;
+
+	length = strlen(cmd);
+	if (length >= 2 && cmd[0] == '"' && cmd[length - 1] == '"') {
+		cmd++;
+		length -= 2;
+	}
+
+	memset(&header, 0, sizeof(wbk_launcher_header_t));
+	header.type = path ? WBK_LAUNCHER_SPAWN_EXE : WBK_LAUNCHER_SPAWN;
+	header.done = done;
+	header.ctx = ctx;
+	header.group = group;
+	if (caps) {
+		header.caps = *caps;
+	} else {
+		wbk_caps_init(&(header.caps));
+	}
+
+	/**
+	 * Both strings are sent in one packet, separated by the terminating
+	 * character of the path
+	 */
+	path_length = path ? strlen(path) + 1 : 0;
+	if (path_length + length <= WBK_LAUNCHER_REQUEST_LEN) {
+		if (path) {
+			memcpy(str, path, sizeof(char) * path_length);
+		}
+		memcpy(str + path_length, cmd, sizeof(char) * length);
+	}
+
+	return wbk_launcher_request(launcher, &header, str, path_length + length, output);
+}
+
+int
+wbk_launcher_kill(wbk_launcher_t *launcher, void *group)
+{
+	wbk_launcher_header_t header;
+
+	memset(&header, 0, sizeof(wbk_launcher_header_t));
+	header.type = WBK_LAUNCHER_KILL;
+	header.group = group;
+	wbk_caps_init(&(header.caps));
+
+	return wbk_launcher_request(launcher, &header, NULL, 0, -1);
+}
+
+int
+wbk_launcher_setenv(wbk_launcher_t *launcher, const char *name_value)
+{
+	wbk_launcher_header_t header;
+
+	memset(&header, 0, sizeof(wbk_launcher_header_t));
+	header.type = WBK_LAUNCHER_SETENV;
+	wbk_caps_init(&(header.caps));
+
+	return wbk_launcher_request(launcher, &header, name_value, strlen(name_value), -1);
+}
+
+int
+wbk_launcher_request(wbk_launcher_t *launcher, const wbk_launcher_header_t *header,
+                     const char *str, int length, int fd)
+{
+	char request[sizeof(wbk_launcher_header_t) + WBK_LAUNCHER_REQUEST_LEN];
+	char control[CMSG_SPACE(sizeof(int))];
+	struct msghdr message;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	int size;
+	int error;
+
+	error = 0;
+	if (length > WBK_LAUNCHER_REQUEST_LEN) {
+		wbk_logger_log(&logger, WARNING, "Request is too long\n");
+		error = 1;
+	} else {
+		/**
+		 * A sequenced packet is sent as a whole, thus several threads may
+		 * send at once
+		 */
+		memcpy(request, header, sizeof(wbk_launcher_header_t));
+		if (length > 0) {
+			memcpy(request + sizeof(wbk_launcher_header_t), str, sizeof(char) * length);
+		}
+		size = sizeof(wbk_launcher_header_t) + length;
+
+		iov.iov_base = request;
+		iov.iov_len = size;
+		memset(&message, 0, sizeof(struct msghdr));
+		message.msg_iov = &iov;
+		message.msg_iovlen = 1;
+
+		/**
+		 * The descriptor is duplicated into the helper by the kernel
+		 */
+		if (fd >= 0) {
+			memset(control, 0, sizeof(control));
+			message.msg_control = control;
+			message.msg_controllen = sizeof(control);
+			cmsg = CMSG_FIRSTHDR(&message);
+			cmsg->cmsg_level = SOL_SOCKET;
+			cmsg->cmsg_type = SCM_RIGHTS;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+			memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+		}
+
+		error = sendmsg(launcher->fd, &message, MSG_DONTWAIT | MSG_NOSIGNAL) != size;
+	}
+
+	return error;
+}
+
+ssize_t
+wbk_launcher_receive(int socket, char *request, int size, int *fd)
+{
+	char control[CMSG_SPACE(sizeof(int))];
+	struct msghdr message;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	ssize_t length;
+
+	iov.iov_base = request;
+	iov.iov_len = size;
+	memset(&message, 0, sizeof(struct msghdr));
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	*fd = -1;
+	length = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+	if (length > 0) {
+		for (cmsg = CMSG_FIRSTHDR(&message); cmsg; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+			if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+				memcpy(fd, CMSG_DATA(cmsg), sizeof(int));
+			}
+		}
+	}
+
+	return length;
+}
+
+void *
+wbk_launcher_read(void *param)
+{
+	wbk_launcher_t *launcher;
+	wbk_launcher_header_t header;
+	ssize_t length;
+	int done;
+
+	launcher = (wbk_launcher_t *) param;
+
+	done = 0;
+	while (!done) {
+		length = recv(launcher->fd, &header, sizeof(wbk_launcher_header_t), 0);
+		if (length == sizeof(wbk_launcher_header_t)) {
+			if (header.type == WBK_LAUNCHER_DONE && header.done) {
+				header.done(header.ctx, header.status);
+			}
+		} else if (length == 0 || (length < 0 && errno != EINTR)) {
+			done = 1;
+		}
+	}
+
+	return NULL;
+}
+
+void
+wbk_launcher_serve(int fd)
+{
+	char request[sizeof(wbk_launcher_header_t) + WBK_LAUNCHER_REQUEST_LEN + 2];
+	wbk_launcher_header_t header;
+	const char *str;
+	wbk_launcher_child_t *children;
+	int children_len;
+	int children_size;
+	struct pollfd pfds[2];
+	struct sigaction action;
+	int pipe_fds[2];
+	int output;
+	char drain[64];
+	ssize_t length;
+	pid_t pid;
+	int timeout;
+	int i;
+	int done;
+
+	children = NULL;
+	children_len = 0;
+	children_size = 0;
+
+	/**
+	 * SIGCHLD wakes up the loop by a pipe, thus exits are reported at once
+	 * without polling
+	 */
+	pipe_fds[0] = -1;
+	if (pipe(pipe_fds) == 0) {
+		for (i = 0; i < 2; i++) {
+			fcntl(pipe_fds[i], F_SETFL, fcntl(pipe_fds[i], F_GETFL) | O_NONBLOCK);
+			fcntl(pipe_fds[i], F_SETFD, FD_CLOEXEC);
+		}
+		g_sigchld_fd = pipe_fds[1];
+
+		memset(&action, 0, sizeof(struct sigaction));
+		action.sa_handler = wbk_launcher_sigchld;
+		action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+		sigemptyset(&(action.sa_mask));
+		sigaction(SIGCHLD, &action, NULL);
+	}
+
+	done = 0;
+	while (!done) {
+		wbk_launcher_reap(fd, children, &children_len);
+		timeout = wbk_launcher_expire(children, children_len);
+
+		pfds[0].fd = fd;
+		pfds[0].events = POLLIN;
+		pfds[1].fd = pipe_fds[0];
+		pfds[1].events = POLLIN;
+		if (poll(pfds, 2, timeout) > 0) {
+			if (pfds[1].revents & POLLIN) {
+				while (read(pipe_fds[0], drain, sizeof(drain)) > 0) {
+					/* Drain the wake ups */
+				}
+			}
+
+			if (pfds[0].revents) {
+				length = wbk_launcher_receive(fd, request, sizeof(request) - 1, &output);
+				if (length >= (ssize_t) sizeof(wbk_launcher_header_t)) {
+					request[length] = '\0';
+					memcpy(&header, request, sizeof(wbk_launcher_header_t));
+					str = request + sizeof(wbk_launcher_header_t);
+
+					if (header.type == WBK_LAUNCHER_SPAWN || header.type == WBK_LAUNCHER_SPAWN_EXE) {
+						if (header.type == WBK_LAUNCHER_SPAWN) {
+							i = wbk_launcher_exec(NULL, str, &(header.caps), output, &pid);
+						} else {
+							i = wbk_launcher_exec(str, str + strlen(str) + 1, &(header.caps), output, &pid);
+						}
+
+						if (i && header.done) {
+							header.type = WBK_LAUNCHER_DONE;
+							header.status = -1;
+							send(fd, &header, sizeof(wbk_launcher_header_t), MSG_NOSIGNAL);
+						} else if (!i) {
+							if (children_len == children_size) {
+								children_size = children_size ? children_size * 2 : 16;
+								children = realloc(children, sizeof(wbk_launcher_child_t) * children_size);
+							}
+							children[children_len].pid = pid;
+							children[children_len].done = header.done;
+							children[children_len].ctx = header.ctx;
+							children[children_len].group = header.group;
+							children[children_len].deadline = header.caps.lifetime
+							                                  ? wbk_executor_now() + header.caps.lifetime
+							                                  : 0;
+							children[children_len].detach = header.caps.detach;
+							children_len++;
+						}
+					} else if (header.type == WBK_LAUNCHER_KILL) {
+						for (i = 0; i < children_len; i++) {
+							if (children[i].group == header.group) {
+								kill(-children[i].pid, SIGTERM);
+							}
+						}
+					} else if (header.type == WBK_LAUNCHER_SETENV) {
+						wbk_launcher_putenv(str);
+					}
+				} else if (length == 0 || (length < 0 && errno != EINTR)) {
+					done = 1;
+				}
+
+				/**
+				 * The started process has its own copy
+				 */
+				if (output >= 0) {
+					close(output);
+				}
+			}
+		}
+	}
+
+	/**
+	 * The daemon exited, thus its processes exit too
+	 */
+	for (i = 0; i < children_len; i++) {
+		if (!children[i].detach) {
+			kill(-children[i].pid, SIGTERM);
+		}
+	}
+
+	free(children);
+	close(fd);
+}
+
+void
+wbk_launcher_reap(int fd, wbk_launcher_child_t *children, int *children_len)
+{
+	wbk_launcher_header_t header;
+	pid_t pid;
+	int status;
+	int i;
+
+	while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+		for (i = 0; i < *children_len && children[i].pid != pid; i++) {
+			/* Find the started process */
+		}
+
+		if (i < *children_len) {
+			if (children[i].done) {
+				memset(&header, 0, sizeof(wbk_launcher_header_t));
+				header.type = WBK_LAUNCHER_DONE;
+				header.done = children[i].done;
+				header.ctx = children[i].ctx;
+				header.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+				send(fd, &header, sizeof(wbk_launcher_header_t), MSG_NOSIGNAL);
+			}
+
+			children[i] = children[--(*children_len)];
+		}
+	}
+}
+
+int
+wbk_launcher_expire(wbk_launcher_child_t *children, int children_len)
+{
+	unsigned long now;
+	int timeout;
+	int i;
+
+	now = wbk_executor_now();
+	timeout = -1;
+	for (i = 0; i < children_len; i++) {
+		if (children[i].deadline && (long) (children[i].deadline - now) <= 0) {
+			wbk_logger_log(&logger, INFO, "Lifetime of process %d is over\n", children[i].pid);
+			kill(-children[i].pid, SIGKILL);
+			children[i].deadline = 0;
+		} else if (children[i].deadline
+		           && (timeout < 0 || (int) (children[i].deadline - now) < timeout)) {
+			timeout = children[i].deadline - now;
+		}
+	}
+
+	return timeout;
+}
+
+void
+wbk_launcher_sigchld(int signal)
+{
+	int saved_errno;
+
+	saved_errno = errno;
+	write(g_sigchld_fd, "c", 1);
+	errno = saved_errno;
+}
+
+int
+wbk_launcher_exec(const char *path, const char *cmd, const wbk_caps_t *caps, int output,
+                  pid_t *pid)
+{
+	char copy[WBK_LAUNCHER_REQUEST_LEN + 1];
+	char *argv[WBK_LAUNCHER_ARGV_LEN + 4];
+	char increment[16];
+	char *rest;
+	char *token;
+	int argc;
+	posix_spawnattr_t attr;
+	posix_spawn_file_actions_t actions;
+	sigset_t sigset;
+	struct rlimit saved;
+	struct rlimit memory;
+	int current;
+	int error;
+
+	/**
+	 * Split plain commands into arguments. Everything else is left to the
+	 * shell.
+	 */
+	argc = 0;
+	if (strpbrk(cmd, WBK_LAUNCHER_SHELL_CHARS) == NULL) {
+		strcpy(copy, cmd);
+		rest = copy;
+		while (argc <= WBK_LAUNCHER_ARGV_LEN && (token = strtok_r(rest, " \t", &rest))) {
+			argv[argc++] = token;
+		}
+	}
+
+	if (argc == 0 || argc > WBK_LAUNCHER_ARGV_LEN) {
+		argv[0] = WBK_LAUNCHER_SHELL;
+		argv[1] = "-c";
+		argv[2] = (char *) cmd;
+		argc = 3;
+		path = NULL;
+	}
+	argv[argc] = NULL;
+
+	/**
+	 * The process must not run at the priority of the helper for a moment,
+	 * thus nice(1) sets it before the command is executed. The helper cannot
+	 * lower its own priority for the time the process is started, since it
+	 * may not raise it again. The pid stays the same.
+	 */
+	if (caps->priority != WBK_CAPS_PRIORITY_DEFAULT) {
+		errno = 0;
+		current = getpriority(PRIO_PROCESS, 0);
+		if (errno) {
+			current = 0;
+		}
+		sprintf(increment, "%d", wbk_caps_get_nice(caps) - current);
+
+		if (path) {
+			argv[0] = (char *) path;
+		}
+		memmove(argv + 3, argv, sizeof(char *) * (argc + 1));
+		argv[0] = WBK_LAUNCHER_NICE;
+		argv[1] = "-n";
+		argv[2] = increment;
+		argc += 3;
+		path = NULL;
+	}
+
+	posix_spawnattr_init(&attr);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP);
+	posix_spawnattr_setpgroup(&attr, 0);
+	sigemptyset(&sigset);
+	posix_spawnattr_setsigmask(&attr, &sigset);
+	sigaddset(&sigset, SIGPIPE);
+	sigaddset(&sigset, SIGCHLD);
+	posix_spawnattr_setsigdefault(&attr, &sigset);
+
+	/**
+	 * dup2() clears close-on-exec of the copies
+	 */
+	posix_spawn_file_actions_init(&actions);
+	if (output >= 0) {
+		posix_spawn_file_actions_adddup2(&actions, output, STDOUT_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, output, STDERR_FILENO);
+	}
+
+	/**
+	 * Resource limits are inherited, thus the helper sets the limit of the
+	 * process for the time it is started
+	 */
+	getrlimit(RLIMIT_AS, &saved);
+	if (caps->memory) {
+		memory = saved;
+		memory.rlim_cur = caps->memory < saved.rlim_max ? caps->memory : saved.rlim_max;
+		setrlimit(RLIMIT_AS, &memory);
+	}
+
+	if (path) {
+		error = posix_spawn(pid, path, &actions, &attr, argv, environ);
+	} else {
+		error = posix_spawnp(pid, argv[0], &actions, &attr, argv, environ);
+	}
+	if (error) {
+		wbk_logger_log(&logger, WARNING, "Exec failed: %s: %s\n", cmd, strerror(error));
+	}
+
+	if (caps->memory) {
+		setrlimit(RLIMIT_AS, &saved);
+	}
+
+	posix_spawn_file_actions_destroy(&actions);
+	posix_spawnattr_destroy(&attr);
+
+	return error;
+}
+
+int
+wbk_launcher_putenv(const char *name_value)
+{
+	char name[WBK_LAUNCHER_REQUEST_LEN + 1];
+	const char *value;
+	int error;
+
+	value = strchr(name_value, '=');
+	if (value && value != name_value) {
+		memcpy(name, name_value, sizeof(char) * (value - name_value));
+		name[value - name_value] = '\0';
+		value++;
+
+		error = value[0] == '\0' ? unsetenv(name) : setenv(name, value, 1);
+	} else {
+		error = 1;
+	}
+
+	return error;
+}
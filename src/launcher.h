@@ -0,0 +1,178 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the launcher class definition
+ *
+ * A launcher is a small helper process, which starts the processes of system
+ * commands (see kc_sys.h) on behalf of the daemon. The daemon sends a launch
+ * request over a socket pair and returns at once; it never forks itself,
+ * thus its hooks, threads and large tables are never copied. The helper
+ * starts a command by posix_spawnp() without a shell, unless the command
+ * uses shell syntax.
+ *
+ * The helper reaps its children once it gets SIGCHLD and reports the exit of
+ * tracked processes back to the daemon, where a reader thread calls their
+ * done callbacks.
+ *
+ * The stdout and stderr of a process can be redirected to a descriptor of the
+ * daemon, e.g. to the pipe of an output capture (see capture.h). It is passed
+ * to the helper along with the request.
+ *
+ * Every process is started in its own process group with the caps of its
+ * command (see caps.h). The helper kills the group once its lifetime is over
+ * and when the daemon exits, unless it is detached.
+ *
+ * The launcher needs fork(), thus it is not available on WIN32.
+ */
+
+#ifndef WBK_LAUNCHER_H
+#define WBK_LAUNCHER_H
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "caps.h"
+
+/**
+ * Maximum length of a request, i.e. of a command or of an environment
+ * variable
+ */
+#define WBK_LAUNCHER_REQUEST_LEN 4096
+
+/**
+ * Maximum number of arguments of a command started without a shell
+ */
+#define WBK_LAUNCHER_ARGV_LEN 64
+
+/**
+ * Called by the reader thread of the launcher once a tracked process exited
+ * or could not be started
+ *
+ * @param status The exit code, 128 plus the number of the signal which killed
+ *        the process or -1 if it could not be started
+ */
+typedef void (*wbk_launcher_done_fn)(void *ctx, int status);
+
+typedef struct wbk_launcher_s
+{
+	/**
+	 * The end of the socket pair of the daemon
+	 */
+	int fd;
+
+	/**
+	 * The helper process
+	 */
+	pid_t pid;
+
+	/**
+	 * Receives the exits of tracked processes
+	 */
+	pthread_t reader;
+} wbk_launcher_t;
+
+/**
+ * @brief Creates a new launcher and forks its helper process.
+ *
+ * Create it early, before other threads are started and before the rc file
+ * is loaded, so the helper is small and does not inherit locked mutexes.
+ *
+ * @return A new launcher or NULL if the helper could not be started
+ */
+extern wbk_launcher_t *
+wbk_launcher_new(void);
+
+/**
+ * @brief Stops the helper process and frees a launcher. Started processes
+ * keep running.
+ */
+extern int
+wbk_launcher_free(wbk_launcher_t *launcher);
+
+/**
+ * @brief Gets the launcher used by system commands.
+ * @return The launcher or NULL if system commands spawn by themselves
+ */
+extern wbk_launcher_t *
+wbk_launcher_get_default(void);
+
+/**
+ * @brief Sets the launcher used by system commands. It must outlive them.
+ */
+extern void
+wbk_launcher_set_default(wbk_launcher_t *launcher);
+
+/**
+ * @brief Requests to start a command. Returns at once without waiting for the
+ * process.
+ * @param cmd The command as written in the rc file. Surrounding quotes are
+ *        removed.
+ * @return Non-0 if the request could not be sent, e.g. because the helper
+ *         exited
+ */
+extern int
+wbk_launcher_spawn(wbk_launcher_t *launcher, const char *cmd);
+
+/**
+ * @brief Requests to start a command whose executable is already resolved.
+ * PATH is not searched again. Commands requiring a shell are started like by
+ * wbk_launcher_spawn().
+ * @param path The absolute path of the executable or NULL to search it in
+ *        PATH
+ * @param cmd The command as written in the rc file. Surrounding quotes are
+ *        removed.
+ * @param caps The caps of the process or NULL if it is restricted by nothing
+ * @param group Identifies the process for wbk_launcher_kill() or NULL
+ * @param output The stdout and stderr of the process or -1 to inherit them.
+ *        It is not closed.
+ * @param done Called with ctx once the process exited or could not be
+ *        started. NULL if the process is not tracked.
+ * @return Non-0 if the request could not be sent. done is not called then.
+ */
+extern int
+wbk_launcher_spawn_exe(wbk_launcher_t *launcher, const char *path, const char *cmd,
+                       const wbk_caps_t *caps, void *group, int output,
+                       wbk_launcher_done_fn done, void *ctx);
+
+/**
+ * @brief Requests to terminate the process groups started with a group.
+ * Their done callbacks are called once they exited.
+ * @return Non-0 if the request could not be sent
+ */
+extern int
+wbk_launcher_kill(wbk_launcher_t *launcher, void *group);
+
+/**
+ * @brief Sets an environment variable of the processes started afterwards.
+ * @param name_value NAME=value. An empty value removes the variable.
+ * @return Non-0 if the request could not be sent
+ */
+extern int
+wbk_launcher_setenv(wbk_launcher_t *launcher, const char *name_value);
+
+#endif // WBK_LAUNCHER_H
@@ -0,0 +1,341 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the concurrency limit class implementation and private methods
+ */
+
+#include "limit.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+#if !defined(WIN32)
+#include "launcher.h"
+#endif
+
+#if defined(WIN32)
+static wbk_logger_t logger =  { "limit" };
+
+/**
+ * A running process of a concurrency limit
+ */
+struct wbk_limit_process_s
+{
+	HANDLE process;
+
+	/**
+	 * The job of the process or NULL
+	 */
+	HANDLE job;
+
+	/**
+	 * The wait registered on process
+	 */
+	HANDLE wait;
+
+	wbk_limit_t *limit;
+
+	wbk_limit_done_fn done;
+	void *ctx;
+
+	wbk_limit_process_t *next;
+};
+
+/**
+ * Guards the wait handles of processes without concurrency limit
+ */
+static SRWLOCK g_limit_lock = SRWLOCK_INIT;
+
+/**
+ * Called by the thread pool once a tracked process exited or its lifetime is
+ * over.
+ */
+static VOID CALLBACK
+wbk_limit_exited(PVOID param, BOOLEAN timed_out);
+#endif
+
+wbk_limit_t *
+wbk_limit_new(wbk_limit_policy_t policy, int max)
+{
+	wbk_limit_t *limit;
+
+	limit = NULL;
+	limit = malloc(sizeof(wbk_limit_t));
+
+	if (limit) {
+		memset(limit, 0, sizeof(wbk_limit_t));
+
+		limit->refcount = 1;
+		limit->policy = policy;
+		limit->max = max > 0 ? max : 1;
+		limit->running = 0;
+
+#if defined(WIN32)
+		limit->processes = NULL;
+		InitializeSRWLock(&(limit->lock));
+#endif
+	}
+
+	return limit;
+}
+
+int
+wbk_limit_free(wbk_limit_t *limit)
+{
+	if (__atomic_sub_fetch(&(limit->refcount), 1, __ATOMIC_ACQ_REL) == 0) {
+		free(limit);
+	}
+
+	return 0;
+}
+
+wbk_limit_t *
+wbk_limit_retain(wbk_limit_t *limit)
+{
+	__atomic_add_fetch(&(limit->refcount), 1, __ATOMIC_RELAXED);
+
+	return limit;
+}
+
+wbk_limit_admit_t
+wbk_limit_acquire(wbk_limit_t *limit)
+{
+	wbk_limit_admit_t admit;
+	int running;
+
+	running = __atomic_load_n(&(limit->running), __ATOMIC_ACQUIRE);
+	do {
+		if (running < limit->max) {
+			admit = WBK_LIMIT_ADMIT;
+		} else if (limit->policy == WBK_LIMIT_RESTART) {
+			/**
+			 * The terminated processes are released once they exited
+			 */
+			admit = WBK_LIMIT_ADMIT_RESTART;
+		} else {
+			admit = WBK_LIMIT_DENY;
+		}
+	} while (admit != WBK_LIMIT_DENY
+	         && !__atomic_compare_exchange_n(&(limit->running), &running, running + 1, 0,
+	                                         __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+	if (admit != WBK_LIMIT_DENY) {
+		wbk_limit_retain(limit);
+	}
+
+	return admit;
+}
+
+void
+wbk_limit_release(wbk_limit_t *limit)
+{
+	__atomic_sub_fetch(&(limit->running), 1, __ATOMIC_ACQ_REL);
+	wbk_limit_free(limit);
+}
+
+#if defined(WIN32)
+void
+wbk_limit_kill(wbk_limit_t *limit)
+{
+	wbk_limit_process_t *process;
+
+	AcquireSRWLockExclusive(&(limit->lock));
+	for (process = limit->processes; process; process = process->next) {
+		if (process->job) {
+			TerminateJobObject(process->job, 1);
+		} else {
+			TerminateProcess(process->process, 1);
+		}
+	}
+	ReleaseSRWLockExclusive(&(limit->lock));
+}
+
+int
+wbk_limit_track(wbk_limit_t *limit, HANDLE process, HANDLE job, int lifetime,
+                wbk_limit_done_fn done, void *ctx)
+{
+	wbk_limit_process_t *tracked;
+	SRWLOCK *lock;
+	int error;
+
+	error = 1;
+	lock = limit ? &(limit->lock) : &g_limit_lock;
+	tracked = malloc(sizeof(wbk_limit_process_t));
+
+	if (tracked) {
+		memset(tracked, 0, sizeof(wbk_limit_process_t));
+		tracked->process = process;
+		tracked->job = job;
+		tracked->limit = limit;
+		tracked->done = done;
+		tracked->ctx = ctx;
+
+		/**
+		 * The callback takes the lock too, thus it sees the wait handle
+		 */
+		AcquireSRWLockExclusive(lock);
+		error = !RegisterWaitForSingleObject(&(tracked->wait), process, wbk_limit_exited, tracked,
+		                                     lifetime > 0 ? lifetime : INFINITE, WT_EXECUTEONLYONCE);
+		if (!error && limit) {
+			tracked->next = limit->processes;
+			limit->processes = tracked;
+		}
+		ReleaseSRWLockExclusive(lock);
+	}
+
+	if (error) {
+		wbk_logger_log(&logger, SEVERE, "Cannot wait for a process\n");
+		free(tracked);
+		if (job) {
+			CloseHandle(job);
+		}
+		CloseHandle(process);
+		if (done) {
+			done(ctx, -1);
+		}
+	}
+
+	return error;
+}
+
+VOID CALLBACK
+wbk_limit_exited(PVOID param, BOOLEAN timed_out)
+{
+	wbk_limit_process_t *tracked;
+	wbk_limit_process_t **link;
+	wbk_limit_t *limit;
+	SRWLOCK *lock;
+	DWORD status;
+
+	tracked = (wbk_limit_process_t *) param;
+	limit = tracked->limit;
+	lock = limit ? &(limit->lock) : &g_limit_lock;
+
+	AcquireSRWLockExclusive(lock);
+
+	/**
+	 * Does not block, which is required within the callback
+	 */
+	UnregisterWait(tracked->wait);
+
+	if (timed_out) {
+		/**
+		 * The lifetime is over. Wait for the exit of the terminated process.
+		 */
+		wbk_logger_log(&logger, INFO, "Lifetime of a process is over\n");
+		if (tracked->job) {
+			TerminateJobObject(tracked->job, 1);
+		} else {
+			TerminateProcess(tracked->process, 1);
+		}
+		RegisterWaitForSingleObject(&(tracked->wait), tracked->process, wbk_limit_exited, tracked,
+		                            INFINITE, WT_EXECUTEONLYONCE);
+	} else if (limit) {
+		for (link = &(limit->processes); *link != tracked; link = &((*link)->next)) {
+			/* Find the link to the process */
+		}
+		*link = tracked->next;
+	}
+
+	ReleaseSRWLockExclusive(lock);
+
+	if (!timed_out) {
+		if (!GetExitCodeProcess(tracked->process, &status)) {
+			status = (DWORD) -1;
+		}
+
+		if (tracked->job) {
+			CloseHandle(tracked->job);
+		}
+		CloseHandle(tracked->process);
+
+		if (tracked->done) {
+			tracked->done(tracked->ctx, (int) status);
+		}
+		free(tracked);
+	}
+}
+#else
+void
+wbk_limit_kill(wbk_limit_t *limit)
+{
+	wbk_launcher_t *launcher;
+
+	/**
+	 * The launcher knows the processes it started for the limit
+	 */
+	launcher = wbk_launcher_get_default();
+	if (launcher) {
+		wbk_launcher_kill(launcher, limit);
+	}
+}
+#endif
+
+int
+wbk_limit_get_running(wbk_limit_t *limit)
+{
+	return __atomic_load_n(&(limit->running), __ATOMIC_ACQUIRE);
+}
+
+int
+wbk_limit_compare(const wbk_limit_t *limit, const wbk_limit_t *other)
+{
+	int result;
+
+	if (limit == NULL || other == NULL) {
+		result = limit != other;
+	} else {
+		result = limit->policy != other->policy || limit->max != other->max;
+	}
+
+	return result;
+}
+
+char *
+wbk_limit_to_str(const wbk_limit_t *limit)
+{
+	char *str;
+
+	str = malloc(sizeof(char) * 48);
+
+	if (limit->policy == WBK_LIMIT_RESTART) {
+		if (limit->max == 1) {
+			strcpy(str, "restart");
+		} else {
+			sprintf(str, "max_concurrent=%d restart", limit->max);
+		}
+	} else if (limit->max == 1) {
+		strcpy(str, "skip-if-running");
+	} else {
+		sprintf(str, "max_concurrent=%d", limit->max);
+	}
+
+	return str;
+}
@@ -0,0 +1,206 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the concurrency limit class definition
+ *
+ * A concurrency limit counts the running processes of a key binding system
+ * command (see kc_sys.h) and decides whether triggering it again starts
+ * another process. It is written in the rc file after the command:
+ *
+ *     "firefox" skip-if-running
+ *     "xterm" max_concurrent=3
+ *     "status-bar" restart
+ *
+ * Admitting a trigger is a single compare and swap. A process is counted from
+ * its trigger until it exited; exits are reported by the launcher (see
+ * launcher.h) or, on WIN32, by a wait registered on the process handle. The
+ * same wait enforces the lifetime of the process (see caps.h).
+ *
+ * Limits are shared by the clones of a key binding command and by their
+ * running processes, thus they are reference counted.
+ */
+
+#ifndef WBK_LIMIT_H
+#define WBK_LIMIT_H
+
+#if defined(WIN32)
+#include <windows.h>
+#endif
+
+typedef enum wbk_limit_policy_e
+{
+	/**
+	 * Triggers are ignored while max processes are running
+	 */
+	WBK_LIMIT_SKIP,
+
+	/**
+	 * The running processes are terminated and the command is started again
+	 */
+	WBK_LIMIT_RESTART
+} wbk_limit_policy_t;
+
+typedef enum wbk_limit_admit_e
+{
+	/**
+	 * Start the process
+	 */
+	WBK_LIMIT_ADMIT,
+
+	/**
+	 * Do not start the process
+	 */
+	WBK_LIMIT_DENY,
+
+	/**
+	 * Terminate the running processes by wbk_limit_kill() and start the
+	 * process
+	 */
+	WBK_LIMIT_ADMIT_RESTART
+} wbk_limit_admit_t;
+
+#if defined(WIN32)
+typedef struct wbk_limit_process_s wbk_limit_process_t;
+
+/**
+ * Called by the thread pool once a tracked process exited
+ *
+ * @param status The exit code or -1 if the process cannot be tracked
+ */
+typedef void (*wbk_limit_done_fn)(void *ctx, int status);
+#endif
+
+typedef struct wbk_limit_s
+{
+	int refcount;
+
+	wbk_limit_policy_t policy;
+
+	/**
+	 * Maximum number of running processes
+	 */
+	int max;
+
+	/**
+	 * Number of admitted processes, which have not exited yet. Accessed
+	 * atomically.
+	 */
+	int running;
+
+#if defined(WIN32)
+	/**
+	 * The tracked processes, guarded by lock
+	 */
+	wbk_limit_process_t *processes;
+	SRWLOCK lock;
+#endif
+} wbk_limit_t;
+
+/**
+ * @brief Creates a new concurrency limit
+ * @param max Maximum number of running processes. At least 1.
+ * @return A new concurrency limit or NULL if allocation failed
+ */
+extern wbk_limit_t *
+wbk_limit_new(wbk_limit_policy_t policy, int max);
+
+/**
+ * @brief Releases a reference. The last one frees the concurrency limit.
+ */
+extern int
+wbk_limit_free(wbk_limit_t *limit);
+
+/**
+ * @brief Adds a reference.
+ * @return The concurrency limit
+ */
+extern wbk_limit_t *
+wbk_limit_retain(wbk_limit_t *limit);
+
+/**
+ * @brief Decides whether a trigger starts a process. Lock free.
+ *
+ * Admitting counts the process and adds a reference, which
+ * wbk_limit_release() removes once the process exited or failed to start.
+ */
+extern wbk_limit_admit_t
+wbk_limit_acquire(wbk_limit_t *limit);
+
+/**
+ * @brief Uncounts an admitted process and releases its reference.
+ */
+extern void
+wbk_limit_release(wbk_limit_t *limit);
+
+/**
+ * @brief Terminates the running processes of a concurrency limit. Processes
+ * which are still being started are not terminated.
+ */
+extern void
+wbk_limit_kill(wbk_limit_t *limit);
+
+#if defined(WIN32)
+/**
+ * @brief Tracks a process until it exits, closes its handles and calls done
+ * then, which releases it from its concurrency limit.
+ * @param limit The concurrency limit which admitted the process or NULL if
+ *        the process is only watched
+ * @param process The handle of the process. It is closed once the process
+ *        exited.
+ * @param job The job of the process (see caps.h) or NULL. It is terminated
+ *        instead of the process and closed once the process exited.
+ * @param lifetime Milliseconds after which the process is terminated or 0
+ * @param done Called with ctx once the process exited or NULL
+ * @return Non-0 if the process cannot be tracked. done is called at once.
+ */
+extern int
+wbk_limit_track(wbk_limit_t *limit, HANDLE process, HANDLE job, int lifetime,
+                wbk_limit_done_fn done, void *ctx);
+#endif
+
+/**
+ * @brief Gets the number of processes admitted and not exited yet.
+ */
+extern int
+wbk_limit_get_running(wbk_limit_t *limit);
+
+/**
+ * @brief Compares two concurrency limits. NULL means unlimited.
+ * @return 0 if both have the same policy and maximum
+ */
+extern int
+wbk_limit_compare(const wbk_limit_t *limit, const wbk_limit_t *other);
+
+/**
+ * @brief Gets the options of a concurrency limit as written in the rc file,
+ * e.g. "max_concurrent=2 restart". Free it by yourself.
+ */
+extern char *
+wbk_limit_to_str(const wbk_limit_t *limit);
+
+#endif // WBK_LIMIT_H
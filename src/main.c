@@ -30,6 +30,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <windows.h>
 #include <getopt.h>
 #include <unistd.h>
@@ -39,26 +40,41 @@
 #include "util.h"
 #include "datafinder.h"
 #include "kbman.h"
+#include "kbtable.h"
 #include "kc.h"
 #include "parser.h"
 #include "kbdaemon.h"
+#include "fwatch.h"
+#include "ctl.h"
+#include "instance.h"
+#include "sink_win32.h"
+#include "executor.h"
+#include "kc_builtin.h"
 
 #define WBK_RC ".w32bindkeysrc"
 
 #define WBK_DEFAULTS_RC "w32bindkeysrc"
 
-#define WBK_GETOPT_OPTIONS "dhvV"
+#define WBK_GETOPT_OPTIONS "c:dhvV"
 
 #define WBK_WINDOW_CLASSNAME "wbkWindowClass"
 
 #define WBK_KBDAEMON_ARR_LEN 30
 
+/**
+ * Number of tries to hand over to a running instance and the milliseconds
+ * between them. The running instance might still be starting up.
+ */
+#define WBK_HANDOFF_TRIES 10
+#define WBK_HANDOFF_INTERVAL 200
+
 static struct option WBK_GETOPT_LONG_OPTIONS[] = {
     /*   NAME          ARGUMENT           FLAG  SHORTNAME */
         {"help",       no_argument,       NULL, 'h'},
         {"verbose",    no_argument,       NULL, 'v'},
         {"version",    no_argument,       NULL, 'V'},
         {"defaults",   no_argument,       NULL, 'd'},
+        {"config",     required_argument, NULL, 'c'},
         {NULL,         0,                 NULL, 0}
     };
 
@@ -66,7 +82,32 @@ static wbk_logger_t logger = { "main" };
 
 static HWND g_window_handler;
 static wbk_kbdaemon_t **g_kbdaemon_arr = NULL;
-static wbk_kbman_t **g_kbman_arr = NULL;
+
+/**
+ * Holds the parsed key board managers. The i-th keyboard daemon executes the
+ * i-th split key board manager.
+ */
+static wbk_kbtable_t *g_kbtable = NULL;
+
+/**
+ * Reloads g_kbtable whenever the rc file changes.
+ */
+static wbk_fwatch_t *g_fwatch = NULL;
+
+/**
+ * Lets other processes manage g_kbtable at runtime.
+ */
+static wbk_ctl_t *g_ctl = NULL;
+
+/**
+ * Emits the key strokes of remapping bindings.
+ */
+static wbk_sink_win32_t *g_sink = NULL;
+
+/**
+ * Runs macros off the hook threads.
+ */
+static wbk_executor_t *g_executor = NULL;
 
 static int
 print_version(void);
@@ -78,11 +119,40 @@ static int
 print_defaults(const wbk_datafinder_t *datafinder);
 
 static int
-parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder);
+parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder,
+                   const char *config);
+
+/**
+ * Passes the command line to the running instance instead of starting a
+ * second one. Without a config the running instance reloads its rc file.
+ */
+static int
+handoff(const char *config);
 
 static int
 kbdaemon_exec_fn(wbk_kbdaemon_t *kbdaemon, wbk_b_t *b);
 
+static int
+rc_change_fn(wbk_fwatch_t *fwatch, void *param);
+
+/**
+ * Built-in action "@reload". Reloads the rc file.
+ */
+static int
+builtin_reload_fn(const char *arg, void *param);
+
+/**
+ * Built-in action "@quit". Terminates the daemon.
+ */
+static int
+builtin_quit_fn(const char *arg, void *param);
+
+/**
+ * Watches the rc file loaded by a "config" control request instead.
+ */
+static int
+ctl_config_fn(wbk_ctl_t *ctl, const char *filename, void *param);
+
 BOOL WINAPI
 ctrl_proc(_In_ DWORD ctrl_type);
 
@@ -92,6 +162,9 @@ main_window_proc(HWND window_handler, UINT msg, WPARAM wParam, LPARAM lParam);
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
 	wbk_datafinder_t *datafinder;
+	wbk_instance_t *instance;
+	char *instance_name;
+	char *config;
 	int ret;
 	char exec;
 	LPWSTR *wargv;
@@ -106,6 +179,7 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 
 	datafinder = wbk_datafinder_new(PKGDATADIR);
 	exec = 1;
+	config = NULL;
 
 	wargv = CommandLineToArgvW(GetCommandLineW(), &argc);
 	if (wargv) {
@@ -142,6 +216,12 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 				exec = 0;
 				break;
 
+			case 'c':
+				free(config);
+				config = malloc(sizeof(char) * (strlen(optarg) + 1));
+				strcpy(config, optarg);
+				break;
+
 			case 'h':
 			default:
 				ret = print_help(argv[0]);
@@ -154,9 +234,22 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
 	}
 
 	if (exec) {
-		ret = parameterized_main(hInstance, datafinder);
+		/**
+		 * A second instance would install all keyboard hooks again and
+		 * execute every command twice.
+		 */
+		instance_name = wbk_instance_default_name();
+		instance = wbk_instance_new(instance_name);
+		if (wbk_instance_acquire(instance)) {
+			ret = handoff(config);
+		} else {
+			ret = parameterized_main(hInstance, datafinder, config);
+		}
+		wbk_instance_free(instance);
+		free(instance_name);
 	}
 
+	free(config);
 	wbk_datafinder_free(datafinder);
 
 	return ret;
@@ -178,8 +271,10 @@ print_help(const char *cmd_name)
 	fprintf(stdout, "  where options are:\n");
 	fprintf(stdout, "  -V, --version          Print version and exit\n");
 	fprintf(stdout, "  -d, --defaults         Print a default rc file\n");
+	fprintf(stdout, "  -c, --config FILE      Use FILE instead of ~/%s\n", WBK_RC);
 	fprintf(stdout, "  -v, --verbose          More information on %s when it runs\n", PACKAGE);
 	fprintf(stdout, "  -h, --help             This help!\n");
+	fprintf(stdout, "If %s is already running, it reloads its rc file or switches to FILE.\n", PACKAGE);
 
 	return 0;
 }
@@ -200,14 +295,74 @@ print_defaults(const wbk_datafinder_t *datafinder)
 }
 
 int
-parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder)
+handoff(const char *config)
+{
+	char *address;
+	char *path;
+	char *request;
+	char *response;
+	int error;
+	int i;
+
+	error = 0;
+	request = NULL;
+	response = NULL;
+
+	if (config) {
+		/**
+		 * The running instance has got another working directory
+		 */
+		path = wbk_path_absolute(config);
+		if (path) {
+			request = malloc(sizeof(char) * (strlen(path) + 9));
+			sprintf(request, "config %s\n", path);
+			free(path);
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Could not find %s\n", config);
+			error = 1;
+		}
+	} else {
+		request = malloc(sizeof(char) * 8);
+		strcpy(request, "reload\n");
+	}
+
+	if (!error) {
+		address = wbk_ctl_default_address();
+
+		error = wbk_ctl_send(address, request, &response);
+		for (i = 1; error && response[0] == '\0' && i < WBK_HANDOFF_TRIES; i++) {
+			free(response);
+			Sleep(WBK_HANDOFF_INTERVAL);
+			error = wbk_ctl_send(address, request, &response);
+		}
+
+		if (error) {
+			wbk_logger_log(&logger, SEVERE, "%s is already running, but did not accept the request: %s",
+			               PACKAGE, response[0] ? response : "no response\n");
+		} else {
+			wbk_logger_log(&logger, INFO, "%s is already running, handed over: %s",
+			               PACKAGE, request);
+		}
+
+		free(response);
+		free(address);
+	}
+
+	free(request);
+
+	return error;
+}
+
+int
+parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder,
+                   const char *config)
 {
 	int error;
 	char *rc_filename;
 	char *defaults_rc_filename;
+	char *ctl_address;
 	FILE *rc_file;
 	wbk_parser_t *parser;
-	wbk_kbman_t *kbman;
 	int i;
 	WNDCLASSEX wc;
 	MSG msg;
@@ -216,7 +371,7 @@ parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder)
 	rc_filename = NULL;
 	rc_file = NULL;
 	parser = NULL;
-	kbman = NULL;
+	ctl_address = NULL;
 
 	g_kbdaemon_arr = malloc(sizeof(wbk_kbdaemon_t **) * WBK_KBDAEMON_ARR_LEN);
 
@@ -246,7 +401,12 @@ parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder)
 	}
 
 	if (!error) {
-		rc_filename = wbk_path_from_home(WBK_RC);
+		if (config) {
+			rc_filename = malloc(sizeof(char) * (strlen(config) + 1));
+			strcpy(rc_filename, config);
+		} else {
+			rc_filename = wbk_path_from_home(WBK_RC);
+		}
 		if(access(rc_filename, F_OK)) {
 			/**
 			 * Create WBK_RC by WBK_DEFAULTS_RC
@@ -273,12 +433,20 @@ parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder)
 	}
 
 	if (!error) {
-		kbman = wbk_parser_parse(parser);
-		if (kbman) {
-			g_kbman_arr = wbk_kbman_split(kbman, WBK_KBDAEMON_ARR_LEN);
+		g_sink = wbk_sink_win32_new();
+		wbk_sink_set_default((wbk_sink_t *) g_sink);
+
+		g_executor = wbk_executor_new();
+		wbk_executor_set_default(g_executor);
 
-			wbk_kbman_free(kbman);
-			kbman = NULL;
+		wbk_builtin_register("reload", builtin_reload_fn, NULL);
+		wbk_builtin_register("quit", builtin_quit_fn, NULL);
+	}
+
+	if (!error) {
+		g_kbtable = wbk_kbtable_new(parser, WBK_KBDAEMON_ARR_LEN);
+		if (g_kbtable) {
+			error = wbk_kbtable_load(g_kbtable);
 		} else {
 			error = 1;
 		}
@@ -295,6 +463,26 @@ parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder)
 		}
 	}
 
+	if (!error) {
+		g_fwatch = wbk_fwatch_new(rc_filename, WBK_FWATCH_DEBOUNCE, rc_change_fn, NULL);
+		if (g_fwatch == NULL || wbk_fwatch_start(g_fwatch)) {
+			wbk_logger_log(&logger, WARNING, "Changes of %s are not reloaded automatically\n",
+			               rc_filename);
+		}
+	}
+
+	if (!error) {
+		ctl_address = wbk_ctl_default_address();
+		g_ctl = wbk_ctl_new(ctl_address, g_kbtable);
+		if (g_ctl) {
+			wbk_ctl_set_config_fn(g_ctl, ctl_config_fn, NULL);
+		}
+		if (g_ctl == NULL || wbk_ctl_start(g_ctl)) {
+			wbk_logger_log(&logger, WARNING, "Could not serve control requests on %s\n",
+			               ctl_address);
+		}
+	}
+
 	if (!error) {
 		while (GetMessage(&msg, NULL, 0, 0) > 0) {
 			TranslateMessage(&msg);
@@ -307,8 +495,13 @@ parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder)
 		free(rc_filename);
 	}
 
-	if (parser) {
-		wbk_parser_free(parser);
+	if (ctl_address) {
+		free(ctl_address);
+	}
+
+	if (g_ctl) {
+		wbk_ctl_free(g_ctl);
+		g_ctl = NULL;
 	}
 
 	if (g_kbdaemon_arr) {
@@ -323,15 +516,30 @@ parameterized_main(HINSTANCE hInstance, const wbk_datafinder_t *datafinder)
 		g_kbdaemon_arr = NULL;
 	}
 
-	if (g_kbman_arr) {
-		for (i = 0; i < WBK_KBDAEMON_ARR_LEN; i++) {
-			if (g_kbman_arr[i]) {
-				wbk_kbman_free(g_kbman_arr[i]);
-				g_kbman_arr[i] = NULL;
-			}
-		}
-		free(g_kbman_arr);
-		g_kbman_arr = NULL;
+	if (g_fwatch) {
+		wbk_fwatch_free(g_fwatch);
+		g_fwatch = NULL;
+	}
+
+	if (g_kbtable) {
+		wbk_kbtable_free(g_kbtable);
+		g_kbtable = NULL;
+	}
+
+	if (g_executor) {
+		wbk_executor_set_default(NULL);
+		wbk_executor_free(g_executor);
+		g_executor = NULL;
+	}
+
+	if (g_sink) {
+		wbk_sink_set_default(NULL);
+		wbk_sink_free((wbk_sink_t *) g_sink);
+		g_sink = NULL;
+	}
+
+	if (parser) {
+		wbk_parser_free(parser);
 	}
 
 	return error;
@@ -344,11 +552,51 @@ kbdaemon_exec_fn(wbk_kbdaemon_t *kbdaemon, wbk_b_t *b)
 
   for (i = 0; i < WBK_KBDAEMON_ARR_LEN; i++) {
     if (kbdaemon == g_kbdaemon_arr[i])
-      return wbk_kbman_exec(g_kbman_arr[i], b);
+      return wbk_kbtable_exec(g_kbtable, i, b);
   }
   return 1;
 }
 
+int
+rc_change_fn(wbk_fwatch_t *fwatch, void *param)
+{
+	return wbk_kbtable_reload(g_kbtable);
+}
+
+int
+builtin_reload_fn(const char *arg, void *param)
+{
+	return wbk_kbtable_reload(g_kbtable);
+}
+
+int
+builtin_quit_fn(const char *arg, void *param)
+{
+	return !PostMessage(g_window_handler, WM_CLOSE, (WPARAM) NULL, (LPARAM) NULL);
+}
+
+int
+ctl_config_fn(wbk_ctl_t *ctl, const char *filename, void *param)
+{
+	wbk_fwatch_t *fwatch;
+
+	/**
+	 * g_fwatch is only used by the main thread after g_ctl has been freed
+	 */
+	fwatch = wbk_fwatch_new(filename, WBK_FWATCH_DEBOUNCE, rc_change_fn, NULL);
+	if (fwatch == NULL || wbk_fwatch_start(fwatch)) {
+		wbk_logger_log(&logger, WARNING, "Changes of %s are not reloaded automatically\n",
+		               filename);
+	}
+
+	if (g_fwatch) {
+		wbk_fwatch_free(g_fwatch);
+	}
+	g_fwatch = fwatch;
+
+	return 0;
+}
+
 LRESULT CALLBACK
 main_window_proc(HWND window_handler, UINT msg, WPARAM wParam, LPARAM lParam)
 {
@@ -0,0 +1,324 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the minimal perfect hash class implementation and private methods
+ */
+
+#include "mph.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bscan.h"
+#include "logger.h"
+
+#define WBK_MPH_KEY_WORDS (WBK_B_KEY_MAP_LEN / 64)
+
+static wbk_logger_t logger =  { "mph" };
+
+/**
+ * Finalizer of MurmurHash3. Every bit of x affects every bit of the result.
+ */
+static uint64_t
+wbk_mph_mix(uint64_t x);
+
+static int
+wbk_mph_bucket(const wbk_mph_t *mph, uint64_t hash);
+
+static int
+wbk_mph_slot(const wbk_mph_t *mph, uint64_t hash, uint32_t pilot);
+
+/**
+ * Searches the pilot of each bucket and fills the values of the slots.
+ *
+ * @param hashes The hash of each binding
+ * @param members The positions of the bindings ordered by bucket
+ * @param starts The start of each bucket within members. starts[pilots_len]
+ *        is len.
+ * @param order The buckets, largest first
+ * @return Non-0 if no pilot was found for a bucket
+ */
+static int
+wbk_mph_place(wbk_mph_t *mph, const uint64_t *hashes, const int *values,
+              const int *members, const int *starts, const int *order);
+
+wbk_mph_t *
+wbk_mph_new(const wbk_b_t **b_arr, const int *values, int len)
+{
+	wbk_mph_t *mph;
+	uint64_t *hashes;
+	int *members;
+	int *starts;
+	int *order;
+	int *counts;
+	int max_size;
+	int error;
+	int bucket;
+	int size;
+	int i;
+
+	mph = NULL;
+	mph = malloc(sizeof(wbk_mph_t));
+
+	hashes = NULL;
+	members = NULL;
+	starts = NULL;
+	order = NULL;
+	counts = NULL;
+
+	error = mph == NULL;
+	if (!error) {
+		mph->len = len;
+		mph->pilots_len = len / WBK_MPH_BUCKET_SIZE + 1;
+		mph->pilots = calloc(mph->pilots_len, sizeof(uint32_t));
+		mph->values = malloc(sizeof(int) * (len > 0 ? len : 1));
+
+		hashes = malloc(sizeof(uint64_t) * (len > 0 ? len : 1));
+		members = malloc(sizeof(int) * (len > 0 ? len : 1));
+		starts = calloc(mph->pilots_len + 1, sizeof(int));
+		order = malloc(sizeof(int) * mph->pilots_len);
+
+		error = !mph->pilots || !mph->values || !hashes || !members || !starts || !order;
+	}
+
+	/**
+	 * Groups the bindings by bucket
+	 */
+	max_size = 0;
+	for (i = 0; !error && i < len; i++) {
+		hashes[i] = wbk_mph_hash(b_arr[i]);
+		starts[wbk_mph_bucket(mph, hashes[i]) + 1]++;
+	}
+	for (i = 0; !error && i < mph->pilots_len; i++) {
+		if (starts[i + 1] > max_size) {
+			max_size = starts[i + 1];
+		}
+		starts[i + 1] += starts[i];
+	}
+
+	if (!error) {
+		counts = calloc(max_size + 2, sizeof(int));
+		error = counts == NULL;
+	}
+
+	if (!error) {
+		/**
+		 * Fills the buckets in order. starts[bucket] is moved to the end of
+		 * the bucket meanwhile and restored afterwards.
+		 */
+		for (i = 0; i < len; i++) {
+			bucket = wbk_mph_bucket(mph, hashes[i]);
+			members[starts[bucket]++] = i;
+		}
+		for (i = mph->pilots_len; i > 0; i--) {
+			starts[i] = starts[i - 1];
+		}
+		starts[0] = 0;
+
+		/**
+		 * Orders the buckets by size, largest first (counting sort)
+		 */
+		memset(counts, 0, sizeof(int) * (max_size + 2));
+		for (i = 0; i < mph->pilots_len; i++) {
+			size = starts[i + 1] - starts[i];
+			counts[max_size - size + 1]++;
+		}
+		for (i = 0; i < max_size + 1; i++) {
+			counts[i + 1] += counts[i];
+		}
+		for (i = 0; i < mph->pilots_len; i++) {
+			size = starts[i + 1] - starts[i];
+			order[counts[max_size - size]++] = i;
+		}
+
+		error = wbk_mph_place(mph, hashes, values, members, starts, order);
+	}
+
+	free(hashes);
+	free(members);
+	free(starts);
+	free(order);
+	free(counts);
+
+	if (error && mph) {
+		wbk_mph_free(mph);
+		mph = NULL;
+	}
+
+	return mph;
+}
+
+int
+wbk_mph_free(wbk_mph_t *mph)
+{
+	free(mph->pilots);
+	mph->pilots = NULL;
+
+	free(mph->values);
+	mph->values = NULL;
+
+	free(mph);
+
+	return 0;
+}
+
+int
+wbk_mph_find(const wbk_mph_t *mph, const wbk_b_t *b)
+{
+	uint64_t hash;
+	int value;
+
+	value = -1;
+	if (mph->len > 0) {
+		hash = wbk_mph_hash(b);
+		value = mph->values[wbk_mph_slot(mph, hash, mph->pilots[wbk_mph_bucket(mph, hash)])];
+	}
+
+	return value;
+}
+
+uint64_t
+wbk_mph_hash(const wbk_b_t *b)
+{
+	uint64_t words[WBK_MPH_KEY_WORDS];
+	uint64_t bytes;
+	uint64_t hash;
+	int i;
+
+	/**
+	 * The key map holds 0 or 1 per key. The multiplication gathers bit 0 of 8
+	 * bytes into the top byte.
+	 */
+	memset(words, 0, sizeof(words));
+	for (i = 0; i < WBK_B_KEY_MAP_LEN; i += 8) {
+		memcpy(&bytes, b->key_map + i, sizeof(uint64_t));
+		words[i / 64] |= (((bytes & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56)
+		                 << (i % 64);
+	}
+
+	/**
+	 * Bits 48 ... 55 of the packed modifiers are free for the key range
+	 */
+	hash = wbk_mph_mix(wbk_bscan_pack(b) | (uint64_t) (unsigned char) b->key_last << 48);
+	hash = wbk_mph_mix(hash ^ b->ignore_mask);
+	for (i = 0; i < WBK_MPH_KEY_WORDS; i++) {
+		hash = wbk_mph_mix(hash ^ words[i]);
+	}
+
+	return hash;
+}
+
+uint64_t
+wbk_mph_mix(uint64_t x)
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+
+	return x;
+}
+
+int
+wbk_mph_bucket(const wbk_mph_t *mph, uint64_t hash)
+{
+	return (int) ((hash >> 32) % (uint32_t) mph->pilots_len);
+}
+
+int
+wbk_mph_slot(const wbk_mph_t *mph, uint64_t hash, uint32_t pilot)
+{
+	return (int) (wbk_mph_mix(hash ^ ((uint64_t) pilot * 0x9e3779b97f4a7c15ULL))
+	              % (uint64_t) mph->len);
+}
+
+int
+wbk_mph_place(wbk_mph_t *mph, const uint64_t *hashes, const int *values,
+              const int *members, const int *starts, const int *order)
+{
+	char *taken;
+	int slots[64];
+	int *slot_arr;
+	int error;
+	int placed;
+	uint32_t pilot;
+	int bucket;
+	int size;
+	int i;
+	int j;
+	int k;
+
+	taken = calloc(mph->len > 0 ? mph->len : 1, sizeof(char));
+	slot_arr = slots;
+	error = taken == NULL;
+
+	for (i = 0; !error && i < mph->pilots_len; i++) {
+		bucket = order[i];
+		size = starts[bucket + 1] - starts[bucket];
+		if (size > 64 && slot_arr == slots) {
+			slot_arr = malloc(sizeof(int) * size);
+			error = slot_arr == NULL;
+		}
+
+		placed = size == 0;
+		for (pilot = 0; !error && !placed && pilot < WBK_MPH_MAX_PILOT; pilot++) {
+			placed = 1;
+			for (k = 0; placed && k < size; k++) {
+				slot_arr[k] = wbk_mph_slot(mph, hashes[members[starts[bucket] + k]], pilot);
+				if (taken[slot_arr[k]]) {
+					placed = 0;
+					for (j = 0; j < k; j++) {
+						taken[slot_arr[j]] = 0;
+					}
+				} else {
+					taken[slot_arr[k]] = 1;
+				}
+			}
+
+			if (placed) {
+				mph->pilots[bucket] = pilot;
+				for (k = 0; k < size; k++) {
+					mph->values[slot_arr[k]] = values[members[starts[bucket] + k]];
+				}
+			}
+		}
+
+		if (!placed) {
+			wbk_logger_log(&logger, WARNING, "No pilot found for a bucket of %d bindings\n", size);
+			error = 1;
+		}
+	}
+
+	if (slot_arr != slots) {
+		free(slot_arr);
+	}
+	free(taken);
+
+	return error;
+}
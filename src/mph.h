@@ -0,0 +1,106 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the minimal perfect hash class definition
+ *
+ * A minimal perfect hash maps a fixed set of n bindings onto the slots 0 ...
+ * n - 1 without collisions (hash and displace). The bindings are hashed into
+ * buckets of about WBK_MPH_BUCKET_SIZE. Each bucket gets a pilot, which is
+ * searched when the hash is built, largest buckets first, until all bindings
+ * of the bucket land in free slots.
+ *
+ * A lookup is one hash of the binding, one pilot and one slot. The slot holds
+ * the value of the only binding which may match; the caller verifies it. It
+ * suits the bindings of a loaded rc file, which do not change until the next
+ * reload.
+ */
+
+#ifndef WBK_MPH_H
+#define WBK_MPH_H
+
+#include <stdint.h>
+
+#include "b.h"
+
+/**
+ * Average number of bindings per bucket
+ */
+#define WBK_MPH_BUCKET_SIZE 4
+
+/**
+ * Pilots tried per bucket before building fails
+ */
+#define WBK_MPH_MAX_PILOT (1 << 24)
+
+typedef struct wbk_mph_s
+{
+	/**
+	 * Number of bindings and slots
+	 */
+	int len;
+
+	int pilots_len;
+	uint32_t *pilots;
+
+	/**
+	 * The value of the binding of each slot
+	 */
+	int *values;
+} wbk_mph_t;
+
+/**
+ * @brief Builds a minimal perfect hash
+ * @param b_arr The bindings. No binding may be equal to another one by
+ *        wbk_b_compare().
+ * @param values The value of each binding
+ * @return A new minimal perfect hash or NULL if allocation failed or no pilot
+ *         was found for a bucket
+ */
+extern wbk_mph_t *
+wbk_mph_new(const wbk_b_t **b_arr, const int *values, int len);
+
+extern int
+wbk_mph_free(wbk_mph_t *mph);
+
+/**
+ * @brief Finds the only binding which may be equal to b
+ * @return The value of the binding or -1 if the hash is empty. Compare the
+ *         binding of the value with b yourself.
+ */
+extern int
+wbk_mph_find(const wbk_mph_t *mph, const wbk_b_t *b);
+
+/**
+ * @brief Hashes the canonical form of a binding: its modifiers, trigger, key
+ * range, ignored modifiers and keys packed into 6 words. Bindings being equal by
+ * wbk_b_compare() produce the same hash.
+ */
+extern uint64_t
+wbk_mph_hash(const wbk_b_t *b);
+
+#endif // WBK_MPH_H
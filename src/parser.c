@@ -30,8 +30,43 @@
 #include "logger.h"
 #include "util.h"
 #include "kc_sys.h"
+#include "kc_mode.h"
+#include "kc_remap.h"
+#include "kc_macro.h"
+#include "kc_builtin.h"
+#include "kc_ipc.h"
 #include "parser.h"
 
+/**
+ * Commands starting with this prefix switch the mode instead of executing a
+ * system command. Example: "@mode resize"
+ */
+#define WBK_PARSER_MODE_CMD "@mode"
+
+/**
+ * Commands starting with this prefix emit the key strokes of another
+ * combination. Example: "@remap Left"
+ */
+#define WBK_PARSER_REMAP_CMD "@remap"
+
+/**
+ * Commands starting with this prefix type a sequence of combinations, delays
+ * and text. Example: "@macro control + c; wait 50; type hello"
+ */
+#define WBK_PARSER_MACRO_CMD "@macro"
+
+/**
+ * Commands starting with this prefix send a message to a long running
+ * consumer. Example: "@ipc /tmp/wm.sock focus left"
+ */
+#define WBK_PARSER_IPC_CMD "@ipc"
+
+/**
+ * Commands starting with this prefix followed by the name of a registered
+ * action run the action (see kc_builtin.h). Example: "@reload"
+ */
+#define WBK_PARSER_BUILTIN_PREFIX '@'
+
 static wbk_logger_t logger =  { "parser" };
 
 typedef enum parser_state_s {
@@ -49,8 +84,90 @@ parse_cmd(FILE *file);
 static wbk_mk_t
 parse_token(const char *token);
 
+/**
+ * Parses the trigger of a binding like: hold + control + a
+ *
+ * @return Non-0 if the token is not a trigger.
+ */
+static int
+parse_trigger(const char *token, wbk_trigger_t *trigger);
+
+/**
+ * Parses a key range of a binding like: mod4 + [1-9]
+ *
+ * @return Non-0 if the token is not a key range.
+ */
+static int
+parse_key_range(const char *token, char *first, char *last);
+
+/**
+ * Parses the Any modifier of a binding like: any + f1
+ *
+ * @return Non-0 if the token is not Any.
+ */
+static int
+parse_any(const char *token);
+
+/**
+ * @return The rest of the current line without comments. Free it by yourself.
+ */
+static char *
+parse_line(FILE *file, int first_character);
+
+/**
+ * Parses a mode declaration like: mode "resize" {
+ *
+ * @param mode Is set to the name of the declared mode or NULL if the
+ *             declaration is malformed. Free it by yourself.
+ * @return Non-0 if the line is a mode declaration.
+ */
+static int
+parse_mode(const char *line, char **mode);
+
 static wbk_b_t *
-parse_binding(FILE *file, int first_character);
+parse_binding(const char *line);
+
+/**
+ * Creates the key binding command for a parsed binding and command.
+ *
+ * @param binding Will be freed by the key binding command.
+ * @param cmd Will be freed by the key binding command or by this function.
+ */
+static wbk_kc_t *
+parse_kc(wbk_kbman_t *kbman, wbk_b_t *binding, char *cmd);
+
+/**
+ * Parses the options written after the closing quote of a command, like:
+ * "firefox" skip-if-running
+ *
+ * @param cmd Is cut after its closing quote.
+ * @param limit Is set to the concurrency limit of the options or NULL if
+ *              there is none.
+ * @param caps Is set to the process caps of the options.
+ * @param capture Is set to the output capture of the options or NULL if
+ *                there is none.
+ * @return Non-0 if the command has options.
+ */
+static int
+parse_kc_options(char *cmd, wbk_limit_t **limit, wbk_caps_t *caps, wbk_capture_t **capture);
+
+/**
+ * @param start The command after its prefix, e.g. " resize\"" of "@mode resize"
+ * @return The argument of the command without quotes and surrounding white
+ *         spaces. Free it by yourself.
+ */
+static char *
+parse_kc_arg(const char *start);
+
+/**
+ * @param start The command without its opening quote, e.g. "@mode resize\""
+ * @param name_len The length of the name of the command after its prefix
+ * @param name A command like "@mode"
+ * @return Non-0 if the command is not name. Longer names like "@modes" are
+ *         other commands.
+ */
+static int
+parse_kc_cmd(const char *start, int name_len, const char *name);
 
 wbk_parser_t *
 wbk_parser_new(const char *filename)
@@ -63,7 +180,7 @@ wbk_parser_new(const char *filename)
 	memset(parser, 0, sizeof(wbk_parser_t));
 
 	if (parser != NULL) {
-		length = strlen(filename);
+		length = strlen(filename) + 1;
 		parser->filename = malloc(sizeof(char) * length);
 
 		if (parser->filename != NULL) {
@@ -74,6 +191,35 @@ wbk_parser_new(const char *filename)
 	return parser;
 }
 
+wbk_b_t *
+wbk_parser_parse_binding(const char *line)
+{
+	return parse_binding(line);
+}
+
+int
+wbk_parser_parse_be(const char *token, wbk_be_t *be)
+{
+	int error;
+
+	error = 0;
+
+	if (token[0] == '\0') {
+		error = 1;
+	} else {
+		be->modifier = parse_token(token);
+		be->key = be->modifier == NOT_A_MODIFIER ? token[0] : '\0';
+	}
+
+	return error;
+}
+
+wbk_kc_t *
+wbk_parser_parse_kc(wbk_kbman_t *kbman, wbk_b_t *binding, char *cmd)
+{
+	return parse_kc(kbman, binding, cmd);
+}
+
 int
 wbk_parser_free(wbk_parser_t *parser)
 {
@@ -92,9 +238,12 @@ wbk_parser_parse(wbk_parser_t *parser)
 	FILE *file;
 	int character;
 	char *cmd;
+	char *line;
+	char *mode;
+	char *new_mode;
 	wbk_b_t *binding;
 	wbk_kbman_t *kbman;
-	wbk_kc_sys_t *kc;
+	wbk_kc_t *kc;
 
 	wbk_logger_log(&logger, INFO, "Using config: %s\n", wbk_parser_get_filename(parser));
 
@@ -106,6 +255,7 @@ wbk_parser_parse(wbk_parser_t *parser)
 		kbman = wbk_kbman_new();
 		cmd = NULL;
 		binding = NULL;
+		mode = NULL;
 		do {
 			character = fgetc(file);
 
@@ -118,22 +268,60 @@ wbk_parser_parse(wbk_parser_t *parser)
 				parse_comment(file);
 			} else if (character == ' ' ||
 					   character == '\t' ||
-					   character == '\n') {
+					   character == '\n' ||
+					   character == '{') {
+			} else if (character == '}') {
+				parse_comment(file);
+				if (mode) {
+					wbk_logger_log(&logger, INFO, "End of mode: %s\n", mode);
+					free(mode);
+					mode = NULL;
+				} else {
+					wbk_logger_log(&logger, SEVERE, "Closing a mode without opening one\n");
+				}
 			} else if (character != EOF) {
-				if (binding) {
-					wbk_b_free(binding);
+				line = parse_line(file, character);
+				if (parse_mode(line, &new_mode)) {
+					if (new_mode) {
+						if (mode) {
+							wbk_logger_log(&logger, SEVERE, "Modes cannot be nested: %s\n", new_mode);
+							free(mode);
+						}
+						wbk_kbman_add_mode(kbman, new_mode);
+						mode = new_mode;
+					}
+				} else {
+					if (binding) {
+						wbk_b_free(binding);
+					}
+					binding = parse_binding(line);
 				}
-				binding = parse_binding(file, character);
+				free(line);
 			}
 
 			if (cmd != NULL && binding != NULL) {
-				kc = wbk_kc_sys_new(binding, cmd);
-				wbk_kbman_add(kbman, (wbk_kc_t *)kc);
+				kc = parse_kc(kbman, binding, cmd);
+				if (kc) {
+					wbk_kbman_add_to_mode(kbman, mode ? mode : WBK_KBMAN_DEFAULT_MODE, kc);
+				}
 				kc = NULL;
 				cmd = NULL;
 				binding = NULL;
 			}
 		} while (character != EOF);
+
+		if (mode) {
+			wbk_logger_log(&logger, SEVERE, "Mode is not closed: %s\n", mode);
+			free(mode);
+		}
+		if (cmd) {
+			free(cmd);
+		}
+		if (binding) {
+			wbk_b_free(binding);
+		}
+
+		fclose(file);
 	} else {
 		wbk_logger_log(&logger, SEVERE, "Could not read config: %s\n", wbk_parser_get_filename(parser));
 	}
@@ -147,6 +335,25 @@ wbk_parser_get_filename(wbk_parser_t *parser)
 	return parser->filename;
 }
 
+int
+wbk_parser_set_filename(wbk_parser_t *parser, const char *filename)
+{
+	char *copy;
+	int error;
+
+	error = 1;
+	copy = malloc(sizeof(char) * (strlen(filename) + 1));
+
+	if (copy != NULL) {
+		strcpy(copy, filename);
+		free(parser->filename);
+		parser->filename = copy;
+		error = 0;
+	}
+
+	return error;
+}
+
 void
 parse_comment(FILE *file)
 {
@@ -240,26 +447,43 @@ parse_token(const char *token)
 		copy[i] = (char) tolower(copy[i]); // TODO
 	}
 
-	if (strcmp(copy, "release") == 0) {
-		modifier_key = ENTER;
-	} else if (strcmp(copy,  "control") == 0) {
+	if (strcmp(copy,  "control") == 0 || strcmp(copy, "ctrl") == 0) {
 		modifier_key = CTRL;
 	} else if (strcmp(copy,  "shift") == 0) {
 		modifier_key = SHIFT;
+	} else if (strcmp(copy, "lcontrol") == 0 || strcmp(copy, "lctrl") == 0) {
+		modifier_key = LCTRL;
+	} else if (strcmp(copy, "rcontrol") == 0 || strcmp(copy, "rctrl") == 0) {
+		modifier_key = RCTRL;
+	} else if (strcmp(copy, "lshift") == 0) {
+		modifier_key = LSHIFT;
+	} else if (strcmp(copy, "rshift") == 0) {
+		modifier_key = RSHIFT;
+	} else if (strcmp(copy, "lmod1") == 0 || strcmp(copy, "lalt") == 0) {
+		modifier_key = LALT;
+	} else if (strcmp(copy, "rmod1") == 0 || strcmp(copy, "ralt") == 0
+	           || strcmp(copy, "altgr") == 0) {
+		modifier_key = RALT;
+	} else if (strcmp(copy, "lmod4") == 0 || strcmp(copy, "lwin") == 0) {
+		modifier_key = LWIN;
+	} else if (strcmp(copy, "rmod4") == 0 || strcmp(copy, "rwin") == 0) {
+		modifier_key = RWIN;
 	} else if (strcmp(copy,  "mod1") == 0) {
 		modifier_key = ALT;
-	} else if (strcmp(copy,  "mod2") == 0) {
+	} else if (strcmp(copy,  "mod2") == 0 || strcmp(copy, "numlock") == 0) {
 		modifier_key = NUMLOCK;
-	} else if (strcmp(copy,  "mod3") == 0) {
+	} else if (strcmp(copy,  "mod3") == 0 || strcmp(copy, "capslock") == 0) {
 		modifier_key = CAPSLOCK;
 	} else if (strcmp(copy,  "mod4") == 0) {
 		modifier_key = WIN;
-	} else if (strcmp(copy,  "mod5") == 0) {
+	} else if (strcmp(copy,  "mod5") == 0 || strcmp(copy, "scroll") == 0) {
 		modifier_key = SCROLL;
 	} else if (strcmp(copy, "return") == 0) {
 		modifier_key = ENTER;
 	} else if (strcmp(copy, "space") == 0) {
 		modifier_key = SPACE;
+	} else if (strcmp(copy, "escape") == 0 || strcmp(copy, "esc") == 0) {
+		modifier_key = ESCAPE;
 	} else if (strcmp(copy,  "f1") == 0) {
 		modifier_key = F1;
 	} else if (strcmp(copy,  "f2") == 0) {
@@ -284,6 +508,32 @@ parse_token(const char *token)
 		modifier_key = F11;
 	} else if (strcmp(copy,  "f12") == 0) {
 		modifier_key = F12;
+	} else if (strcmp(copy, "b:1") == 0 || strcmp(copy, "mouse-left") == 0) {
+		modifier_key = MOUSE_LEFT;
+	} else if (strcmp(copy, "b:2") == 0 || strcmp(copy, "mouse-middle") == 0) {
+		modifier_key = MOUSE_MIDDLE;
+	} else if (strcmp(copy, "b:3") == 0 || strcmp(copy, "mouse-right") == 0) {
+		modifier_key = MOUSE_RIGHT;
+	} else if (strcmp(copy, "b:4") == 0 || strcmp(copy, "wheel-up") == 0) {
+		modifier_key = WHEEL_UP;
+	} else if (strcmp(copy, "b:5") == 0 || strcmp(copy, "wheel-down") == 0) {
+		modifier_key = WHEEL_DOWN;
+	} else if (strcmp(copy, "b:6") == 0 || strcmp(copy, "wheel-left") == 0) {
+		modifier_key = WHEEL_LEFT;
+	} else if (strcmp(copy, "b:7") == 0 || strcmp(copy, "wheel-right") == 0) {
+		modifier_key = WHEEL_RIGHT;
+	} else if (strcmp(copy, "b:8") == 0 || strcmp(copy, "mouse-back") == 0) {
+		modifier_key = MOUSE_BACK;
+	} else if (strcmp(copy, "b:9") == 0 || strcmp(copy, "mouse-forward") == 0) {
+		modifier_key = MOUSE_FORWARD;
+	} else if (strcmp(copy, "left") == 0) {
+		modifier_key = LEFT;
+	} else if (strcmp(copy, "right") == 0) {
+		modifier_key = RIGHT;
+	} else if (strcmp(copy, "up") == 0) {
+		modifier_key = UP;
+	} else if (strcmp(copy, "down") == 0) {
+		modifier_key = DOWN;
 	} else {
 		modifier_key = NOT_A_MODIFIER;
 	}
@@ -293,20 +543,70 @@ parse_token(const char *token)
 	return modifier_key;
 }
 
-wbk_b_t *
-parse_binding(FILE *file, int first_character)
+int
+parse_trigger(const char *token, wbk_trigger_t *trigger)
+{
+	char copy[8];
+	int error;
+	int i;
+
+	error = 0;
+
+	for (i = 0; token[i] != '\0' && i < (int) sizeof(copy) - 1; i++) {
+		copy[i] = (char) tolower(token[i]);
+	}
+	copy[i] = '\0';
+
+	if (token[i] != '\0') {
+		error = 1;
+	} else if (strcmp(copy, "tap") == 0) {
+		*trigger = TRIGGER_TAP;
+	} else if (strcmp(copy, "hold") == 0) {
+		*trigger = TRIGGER_HOLD;
+	} else if (strcmp(copy, "double") == 0) {
+		*trigger = TRIGGER_DOUBLE_TAP;
+	} else if (strcmp(copy, "chord") == 0) {
+		*trigger = TRIGGER_CHORD;
+	} else if (strcmp(copy, "release") == 0) {
+		*trigger = TRIGGER_RELEASE;
+	} else {
+		error = 1;
+	}
+
+	return error;
+}
+
+int
+parse_key_range(const char *token, char *first, char *last)
+{
+	int error;
+
+	error = 1;
+	if (token[0] == '[' && token[1] != '\0' && token[2] == '-'
+	    && token[3] != '\0' && token[4] == ']' && token[5] == '\0'
+	    && (unsigned char) token[1] < (unsigned char) token[3]) {
+		*first = token[1];
+		*last = token[3];
+		error = 0;
+	}
+
+	return error;
+}
+
+int
+parse_any(const char *token)
+{
+	return tolower(token[0]) != 'a' || tolower(token[1]) != 'n'
+	       || tolower(token[2]) != 'y' || token[3] != '\0';
+}
+
+char *
+parse_line(FILE *file, int first_character)
 {
-	wbk_b_t *binding;
-	wbk_be_t *be;
 	int *character;
+	int next;
 	Array *line;
 	char *str;
-	int length;
-	char *token;
-	char *rest;
-	wbk_mk_t modifier_key;
-
-	binding = wbk_b_new();
 
 	array_new(&line);
 
@@ -314,46 +614,345 @@ parse_binding(FILE *file, int first_character)
 	*character = first_character;
 	array_add(line, character);
 
-	length = 0;
 	do {
-		character = malloc(sizeof(int));
-		*character = fgetc(file);
+		next = fgetc(file);
 
-		if (*character == '\n') {
-			*character = EOF;
-		} else if (*character == '#') {
+		if (next == '\n') {
+			next = EOF;
+		} else if (next == '#') {
 			parse_comment(file);
-			*character = EOF;
-		} else if (*character != ' ' &&
-				   *character != '\t') {
-			length++;
+			next = EOF;
+		}
+
+		if (next != EOF) {
+			character = malloc(sizeof(int));
+			*character = next;
 			array_add(line, character);
 		}
-	} while(*character != EOF);
+	} while(next != EOF);
 
 	str = wbk_intarr_to_str(line);
 
+	array_destroy_cb(line, free);
+
+	return str;
+}
+
+int
+parse_mode(const char *line, char **mode)
+{
+	int is_mode;
+	const char *start;
+	const char *end;
+
+	is_mode = 0;
+	*mode = NULL;
+
+	if (strncmp(line, "mode", 4) == 0
+		&& (line[4] == ' ' || line[4] == '\t' || line[4] == '"')) {
+		is_mode = 1;
+
+		end = NULL;
+		start = strchr(line + 4, '"');
+		if (start) {
+			end = strchr(start + 1, '"');
+		}
+
+		if (start && end && end - start > 1) {
+			*mode = malloc(sizeof(char) * (end - start));
+			memcpy(*mode, start + 1, sizeof(char) * (end - start - 1));
+			(*mode)[end - start - 1] = '\0';
+			wbk_logger_log(&logger, INFO, "Parsed mode: %s\n", *mode);
+		} else {
+			wbk_logger_log(&logger, SEVERE, "Failed parsing mode: %s\n", line);
+		}
+	}
+
+	return is_mode;
+}
+
+wbk_b_t *
+parse_binding(const char *line)
+{
+	wbk_b_t *binding;
+	wbk_be_t *be;
+	char *str;
+	int length;
+	int i;
+	char *token;
+	char *rest;
+	wbk_mk_t modifier_key;
+	char first;
+	uint64_t ignore_mask;
+	int any;
+
+	binding = wbk_b_new();
+	ignore_mask = WBK_B_LOCK_MASK | WBK_B_SIDE_MASK;
+	any = 0;
+
+	str = malloc(sizeof(char) * (strlen(line) + 1));
+	length = 0;
+	for (i = 0; line[i] != '\0'; i++) {
+		if (line[i] != ' ' &&
+			line[i] != '\t' &&
+			line[i] != '\r') {
+			str[length++] = line[i];
+		}
+	}
+	str[length] = '\0';
+
 	wbk_logger_log(&logger, INFO, "Parsed binding:\n");
 	if (length > 0) {
 		rest = str;
 		while ((token = strtok_r(rest, "+", &rest))) {
-			modifier_key = parse_token(token);
-			if (modifier_key == NOT_A_MODIFIER) {
-				be = wbk_be_new(modifier_key, token[0]);
-				wbk_logger_log(&logger, INFO, "Key: %c\n", token[0]);
+			if (parse_trigger(token, &(binding->trigger)) == 0) {
+				wbk_logger_log(&logger, INFO, "Trigger: %d\n", binding->trigger);
+			} else if (parse_any(token) == 0) {
+				ignore_mask = WBK_B_ANY_MASK;
+				any = 1;
+				wbk_logger_log(&logger, INFO, "Any modifier\n");
+			} else if (parse_key_range(token, &first, &(binding->key_last)) == 0) {
+				/**
+				 * The first key is added like any key. The range ends at key_last.
+				 */
+				be = wbk_be_new(NOT_A_MODIFIER, first);
+				wbk_logger_log(&logger, INFO, "Keys: %c-%c\n", first, binding->key_last);
+				wbk_b_add(binding, be);
 			} else {
-				be = wbk_be_new(modifier_key, '\0');
-				wbk_logger_log(&logger, INFO, "Modifier: %d\n", modifier_key);
+				modifier_key = parse_token(token);
+				if (modifier_key == NOT_A_MODIFIER) {
+					be = wbk_be_new(modifier_key, token[0]);
+					wbk_logger_log(&logger, INFO, "Key: %c\n", token[0]);
+				} else {
+					be = wbk_be_new(modifier_key, '\0');
+					wbk_logger_log(&logger, INFO, "Modifier: %d\n", modifier_key);
+				}
+				wbk_b_add(binding, be);
 			}
-			wbk_b_add(binding, be);
 		}
 	} else {
 		// TODO use +
 	}
 	wbk_logger_log(&logger, INFO, "\n");
 
+	/**
+	 * Named modifiers must be held, even if Any is given. Naming one side of
+	 * a modifier rules out the other one, unless Any is given.
+	 */
+	for (i = 0; i < WBK_B_MODIFER_MAP_LEN; i++) {
+		if (binding->modifier_map[i]
+		    || (!any && wbk_b_is_implied(binding, wbk_be_mk_get_generic(i))
+		        && wbk_be_mk_get_generic(i) != (wbk_mk_t) i)) {
+			ignore_mask &= ~((uint64_t) 1 << i);
+		}
+	}
+	binding->ignore_mask = ignore_mask;
+
 	free(str);
-	array_destroy_cb(line, free);
 
 	return binding;
 }
+
+int
+parse_kc_cmd(const char *start, int name_len, const char *name)
+{
+	return start[0] != WBK_PARSER_BUILTIN_PREFIX
+	       || name_len + 1 != (int) strlen(name)
+	       || strncmp(start, name, name_len + 1);
+}
+
+wbk_kc_t *
+parse_kc(wbk_kbman_t *kbman, wbk_b_t *binding, char *cmd)
+{
+	wbk_kc_t *kc;
+	const char *start;
+	char *mode;
+	char *target;
+	char *macro;
+	char *arg;
+	char *message;
+	const char *rest;
+	int address_len;
+	const wbk_builtin_t *builtin;
+	int name_len;
+	wbk_limit_t *limit;
+	wbk_caps_t caps;
+	wbk_capture_t *capture;
+	int has_options;
+
+	has_options = parse_kc_options(cmd, &limit, &caps, &capture);
+
+	start = cmd[0] == '"' ? cmd + 1 : cmd;
+
+	builtin = NULL;
+	name_len = 0;
+	if (start[0] == WBK_PARSER_BUILTIN_PREFIX) {
+		name_len = strcspn(start + 1, " \t\"");
+		builtin = wbk_builtin_find(start + 1, name_len);
+	}
+
+	if (parse_kc_cmd(start, name_len, WBK_PARSER_MODE_CMD) == 0) {
+		mode = parse_kc_arg(start + strlen(WBK_PARSER_MODE_CMD));
+		free(cmd);
+
+		kc = (wbk_kc_t *) wbk_kc_mode_new(binding, kbman, mode);
+	} else if (parse_kc_cmd(start, name_len, WBK_PARSER_REMAP_CMD) == 0) {
+		target = parse_kc_arg(start + strlen(WBK_PARSER_REMAP_CMD));
+		free(cmd);
+
+		kc = (wbk_kc_t *) wbk_kc_remap_new(binding, parse_binding(target), wbk_sink_get_default());
+		free(target);
+	} else if (parse_kc_cmd(start, name_len, WBK_PARSER_MACRO_CMD) == 0) {
+		macro = parse_kc_arg(start + strlen(WBK_PARSER_MACRO_CMD));
+		free(cmd);
+
+		kc = (wbk_kc_t *) wbk_kc_macro_new(binding, macro, wbk_sink_get_default(),
+		                                   wbk_executor_get_default());
+	} else if (parse_kc_cmd(start, name_len, WBK_PARSER_IPC_CMD) == 0) {
+		arg = parse_kc_arg(start + strlen(WBK_PARSER_IPC_CMD));
+		free(cmd);
+
+		/**
+		 * The first word is the address, the rest is the message
+		 */
+		address_len = strcspn(arg, " \t");
+		rest = arg + address_len;
+		rest += strspn(rest, " \t");
+		message = malloc(sizeof(char) * (strlen(rest) + 1));
+		strcpy(message, rest);
+		arg[address_len] = '\0';
+
+		kc = (wbk_kc_t *) wbk_kc_ipc_new(binding, arg, message, wbk_executor_get_default());
+		free(arg);
+	} else if (builtin) {
+		arg = parse_kc_arg(start + 1 + name_len);
+		free(cmd);
+
+		kc = (wbk_kc_t *) wbk_kc_builtin_new(binding, builtin, arg, wbk_executor_get_default());
+	} else {
+		kc = (wbk_kc_t *) wbk_kc_sys_new(binding, cmd);
+		if (kc) {
+			wbk_kc_sys_set_limit((wbk_kc_sys_t *) kc, limit);
+			wbk_kc_sys_set_caps((wbk_kc_sys_t *) kc, &caps);
+			wbk_kc_sys_set_capture((wbk_kc_sys_t *) kc, capture);
+			limit = NULL;
+			capture = NULL;
+			has_options = 0;
+		}
+	}
+
+	if (has_options) {
+		wbk_logger_log(&logger, WARNING, "Only system commands can have options\n");
+	}
+	if (limit) {
+		wbk_limit_free(limit);
+	}
+	if (capture) {
+		wbk_capture_free(capture);
+	}
+
+	return kc;
+}
+
+int
+parse_kc_options(char *cmd, wbk_limit_t **limit, wbk_caps_t *caps, wbk_capture_t **capture)
+{
+	char *end;
+	char *rest;
+	char *token;
+	char *unit;
+	int max;
+	wbk_limit_policy_t policy;
+	int limited;
+	long size;
+	int has_options;
+
+	*limit = NULL;
+	*capture = NULL;
+	wbk_caps_init(caps);
+	has_options = 0;
+
+	end = strrchr(cmd, '"');
+	if (cmd[0] == '"' && end != cmd) {
+		rest = end + 1;
+		rest += strspn(rest, " \t\r");
+		has_options = rest[0] != '\0';
+
+		max = 1;
+		policy = WBK_LIMIT_SKIP;
+		limited = 0;
+		size = 0;
+		while ((token = strtok_r(rest, " \t\r", &rest))) {
+			if (strncmp(token, "max_concurrent=", 15) == 0 && atoi(token + 15) > 0) {
+				max = atoi(token + 15);
+				limited = 1;
+			} else if (strcmp(token, "skip-if-running") == 0) {
+				max = 1;
+				limited = 1;
+			} else if (strcmp(token, "restart") == 0) {
+				policy = WBK_LIMIT_RESTART;
+				limited = 1;
+			} else if (strcmp(token, "capture") == 0) {
+				size = WBK_CAPTURE_DEFAULT_SIZE;
+			} else if (strncmp(token, "capture=", 8) == 0) {
+				size = strtol(token + 8, &unit, 10);
+				if (*unit == 'K' || *unit == 'k') {
+					size <<= 10;
+				} else if (*unit == 'M' || *unit == 'm') {
+					size <<= 20;
+				}
+				if (size <= 0 || size > WBK_CAPTURE_MAX_SIZE) {
+					wbk_logger_log(&logger, SEVERE, "Invalid capture size: %s\n", token);
+					size = 0;
+				}
+			} else if (wbk_caps_parse(caps, token) == 0) {
+				wbk_logger_log(&logger, INFO, "Parsed cap: %s\n", token);
+			} else {
+				wbk_logger_log(&logger, SEVERE, "Unknown option of command: %s\n", token);
+			}
+		}
+
+		if (limited) {
+			*limit = wbk_limit_new(policy, max);
+			wbk_logger_log(&logger, INFO, "Parsed concurrency limit: %d\n", max);
+		}
+
+		/**
+		 * The pipes are read by the executor
+		 */
+		if (size && wbk_executor_get_default() == NULL) {
+			wbk_logger_log(&logger, SEVERE, "Cannot capture output without executor\n");
+		} else if (size) {
+			*capture = wbk_capture_new(size, wbk_executor_get_default());
+			wbk_logger_log(&logger, INFO, "Parsed output capture: %ld\n", size);
+		}
+		end[1] = '\0';
+	}
+
+	return has_options;
+}
+
+char *
+parse_kc_arg(const char *start)
+{
+	int length;
+	char *arg;
+
+	while (*start == ' ' || *start == '\t') {
+		start++;
+	}
+
+	length = 0;
+	while (start[length] != '\0' && start[length] != '"') {
+		length++;
+	}
+	while (length > 0 && (start[length - 1] == ' ' || start[length - 1] == '\t')) {
+		length--;
+	}
+
+	arg = malloc(sizeof(char) * (length + 1));
+	memcpy(arg, start, sizeof(char) * length);
+	arg[length] = '\0';
+
+	return arg;
+}
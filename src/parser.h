@@ -47,6 +47,31 @@ wbk_parser_free(wbk_parser_t *parser);
 extern wbk_kbman_t *
 wbk_parser_parse(wbk_parser_t *parser);
 
+/**
+ * @brief Parses a binding in the rc file notation (e.g. "control + a")
+ * @return A new binding. Free it by yourself!
+ */
+extern wbk_b_t *
+wbk_parser_parse_binding(const char *line);
+
+/**
+ * @brief Parses a single key in the rc file notation (e.g. "control" or "a")
+ * @param be Is set to the binding element of the key.
+ * @return Non-0 if token is empty.
+ */
+extern int
+wbk_parser_parse_be(const char *token, wbk_be_t *be);
+
+/**
+ * @brief Creates the key binding command for a binding and a command in the rc
+ * file notation (e.g. "\"notepad.exe\"" or "\"@mode resize\"").
+ * @param kbman The key board manager the key binding command will be added to
+ * @param binding Will be freed by the key binding command.
+ * @param cmd Will be freed by the key binding command or by this function.
+ */
+extern wbk_kc_t *
+wbk_parser_parse_kc(wbk_kbman_t *kbman, wbk_b_t *binding, char *cmd);
+
 /**
  * @brief Gets the filename used by the parser
  * @return The filename used by the parser. Do not free the returned string.
@@ -54,4 +79,11 @@ wbk_parser_parse(wbk_parser_t *parser);
 extern const char *
 wbk_parser_get_filename(wbk_parser_t *parser);
 
+/**
+ * @brief Sets the filename parsed by the following calls of wbk_parser_parse()
+ * @param filename The passed string is copied.
+ */
+extern int
+wbk_parser_set_filename(wbk_parser_t *parser, const char *filename);
+
 #endif // WBK_PARSER_H
@@ -0,0 +1,163 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the injection sink class implementation and private methods
+ */
+
+#include "sink.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Implementation of wbk_sink_free().
+ */
+static int
+wbk_sink_free_impl(wbk_sink_t *sink);
+
+/**
+ * A sink without a system needs no native representation.
+ */
+static int
+wbk_sink_prepare_impl(wbk_sink_t *sink, wbk_sink_batch_t *batch);
+
+static int
+wbk_sink_release_impl(wbk_sink_t *sink, wbk_sink_batch_t *batch);
+
+/**
+ * Without a system nothing can be emitted.
+ */
+static int
+wbk_sink_send_impl(wbk_sink_t *sink, const wbk_sink_batch_t *batch);
+
+static wbk_sink_t *g_default_sink = NULL;
+
+wbk_sink_t *
+wbk_sink_new(void)
+{
+	wbk_sink_t *sink;
+
+	sink = NULL;
+	sink = malloc(sizeof(wbk_sink_t));
+
+	if (sink) {
+		memset(sink, 0, sizeof(wbk_sink_t));
+
+		sink->sink_free = wbk_sink_free_impl;
+		sink->sink_prepare = wbk_sink_prepare_impl;
+		sink->sink_release = wbk_sink_release_impl;
+		sink->sink_send = wbk_sink_send_impl;
+	}
+
+	return sink;
+}
+
+int
+wbk_sink_free(wbk_sink_t *sink)
+{
+	return sink->sink_free(sink);
+}
+
+wbk_sink_t *
+wbk_sink_get_default(void)
+{
+	return __atomic_load_n(&g_default_sink, __ATOMIC_ACQUIRE);
+}
+
+void
+wbk_sink_set_default(wbk_sink_t *sink)
+{
+	__atomic_store_n(&g_default_sink, sink, __ATOMIC_RELEASE);
+}
+
+wbk_sink_batch_t *
+wbk_sink_batch_new(wbk_sink_t *sink, const wbk_sink_event_t *event_arr, int event_arr_len)
+{
+	wbk_sink_batch_t *batch;
+
+	batch = malloc(sizeof(wbk_sink_batch_t));
+	if (batch) {
+		batch->sink = sink;
+		batch->event_arr_len = event_arr_len;
+		batch->event_arr = malloc(sizeof(wbk_sink_event_t) * (event_arr_len + 1));
+		memcpy(batch->event_arr, event_arr, sizeof(wbk_sink_event_t) * event_arr_len);
+		batch->native = NULL;
+
+		if (sink->sink_prepare(sink, batch)) {
+			free(batch->event_arr);
+			free(batch);
+			batch = NULL;
+		}
+	}
+
+	return batch;
+}
+
+int
+wbk_sink_batch_free(wbk_sink_batch_t *batch)
+{
+	batch->sink->sink_release(batch->sink, batch);
+
+	free(batch->event_arr);
+	batch->event_arr = NULL;
+	free(batch);
+
+	return 0;
+}
+
+int
+wbk_sink_batch_send(const wbk_sink_batch_t *batch)
+{
+	return batch->sink->sink_send(batch->sink, batch);
+}
+
+int
+wbk_sink_free_impl(wbk_sink_t *sink)
+{
+	free(sink);
+
+	return 0;
+}
+
+int
+wbk_sink_prepare_impl(wbk_sink_t *sink, wbk_sink_batch_t *batch)
+{
+	return 0;
+}
+
+int
+wbk_sink_release_impl(wbk_sink_t *sink, wbk_sink_batch_t *batch)
+{
+	return 0;
+}
+
+int
+wbk_sink_send_impl(wbk_sink_t *sink, const wbk_sink_batch_t *batch)
+{
+	return 1;
+}
@@ -0,0 +1,127 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the injection sink class definition
+ *
+ * An injection sink emits synthetic key events into the system, e.g. for
+ * remapped keys (see kc_remap.h). The events are compiled into a batch once,
+ * when the binding is loaded. Sending a batch emits all of its events at once,
+ * so other input cannot get between them. See sink_win32.h for the sink using
+ * SendInput().
+ */
+
+#include "be.h"
+
+#ifndef WBK_SINK_H
+#define WBK_SINK_H
+
+typedef struct wbk_sink_s wbk_sink_t;
+typedef struct wbk_sink_batch_s wbk_sink_batch_t;
+
+typedef struct wbk_sink_event_s
+{
+	wbk_be_t be;
+	int pressed;
+} wbk_sink_event_t;
+
+struct wbk_sink_s
+{
+	int (*sink_free)(wbk_sink_t *sink);
+
+	/**
+	 * Creates the native representation of the events of a batch.
+	 */
+	int (*sink_prepare)(wbk_sink_t *sink, wbk_sink_batch_t *batch);
+
+	/**
+	 * Frees the native representation of the events of a batch.
+	 */
+	int (*sink_release)(wbk_sink_t *sink, wbk_sink_batch_t *batch);
+
+	int (*sink_send)(wbk_sink_t *sink, const wbk_sink_batch_t *batch);
+};
+
+struct wbk_sink_batch_s
+{
+	/**
+	 * The sink that prepared the batch. It is not owned by the batch.
+	 */
+	wbk_sink_t *sink;
+
+	wbk_sink_event_t *event_arr;
+	int event_arr_len;
+
+	/**
+	 * The native representation of the events. It is owned by the sink.
+	 */
+	void *native;
+};
+
+/**
+ * @brief Creates a new injection sink, which does not emit into any system
+ * @return A new injection sink or NULL if allocation failed
+ */
+extern wbk_sink_t *
+wbk_sink_new(void);
+
+extern int
+wbk_sink_free(wbk_sink_t *sink);
+
+/**
+ * @brief Gets the injection sink used by loaded bindings.
+ * @return The injection sink or NULL if none is set.
+ */
+extern wbk_sink_t *
+wbk_sink_get_default(void);
+
+/**
+ * @brief Sets the injection sink used by bindings loaded afterwards.
+ * @param sink The sink is not owned. It must outlive all loaded bindings.
+ */
+extern void
+wbk_sink_set_default(wbk_sink_t *sink);
+
+/**
+ * @brief Compiles events into a batch of a sink
+ * @param event_arr The events are copied.
+ * @return A new batch or NULL if the sink cannot emit one of the events.
+ */
+extern wbk_sink_batch_t *
+wbk_sink_batch_new(wbk_sink_t *sink, const wbk_sink_event_t *event_arr, int event_arr_len);
+
+extern int
+wbk_sink_batch_free(wbk_sink_batch_t *batch);
+
+/**
+ * @brief Emits all events of a batch at once.
+ * @return Non-0 if not all events were emitted.
+ */
+extern int
+wbk_sink_batch_send(const wbk_sink_batch_t *batch);
+
+#endif // WBK_SINK_H
@@ -0,0 +1,322 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the WIN32 injection sink class implementation and private methods
+ */
+
+#include "sink_win32.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+static wbk_logger_t logger = { "sink_win32" };
+
+/**
+ * Implementation of the preparation of wbk_sink_batch_new().
+ *
+ * Builds the INPUT array of the batch.
+ */
+static int
+wbk_sink_win32_prepare_impl(wbk_sink_t *sink, wbk_sink_batch_t *batch);
+
+static int
+wbk_sink_win32_release_impl(wbk_sink_t *sink, wbk_sink_batch_t *batch);
+
+/**
+ * Implementation of wbk_sink_batch_send().
+ */
+static int
+wbk_sink_win32_send_impl(wbk_sink_t *sink, const wbk_sink_batch_t *batch);
+
+/**
+ * Translates an event to its INPUT. The mapping is the inverse of
+ * wbk_kbdaemon_win32_to_mk() and wbk_kbdaemon_win32_to_char().
+ *
+ * @return Non-0 if the event has got no virtual key or mouse button.
+ */
+static int
+wbk_sink_win32_to_input(const wbk_sink_event_t *event, INPUT *input);
+
+/**
+ * @return The virtual key of a modifier or 0 if it is no key.
+ */
+static WORD
+wbk_sink_win32_mk_to_vk(wbk_mk_t modifier);
+
+/**
+ * @return The virtual key of a key or 0 if it is unknown.
+ */
+static WORD
+wbk_sink_win32_char_to_vk(char key);
+
+wbk_sink_win32_t *
+wbk_sink_win32_new(void)
+{
+	wbk_sink_t *sink;
+	wbk_sink_win32_t *sink_win32;
+
+	sink_win32 = NULL;
+	sink_win32 = malloc(sizeof(wbk_sink_win32_t));
+
+	if (sink_win32) {
+		memset(sink_win32, 0, sizeof(wbk_sink_win32_t));
+
+		sink = wbk_sink_new();
+		memcpy(sink_win32, sink, sizeof(wbk_sink_t));
+		free(sink); /* Just free the top level element */
+
+		sink_win32->super_sink_free = sink_win32->sink.sink_free;
+		sink_win32->super_sink_prepare = sink_win32->sink.sink_prepare;
+		sink_win32->super_sink_release = sink_win32->sink.sink_release;
+		sink_win32->super_sink_send = sink_win32->sink.sink_send;
+
+		sink_win32->sink.sink_prepare = wbk_sink_win32_prepare_impl;
+		sink_win32->sink.sink_release = wbk_sink_win32_release_impl;
+		sink_win32->sink.sink_send = wbk_sink_win32_send_impl;
+	}
+
+	return sink_win32;
+}
+
+int
+wbk_sink_win32_is_injected(DWORD flags, ULONG_PTR extra_info)
+{
+	/**
+	 * LLKHF_INJECTED and LLMHF_INJECTED differ. Events of other programs
+	 * are injected as well, so the extra information decides.
+	 */
+	return (flags & (LLKHF_INJECTED | LLMHF_INJECTED))
+		&& extra_info == WBK_SINK_WIN32_EXTRA_INFO;
+}
+
+int
+wbk_sink_win32_prepare_impl(wbk_sink_t *sink, wbk_sink_batch_t *batch)
+{
+	INPUT *input_arr;
+	int error;
+	int i;
+
+	error = 0;
+
+	input_arr = malloc(sizeof(INPUT) * (batch->event_arr_len + 1));
+	memset(input_arr, 0, sizeof(INPUT) * (batch->event_arr_len + 1));
+
+	for (i = 0; !error && i < batch->event_arr_len; i++) {
+		error = wbk_sink_win32_to_input(&(batch->event_arr[i]), &(input_arr[i]));
+		if (error) {
+			wbk_logger_log(&logger, WARNING, "Cannot emit modifier %d or key %c\n",
+			               batch->event_arr[i].be.modifier, batch->event_arr[i].be.key);
+		}
+	}
+
+	if (error) {
+		free(input_arr);
+	} else {
+		batch->native = input_arr;
+	}
+
+	return error;
+}
+
+int
+wbk_sink_win32_release_impl(wbk_sink_t *sink, wbk_sink_batch_t *batch)
+{
+	free(batch->native);
+	batch->native = NULL;
+
+	return 0;
+}
+
+int
+wbk_sink_win32_send_impl(wbk_sink_t *sink, const wbk_sink_batch_t *batch)
+{
+	UINT sent;
+	int error;
+
+	error = 0;
+
+	if (batch->event_arr_len > 0) {
+		sent = SendInput(batch->event_arr_len, (INPUT *) batch->native, sizeof(INPUT));
+		if (sent != (UINT) batch->event_arr_len) {
+			wbk_logger_log(&logger, WARNING, "Sent %u of %d events, error %lu\n",
+			               sent, batch->event_arr_len, GetLastError());
+			error = 1;
+		}
+	}
+
+	return error;
+}
+
+int
+wbk_sink_win32_to_input(const wbk_sink_event_t *event, INPUT *input)
+{
+	int error;
+
+	error = 0;
+
+	switch (event->be.modifier) {
+	case MOUSE_LEFT:
+		input->type = INPUT_MOUSE;
+		input->u.mi.dwFlags = event->pressed ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+		break;
+
+	case MOUSE_MIDDLE:
+		input->type = INPUT_MOUSE;
+		input->u.mi.dwFlags = event->pressed ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP;
+		break;
+
+	case MOUSE_RIGHT:
+		input->type = INPUT_MOUSE;
+		input->u.mi.dwFlags = event->pressed ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP;
+		break;
+
+	case MOUSE_BACK:
+	case MOUSE_FORWARD:
+		input->type = INPUT_MOUSE;
+		input->u.mi.dwFlags = event->pressed ? MOUSEEVENTF_XDOWN : MOUSEEVENTF_XUP;
+		input->u.mi.mouseData = event->be.modifier == MOUSE_BACK ? XBUTTON1 : XBUTTON2;
+		break;
+
+	case WHEEL_UP:
+	case WHEEL_DOWN:
+	case WHEEL_LEFT:
+	case WHEEL_RIGHT:
+		/**
+		 * A notch is emitted on the press. The release is a move by 0.
+		 */
+		input->type = INPUT_MOUSE;
+		input->u.mi.dwFlags = event->be.modifier == WHEEL_UP || event->be.modifier == WHEEL_DOWN
+			? MOUSEEVENTF_WHEEL : MOUSEEVENTF_HWHEEL;
+		if (event->pressed) {
+			input->u.mi.mouseData = event->be.modifier == WHEEL_UP || event->be.modifier == WHEEL_RIGHT
+				? WHEEL_DELTA : (DWORD) -WHEEL_DELTA;
+		}
+		break;
+
+	default:
+		input->type = INPUT_KEYBOARD;
+		if (event->be.modifier != NOT_A_MODIFIER) {
+			input->u.ki.wVk = wbk_sink_win32_mk_to_vk(event->be.modifier);
+		} else {
+			input->u.ki.wVk = wbk_sink_win32_char_to_vk(event->be.key);
+		}
+		input->u.ki.dwFlags = event->pressed ? 0 : KEYEVENTF_KEYUP;
+
+		/**
+		 * Otherwise the arrow keys are taken from the number pad. The right
+		 * modifiers are extended keys too.
+		 */
+		if (event->be.modifier == LEFT || event->be.modifier == RIGHT
+		    || event->be.modifier == UP || event->be.modifier == DOWN
+		    || event->be.modifier == WIN || event->be.modifier == LWIN
+		    || event->be.modifier == RWIN || event->be.modifier == RALT
+		    || event->be.modifier == RCTRL) {
+			input->u.ki.dwFlags |= KEYEVENTF_EXTENDEDKEY;
+		}
+
+		error = input->u.ki.wVk == 0;
+	}
+
+	if (input->type == INPUT_MOUSE) {
+		input->u.mi.dwExtraInfo = WBK_SINK_WIN32_EXTRA_INFO;
+	} else {
+		input->u.ki.dwExtraInfo = WBK_SINK_WIN32_EXTRA_INFO;
+	}
+
+	return error;
+}
+
+WORD
+wbk_sink_win32_mk_to_vk(wbk_mk_t modifier)
+{
+	WORD vk;
+
+	vk = 0;
+
+	switch (modifier) {
+	case WIN:      vk = VK_LWIN; break;
+	case ALT:      vk = VK_MENU; break;
+	case CTRL:     vk = VK_CONTROL; break;
+	case SHIFT:    vk = VK_SHIFT; break;
+	case ENTER:    vk = VK_RETURN; break;
+	case NUMLOCK:  vk = VK_NUMLOCK; break;
+	case CAPSLOCK: vk = VK_CAPITAL; break;
+	case SCROLL:   vk = VK_SCROLL; break;
+	case SPACE:    vk = VK_SPACE; break;
+	case ESCAPE:   vk = VK_ESCAPE; break;
+	case LEFT:     vk = VK_LEFT; break;
+	case RIGHT:    vk = VK_RIGHT; break;
+	case UP:       vk = VK_UP; break;
+	case DOWN:     vk = VK_DOWN; break;
+	case LWIN:     vk = VK_LWIN; break;
+	case RWIN:     vk = VK_RWIN; break;
+	case LALT:     vk = VK_LMENU; break;
+	case RALT:     vk = VK_RMENU; break;
+	case LCTRL:    vk = VK_LCONTROL; break;
+	case RCTRL:    vk = VK_RCONTROL; break;
+	case LSHIFT:   vk = VK_LSHIFT; break;
+	case RSHIFT:   vk = VK_RSHIFT; break;
+
+	default:
+		if (modifier >= F1 && modifier <= F12) {
+			vk = VK_F1 + (modifier - F1);
+		}
+	}
+
+	return vk;
+}
+
+WORD
+wbk_sink_win32_char_to_vk(char key)
+{
+	WORD vk;
+
+	vk = 0;
+
+	if (key == '+')
+		vk = 186;
+	else if (key == ',')
+		vk = 188;
+	else if (key == '-')
+		vk = 189;
+	else if (key == '.')
+		vk = 190;
+	else if (key == '#')
+		vk = 191;
+	else if (key == '<')
+		vk = 226;
+	else if (key == ' ')
+		vk = VK_SPACE;
+	else if (isdigit(key) || isalpha(key))
+		vk = toupper(key);
+
+	return vk;
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the WIN32 injection sink class definition
+ *
+ * wbk_sink_win32_t inherits all methods of wbk_sink_t (see sink.h). A batch
+ * is prepared as INPUT array and sent by a single call of SendInput(). All
+ * emitted events carry WBK_SINK_WIN32_EXTRA_INFO, thus the keyboard hooks
+ * recognize them and do not match them against bindings again.
+ */
+
+#include <windows.h>
+
+#include "sink.h"
+
+#ifndef WBK_SINK_WIN32_H
+#define WBK_SINK_WIN32_H
+
+/**
+ * The extra information of all emitted events ("WBK1").
+ */
+#define WBK_SINK_WIN32_EXTRA_INFO 0x57424B31
+
+typedef struct wbk_sink_win32_s wbk_sink_win32_t;
+
+struct wbk_sink_win32_s
+{
+	wbk_sink_t sink;
+	int (*super_sink_free)(wbk_sink_t *sink);
+	int (*super_sink_prepare)(wbk_sink_t *sink, wbk_sink_batch_t *batch);
+	int (*super_sink_release)(wbk_sink_t *sink, wbk_sink_batch_t *batch);
+	int (*super_sink_send)(wbk_sink_t *sink, const wbk_sink_batch_t *batch);
+};
+
+/**
+ * @brief Creates a new injection sink using SendInput()
+ * @return A new injection sink or NULL if allocation failed
+ */
+extern wbk_sink_win32_t *
+wbk_sink_win32_new(void);
+
+/**
+ * @brief Checks if an event passed to a low level hook was emitted by a
+ * wbk_sink_win32_t.
+ * @param flags The flags of KBDLLHOOKSTRUCT or MSLLHOOKSTRUCT
+ * @param extra_info The dwExtraInfo of KBDLLHOOKSTRUCT or MSLLHOOKSTRUCT
+ * @return Non-0 if the event was emitted by an injection sink
+ */
+extern int
+wbk_sink_win32_is_injected(DWORD flags, ULONG_PTR extra_info);
+
+#endif // WBK_SINK_WIN32_H
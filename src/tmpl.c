@@ -0,0 +1,217 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the command template class implementation and private methods
+ */
+
+#include "tmpl.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+
+/**
+ * The name of the slot of the key of the binding
+ */
+#define WBK_TMPL_KEY_NAME "key"
+
+static wbk_logger_t logger =  { "tmpl" };
+
+/**
+ * Appends a segment. The text of the template has room for it.
+ */
+static void
+wbk_tmpl_add(wbk_tmpl_t *tmpl, int *text_len, wbk_tmpl_segment_type_t type,
+             const char *str, int length);
+
+/**
+ * @return Non-0 if the characters can be the name of an environment variable
+ */
+static int
+wbk_tmpl_is_name(const char *str, int length);
+
+wbk_tmpl_t *
+wbk_tmpl_new(const char *cmd)
+{
+	wbk_tmpl_t *tmpl;
+	const char *start;
+	const char *end;
+	const char *literal;
+	int text_len;
+	int length;
+
+	tmpl = NULL;
+	tmpl = malloc(sizeof(wbk_tmpl_t));
+
+	if (tmpl) {
+		memset(tmpl, 0, sizeof(wbk_tmpl_t));
+
+		/**
+		 * Every segment takes at most its characters of the command and a
+		 * terminating character
+		 */
+		length = strlen(cmd);
+		tmpl->text = malloc(sizeof(char) * (2 * length + 1));
+		tmpl->segments = malloc(sizeof(wbk_tmpl_segment_t) * (length + 1));
+		if (tmpl->text == NULL || tmpl->segments == NULL) {
+			wbk_tmpl_free(tmpl);
+			tmpl = NULL;
+		}
+	}
+
+	if (tmpl) {
+		text_len = 0;
+		literal = cmd;
+		start = strchr(cmd, '%');
+		while (start) {
+			end = strchr(start + 1, '%');
+			if (end == NULL) {
+				start = NULL;
+			} else if (end == start + 1) {
+				wbk_tmpl_add(tmpl, &text_len, WBK_TMPL_LITERAL, literal, start + 1 - literal);
+				literal = end + 1;
+				start = strchr(literal, '%');
+			} else if (end - start - 1 == strlen(WBK_TMPL_KEY_NAME)
+			           && strncmp(start + 1, WBK_TMPL_KEY_NAME, end - start - 1) == 0) {
+				wbk_tmpl_add(tmpl, &text_len, WBK_TMPL_LITERAL, literal, start - literal);
+				wbk_tmpl_add(tmpl, &text_len, WBK_TMPL_KEY, start + 1, end - start - 1);
+				literal = end + 1;
+				start = strchr(literal, '%');
+			} else if (wbk_tmpl_is_name(start + 1, end - start - 1)) {
+				wbk_tmpl_add(tmpl, &text_len, WBK_TMPL_LITERAL, literal, start - literal);
+				wbk_tmpl_add(tmpl, &text_len, WBK_TMPL_ENV, start + 1, end - start - 1);
+				literal = end + 1;
+				start = strchr(literal, '%');
+			} else {
+				/**
+				 * The closing % may open the next slot
+				 */
+				start = end;
+			}
+		}
+		wbk_tmpl_add(tmpl, &text_len, WBK_TMPL_LITERAL, literal, strlen(literal));
+
+		wbk_logger_log(&logger, DEBUG, "Compiled %d slots of: %s\n", tmpl->slots, cmd);
+	}
+
+	return tmpl;
+}
+
+int
+wbk_tmpl_free(wbk_tmpl_t *tmpl)
+{
+	free(tmpl->text);
+	free(tmpl->segments);
+	free(tmpl);
+
+	return 0;
+}
+
+int
+wbk_tmpl_has_slots(const wbk_tmpl_t *tmpl)
+{
+	return tmpl->slots > 0;
+}
+
+int
+wbk_tmpl_expand(const wbk_tmpl_t *tmpl, const char *key, char *buffer, int buffer_len)
+{
+	const wbk_tmpl_segment_t *segment;
+	const char *value;
+	int value_len;
+	int length;
+	int i;
+
+	length = 0;
+	for (i = 0; i < tmpl->segments_len && length >= 0; i++) {
+		segment = tmpl->segments + i;
+
+		if (segment->type == WBK_TMPL_LITERAL) {
+			value = tmpl->text + segment->start;
+			value_len = segment->length;
+		} else {
+			value = segment->type == WBK_TMPL_KEY ? key : getenv(tmpl->text + segment->start);
+			value_len = value ? strlen(value) : 0;
+		}
+
+		if (length + value_len < buffer_len) {
+			if (value_len > 0) {
+				memcpy(buffer + length, value, sizeof(char) * value_len);
+			}
+			length += value_len;
+		} else {
+			length = -1;
+		}
+	}
+
+	if (length >= 0) {
+		buffer[length] = '\0';
+	} else if (buffer_len > 0) {
+		buffer[0] = '\0';
+	}
+
+	return length;
+}
+
+void
+wbk_tmpl_add(wbk_tmpl_t *tmpl, int *text_len, wbk_tmpl_segment_type_t type,
+             const char *str, int length)
+{
+	wbk_tmpl_segment_t *segment;
+
+	if (length > 0 || type != WBK_TMPL_LITERAL) {
+		segment = tmpl->segments + tmpl->segments_len++;
+		segment->type = type;
+		segment->start = *text_len;
+		segment->length = length;
+
+		memcpy(tmpl->text + *text_len, str, sizeof(char) * length);
+		tmpl->text[*text_len + length] = '\0';
+		*text_len += length + 1;
+
+		if (type != WBK_TMPL_LITERAL) {
+			tmpl->slots++;
+		}
+	}
+}
+
+int
+wbk_tmpl_is_name(const char *str, int length)
+{
+	int i;
+
+	for (i = 0; i < length && (isalnum((unsigned char) str[i]) || str[i] == '_'
+	                           || str[i] == '(' || str[i] == ')'); i++) {
+		/* Check the characters */
+	}
+
+	return length > 0 && i == length;
+}
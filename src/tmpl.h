@@ -0,0 +1,122 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the command template class definition
+ *
+ * A command template is a command of the rc file split into literal and slot
+ * segments once, when the rc file is loaded:
+ *
+ *     "launcher --workspace=%key%"
+ *     "%HOME%/bin/backup.sh"
+ *
+ * %key% is the key of the binding, %NAME% the environment variable NAME at
+ * the time the binding is triggered and %% a single %. A % without closing
+ * % is kept as it is.
+ *
+ * Expanding a template only copies its segments into a buffer of the caller;
+ * it neither allocates nor runs a shell.
+ */
+
+#ifndef WBK_TMPL_H
+#define WBK_TMPL_H
+
+/**
+ * Size of the buffer a command is expanded into
+ */
+#define WBK_TMPL_EXPAND_LEN 4096
+
+typedef enum wbk_tmpl_segment_type_e
+{
+	WBK_TMPL_LITERAL = 0,
+
+	/**
+	 * The key of the binding
+	 */
+	WBK_TMPL_KEY,
+
+	/**
+	 * An environment variable
+	 */
+	WBK_TMPL_ENV
+} wbk_tmpl_segment_type_t;
+
+typedef struct wbk_tmpl_segment_s
+{
+	wbk_tmpl_segment_type_t type;
+
+	/**
+	 * The literal or the name of the variable within the text of the
+	 * template. It is terminated.
+	 */
+	int start;
+	int length;
+} wbk_tmpl_segment_t;
+
+typedef struct wbk_tmpl_s
+{
+	/**
+	 * The literals and names of the segments
+	 */
+	char *text;
+
+	wbk_tmpl_segment_t *segments;
+	int segments_len;
+
+	/**
+	 * Number of slot segments
+	 */
+	int slots;
+} wbk_tmpl_t;
+
+/**
+ * @brief Compiles a command into a template
+ * @return A new template or NULL if allocation failed
+ */
+extern wbk_tmpl_t *
+wbk_tmpl_new(const char *cmd);
+
+extern int
+wbk_tmpl_free(wbk_tmpl_t *tmpl);
+
+/**
+ * @return Non-0 if the template has a slot, i.e. expanding it differs from
+ *         the command
+ */
+extern int
+wbk_tmpl_has_slots(const wbk_tmpl_t *tmpl);
+
+/**
+ * @brief Expands a template. Does not allocate.
+ * @param key The value of %key%
+ * @param buffer Is set to the terminated command
+ * @return The length of the command or -1 if it does not fit into buffer
+ */
+extern int
+wbk_tmpl_expand(const wbk_tmpl_t *tmpl, const char *key, char *buffer, int buffer_len);
+
+#endif // WBK_TMPL_H
@@ -0,0 +1,307 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the timer wheel class implementation and private methods
+ */
+
+#include "twheel.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WBK_TWHEEL_MASK (WBK_TWHEEL_SLOTS - 1)
+
+/**
+ * Links a timer into the slot matching its expiry.
+ */
+static void
+wbk_twheel_insert(wbk_twheel_t *twheel, wbk_timer_t *timer);
+
+/**
+ * Unlinks a timer from its slot.
+ */
+static void
+wbk_twheel_unlink(wbk_timer_t *timer);
+
+/**
+ * Moves all timers of a slot of a higher level into the lower levels.
+ * @return The index of the slot
+ */
+static int
+wbk_twheel_cascade(wbk_twheel_t *twheel, int level, int index);
+
+wbk_twheel_t *
+wbk_twheel_new(unsigned long time)
+{
+	wbk_twheel_t *twheel;
+	int i;
+	int j;
+
+	twheel = NULL;
+	twheel = malloc(sizeof(wbk_twheel_t));
+
+	if (twheel) {
+		twheel->now = time + 1;
+		twheel->count = 0;
+
+		for (i = 0; i < WBK_TWHEEL_LEVELS; i++) {
+			for (j = 0; j < WBK_TWHEEL_SLOTS; j++) {
+				twheel->slot_arr[i][j].next = &(twheel->slot_arr[i][j]);
+				twheel->slot_arr[i][j].prev = &(twheel->slot_arr[i][j]);
+			}
+		}
+	}
+
+	return twheel;
+}
+
+int
+wbk_twheel_free(wbk_twheel_t *twheel)
+{
+	wbk_timer_t *timer;
+	int i;
+	int j;
+
+	for (i = 0; i < WBK_TWHEEL_LEVELS; i++) {
+		for (j = 0; j < WBK_TWHEEL_SLOTS; j++) {
+			while (twheel->slot_arr[i][j].next != &(twheel->slot_arr[i][j])) {
+				timer = twheel->slot_arr[i][j].next;
+				wbk_twheel_unlink(timer);
+			}
+		}
+	}
+
+	free(twheel);
+
+	return 0;
+}
+
+unsigned long
+wbk_twheel_get_time(const wbk_twheel_t *twheel)
+{
+	return twheel->now - 1;
+}
+
+int
+wbk_twheel_advance(wbk_twheel_t *twheel, unsigned long time)
+{
+	wbk_timer_t *slot;
+	wbk_timer_t *timer;
+	int index;
+	int cascaded;
+	int level;
+
+	while ((long) (time - twheel->now) >= 0) {
+		if (twheel->count == 0) {
+			/**
+			 * Nothing can expire, skip the idle milliseconds at once
+			 */
+			twheel->now = time + 1;
+		} else {
+			index = twheel->now & WBK_TWHEEL_MASK;
+
+			/**
+			 * Whenever a level wrapped around, the next slot of the level
+			 * above is due to be spread over the lower levels
+			 */
+			cascaded = index;
+			for (level = 1; cascaded == 0 && level < WBK_TWHEEL_LEVELS; level++) {
+				cascaded = wbk_twheel_cascade(twheel, level,
+				                              (twheel->now >> (WBK_TWHEEL_BITS * level)) & WBK_TWHEEL_MASK);
+			}
+
+			slot = &(twheel->slot_arr[0][index]);
+			twheel->now++;
+
+			while (slot->next != slot) {
+				timer = slot->next;
+				wbk_twheel_unlink(timer);
+				twheel->count--;
+				timer->expire_fn(timer, timer->param);
+			}
+		}
+	}
+
+	return 0;
+}
+
+int
+wbk_twheel_next_timeout(const wbk_twheel_t *twheel, unsigned long *timeout)
+{
+	const wbk_timer_t *slot;
+	const wbk_timer_t *timer;
+	unsigned long time;
+	long delta;
+	long min;
+	int i;
+	int j;
+
+	min = -1;
+	time = wbk_twheel_get_time(twheel);
+
+	for (i = 0; twheel->count > 0 && i < WBK_TWHEEL_LEVELS; i++) {
+		for (j = 0; j < WBK_TWHEEL_SLOTS; j++) {
+			slot = &(twheel->slot_arr[i][j]);
+			for (timer = slot->next; timer != slot; timer = timer->next) {
+				delta = (long) (timer->expires - time);
+				if (delta < 0) {
+					delta = 0;
+				}
+				if (min < 0 || delta < min) {
+					min = delta;
+				}
+			}
+		}
+	}
+
+	if (min >= 0) {
+		*timeout = min;
+	}
+
+	return min < 0;
+}
+
+int
+wbk_timer_init(wbk_timer_t *timer,
+               void (*expire_fn)(wbk_timer_t *timer, void *param), void *param)
+{
+	timer->next = NULL;
+	timer->prev = NULL;
+	timer->expires = 0;
+	timer->expire_fn = expire_fn;
+	timer->param = param;
+
+	return 0;
+}
+
+int
+wbk_timer_start(wbk_twheel_t *twheel, wbk_timer_t *timer, unsigned long timeout)
+{
+	wbk_timer_cancel(twheel, timer);
+
+	timer->expires = wbk_twheel_get_time(twheel) + timeout;
+	wbk_twheel_insert(twheel, timer);
+	twheel->count++;
+
+	return 0;
+}
+
+int
+wbk_timer_cancel(wbk_twheel_t *twheel, wbk_timer_t *timer)
+{
+	if (wbk_timer_pending(timer)) {
+		wbk_twheel_unlink(timer);
+		twheel->count--;
+	}
+
+	return 0;
+}
+
+int
+wbk_timer_pending(const wbk_timer_t *timer)
+{
+	return timer->next != NULL;
+}
+
+void
+wbk_twheel_insert(wbk_twheel_t *twheel, wbk_timer_t *timer)
+{
+	wbk_timer_t *slot;
+	unsigned long delta;
+	unsigned long expires;
+	int level;
+
+	expires = timer->expires;
+	if ((long) (expires - twheel->now) < 0) {
+		/**
+		 * Already expired, call it with the next processed millisecond
+		 */
+		expires = twheel->now;
+	}
+
+	delta = expires - twheel->now;
+	level = 0;
+	while (level < WBK_TWHEEL_LEVELS - 1
+	       && delta >= 1UL << (WBK_TWHEEL_BITS * (level + 1))) {
+		level++;
+	}
+
+	if (delta >= 1UL << (WBK_TWHEEL_BITS * WBK_TWHEEL_LEVELS)) {
+		/**
+		 * Beyond the range of the wheel. The timer is cascaded again once its
+		 * slot comes up.
+		 */
+		expires = twheel->now + (1UL << (WBK_TWHEEL_BITS * WBK_TWHEEL_LEVELS)) - 1;
+	}
+
+	slot = &(twheel->slot_arr[level][(expires >> (WBK_TWHEEL_BITS * level)) & WBK_TWHEEL_MASK]);
+
+	timer->next = slot;
+	timer->prev = slot->prev;
+	slot->prev->next = timer;
+	slot->prev = timer;
+}
+
+void
+wbk_twheel_unlink(wbk_timer_t *timer)
+{
+	timer->prev->next = timer->next;
+	timer->next->prev = timer->prev;
+	timer->next = NULL;
+	timer->prev = NULL;
+}
+
+int
+wbk_twheel_cascade(wbk_twheel_t *twheel, int level, int index)
+{
+	wbk_timer_t list;
+	wbk_timer_t *slot;
+	wbk_timer_t *timer;
+
+	slot = &(twheel->slot_arr[level][index]);
+
+	if (slot->next != slot) {
+		/**
+		 * Detach the whole slot first, timers may land in it again
+		 */
+		list.next = slot->next;
+		list.prev = slot->prev;
+		list.next->prev = &list;
+		list.prev->next = &list;
+		slot->next = slot;
+		slot->prev = slot;
+
+		while (list.next != &list) {
+			timer = list.next;
+			wbk_twheel_unlink(timer);
+			wbk_twheel_insert(twheel, timer);
+		}
+	}
+
+	return index;
+}
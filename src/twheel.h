@@ -0,0 +1,151 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * @author Richard Bäck
+ * @date 2026-10-18
+ * @brief File contains the timer wheel class definition
+ *
+ * A hierarchical timer wheel with a resolution of 1 millisecond. Starting and
+ * cancelling a timer is O(1). Time only passes by calling
+ * wbk_twheel_advance(), thus the owner decides which clock is used: the
+ * timestamps of input events make timing decisions deterministic and
+ * replayable. Expired timers are called on the thread advancing the wheel.
+ *
+ * A timer wheel is not thread safe. It is meant to be owned by the thread of
+ * an input backend.
+ */
+
+#ifndef WBK_TWHEEL_H
+#define WBK_TWHEEL_H
+
+#define WBK_TWHEEL_BITS 6
+#define WBK_TWHEEL_SLOTS (1 << WBK_TWHEEL_BITS)
+#define WBK_TWHEEL_LEVELS 4
+
+typedef struct wbk_timer_s wbk_timer_t;
+
+struct wbk_timer_s
+{
+	/**
+	 * Timers are linked into the slots of the wheel. Both are NULL if the
+	 * timer is not pending.
+	 */
+	wbk_timer_t *next;
+	wbk_timer_t *prev;
+
+	unsigned long expires;
+
+	/**
+	 * Function is called once the timer expired. The timer may be started
+	 * again from within.
+	 */
+	void (*expire_fn)(wbk_timer_t *timer, void *param);
+	void *param;
+};
+
+typedef struct wbk_twheel_s
+{
+	/**
+	 * The next millisecond to process.
+	 */
+	unsigned long now;
+
+	/**
+	 * Number of pending timers.
+	 */
+	int count;
+
+	/**
+	 * Each slot is a circular list with a sentinel timer. Level 0 holds the
+	 * timers expiring within the next WBK_TWHEEL_SLOTS milliseconds, every
+	 * further level covers WBK_TWHEEL_SLOTS times the range of the previous
+	 * one.
+	 */
+	wbk_timer_t slot_arr[WBK_TWHEEL_LEVELS][WBK_TWHEEL_SLOTS];
+} wbk_twheel_t;
+
+/**
+ * @param time The current time in milliseconds
+ */
+extern wbk_twheel_t *
+wbk_twheel_new(unsigned long time);
+
+/**
+ * @brief Frees a timer wheel. Pending timers are not called.
+ */
+extern int
+wbk_twheel_free(wbk_twheel_t *twheel);
+
+/**
+ * @return The time the timer wheel was advanced to
+ */
+extern unsigned long
+wbk_twheel_get_time(const wbk_twheel_t *twheel);
+
+/**
+ * @brief Calls all timers expiring until time.
+ *
+ * Time going backwards is ignored.
+ */
+extern int
+wbk_twheel_advance(wbk_twheel_t *twheel, unsigned long time);
+
+/**
+ * @brief Computes the milliseconds until the next timer expires.
+ * @return Non-0 if no timer is pending.
+ */
+extern int
+wbk_twheel_next_timeout(const wbk_twheel_t *twheel, unsigned long *timeout);
+
+/**
+ * @brief Initializes a timer, which is not pending.
+ */
+extern int
+wbk_timer_init(wbk_timer_t *timer,
+               void (*expire_fn)(wbk_timer_t *timer, void *param), void *param);
+
+/**
+ * @brief Starts a timer. A pending timer is restarted.
+ * @param timeout Milliseconds from the current time of the timer wheel. A
+ * timeout of 0 expires with the next millisecond.
+ */
+extern int
+wbk_timer_start(wbk_twheel_t *twheel, wbk_timer_t *timer, unsigned long timeout);
+
+/**
+ * @brief Cancels a timer. Cancelling a timer, which is not pending, does
+ * nothing.
+ */
+extern int
+wbk_timer_cancel(wbk_twheel_t *twheel, wbk_timer_t *timer);
+
+/**
+ * @return Non-0 if the timer is pending.
+ */
+extern int
+wbk_timer_pending(const wbk_timer_t *timer);
+
+#endif // WBK_TWHEEL_H
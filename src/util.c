@@ -74,9 +74,21 @@ wbk_get_path_of_home(void)
 {
 	char *home_dir;
 
+#if defined(WIN32)
 	home_dir = malloc(sizeof(char) * MAX_PATH);
 
 	SHGetFolderPath(NULL, CSIDL_PROFILE, NULL, 0, home_dir);
+#else
+	const char *home;
+
+	home = getenv("HOME");
+	if (home == NULL) {
+		home = getpwuid(getuid())->pw_dir;
+	}
+
+	home_dir = malloc(sizeof(char) * (strlen(home) + 1));
+	strcpy(home_dir, home);
+#endif
 
 	return home_dir;
 }
@@ -96,7 +108,11 @@ wbk_path_from_home(const char *relative_path)
 	absolute_path = malloc(sizeof(char) * length);
 
 	strcpy(absolute_path, home_dir);
+#if defined(WIN32)
 	absolute_path[pw_dir_length] = '\\';
+#else
+	absolute_path[pw_dir_length] = '/';
+#endif
 	strcpy(absolute_path + pw_dir_length + 1, relative_path);
 
 	free(home_dir);
@@ -104,6 +120,16 @@ wbk_path_from_home(const char *relative_path)
 	return absolute_path;
 }
 
+char *
+wbk_path_absolute(const char *path)
+{
+#if defined(WIN32)
+	return _fullpath(NULL, path, 0);
+#else
+	return realpath(path, NULL);
+#endif
+}
+
 int
 wbk_write_file(const char *src_path, FILE *dest)
 {
@@ -54,6 +54,14 @@ wbk_get_path_of_home(void);
 extern char *
 wbk_path_from_home(const char *relative_path);
 
+/**
+ * @brief Produces an absolute path from a path relative to the working
+ * directory
+ * @return A new string or NULL if the path cannot be resolved. Free it by yourself.
+ */
+extern char *
+wbk_path_absolute(const char *path);
+
 extern int
 wbk_write_file(const char *src_path, FILE *dest);
 
@@ -0,0 +1,193 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * Measures how many key events per second pass the portable core, from the
+ * input backend through the binding lookup. Runs the simulated input backend,
+ * thus the numbers are comparable across platforms and suited for perf or
+ * valgrind --tool=callgrind.
+ *
+ * Usage: bench_backend [ROUNDS]
+ */
+
+#include "backend_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "kbtable.h"
+#include "logger.h"
+#include "parser.h"
+
+#define RC_FILENAME "bench_backend.rc"
+
+#define DEFAULT_ROUNDS 100000
+
+#define KEYS "abcdefghijklmnopqrstuvwxyz0123456789"
+
+static const wbk_mk_t MODIFIERS[][2] = {
+	{ CTRL, NOT_A_MODIFIER },
+	{ SHIFT, NOT_A_MODIFIER },
+	{ ALT, NOT_A_MODIFIER },
+	{ WIN, NOT_A_MODIFIER },
+	{ CTRL, SHIFT },
+	{ CTRL, ALT },
+	{ WIN, SHIFT },
+	{ WIN, CTRL }
+};
+
+static const char *MODIFIER_NAMES[][2] = {
+	{ "control", NULL },
+	{ "shift", NULL },
+	{ "mod1", NULL },
+	{ "mod4", NULL },
+	{ "control", "shift" },
+	{ "control", "mod1" },
+	{ "mod4", "shift" },
+	{ "mod4", "control" }
+};
+
+#define MODIFIER_COUNT (sizeof(MODIFIERS) / sizeof(MODIFIERS[0]))
+
+static long g_exec_count = 0;
+
+static int
+write_rc(void)
+{
+	FILE *file;
+	size_t i;
+	size_t j;
+	int count;
+
+	file = fopen(RC_FILENAME, "w");
+	if (file == NULL)
+		exit(100);
+
+	count = 0;
+	for (i = 0; i < MODIFIER_COUNT; i++) {
+		for (j = 0; j < strlen(KEYS); j++) {
+			/**
+			 * Every 4th key stays unbound, so misses are measured as well.
+			 */
+			if (j % 4 == 3)
+				continue;
+
+			fprintf(file, "\"@mode default\"\n");
+			if (MODIFIER_NAMES[i][1]) {
+				fprintf(file, "  %s + %s + %c\n", MODIFIER_NAMES[i][0],
+				        MODIFIER_NAMES[i][1], KEYS[j]);
+			} else {
+				fprintf(file, "  %s + %c\n", MODIFIER_NAMES[i][0], KEYS[j]);
+			}
+			count++;
+		}
+	}
+
+	fclose(file);
+
+	return count;
+}
+
+static int
+exec_fn(wbk_backend_t *backend, wbk_b_t *b, void *param)
+{
+	g_exec_count++;
+
+	return wbk_kbtable_exec((wbk_kbtable_t *) param, 0, b);
+}
+
+static void
+send(wbk_backend_sim_t *sim, wbk_mk_t modifier, char key, int pressed)
+{
+	wbk_be_t be;
+
+	be.modifier = modifier;
+	be.key = key;
+
+	wbk_backend_sim_send(sim, &be, pressed);
+}
+
+int main(int argc, char **argv)
+{
+	wbk_parser_t *parser;
+	wbk_kbtable_t *kbtable;
+	wbk_backend_sim_t *sim;
+	long rounds;
+	long i;
+	int binding_count;
+	const wbk_mk_t *modifiers;
+	char key;
+	clock_t start;
+	double seconds;
+
+	rounds = argc > 1 ? atol(argv[1]) : DEFAULT_ROUNDS;
+
+	wbk_logger_set_level(SEVERE);
+
+	binding_count = write_rc();
+
+	parser = wbk_parser_new(RC_FILENAME);
+	kbtable = wbk_kbtable_new(parser, 1);
+	if (wbk_kbtable_load(kbtable))
+		exit(101);
+
+	sim = wbk_backend_sim_new(exec_fn, kbtable);
+	wbk_backend_start((wbk_backend_t *) sim);
+
+	start = clock();
+	for (i = 0; i < rounds; i++) {
+		modifiers = MODIFIERS[i % MODIFIER_COUNT];
+		key = KEYS[i % strlen(KEYS)];
+
+		send(sim, modifiers[0], '\0', 1);
+		if (modifiers[1] != NOT_A_MODIFIER)
+			send(sim, modifiers[1], '\0', 1);
+		send(sim, NOT_A_MODIFIER, key, 1);
+		send(sim, NOT_A_MODIFIER, key, 0);
+		if (modifiers[1] != NOT_A_MODIFIER)
+			send(sim, modifiers[1], '\0', 0);
+		send(sim, modifiers[0], '\0', 0);
+	}
+	seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+	printf("bindings:  %d\n", binding_count);
+	printf("events:    %ld\n", sim->event_count);
+	printf("lookups:   %ld\n", g_exec_count);
+	printf("swallowed: %ld\n", sim->swallow_count);
+	printf("seconds:   %.3f\n", seconds);
+	if (seconds > 0) {
+		printf("events/s:  %.0f\n", sim->event_count / seconds);
+	}
+
+	wbk_backend_free((wbk_backend_t *) sim);
+	wbk_kbtable_free(kbtable);
+	wbk_parser_free(parser);
+
+	remove(RC_FILENAME);
+
+	return 0;
+}
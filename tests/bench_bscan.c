@@ -0,0 +1,135 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * Measures how many bindings per second the binding scanner compares, for
+ * every instruction set the CPU supports. The probes miss, so every lookup
+ * scans all bindings.
+ *
+ * Usage: bench_bscan [BINDINGS] [ROUNDS]
+ */
+
+#include "bscan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "logger.h"
+
+#define DEFAULT_BINDINGS 1024
+#define DEFAULT_ROUNDS 100000
+
+static const char *ISA_NAMES[] = { "scalar", "sse2", "avx2" };
+
+static wbk_b_t *
+new_binding(int i)
+{
+	wbk_b_t *b;
+	wbk_be_t be;
+	int bit;
+
+	b = wbk_b_new();
+
+	/**
+	 * Every binding gets another set of modifiers
+	 */
+	for (bit = 0; bit < 16; bit++) {
+		if (i & (1 << bit)) {
+			be.modifier = WIN + bit;
+			be.key = '\0';
+			wbk_b_add(b, &be);
+		}
+	}
+
+	be.modifier = NOT_A_MODIFIER;
+	be.key = '1';
+	wbk_b_add(b, &be);
+	b->key_last = '9';
+
+	return b;
+}
+
+int main(int argc, char **argv)
+{
+	wbk_bscan_t *bscan;
+	wbk_b_t *b;
+	wbk_b_t *probe;
+	int bindings;
+	long rounds;
+	long misses;
+	long i;
+	int isa;
+	clock_t start;
+	double seconds;
+
+	bindings = argc > 1 ? atoi(argv[1]) : DEFAULT_BINDINGS;
+	rounds = argc > 2 ? atol(argv[2]) : DEFAULT_ROUNDS;
+
+	wbk_logger_set_level(SEVERE);
+
+	/**
+	 * The probe has the modifiers of the last binding, but a key out of its
+	 * range
+	 */
+	probe = new_binding(bindings - 1);
+	probe->key_last = '\0';
+	probe->key_map['1'] = 0;
+	probe->key_map['0'] = 1;
+
+	printf("bindings:  %d\n", bindings);
+	printf("lookups:   %ld\n", rounds);
+
+	for (isa = WBK_BSCAN_SCALAR; isa <= WBK_BSCAN_AVX2; isa++) {
+		bscan = wbk_bscan_new();
+		if (wbk_bscan_set_isa(bscan, isa) == 0) {
+			for (i = 0; i < bindings; i++) {
+				b = new_binding(i);
+				wbk_bscan_add(bscan, b, i);
+				wbk_b_free(b);
+			}
+
+			misses = 0;
+			start = clock();
+			for (i = 0; i < rounds; i++) {
+				misses += wbk_bscan_find(bscan, probe) < 0;
+			}
+			seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+			printf("%-7s    seconds: %.3f", ISA_NAMES[isa], seconds);
+			if (seconds > 0) {
+				printf("  bindings/s: %.0f", (double) bindings * rounds / seconds);
+			}
+			printf("  misses: %ld\n", misses);
+		} else {
+			printf("%-7s    not supported\n", ISA_NAMES[isa]);
+		}
+		wbk_bscan_free(bscan);
+	}
+
+	wbk_b_free(probe);
+
+	return 0;
+}
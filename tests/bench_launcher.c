@@ -0,0 +1,214 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+/**
+ * Measures the latency from executing a system command (see kc_sys.h) until
+ * the started process runs, once by a thread calling system() and once by a
+ * launcher (see launcher.h). The started process is this program, which
+ * writes the time it started.
+ *
+ * Usage: bench_launcher [ROUNDS]
+ */
+
+#include "launcher.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "kc_sys.h"
+#include "logger.h"
+#include "parser.h"
+
+#define STAMP_FILENAME "bench_launcher.stamp"
+
+#define DEFAULT_ROUNDS 200
+
+/**
+ * Microseconds of the system wide monotonic clock
+ */
+static long long
+now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+}
+
+/**
+ * Started process: writes the time it started
+ */
+static int
+stamp(const char *filename)
+{
+	char tmp_filename[PATH_MAX];
+	long long start;
+	FILE *file;
+
+	start = now();
+
+	snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", filename);
+	file = fopen(tmp_filename, "w");
+	if (file) {
+		fprintf(file, "%lld\n", start);
+		fclose(file);
+		rename(tmp_filename, filename);
+	}
+
+	return file == NULL;
+}
+
+/**
+ * Waits for the started process
+ *
+ * @return The time the process started or -1 if it did not start
+ */
+static long long
+wait_stamp(const char *filename)
+{
+	long long start;
+	FILE *file;
+	int i;
+
+	start = -1;
+	file = NULL;
+	for (i = 0; i < 50000 && file == NULL; i++) {
+		file = fopen(filename, "r");
+		if (file == NULL) {
+			usleep(100);
+		}
+	}
+
+	if (file) {
+		if (fscanf(file, "%lld", &start) != 1) {
+			start = -1;
+		}
+		fclose(file);
+		remove(filename);
+	}
+
+	return start;
+}
+
+static int
+compare_latency(const void *a, const void *b)
+{
+	long long x;
+	long long y;
+
+	x = *((const long long *) a);
+	y = *((const long long *) b);
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * Executes a system command repeatedly and prints the latencies
+ */
+static int
+run(const char *name, const char *cmd, long rounds)
+{
+	long long *latency_arr;
+	long long sum;
+	long long start;
+	wbk_kc_t *kc;
+	char *copy;
+	long i;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+	kc = (wbk_kc_t *) wbk_kc_sys_new(wbk_parser_parse_binding("mod4 + b"), copy);
+
+	latency_arr = malloc(sizeof(long long) * rounds);
+	sum = 0;
+	for (i = 0; i < rounds; i++) {
+		start = now();
+		wbk_kc_exec(kc);
+		latency_arr[i] = wait_stamp(STAMP_FILENAME) - start;
+		if (latency_arr[i] < 0)
+			exit(102);
+		sum += latency_arr[i];
+	}
+
+	qsort(latency_arr, rounds, sizeof(long long), compare_latency);
+	printf("%-9s min %6lld us  median %6lld us  mean %6lld us\n", name,
+	       latency_arr[0], latency_arr[rounds / 2], sum / rounds);
+
+	free(latency_arr);
+	wbk_kc_free(kc);
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	wbk_launcher_t *launcher;
+	char self[PATH_MAX];
+	char stamp_filename[PATH_MAX];
+	char cmd[3 * PATH_MAX];
+	long rounds;
+
+	if (argc > 2 && strcmp(argv[1], "--stamp") == 0)
+		return stamp(argv[2]);
+
+	rounds = argc > 1 ? atol(argv[1]) : DEFAULT_ROUNDS;
+	if (rounds <= 0)
+		exit(100);
+
+	wbk_logger_set_level(SEVERE);
+
+	/**
+	 * The launcher is started before anything else, like a daemon would
+	 */
+	launcher = wbk_launcher_new();
+
+	if (realpath(argv[0], self) == NULL)
+		exit(101);
+	if (getcwd(stamp_filename, sizeof(stamp_filename)) == NULL)
+		exit(101);
+	strcat(stamp_filename, "/" STAMP_FILENAME);
+	remove(STAMP_FILENAME);
+
+	/**
+	 * Unquoted, because the shell of system() would take a quoted command as
+	 * a single word
+	 */
+	snprintf(cmd, sizeof(cmd), "%s --stamp %s", self, stamp_filename);
+
+	printf("rounds:   %ld\n", rounds);
+	run("system()", cmd, rounds);
+
+	wbk_launcher_set_default(launcher);
+	run("launcher", cmd, rounds);
+	wbk_launcher_set_default(NULL);
+
+	wbk_launcher_free(launcher);
+
+	return 0;
+}
@@ -0,0 +1,196 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+/**
+ * Measures building a minimal perfect hash over 1k ... 1M bindings and the
+ * cost of a lookup, including the verifying compare. The last column is the
+ * cost of a lookup by an open addressing index over wbk_b_hash(), like the
+ * one of uncompiled modes.
+ *
+ * Usage: bench_mph [MAX_BINDINGS] [LOOKUPS]
+ */
+
+#include "mph.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "logger.h"
+
+#define DEFAULT_MAX_BINDINGS 1000000
+#define DEFAULT_LOOKUPS 2000000
+
+#define KEYS "abcdefghijklmnopqrstuvwxyz0123456789"
+#define KEY_COUNT 36
+
+/**
+ * Binding i gets key i % KEY_COUNT and a set of modifiers of the other bits
+ */
+static void
+init_binding(wbk_b_t *b, int i)
+{
+	wbk_be_t be;
+	int rest;
+	int bit;
+
+	wbk_b_reset(b);
+
+	be.modifier = NOT_A_MODIFIER;
+	be.key = KEYS[i % KEY_COUNT];
+	wbk_b_add(b, &be);
+
+	rest = i / KEY_COUNT;
+	for (bit = 0; rest; bit++, rest >>= 1) {
+		if (rest & 1) {
+			be.modifier = WIN + bit;
+			be.key = '\0';
+			wbk_b_add(b, &be);
+		}
+	}
+}
+
+/**
+ * Builds an open addressing index like wbk_kbman_mode_reindex() and measures
+ * its lookups.
+ *
+ * @return Seconds of all lookups
+ */
+static double
+bench_index(const wbk_b_t **b_arr, int len, long lookups)
+{
+	int *index;
+	int index_len;
+	int mask;
+	int slot;
+	long found;
+	long i;
+	const wbk_b_t *b;
+	clock_t start;
+
+	for (index_len = 16; len * 4 > index_len * 3; index_len *= 2) {
+		/* Same load factor as the modes */
+	}
+	mask = index_len - 1;
+	index = calloc(index_len, sizeof(int));
+
+	for (i = 0; i < len; i++) {
+		slot = wbk_b_hash(b_arr[i]) & mask;
+		while (index[slot]) {
+			slot = (slot + 1) & mask;
+		}
+		index[slot] = i + 1;
+	}
+
+	found = 0;
+	start = clock();
+	for (i = 0; i < lookups; i++) {
+		b = b_arr[(i * 7919) % len];
+		slot = wbk_b_hash(b) & mask;
+		while (index[slot] && wbk_b_compare(b_arr[index[slot] - 1], b)) {
+			slot = (slot + 1) & mask;
+		}
+		found += index[slot] != 0;
+	}
+	if (found != lookups)
+		exit(103);
+
+	free(index);
+
+	return (double) (clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char **argv)
+{
+	wbk_mph_t *mph;
+	wbk_b_t *b_arr;
+	const wbk_b_t **b_ptr_arr;
+	int *values;
+	int max_len;
+	long lookups;
+	long found;
+	long i;
+	int len;
+	int value;
+	clock_t start;
+	double build_seconds;
+	double lookup_seconds;
+	double index_seconds;
+
+	max_len = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_BINDINGS;
+	lookups = argc > 2 ? atol(argv[2]) : DEFAULT_LOOKUPS;
+
+	wbk_logger_set_level(SEVERE);
+
+	b_arr = malloc(sizeof(wbk_b_t) * max_len);
+	b_ptr_arr = malloc(sizeof(wbk_b_t *) * max_len);
+	values = malloc(sizeof(int) * max_len);
+	if (!b_arr || !b_ptr_arr || !values)
+		exit(100);
+
+	for (i = 0; i < max_len; i++) {
+		init_binding(b_arr + i, i);
+		b_ptr_arr[i] = b_arr + i;
+		values[i] = i;
+	}
+
+	printf("%10s %12s %12s %12s %12s\n", "bindings", "build ms", "ns/binding", "ns/lookup",
+	       "ns/probed");
+	for (len = 1000; len <= max_len; len *= 10) {
+		start = clock();
+		mph = wbk_mph_new(b_ptr_arr, values, len);
+		build_seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+		if (mph == NULL)
+			exit(101);
+
+		/**
+		 * Lookups walk the bindings with a stride, so large hashes miss the
+		 * caches like they would in use
+		 */
+		found = 0;
+		start = clock();
+		for (i = 0; i < lookups; i++) {
+			value = wbk_mph_find(mph, b_ptr_arr[(i * 7919) % len]);
+			found += wbk_b_compare(b_ptr_arr[value], b_ptr_arr[(i * 7919) % len]) == 0;
+		}
+		lookup_seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+		if (found != lookups)
+			exit(102);
+
+		index_seconds = bench_index(b_ptr_arr, len, lookups);
+
+		printf("%10d %12.1f %12.1f %12.1f %12.1f\n", len, build_seconds * 1000,
+		       build_seconds * 1e9 / len, lookup_seconds * 1e9 / lookups,
+		       index_seconds * 1e9 / lookups);
+
+		wbk_mph_free(mph);
+	}
+
+	free(b_arr);
+	free(b_ptr_arr);
+	free(values);
+
+	return 0;
+}
@@ -0,0 +1,267 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+
+#include "backend_evdev.h"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define EVENT_FILENAME "check_backend_evdev.events"
+
+#define WAIT_INTERVAL 10
+
+#define WAIT_TRIES 300
+
+static wbk_b_t *g_expected = NULL;
+static int g_match_count = 0;
+
+static int
+exec_fn(wbk_backend_t *backend, wbk_b_t *b, void *param)
+{
+	int error;
+
+	error = wbk_b_compare(b, g_expected);
+	if (!error) {
+		__atomic_add_fetch(&g_match_count, 1, __ATOMIC_SEQ_CST);
+	}
+
+	return error;
+}
+
+static void
+fill_event(struct input_event *event, unsigned short type, unsigned short code, int value)
+{
+	memset(event, 0, sizeof(struct input_event));
+	event->type = type;
+	event->code = code;
+	event->value = value;
+}
+
+/**
+ * Records control + a including a SYN_REPORT after every key event, an auto
+ * repeat and a key which cannot be bound.
+ * @return The number of recorded events
+ */
+static int
+record(struct input_event *event_arr)
+{
+	int n;
+
+	n = 0;
+	fill_event(&event_arr[n++], EV_KEY, KEY_LEFTCTRL, 1);
+	fill_event(&event_arr[n++], EV_SYN, SYN_REPORT, 0);
+	fill_event(&event_arr[n++], EV_KEY, KEY_A, 1);
+	fill_event(&event_arr[n++], EV_SYN, SYN_REPORT, 0);
+	fill_event(&event_arr[n++], EV_KEY, KEY_A, 2);
+	fill_event(&event_arr[n++], EV_SYN, SYN_REPORT, 0);
+	fill_event(&event_arr[n++], EV_KEY, KEY_A, 0);
+	fill_event(&event_arr[n++], EV_SYN, SYN_REPORT, 0);
+	fill_event(&event_arr[n++], EV_KEY, KEY_VOLUMEUP, 1);
+	fill_event(&event_arr[n++], EV_KEY, KEY_VOLUMEUP, 0);
+	fill_event(&event_arr[n++], EV_KEY, KEY_LEFTCTRL, 0);
+	fill_event(&event_arr[n++], EV_SYN, SYN_REPORT, 0);
+
+	return n;
+}
+
+static void
+wait_finished(wbk_backend_evdev_t *evdev)
+{
+	int i;
+
+	for (i = 0; i < WAIT_TRIES && !wbk_backend_evdev_finished(evdev); i++) {
+		usleep(WAIT_INTERVAL * 1000);
+	}
+}
+
+static void
+test_to_be(void)
+{
+	wbk_be_t be;
+
+	if (wbk_backend_evdev_to_be(KEY_A, &be) || be.key != 'a' || be.modifier != NOT_A_MODIFIER)
+		exit(1);
+
+	if (wbk_backend_evdev_to_be(KEY_0, &be) || be.key != '0')
+		exit(2);
+
+	if (wbk_backend_evdev_to_be(KEY_RIGHTCTRL, &be) || be.modifier != RCTRL || be.key != '\0')
+		exit(3);
+
+	if (wbk_backend_evdev_to_be(KEY_LEFTMETA, &be) || be.modifier != LWIN)
+		exit(4);
+
+	if (wbk_backend_evdev_to_be(KEY_F12, &be) || be.modifier != F12)
+		exit(5);
+
+	if (wbk_backend_evdev_to_be(KEY_VOLUMEUP, &be) == 0)
+		exit(6);
+
+	if (wbk_backend_evdev_to_be(BTN_SIDE, &be) || be.modifier != MOUSE_BACK)
+		exit(7);
+
+	if (wbk_backend_evdev_to_be(KEY_ESC, &be) || be.modifier != ESCAPE)
+		exit(8);
+}
+
+static void
+test_file(void)
+{
+	wbk_backend_evdev_t *evdev;
+	struct input_event event_arr[16];
+	int event_arr_len;
+	FILE *file;
+
+	event_arr_len = record(event_arr);
+
+	file = fopen(EVENT_FILENAME, "wb");
+	if (file == NULL)
+		exit(100);
+	fwrite(event_arr, sizeof(struct input_event), event_arr_len, file);
+	fclose(file);
+
+	g_match_count = 0;
+	evdev = wbk_backend_evdev_new(exec_fn, NULL, EVENT_FILENAME);
+	if (evdev == NULL)
+		exit(10);
+
+	if (wbk_backend_start((wbk_backend_t *) evdev))
+		exit(11);
+
+	wait_finished(evdev);
+	if (!wbk_backend_evdev_finished(evdev))
+		exit(12);
+
+	if (g_match_count != 1)
+		exit(13);
+
+	/**
+	 * The auto repeat is read, the unknown key is not
+	 */
+	if (evdev->event_count != 5)
+		exit(14);
+
+	/**
+	 * Restarting reads the recording again
+	 */
+	if (wbk_backend_start((wbk_backend_t *) evdev))
+		exit(15);
+	wait_finished(evdev);
+	if (g_match_count != 2)
+		exit(16);
+
+	wbk_backend_free((wbk_backend_t *) evdev);
+
+	remove(EVENT_FILENAME);
+}
+
+static void
+test_pipe(void)
+{
+	wbk_backend_evdev_t *evdev;
+	struct input_event event_arr[16];
+	int event_arr_len;
+	int fds[2];
+	char device[64];
+	size_t half;
+
+	event_arr_len = record(event_arr);
+
+	if (pipe(fds))
+		exit(100);
+
+	sprintf(device, "/proc/self/fd/%d", fds[0]);
+
+	g_match_count = 0;
+	evdev = wbk_backend_evdev_new(exec_fn, NULL, device);
+	if (wbk_backend_start((wbk_backend_t *) evdev))
+		exit(20);
+
+	/**
+	 * Split an event across two writes
+	 */
+	half = sizeof(struct input_event) * 2 + sizeof(struct input_event) / 2;
+	if (write(fds[1], event_arr, half) != half)
+		exit(101);
+	usleep(WAIT_INTERVAL * 1000);
+
+	if (wbk_backend_evdev_finished(evdev))
+		exit(21);
+
+	if (write(fds[1], (char *) event_arr + half,
+	          sizeof(struct input_event) * event_arr_len - half)
+	    != sizeof(struct input_event) * event_arr_len - half)
+		exit(102);
+	close(fds[1]);
+
+	wait_finished(evdev);
+	if (!wbk_backend_evdev_finished(evdev) || g_match_count != 1)
+		exit(22);
+
+	wbk_backend_free((wbk_backend_t *) evdev);
+	close(fds[0]);
+}
+
+static void
+test_missing_device(void)
+{
+	wbk_backend_evdev_t *evdev;
+
+	evdev = wbk_backend_evdev_new(exec_fn, NULL, "does-not-exist.events");
+	if (wbk_backend_start((wbk_backend_t *) evdev) == 0)
+		exit(30);
+
+	wbk_backend_free((wbk_backend_t *) evdev);
+}
+
+int main(void)
+{
+	wbk_be_t be;
+
+	/**
+	 * The left control holds the generic control too
+	 */
+	g_expected = wbk_b_new();
+	be.modifier = LCTRL;
+	be.key = '\0';
+	wbk_b_add(g_expected, &be);
+	be.modifier = NOT_A_MODIFIER;
+	be.key = 'a';
+	wbk_b_add(g_expected, &be);
+
+	test_to_be();
+	test_file();
+	test_pipe();
+	test_missing_device();
+
+	wbk_b_free(g_expected);
+
+	return 0;
+}
@@ -0,0 +1,508 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+#include "backend_sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "kbtable.h"
+#include "parser.h"
+#include "sink.h"
+
+#define RC_FILENAME "check_backend_sim.rc"
+#define EVENT_FILENAME "check_backend_sim.events"
+
+static void
+write_rc(void)
+{
+	FILE *file;
+
+	file = fopen(RC_FILENAME, "w");
+	if (file == NULL)
+		exit(100);
+
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  control + a\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  mod4 + wheel-up\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  control + b:1\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  tap + f2\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  hold + f2\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  double + f1\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  chord + shift + s\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  tap + control + t\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  control + r\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  release + control + r\n");
+	fprintf(file, "\"@remap escape\"\n");
+	fprintf(file, "  tap + capslock\n");
+	fprintf(file, "\"@remap control\"\n");
+	fprintf(file, "  hold + capslock\n");
+
+	fclose(file);
+}
+
+static int g_trigger_count[TRIGGER_HOLD_END + 1];
+
+static wbk_sink_event_t g_sent;
+static int g_sent_len = 0;
+
+static int
+record_send(wbk_sink_t *sink, const wbk_sink_batch_t *batch)
+{
+	g_sent = batch->event_arr[0];
+	g_sent_len = batch->event_arr_len;
+
+	return 0;
+}
+
+static int
+exec_fn(wbk_backend_t *backend, wbk_b_t *b, void *param)
+{
+	int error;
+
+	error = wbk_kbtable_exec((wbk_kbtable_t *) param, 0, b);
+	if (error == 0) {
+		g_trigger_count[b->trigger]++;
+	}
+
+	return error;
+}
+
+static int
+send(wbk_backend_sim_t *sim, wbk_mk_t modifier, char key, int pressed)
+{
+	wbk_be_t be;
+
+	be.modifier = modifier;
+	be.key = key;
+
+	return wbk_backend_sim_send(sim, &be, pressed);
+}
+
+static void
+test_send(wbk_kbtable_t *kbtable)
+{
+	wbk_backend_sim_t *sim;
+
+	sim = wbk_backend_sim_new(exec_fn, kbtable);
+	if (sim == NULL)
+		exit(1);
+
+	/**
+	 * Events are dropped before the backend is started
+	 */
+	if (send(sim, CTRL, '\0', 1) == 0 || sim->event_count != 0)
+		exit(2);
+
+	if (wbk_backend_start((wbk_backend_t *) sim))
+		exit(3);
+
+	if (send(sim, CTRL, '\0', 1) == 0)
+		exit(4);
+
+	if (send(sim, NOT_A_MODIFIER, 'a', 1) != 0)
+		exit(5);
+
+	if (send(sim, NOT_A_MODIFIER, 'a', 0) == 0
+		|| send(sim, CTRL, '\0', 0) == 0)
+		exit(6);
+
+	if (send(sim, NOT_A_MODIFIER, 'a', 1) == 0
+		|| send(sim, NOT_A_MODIFIER, 'a', 0) == 0)
+		exit(7);
+
+	if (sim->event_count != 6 || sim->swallow_count != 1)
+		exit(8);
+
+	wbk_backend_free((wbk_backend_t *) sim);
+}
+
+static void
+test_stop(wbk_kbtable_t *kbtable)
+{
+	wbk_backend_sim_t *sim;
+
+	sim = wbk_backend_sim_new(exec_fn, kbtable);
+	wbk_backend_start((wbk_backend_t *) sim);
+
+	send(sim, CTRL, '\0', 1);
+	wbk_backend_stop((wbk_backend_t *) sim);
+	wbk_backend_start((wbk_backend_t *) sim);
+
+	/**
+	 * The control key was forgotten when the backend stopped
+	 */
+	if (send(sim, NOT_A_MODIFIER, 'a', 1) == 0)
+		exit(10);
+
+	wbk_backend_free((wbk_backend_t *) sim);
+}
+
+static void
+test_mouse(wbk_kbtable_t *kbtable)
+{
+	wbk_backend_sim_t *sim;
+	wbk_b_t *b;
+	wbk_be_t be;
+	char *str;
+
+	b = wbk_parser_parse_binding("mod4 + wheel-up");
+	str = wbk_b_to_str(b);
+	if (strcmp(str, "Mod4 + b:4"))
+		exit(40);
+	free(str);
+	wbk_b_free(b);
+
+	sim = wbk_backend_sim_new(exec_fn, kbtable);
+	wbk_backend_start((wbk_backend_t *) sim);
+
+	be.modifier = WHEEL_UP;
+	be.key = '\0';
+
+	send(sim, WIN, '\0', 1);
+	if (wbk_backend_sim_click(sim, &be) != 0)
+		exit(41);
+
+	/**
+	 * The notch is released right away, so the next one matches too
+	 */
+	if (wbk_backend_sim_click(sim, &be) != 0)
+		exit(42);
+	send(sim, WIN, '\0', 0);
+
+	if (wbk_backend_sim_click(sim, &be) == 0)
+		exit(43);
+
+	send(sim, CTRL, '\0', 1);
+	if (send(sim, MOUSE_LEFT, '\0', 1) != 0)
+		exit(44);
+	send(sim, MOUSE_LEFT, '\0', 0);
+	send(sim, CTRL, '\0', 0);
+
+	if (sim->swallow_count != 3)
+		exit(45);
+
+	wbk_backend_free((wbk_backend_t *) sim);
+}
+
+static void
+test_trigger(wbk_kbtable_t *kbtable)
+{
+	wbk_backend_sim_t *sim;
+	wbk_b_t *b;
+	char *str;
+
+	b = wbk_parser_parse_binding("hold + f2");
+	str = wbk_b_to_str(b);
+	if (strcmp(str, "Hold + F2"))
+		exit(50);
+	free(str);
+	wbk_b_free(b);
+
+	sim = wbk_backend_sim_new(exec_fn, kbtable);
+	wbk_backend_start((wbk_backend_t *) sim);
+	memset(g_trigger_count, 0, sizeof(g_trigger_count));
+
+	/**
+	 * The press is swallowed because a tap or a hold may follow
+	 */
+	if (send(sim, F2, '\0', 1) != 0)
+		exit(51);
+	send(sim, F2, '\0', 0);
+	if (g_trigger_count[TRIGGER_TAP] != 1 || g_trigger_count[TRIGGER_HOLD] != 0)
+		exit(52);
+
+	wbk_backend_sim_wait(sim, 1000);
+	send(sim, F2, '\0', 1);
+	wbk_backend_sim_wait(sim, WBK_BACKEND_HOLD_TIMEOUT + 50);
+	if (g_trigger_count[TRIGGER_HOLD] != 1)
+		exit(53);
+	send(sim, F2, '\0', 0);
+	if (g_trigger_count[TRIGGER_TAP] != 1 || g_trigger_count[TRIGGER_HOLD] != 1)
+		exit(54);
+
+	send(sim, F1, '\0', 1);
+	send(sim, F1, '\0', 0);
+	wbk_backend_sim_wait(sim, 100);
+	send(sim, F1, '\0', 1);
+	send(sim, F1, '\0', 0);
+	if (g_trigger_count[TRIGGER_DOUBLE_TAP] != 1)
+		exit(55);
+
+	/**
+	 * Too slow for a double tap
+	 */
+	wbk_backend_sim_wait(sim, 1000);
+	send(sim, F1, '\0', 1);
+	send(sim, F1, '\0', 0);
+	wbk_backend_sim_wait(sim, WBK_BACKEND_DOUBLE_TAP_TIMEOUT + 50);
+	send(sim, F1, '\0', 1);
+	send(sim, F1, '\0', 0);
+	if (g_trigger_count[TRIGGER_DOUBLE_TAP] != 1)
+		exit(56);
+
+	send(sim, SHIFT, '\0', 1);
+	if (send(sim, NOT_A_MODIFIER, 's', 1) != 0)
+		exit(57);
+	send(sim, NOT_A_MODIFIER, 's', 0);
+	send(sim, SHIFT, '\0', 0);
+	if (g_trigger_count[TRIGGER_CHORD] != 1)
+		exit(58);
+
+	/**
+	 * Too slow for a chord
+	 */
+	send(sim, SHIFT, '\0', 1);
+	wbk_backend_sim_wait(sim, WBK_BACKEND_CHORD_TIMEOUT + 50);
+	send(sim, NOT_A_MODIFIER, 's', 1);
+	send(sim, NOT_A_MODIFIER, 's', 0);
+	send(sim, SHIFT, '\0', 0);
+	if (g_trigger_count[TRIGGER_CHORD] != 1)
+		exit(59);
+
+	/**
+	 * The system saw the key down of control, so it sees its key up too,
+	 * although the tap fires on it
+	 */
+	wbk_backend_sim_wait(sim, 1000);
+	if (send(sim, CTRL, '\0', 1) == 0 || send(sim, NOT_A_MODIFIER, 't', 1) != 0)
+		exit(70);
+	if (send(sim, CTRL, '\0', 0) == 0 || g_trigger_count[TRIGGER_TAP] != 2)
+		exit(71);
+	send(sim, NOT_A_MODIFIER, 't', 0);
+
+	wbk_backend_free((wbk_backend_t *) sim);
+}
+
+static void
+test_release(wbk_kbtable_t *kbtable)
+{
+	wbk_backend_sim_t *sim;
+	wbk_b_t *b;
+	char *str;
+
+	b = wbk_parser_parse_binding("release + control + r");
+	str = wbk_b_to_str(b);
+	if (strcmp(str, "Release + Ctrl + r") || b->modifier_map[ENTER])
+		exit(60);
+	free(str);
+	wbk_b_free(b);
+
+	sim = wbk_backend_sim_new(exec_fn, kbtable);
+	wbk_backend_start((wbk_backend_t *) sim);
+	memset(g_trigger_count, 0, sizeof(g_trigger_count));
+
+	/**
+	 * The press and the release binding of the same combination both fire
+	 */
+	send(sim, CTRL, '\0', 1);
+	if (send(sim, NOT_A_MODIFIER, 'r', 1) != 0
+	    || g_trigger_count[TRIGGER_PRESS] != 1 || g_trigger_count[TRIGGER_RELEASE] != 0)
+		exit(61);
+	if (send(sim, NOT_A_MODIFIER, 'r', 0) != 0 || g_trigger_count[TRIGGER_RELEASE] != 1)
+		exit(62);
+	send(sim, CTRL, '\0', 0);
+	if (g_trigger_count[TRIGGER_RELEASE] != 1)
+		exit(63);
+
+	/**
+	 * Held long enough to be a hold, it is still released
+	 */
+	send(sim, CTRL, '\0', 1);
+	send(sim, NOT_A_MODIFIER, 'r', 1);
+	wbk_backend_sim_wait(sim, WBK_BACKEND_HOLD_TIMEOUT + 50);
+	send(sim, CTRL, '\0', 0);
+	send(sim, NOT_A_MODIFIER, 'r', 0);
+	if (g_trigger_count[TRIGGER_RELEASE] != 2)
+		exit(64);
+
+	/**
+	 * Another key pressed in between disarms the release
+	 */
+	send(sim, CTRL, '\0', 1);
+	send(sim, NOT_A_MODIFIER, 'r', 1);
+	send(sim, NOT_A_MODIFIER, 'x', 1);
+	send(sim, NOT_A_MODIFIER, 'x', 0);
+	send(sim, NOT_A_MODIFIER, 'r', 0);
+	send(sim, CTRL, '\0', 0);
+	if (g_trigger_count[TRIGGER_RELEASE] != 2)
+		exit(65);
+
+	/**
+	 * Releasing control first fires the release, but its key up reaches
+	 * the system like its key down did
+	 */
+	if (send(sim, CTRL, '\0', 1) == 0 || send(sim, NOT_A_MODIFIER, 'r', 1) != 0)
+		exit(66);
+	if (send(sim, CTRL, '\0', 0) == 0 || g_trigger_count[TRIGGER_RELEASE] != 3)
+		exit(67);
+	send(sim, NOT_A_MODIFIER, 'r', 0);
+	if (g_trigger_count[TRIGGER_RELEASE] != 3)
+		exit(68);
+
+	wbk_backend_free((wbk_backend_t *) sim);
+}
+
+static void
+test_hold(wbk_kbtable_t *kbtable)
+{
+	wbk_backend_sim_t *sim;
+
+	sim = wbk_backend_sim_new(exec_fn, kbtable);
+	wbk_backend_start((wbk_backend_t *) sim);
+	memset(g_trigger_count, 0, sizeof(g_trigger_count));
+
+	/**
+	 * Tapped, Capslock acts as Escape
+	 */
+	if (send(sim, CAPSLOCK, '\0', 1) != 0 || g_sent_len != 0)
+		exit(80);
+	if (send(sim, CAPSLOCK, '\0', 0) != 0 || g_sent_len != 2
+	    || g_sent.be.modifier != ESCAPE || g_sent.pressed != 1)
+		exit(81);
+
+	/**
+	 * Held, it acts as Control until it is released. Keys pressed meanwhile
+	 * reach the system along with it.
+	 */
+	wbk_backend_sim_wait(sim, 1000);
+	send(sim, CAPSLOCK, '\0', 1);
+	wbk_backend_sim_wait(sim, WBK_BACKEND_HOLD_TIMEOUT + 50);
+	if (g_sent_len != 1 || g_sent.be.modifier != CTRL || g_sent.pressed != 1)
+		exit(82);
+	if (send(sim, NOT_A_MODIFIER, 'x', 1) == 0 || send(sim, NOT_A_MODIFIER, 'x', 0) == 0)
+		exit(83);
+	if (g_sent.pressed != 1 || g_trigger_count[TRIGGER_HOLD_END] != 0)
+		exit(84);
+	if (send(sim, CAPSLOCK, '\0', 0) != 0 || g_sent_len != 1
+	    || g_sent.be.modifier != CTRL || g_sent.pressed != 0
+	    || g_trigger_count[TRIGGER_HOLD_END] != 1 || g_trigger_count[TRIGGER_TAP] != 1)
+		exit(85);
+
+	/**
+	 * Forgetting the pressed keys releases Control as well
+	 */
+	send(sim, CAPSLOCK, '\0', 1);
+	wbk_backend_sim_wait(sim, WBK_BACKEND_HOLD_TIMEOUT + 50);
+	wbk_backend_reset((wbk_backend_t *) sim);
+	if (g_sent.be.modifier != CTRL || g_sent.pressed != 0
+	    || g_trigger_count[TRIGGER_HOLD_END] != 2)
+		exit(86);
+
+	wbk_backend_free((wbk_backend_t *) sim);
+}
+
+static void
+test_play(wbk_kbtable_t *kbtable)
+{
+	wbk_backend_sim_t *sim;
+	FILE *file;
+
+	file = fopen(EVENT_FILENAME, "w");
+	if (file == NULL)
+		exit(100);
+
+	fprintf(file, "# Executes control + a twice\n");
+	fprintf(file, "press control\n");
+	fprintf(file, "press a\n");
+	fprintf(file, "release a\n");
+	fprintf(file, "\n");
+	fprintf(file, "press a\n");
+	fprintf(file, "release a\n");
+	fprintf(file, "release control\n");
+	fprintf(file, "press mod4\n");
+	fprintf(file, "click b:4\n");
+	fprintf(file, "release mod4\n");
+
+	fclose(file);
+
+	sim = wbk_backend_sim_new(exec_fn, kbtable);
+	wbk_backend_start((wbk_backend_t *) sim);
+
+	if (wbk_backend_sim_play(sim, EVENT_FILENAME))
+		exit(20);
+
+	if (sim->event_count != 9 || sim->swallow_count != 3)
+		exit(21);
+
+	file = fopen(EVENT_FILENAME, "w");
+	fprintf(file, "press control\n");
+	fprintf(file, "hold a\n");
+	fclose(file);
+
+	if (wbk_backend_sim_play(sim, EVENT_FILENAME) == 0)
+		exit(22);
+
+	if (wbk_backend_sim_play(sim, "does-not-exist.events") == 0)
+		exit(23);
+
+	wbk_backend_free((wbk_backend_t *) sim);
+
+	remove(EVENT_FILENAME);
+}
+
+int main(void)
+{
+	wbk_parser_t *parser;
+	wbk_kbtable_t *kbtable;
+	wbk_sink_t *sink;
+
+	sink = wbk_sink_new();
+	sink->sink_send = record_send;
+	wbk_sink_set_default(sink);
+
+	write_rc();
+
+	parser = wbk_parser_new(RC_FILENAME);
+	kbtable = wbk_kbtable_new(parser, 1);
+	if (wbk_kbtable_load(kbtable))
+		exit(101);
+
+	test_send(kbtable);
+	test_stop(kbtable);
+	test_mouse(kbtable);
+	test_trigger(kbtable);
+	test_release(kbtable);
+	test_hold(kbtable);
+	test_play(kbtable);
+
+	wbk_kbtable_free(kbtable);
+	wbk_parser_free(parser);
+	wbk_sink_free(sink);
+
+	remove(RC_FILENAME);
+
+	return 0;
+}
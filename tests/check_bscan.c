@@ -0,0 +1,174 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "launcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bscan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const wbk_mk_t MODIFIERS[] = { WIN, ALT, CTRL, SHIFT, F1 };
+
+#define MODIFIER_COUNT (sizeof(MODIFIERS) / sizeof(MODIFIERS[0]))
+
+static wbk_b_t *
+new_binding(wbk_mk_t modifier, char first, char last, wbk_trigger_t trigger)
+{
+	wbk_b_t *b;
+	wbk_be_t be;
+
+	b = wbk_b_new();
+
+	be.modifier = modifier;
+	be.key = '\0';
+	wbk_b_add(b, &be);
+
+	be.modifier = NOT_A_MODIFIER;
+	be.key = first;
+	wbk_b_add(b, &be);
+
+	b->key_last = last;
+	b->trigger = trigger;
+
+	return b;
+}
+
+static int
+find(const wbk_bscan_t *bscan, wbk_mk_t modifier, char key, wbk_trigger_t trigger)
+{
+	wbk_b_t *b;
+	int value;
+
+	b = new_binding(modifier, key, '\0', trigger);
+	value = wbk_bscan_find(bscan, b);
+	wbk_b_free(b);
+
+	return value;
+}
+
+/**
+ * Fills a scanner with 37 bindings, so the vector loops and the scalar tail
+ * are both run, and checks the result against wbk_b_matches(). Every 4th
+ * binding ignores the lock modifiers, which some probes hold.
+ */
+static void
+test_isa(wbk_bscan_isa_t isa)
+{
+	wbk_bscan_t *bscan;
+	wbk_b_t *arr[37];
+	wbk_b_t *probe;
+	wbk_mk_t modifier;
+	int expected;
+	int i;
+	int j;
+	int k;
+	int t;
+	int lock;
+
+	bscan = wbk_bscan_new();
+	if (wbk_bscan_set_isa(bscan, isa) || wbk_bscan_get_isa(bscan) != isa)
+		exit(1);
+
+	if (find(bscan, WIN, '1', TRIGGER_PRESS) != -1)
+		exit(2);
+
+	for (i = 0; i < 37; i++) {
+		arr[i] = new_binding(MODIFIERS[i % MODIFIER_COUNT], 'a' + i % 20,
+		                     'a' + i % 20 + i % 3, i % 7 == 6 ? TRIGGER_HOLD : TRIGGER_PRESS);
+		arr[i]->ignore_mask = i % 4 == 3 ? WBK_B_LOCK_MASK : 0;
+		if (wbk_bscan_add(bscan, arr[i], 100 + i))
+			exit(3);
+	}
+
+	for (i = 0; i < MODIFIER_COUNT; i++) {
+		modifier = MODIFIERS[i];
+		for (k = 'a'; k <= 'z'; k++) {
+			for (t = 0; t < 4; t++) {
+				lock = t / 2;
+				probe = new_binding(modifier, k, '\0', t % 2 ? TRIGGER_HOLD : TRIGGER_PRESS);
+				probe->modifier_map[CAPSLOCK] = lock;
+
+				expected = -1;
+				for (j = 0; expected < 0 && j < 37; j++) {
+					if (wbk_b_matches(arr[j], probe)) {
+						expected = 100 + j;
+					}
+				}
+
+				if (wbk_bscan_find(bscan, probe) != expected)
+					exit(4);
+
+				/**
+				 * Only bindings ignoring the locks match if one is held
+				 */
+				if (lock && expected >= 0 && (expected - 100) % 4 != 3)
+					exit(7);
+
+				wbk_b_free(probe);
+			}
+		}
+	}
+
+	/**
+	 * Combinations of more than one key do not match
+	 */
+	probe = new_binding(WIN, 'a', '\0', TRIGGER_PRESS);
+	probe->key_map['b'] = 1;
+	if (wbk_bscan_find(bscan, probe) != -1)
+		exit(5);
+
+	if (!wbk_bscan_add(bscan, probe, 0))
+		exit(6);
+	wbk_b_free(probe);
+
+	for (i = 0; i < 37; i++) {
+		wbk_b_free(arr[i]);
+	}
+	wbk_bscan_free(bscan);
+}
+
+int main(void)
+{
+	wbk_bscan_t *bscan;
+	int isa;
+
+	bscan = wbk_bscan_new();
+	if (wbk_bscan_set_isa(bscan, WBK_BSCAN_SCALAR))
+		exit(10);
+	wbk_bscan_free(bscan);
+
+	for (isa = WBK_BSCAN_SCALAR; isa <= WBK_BSCAN_AVX2; isa++) {
+		bscan = wbk_bscan_new();
+		if (wbk_bscan_set_isa(bscan, isa) == 0) {
+			test_isa(isa);
+		}
+		wbk_bscan_free(bscan);
+	}
+
+	return 0;
+}
@@ -0,0 +1,193 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "launcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "caps.h"
+#include "kc_sys.h"
+#include "launcher.h"
+#include "parser.h"
+
+#define OUT_FILENAME "check_caps.out"
+#define DETACHED_FILENAME "check_caps.detached"
+#define ATTACHED_FILENAME "check_caps.attached"
+
+/**
+ * Waits until a number of processes of a concurrency limit are running.
+ */
+static int
+expect_running(wbk_limit_t *limit, int running)
+{
+	int i;
+
+	for (i = 0; i < 300 && wbk_limit_get_running(limit) != running; i++) {
+		usleep(10000);
+	}
+
+	return wbk_limit_get_running(limit) != running;
+}
+
+/**
+ * Waits until a started process wrote a file and compares its first line.
+ */
+static int
+expect_file(const char *filename, const char *line)
+{
+	char buffer[64];
+	FILE *file;
+	int i;
+	int error;
+
+	file = NULL;
+	for (i = 0; i < 300 && file == NULL; i++) {
+		if (access(filename, F_OK) == 0) {
+			usleep(20000);
+			file = fopen(filename, "r");
+		} else {
+			usleep(10000);
+		}
+	}
+
+	error = file == NULL;
+	if (file) {
+		error = line && (fgets(buffer, sizeof(buffer), file) == NULL || strcmp(buffer, line));
+		fclose(file);
+	}
+	remove(filename);
+
+	return error;
+}
+
+static wbk_kc_sys_t *
+parse_kc_sys(const char *cmd)
+{
+	char *copy;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+
+	return (wbk_kc_sys_t *) wbk_parser_parse_kc(NULL, wbk_parser_parse_binding("mod4 + t"), copy);
+}
+
+int
+main(void)
+{
+	wbk_launcher_t *launcher;
+	wbk_kc_sys_t *kc_sys;
+	const wbk_caps_t *caps;
+	char *str;
+
+	remove(OUT_FILENAME);
+	remove(DETACHED_FILENAME);
+	remove(ATTACHED_FILENAME);
+
+	/**
+	 * The options of the rc file
+	 */
+	kc_sys = parse_kc_sys("\"make\" skip-if-running priority=low memory=512M lifetime=60 detach");
+	caps = wbk_kc_sys_get_caps(kc_sys);
+	if (caps->priority != WBK_CAPS_PRIORITY_LOW || caps->memory != 512ULL << 20
+	    || caps->lifetime != 60000 || !caps->detach)
+		exit(1);
+	str = wbk_kc_to_str((wbk_kc_t *) kc_sys);
+	if (strcmp(str, "\"make\" skip-if-running priority=low memory=512M lifetime=60 detach"))
+		exit(2);
+	free(str);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	kc_sys = parse_kc_sys("\"make\" memory=1000");
+	str = wbk_kc_to_str((wbk_kc_t *) kc_sys);
+	if (strcmp(str, "\"make\" memory=1000") || wbk_kc_sys_get_limit(kc_sys))
+		exit(3);
+	free(str);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	/**
+	 * Without a launcher nothing applies the caps, thus the command is not
+	 * started at all
+	 */
+	kc_sys = parse_kc_sys("\"touch " OUT_FILENAME "\" priority=low");
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	usleep(200000);
+	if (access(OUT_FILENAME, F_OK) == 0)
+		exit(5);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	launcher = wbk_launcher_new();
+	if (launcher == NULL)
+		exit(10);
+	wbk_launcher_set_default(launcher);
+
+	/**
+	 * The priority
+	 */
+	kc_sys = parse_kc_sys("\"nice > " OUT_FILENAME "\" priority=low");
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (expect_file(OUT_FILENAME, "10\n"))
+		exit(20);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	/**
+	 * The lifetime
+	 */
+	kc_sys = parse_kc_sys("\"sleep 30\" skip-if-running lifetime=1");
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (wbk_limit_get_running(wbk_kc_sys_get_limit(kc_sys)) != 1)
+		exit(30);
+	usleep(500000);
+	if (wbk_limit_get_running(wbk_kc_sys_get_limit(kc_sys)) != 1)
+		exit(31);
+	if (expect_running(wbk_kc_sys_get_limit(kc_sys), 0))
+		exit(32);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	/**
+	 * Processes are killed with the daemon unless they are detached
+	 */
+	kc_sys = parse_kc_sys("\"sleep 1; touch " DETACHED_FILENAME "\" detach");
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+	kc_sys = parse_kc_sys("\"sleep 1; touch " ATTACHED_FILENAME "\"");
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+	usleep(200000);
+
+	wbk_launcher_set_default(NULL);
+	wbk_launcher_free(launcher);
+
+	if (expect_file(DETACHED_FILENAME, NULL))
+		exit(40);
+	if (access(ATTACHED_FILENAME, F_OK) == 0)
+		exit(41);
+
+	return 0;
+}
@@ -0,0 +1,198 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "launcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "capture.h"
+#include "executor.h"
+#include "kc_sys.h"
+#include "launcher.h"
+#include "parser.h"
+
+#define DUMP_FILENAME "check_capture.out"
+
+/**
+ * Waits until an output capture got an output and compares the last exit
+ * code.
+ */
+static int
+expect_output(wbk_capture_t *capture, int status, const char *output)
+{
+	char buffer[256];
+	int got;
+	int i;
+	int error;
+
+	error = 1;
+	for (i = 0; i < 300 && error; i++) {
+		wbk_capture_read(capture, buffer, sizeof(buffer));
+		error = strcmp(buffer, output);
+		if (error) {
+			usleep(10000);
+		}
+	}
+
+	return error || wbk_capture_get_status(capture, &got) || got != status;
+}
+
+static wbk_kc_sys_t *
+parse_kc_sys(const char *cmd)
+{
+	char *copy;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+
+	return (wbk_kc_sys_t *) wbk_parser_parse_kc(NULL, wbk_parser_parse_binding("mod4 + t"), copy);
+}
+
+int
+main(void)
+{
+	wbk_executor_t *executor;
+	wbk_launcher_t *launcher;
+	wbk_capture_t *capture;
+	wbk_kc_sys_t *kc_sys;
+	char buffer[64];
+	FILE *file;
+	char *str;
+	int status;
+
+	remove(DUMP_FILENAME);
+
+	/**
+	 * The ring keeps the latest bytes
+	 */
+	capture = wbk_capture_new(8, NULL);
+	if (wbk_capture_get_status(capture, &status) == 0)
+		exit(1);
+	wbk_capture_write(capture, "abc", 3);
+	if (wbk_capture_read(capture, buffer, sizeof(buffer)) != 3 || strcmp(buffer, "abc"))
+		exit(2);
+	wbk_capture_write(capture, "defghij", 7);
+	if (wbk_capture_read(capture, buffer, sizeof(buffer)) != 8 || strcmp(buffer, "cdefghij"))
+		exit(3);
+	wbk_capture_write(capture, "0123456789abcdefghij", 20);
+	if (wbk_capture_read(capture, buffer, sizeof(buffer)) != 8 || strcmp(buffer, "cdefghij"))
+		exit(4);
+	if (wbk_capture_read(capture, buffer, 4) != 3 || strcmp(buffer, "hij"))
+		exit(5);
+	wbk_capture_exit(capture, 3);
+	if (wbk_capture_get_status(capture, &status) || status != 3)
+		exit(6);
+	wbk_capture_read(capture, buffer, sizeof(buffer));
+	if (strcmp(buffer, "exit 3]\n"))
+		exit(7);
+	wbk_capture_free(capture);
+
+	executor = wbk_executor_new();
+	wbk_executor_set_default(executor);
+
+	/**
+	 * The options of the rc file
+	 */
+	kc_sys = parse_kc_sys("\"make\" skip-if-running capture");
+	str = wbk_kc_to_str((wbk_kc_t *) kc_sys);
+	if (strcmp(str, "\"make\" skip-if-running capture")
+	    || wbk_kc_sys_get_capture(kc_sys)->size != WBK_CAPTURE_DEFAULT_SIZE)
+		exit(10);
+	free(str);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	kc_sys = parse_kc_sys("\"make\" capture=1K");
+	str = wbk_kc_to_str((wbk_kc_t *) kc_sys);
+	if (strcmp(str, "\"make\" capture=1024"))
+		exit(11);
+	free(str);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	launcher = wbk_launcher_new();
+	if (launcher == NULL)
+		exit(20);
+	wbk_launcher_set_default(launcher);
+
+	/**
+	 * stdout and stderr of a shell command precede its exit code
+	 */
+	kc_sys = parse_kc_sys("\"echo out; echo err >&2; exit 3\" capture");
+	capture = wbk_kc_sys_get_capture(kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (expect_output(capture, 3, "out\nerr\n[exit 3]\n"))
+		exit(30);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	/**
+	 * An executable started without a shell. The ring is shared by the
+	 * processes of the command.
+	 */
+	kc_sys = parse_kc_sys("\"echo plain\" capture=20");
+	capture = wbk_kc_sys_get_capture(kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (expect_output(capture, 0, "plain\n[exit 0]\n"))
+		exit(40);
+	wbk_capture_retain(capture);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+	if (expect_output(capture, 0, "t 0]\nplain\n[exit 0]\n"))
+		exit(41);
+
+	if (wbk_capture_dump(capture, DUMP_FILENAME))
+		exit(50);
+	file = fopen(DUMP_FILENAME, "r");
+	if (file == NULL || fread(buffer, sizeof(char), sizeof(buffer), file) != 20
+	    || memcmp(buffer, "t 0]\nplain\n[exit 0]\n", 20))
+		exit(51);
+	fclose(file);
+	remove(DUMP_FILENAME);
+	wbk_capture_free(capture);
+
+	/**
+	 * Templates are expanded before the process is started
+	 */
+	kc_sys = parse_kc_sys("\"echo key %key%\" capture");
+	capture = wbk_kc_sys_get_capture(kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (expect_output(capture, 0, "key t\n[exit 0]\n"))
+		exit(60);
+	wbk_kc_exec_key((wbk_kc_t *) kc_sys, '7');
+	if (expect_output(capture, 0, "key t\n[exit 0]\nkey 7\n[exit 0]\n"))
+		exit(61);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	wbk_launcher_set_default(NULL);
+	wbk_launcher_free(launcher);
+
+	wbk_executor_set_default(NULL);
+	wbk_executor_free(executor);
+
+	return 0;
+}
@@ -0,0 +1,366 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+#include "ctl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(WIN32)
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+#include "kbtable.h"
+#include "parser.h"
+
+#define RC_FILENAME "check_ctl.rc"
+
+#define OTHER_RC_FILENAME "check_ctl.other.rc"
+
+#if defined(WIN32)
+#define ADDRESS "\\\\.\\pipe\\check_ctl"
+#else
+#define ADDRESS "check_ctl.sock"
+#endif
+
+#define KBMAN_ARR_LEN 4
+
+static wbk_kbtable_t *g_kbtable = NULL;
+
+static void
+write_rc(void)
+{
+	FILE *file;
+
+	file = fopen(RC_FILENAME, "w");
+	if (file == NULL)
+		exit(100);
+
+	fprintf(file, "\"@mode resize\"\n");
+	fprintf(file, "  control + a\n");
+	fprintf(file, "mode \"resize\" {\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  control + a\n");
+	fprintf(file, "}\n");
+
+	fclose(file);
+}
+
+/**
+ * @return The number of split key board managers matching the combination.
+ */
+static int
+exec(wbk_mk_t modifier, char key)
+{
+	wbk_b_t *b;
+	wbk_be_t be;
+	int found;
+	int i;
+
+	b = wbk_b_new();
+	be.modifier = modifier;
+	be.key = '\0';
+	wbk_b_add(b, &be);
+	be.modifier = NOT_A_MODIFIER;
+	be.key = key;
+	wbk_b_add(b, &be);
+
+	found = 0;
+	for (i = 0; i < KBMAN_ARR_LEN; i++) {
+		if (wbk_kbtable_exec(g_kbtable, i, b) == 0) {
+			found++;
+		}
+	}
+
+	wbk_b_free(b);
+
+	return found;
+}
+
+/**
+ * Sends a request and exits with code if the result is not as expected.
+ * @return The response. Free it by yourself.
+ */
+static char *
+send_request(const char *request, int expected_error, int code)
+{
+	char *response;
+
+	response = NULL;
+	if (wbk_ctl_send(ADDRESS, request, &response) != expected_error)
+		exit(code);
+
+	return response;
+}
+
+static int
+generation(void)
+{
+	wbk_kbtable_stats_t stats;
+
+	wbk_kbtable_get_stats(g_kbtable, &stats);
+
+	return stats.generation;
+}
+
+static void
+test_requests(void)
+{
+	char *response;
+	int gen;
+
+	response = send_request("list\n", 0, 1);
+	if (strstr(response, " default Ctrl + a \"@mode resize\"\n") == NULL
+	    || strstr(response, " resize Ctrl + a \"@mode default\"\n") == NULL)
+		exit(2);
+	free(response);
+
+	free(send_request("add default control + b \"@mode default\"\n", 0, 3));
+	if (exec(CTRL, 'b') != 1)
+		exit(4);
+
+	/**
+	 * A batch is applied as a single generation
+	 */
+	gen = generation();
+	free(send_request("begin\n"
+	          "add resize ctrl + x \"@mode resize\"\n"
+	          "remove default control + b\n", 0, 5));
+	if (generation() != gen || exec(CTRL, 'b') != 1)
+		exit(6);
+
+	free(send_request("begin\n"
+	          "add resize ctrl + x \"@mode resize\"\n"
+	          "remove default control + b\n"
+	          "commit\n", 0, 7));
+	if (generation() != gen + 1 || exec(CTRL, 'b') != 0)
+		exit(8);
+
+	free(send_request("begin\n"
+	          "add default control + c \"@mode default\"\n"
+	          "abort\n", 0, 9));
+	if (generation() != gen + 1 || exec(CTRL, 'c') != 0)
+		exit(10);
+
+	free(send_request("mode resize\n", 0, 11));
+	if (exec(CTRL, 'x') != 1)
+		exit(12);
+
+	response = send_request("stats\n", 0, 13);
+	if (strstr(response, " mode resize\n") == NULL
+	    || strstr(response, " bindings 3\n") == NULL
+	    || strstr(response, " changes 2\n") == NULL)
+		exit(14);
+	free(response);
+
+	/**
+	 * Runtime changes survive reloads of the rc file
+	 */
+	write_rc();
+	if (wbk_kbtable_load(g_kbtable) || exec(CTRL, 'x') != 1)
+		exit(15);
+
+	free(send_request("mode unknown\n", 1, 16));
+	free(send_request("list unknown\n", 1, 17));
+	free(send_request("unknown\n", 1, 18));
+	free(send_request("add default control + d\n", 1, 19));
+	free(send_request("remove default\n", 1, 20));
+	free(send_request("commit\n", 1, 21));
+
+	response = send_request("mode default\nmode unknown\nmode default\n", 1, 22);
+	if (strcmp(response, "ok\nerror unknown mode\nok\n"))
+		exit(23);
+	free(response);
+}
+
+static void
+test_idle(void)
+{
+	const char *request;
+#if defined(WIN32)
+	HANDLE pipe;
+	DWORD length;
+#else
+	struct sockaddr_un addr;
+	int fd;
+#endif
+
+	/**
+	 * A client opens a batch and then neither sends nor reads anymore
+	 */
+	request = "begin\nadd default control + z \"@mode default\"\n";
+#if defined(WIN32)
+	pipe = CreateFileA(ADDRESS, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+	if (pipe == INVALID_HANDLE_VALUE
+	    || !WriteFile(pipe, request, strlen(request), &length, NULL))
+		exit(40);
+#else
+	memset(&addr, 0, sizeof(struct sockaddr_un));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, ADDRESS);
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(struct sockaddr_un))
+	    || write(fd, request, strlen(request)) != (ssize_t) strlen(request))
+		exit(40);
+#endif
+
+	/**
+	 * It is dropped along with its batch, so the next client is served
+	 */
+	free(send_request("mode default\n", 0, 41));
+	if (exec(CTRL, 'z') != 0)
+		exit(42);
+
+#if defined(WIN32)
+	CloseHandle(pipe);
+#else
+	close(fd);
+#endif
+}
+
+#if !defined(WIN32)
+static void
+test_socket(void)
+{
+	wbk_ctl_t *other;
+	struct stat st;
+
+	if (stat(ADDRESS, &st) || (st.st_mode & 0777) != 0600)
+		exit(50);
+
+	/**
+	 * A second control server neither takes over nor removes the socket
+	 */
+	other = wbk_ctl_new(ADDRESS, g_kbtable);
+	if (wbk_ctl_start(other) == 0)
+		exit(51);
+	wbk_ctl_free(other);
+	free(send_request("mode default\n", 0, 52));
+}
+
+static void
+test_foreign_file(void)
+{
+	wbk_ctl_t *other;
+	struct stat st;
+	FILE *file;
+
+	/**
+	 * Anything but a stale socket at the address is left alone
+	 */
+	file = fopen(ADDRESS, "w");
+	if (file == NULL)
+		exit(100);
+	fclose(file);
+
+	other = wbk_ctl_new(ADDRESS, g_kbtable);
+	if (wbk_ctl_start(other) == 0)
+		exit(53);
+	wbk_ctl_free(other);
+	if (stat(ADDRESS, &st) || !S_ISREG(st.st_mode))
+		exit(54);
+
+	remove(ADDRESS);
+}
+#endif
+
+static int
+config_fn(wbk_ctl_t *ctl, const char *filename, void *param)
+{
+	(*((int *) param))++;
+	return 0;
+}
+
+static void
+test_config(wbk_ctl_t *ctl, wbk_parser_t *parser)
+{
+	FILE *file;
+	int config_count;
+
+	file = fopen(OTHER_RC_FILENAME, "w");
+	if (file == NULL)
+		exit(100);
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  control + y\n");
+	fclose(file);
+
+	config_count = 0;
+	wbk_ctl_set_config_fn(ctl, config_fn, &config_count);
+
+	free(send_request("config " OTHER_RC_FILENAME "\n", 0, 31));
+	if (strcmp(wbk_parser_get_filename(parser), OTHER_RC_FILENAME)
+	    || config_count != 1 || exec(CTRL, 'y') != 1 || exec(CTRL, 'a') != 0)
+		exit(32);
+
+	/**
+	 * The current rc file is kept if the other one cannot be loaded
+	 */
+	free(send_request("config check_ctl.missing.rc\n", 1, 33));
+	free(send_request("config\n", 1, 34));
+	if (strcmp(wbk_parser_get_filename(parser), OTHER_RC_FILENAME)
+	    || config_count != 1 || exec(CTRL, 'y') != 1)
+		exit(35);
+
+	remove(OTHER_RC_FILENAME);
+}
+
+int
+main(void)
+{
+	wbk_parser_t *parser;
+	wbk_ctl_t *ctl;
+
+	write_rc();
+
+	parser = wbk_parser_new(RC_FILENAME);
+	g_kbtable = wbk_kbtable_new(parser, KBMAN_ARR_LEN);
+	if (wbk_kbtable_load(g_kbtable))
+		exit(101);
+
+	ctl = wbk_ctl_new(ADDRESS, g_kbtable);
+	if (wbk_ctl_start(ctl))
+		exit(102);
+
+	test_requests();
+	test_idle();
+	test_config(ctl, parser);
+#if !defined(WIN32)
+	test_socket();
+#endif
+
+	wbk_ctl_free(ctl);
+#if !defined(WIN32)
+	test_foreign_file();
+#endif
+	wbk_kbtable_free(g_kbtable);
+	wbk_parser_free(parser);
+	remove(RC_FILENAME);
+
+	return 0;
+}
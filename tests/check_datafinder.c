@@ -25,9 +25,34 @@
 #include "datafinder.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "datafinder.h"
 
+/**
+ * A file, which is next to the executable in any build directory
+ */
+#if defined(WIN32)
+#define EXE_NAME "check_datafinder.exe"
+#else
+#define EXE_NAME "check_datafinder"
+#endif
+
+/**
+ * @return Non-0 unless path is EXE_NAME within the directory of the
+ * executable
+ */
+static int
+is_exe_path(const char *path)
+{
+	int offset;
+
+	offset = (int) strlen(path) - (int) strlen(EXE_NAME) - 1;
+
+	return offset < 0 || (path[offset] != '/' && path[offset] != '\\')
+	       || strcmp(path + offset + 1, EXE_NAME);
+}
+
 int
 test_new(void)
 {
@@ -63,11 +88,14 @@ test_simple(void)
 
 	free(path);
 
-	path = wbk_datafinder_gen_path(datafinder, "Makefile.am");
+	/**
+	 * The directory of the executable is probed first
+	 */
+	path = wbk_datafinder_gen_path(datafinder, EXE_NAME);
 	if (path == NULL)
 		exit(4);
 
-	if (strcmp(path, "Makefile.am"))
+	if (is_exe_path(path))
 		exit(5);
 
 	free(path);
@@ -83,7 +111,11 @@ test_multi(void)
 	wbk_datafinder_t *datafinder;
 	char *path;
 
-	datafinder = wbk_datafinder_new(PKGDATADIR);
+	/**
+	 * The data directory of the source tree, as PKGDATADIR is only filled
+	 * once installed
+	 */
+	datafinder = wbk_datafinder_new(PKGSRCDATADIR);
 	if (datafinder == NULL)
 		exit(1);
 
@@ -107,17 +139,17 @@ test_multi(void)
 		exit(3);
 
 	if (!(strstr(path, "w32bindkeysrc")
-		  && strstr(path, PKGDATADIR)))
+		  && strstr(path, PKGSRCDATADIR)))
 		exit(4);
 
 	free(path);
 
-	path = wbk_datafinder_gen_path(datafinder, "Makefile.am");
+	path = wbk_datafinder_gen_path(datafinder, EXE_NAME);
 
 	if (path == NULL)
 		exit(3);
 
-	if (strcmp(path, "Makefile.am"))
+	if (is_exe_path(path))
 		exit(4);
 
 	free(path);
@@ -0,0 +1,197 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "launcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(WIN32)
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "exe.h"
+
+#if defined(WIN32)
+#define EXE_NAME "wbk-check-exe"
+#define EXE_FILENAME "wbk-check-exe.exe"
+#define DIR_SEPARATOR "\\"
+#define PATH_SEPARATOR ";"
+#else
+#define EXE_NAME "wbk-check-exe"
+#define EXE_FILENAME "wbk-check-exe"
+#define DIR_SEPARATOR "/"
+#define PATH_SEPARATOR ":"
+#endif
+
+#define DIR_A "check_exe.a"
+#define DIR_B "check_exe.b"
+
+/**
+ * Creates an executable file with some content.
+ */
+static int
+create_exe(const char *dir, const char *content)
+{
+	char filename[256];
+	FILE *file;
+	int error;
+
+#if defined(WIN32)
+	_mkdir(dir);
+#else
+	mkdir(dir, 0755);
+#endif
+
+	sprintf(filename, "%s" DIR_SEPARATOR EXE_FILENAME, dir);
+	file = fopen(filename, "w");
+	error = file == NULL;
+	if (file) {
+		fputs(content, file);
+		fclose(file);
+#if !defined(WIN32)
+		error = chmod(filename, 0755);
+#endif
+	}
+
+	return error;
+}
+
+static void
+remove_exe(const char *dir)
+{
+	char filename[256];
+
+	sprintf(filename, "%s" DIR_SEPARATOR EXE_FILENAME, dir);
+	remove(filename);
+#if defined(WIN32)
+	_rmdir(dir);
+#else
+	rmdir(dir);
+#endif
+}
+
+static void
+set_path(const char *dir)
+{
+	char cwd[1024];
+	char value[4096];
+
+	getcwd(cwd, sizeof(cwd));
+#if defined(WIN32)
+	sprintf(value, "PATH=%s" DIR_SEPARATOR "%s" PATH_SEPARATOR "%s" DIR_SEPARATOR "nothing", cwd, dir, cwd);
+	_putenv(value);
+#else
+	sprintf(value, "%s" DIR_SEPARATOR "%s" PATH_SEPARATOR "%s" DIR_SEPARATOR "nothing", cwd, dir, cwd);
+	setenv("PATH", value, 1);
+#endif
+}
+
+/**
+ * Tests whether a path is within a directory.
+ */
+static int
+in_dir(const char *path, const char *dir)
+{
+	char suffix[256];
+	int path_length;
+	int suffix_length;
+
+	sprintf(suffix, DIR_SEPARATOR "%s" DIR_SEPARATOR EXE_FILENAME, dir);
+	path_length = strlen(path);
+	suffix_length = strlen(suffix);
+
+	return path_length >= suffix_length && strcmp(path + path_length - suffix_length, suffix) == 0;
+}
+
+int
+main(void)
+{
+	wbk_exe_t *exe;
+	wbk_exe_t *missing;
+	char path[WBK_EXE_PATH_LEN];
+
+	remove_exe(DIR_A);
+	remove_exe(DIR_B);
+	if (create_exe(DIR_A, "a") || create_exe(DIR_B, "bb"))
+		exit(1);
+
+	/**
+	 * The name is resolved within PATH
+	 */
+	set_path(DIR_A);
+	exe = wbk_exe_new(EXE_NAME);
+	if (exe == NULL)
+		exit(10);
+	if (strcmp(wbk_exe_get_name(exe), EXE_NAME))
+		exit(11);
+	if (wbk_exe_get_path(exe, path, WBK_EXE_PATH_LEN) || !in_dir(path, DIR_A))
+		exit(12);
+	if (wbk_exe_get_path(exe, path, 4) == 0)
+		exit(13);
+
+	/**
+	 * Missing names are not resolved
+	 */
+	missing = wbk_exe_new("wbk-check-exe-missing");
+	if (missing == NULL)
+		exit(20);
+	if (wbk_exe_get_path(missing, path, WBK_EXE_PATH_LEN) == 0)
+		exit(21);
+	wbk_exe_free(missing);
+
+	/**
+	 * A changed PATH resolves the name again
+	 */
+	set_path(DIR_B);
+	if (wbk_exe_get_path(exe, path, WBK_EXE_PATH_LEN) || !in_dir(path, DIR_B))
+		exit(30);
+
+	/**
+	 * A replaced file is resolved again, a removed one is not found
+	 */
+	if (wbk_exe_retain(exe) != exe)
+		exit(40);
+	wbk_exe_free(exe);
+	remove_exe(DIR_B);
+	if (wbk_exe_get_path(exe, path, WBK_EXE_PATH_LEN) == 0)
+		exit(41);
+	if (create_exe(DIR_B, "ccc"))
+		exit(42);
+	if (wbk_exe_get_path(exe, path, WBK_EXE_PATH_LEN) || !in_dir(path, DIR_B))
+		exit(43);
+
+	wbk_exe_free(exe);
+	remove_exe(DIR_A);
+	remove_exe(DIR_B);
+
+	return 0;
+}
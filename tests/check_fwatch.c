@@ -0,0 +1,137 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+#include "fwatch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define RC_FILENAME "check_fwatch.rc"
+
+#define OTHER_FILENAME "check_fwatch.other"
+
+#define DEBOUNCE 100
+
+static int g_change_count = 0;
+
+static int
+change_fn(wbk_fwatch_t *fwatch, void *param)
+{
+	__atomic_add_fetch(&g_change_count, 1, __ATOMIC_SEQ_CST);
+	return 0;
+}
+
+static void
+write_file(const char *filename, int version)
+{
+	FILE *file;
+
+	file = fopen(filename, "w");
+	if (file == NULL)
+		exit(100);
+
+	fprintf(file, "\"version %d\"\n  control + a\n", version);
+
+	fclose(file);
+}
+
+/**
+ * Waits long enough for a debounced change to be reported
+ */
+static void
+settle(void)
+{
+	usleep(DEBOUNCE * 10 * 1000);
+}
+
+static void
+test_debounce(void)
+{
+	wbk_fwatch_t *fwatch;
+	int i;
+
+	write_file(RC_FILENAME, 0);
+
+	fwatch = wbk_fwatch_new(RC_FILENAME, DEBOUNCE, change_fn, NULL);
+	if (fwatch == NULL)
+		exit(1);
+
+	if (wbk_fwatch_start(fwatch))
+		exit(2);
+
+	settle();
+	if (g_change_count != 0)
+		exit(3);
+
+	/**
+	 * A burst of writes is reported once
+	 */
+	for (i = 1; i <= 10; i++) {
+		write_file(RC_FILENAME, i);
+		usleep(DEBOUNCE / 10 * 1000);
+	}
+	settle();
+	if (g_change_count != 1)
+		exit(4);
+
+	/**
+	 * Other files of the same directory are ignored
+	 */
+	write_file(OTHER_FILENAME, 0);
+	settle();
+	if (g_change_count != 1)
+		exit(5);
+
+	/**
+	 * Editors replacing the file by a renamed one
+	 */
+	remove(RC_FILENAME);
+	if (rename(OTHER_FILENAME, RC_FILENAME))
+		exit(6);
+	settle();
+	if (g_change_count != 2)
+		exit(7);
+
+	wbk_fwatch_stop(fwatch);
+
+	write_file(RC_FILENAME, 0);
+	settle();
+	if (g_change_count != 2)
+		exit(8);
+
+	wbk_fwatch_free(fwatch);
+}
+
+int
+main(void)
+{
+	test_debounce();
+
+	remove(RC_FILENAME);
+	remove(OTHER_FILENAME);
+
+	return 0;
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+#include "instance.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(WIN32)
+#define NAME "Local\\check_instance"
+#else
+#define NAME "check_instance.lock"
+#endif
+
+static void
+test_acquire(void)
+{
+	wbk_instance_t *first;
+	wbk_instance_t *second;
+
+	first = wbk_instance_new(NAME);
+	second = wbk_instance_new(NAME);
+
+	if (wbk_instance_acquire(first))
+		exit(1);
+
+	/**
+	 * Acquiring twice is fine for the owner
+	 */
+	if (wbk_instance_acquire(first))
+		exit(2);
+
+	if (wbk_instance_acquire(second) == 0)
+		exit(3);
+
+	wbk_instance_free(first);
+
+	if (wbk_instance_acquire(second))
+		exit(4);
+
+	wbk_instance_free(second);
+}
+
+int
+main(void)
+{
+	test_acquire();
+
+#if !defined(WIN32)
+	remove(NAME);
+#endif
+
+	return 0;
+}
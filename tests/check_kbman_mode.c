@@ -0,0 +1,490 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "kbman.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "kc.h"
+#include "parser.h"
+
+static const wbk_kc_t *g_last_exec = NULL;
+static char g_last_key = '\0';
+
+static int
+count_exec(const wbk_kc_t *kc)
+{
+	g_last_exec = kc;
+	return 0;
+}
+
+static int
+count_exec_key(const wbk_kc_t *kc, char key)
+{
+	g_last_key = key;
+	return count_exec(kc);
+}
+
+static wbk_kc_t *
+clone_kc(const wbk_kc_t *other)
+{
+	wbk_kc_t *kc;
+
+	kc = wbk_kc_new(wbk_b_clone(wbk_kc_get_binding(other)));
+	kc->kc_clone = clone_kc;
+	kc->kc_exec = count_exec;
+	kc->kc_exec_key = count_exec_key;
+
+	return kc;
+}
+
+static wbk_b_t *
+new_binding(wbk_mk_t modifier, char key)
+{
+	wbk_b_t *b;
+	wbk_be_t be;
+
+	b = wbk_b_new();
+
+	be.modifier = modifier;
+	be.key = '\0';
+	wbk_b_add(b, &be);
+
+	be.modifier = NOT_A_MODIFIER;
+	be.key = key;
+	wbk_b_add(b, &be);
+
+	return b;
+}
+
+static wbk_kc_t *
+new_kc(wbk_mk_t modifier, char key)
+{
+	wbk_kc_t *kc;
+
+	kc = wbk_kc_new(new_binding(modifier, key));
+	kc->kc_clone = clone_kc;
+	kc->kc_exec = count_exec;
+	kc->kc_exec_key = count_exec_key;
+
+	return kc;
+}
+
+static wbk_kc_t *
+new_kc_parsed(const char *line)
+{
+	wbk_kc_t *kc;
+
+	kc = wbk_kc_new(wbk_parser_parse_binding(line));
+	kc->kc_clone = clone_kc;
+	kc->kc_exec = count_exec;
+	kc->kc_exec_key = count_exec_key;
+
+	return kc;
+}
+
+static int
+exec(wbk_kbman_t *kbman, wbk_mk_t modifier, char key)
+{
+	wbk_b_t *b;
+	int error;
+
+	g_last_exec = NULL;
+	g_last_key = '\0';
+
+	b = new_binding(modifier, key);
+	error = wbk_kbman_exec(kbman, b);
+	wbk_b_free(b);
+
+	return error;
+}
+
+int
+test_modes(void)
+{
+	wbk_kbman_t *kbman;
+	wbk_kc_t *kc_default;
+	wbk_kc_t *kc_resize_a;
+	wbk_kc_t *kc_resize_b;
+
+	kbman = wbk_kbman_new();
+
+	kc_default = new_kc(CTRL, 'a');
+	wbk_kbman_add(kbman, kc_default);
+
+	if (wbk_kbman_add_mode(kbman, "resize"))
+		exit(1);
+
+	if (!wbk_kbman_add_mode(kbman, "resize"))
+		exit(2);
+
+	kc_resize_a = new_kc(CTRL, 'a');
+	kc_resize_b = new_kc(CTRL, 'b');
+	if (wbk_kbman_add_to_mode(kbman, "resize", kc_resize_a)
+		|| wbk_kbman_add_to_mode(kbman, "resize", kc_resize_b))
+		exit(3);
+
+	if (exec(kbman, CTRL, 'a') || g_last_exec != kc_default)
+		exit(4);
+
+	if (!exec(kbman, CTRL, 'b'))
+		exit(5);
+
+	if (wbk_kbman_switch_mode(kbman, "resize"))
+		exit(6);
+
+	if (exec(kbman, CTRL, 'a') || g_last_exec != kc_resize_a)
+		exit(7);
+
+	if (exec(kbman, CTRL, 'b') || g_last_exec != kc_resize_b)
+		exit(8);
+
+	if (!wbk_kbman_switch_mode(kbman, "unknown"))
+		exit(9);
+
+	if (wbk_kbman_switch_mode(kbman, WBK_KBMAN_DEFAULT_MODE))
+		exit(10);
+
+	if (!exec(kbman, CTRL, 'b'))
+		exit(11);
+
+	wbk_kbman_free(kbman);
+
+	return 0;
+}
+
+int
+test_split(void)
+{
+	wbk_kbman_t *kbman;
+	wbk_kbman_t **kbmans;
+	int found;
+	int i;
+
+	kbman = wbk_kbman_new();
+	wbk_kbman_add(kbman, new_kc(CTRL, 'a'));
+	wbk_kbman_add_mode(kbman, "resize");
+	wbk_kbman_add_to_mode(kbman, "resize", new_kc(SHIFT, 'a'));
+
+	kbmans = wbk_kbman_split(kbman, 3);
+
+	/**
+	 * Switching the split key board manager switches all of its parts
+	 */
+	wbk_kbman_switch_mode(kbman, "resize");
+
+	found = 0;
+	for (i = 0; i < 3; i++) {
+		if (exec(kbmans[i], CTRL, 'a') == 0)
+			exit(1);
+
+		if (exec(kbmans[i], SHIFT, 'a') == 0)
+			found++;
+	}
+
+	if (found != 1)
+		exit(2);
+
+	for (i = 0; i < 3; i++) {
+		wbk_kbman_free(kbmans[i]);
+	}
+	free(kbmans);
+
+	wbk_kbman_free(kbman);
+
+	return 0;
+}
+
+int
+test_many(void)
+{
+	wbk_kbman_t *kbman;
+	wbk_kc_t *kc_arr[36];
+	char key;
+	int i;
+
+	kbman = wbk_kbman_new();
+
+	for (i = 0; i < 36; i++) {
+		key = i < 26 ? 'a' + i : '0' + i - 26;
+		kc_arr[i] = new_kc(i % 2 ? ALT : WIN, key);
+		wbk_kbman_add(kbman, kc_arr[i]);
+	}
+
+	for (i = 0; i < 36; i++) {
+		key = i < 26 ? 'a' + i : '0' + i - 26;
+		if (exec(kbman, i % 2 ? ALT : WIN, key) || g_last_exec != kc_arr[i])
+			exit(1);
+
+		if (!exec(kbman, i % 2 ? WIN : ALT, key))
+			exit(2);
+	}
+
+	/**
+	 * Compiled modes find the same key binding commands by their perfect hash
+	 */
+	if (wbk_kbman_compile(kbman) || kbman->mode_arr[0]->mph == NULL)
+		exit(3);
+
+	for (i = 0; i < 36; i++) {
+		key = i < 26 ? 'a' + i : '0' + i - 26;
+		if (exec(kbman, i % 2 ? ALT : WIN, key) || g_last_exec != kc_arr[i])
+			exit(4);
+
+		if (!exec(kbman, i % 2 ? WIN : ALT, key))
+			exit(5);
+	}
+
+	/**
+	 * Adding drops the hash again
+	 */
+	wbk_kbman_add(kbman, new_kc(CTRL, 'a'));
+	if (kbman->mode_arr[0]->mph || exec(kbman, CTRL, 'a') || exec(kbman, WIN, 'a'))
+		exit(6);
+
+	wbk_kbman_free(kbman);
+
+	return 0;
+}
+
+int
+test_ranges(void)
+{
+	wbk_kbman_t *kbman;
+	wbk_kbman_t **kbmans;
+	wbk_kc_t *kc_range;
+	wbk_kc_t *kc_exact;
+	wbk_b_t *b;
+	char *str;
+	char key;
+
+	b = wbk_parser_parse_binding("mod4 + [1-9]");
+	str = wbk_b_to_str(b);
+	if (strcmp(str, "Mod4 + [1-9]") || b->key_last != '9')
+		exit(1);
+	free(str);
+
+	kc_range = wbk_kc_new(b);
+	kc_range->kc_clone = clone_kc;
+	kc_range->kc_exec = count_exec;
+	kc_range->kc_exec_key = count_exec_key;
+
+	kbman = wbk_kbman_new();
+	wbk_kbman_add(kbman, kc_range);
+	kc_exact = new_kc(WIN, '5');
+	wbk_kbman_add(kbman, kc_exact);
+
+	/**
+	 * One key binding command covers the whole range
+	 */
+	for (key = '1'; key <= '9'; key++) {
+		if (exec(kbman, WIN, key))
+			exit(2);
+
+		if (key == '5') {
+			if (g_last_exec != kc_exact || g_last_key != '\0')
+				exit(3);
+		} else if (g_last_exec != kc_range || g_last_key != key) {
+			exit(4);
+		}
+	}
+
+	if (!exec(kbman, WIN, '0') || !exec(kbman, ALT, '1'))
+		exit(5);
+
+	/**
+	 * The range is kept by cloning and by removing other bindings
+	 */
+	kbmans = wbk_kbman_split(kbman, 1);
+	if (exec(kbmans[0], WIN, '3') || g_last_key != '3')
+		exit(6);
+	wbk_kbman_free(kbmans[0]);
+	free(kbmans);
+
+	b = new_binding(WIN, '5');
+	if (wbk_kbman_remove(kbman, WBK_KBMAN_DEFAULT_MODE, b)
+	    || exec(kbman, WIN, '5') || g_last_exec != kc_range || g_last_key != '5')
+		exit(7);
+	wbk_b_free(b);
+
+	wbk_kbman_free(kbman);
+
+	return 0;
+}
+
+int
+test_any(void)
+{
+	wbk_kbman_t *kbman;
+	wbk_kc_t *kc_any;
+	wbk_kc_t *kc_ctrl;
+	wbk_kc_t *kc_plain;
+	wbk_b_t *b;
+	wbk_b_t *other;
+	char *str;
+	int round;
+
+	b = wbk_parser_parse_binding("any + control + a");
+	str = wbk_b_to_str(b);
+	other = wbk_parser_parse_binding(str);
+	if (strcmp(str, "Any + Ctrl + a") || wbk_b_compare(b, other)
+	    || b->ignore_mask != (WBK_B_ANY_MASK & ~((uint64_t) 1 << CTRL)))
+		exit(1);
+	free(str);
+	wbk_b_free(b);
+	wbk_b_free(other);
+
+	kbman = wbk_kbman_new();
+	kc_any = new_kc_parsed("any + a");
+	kc_ctrl = new_kc_parsed("control + a");
+	kc_plain = new_kc_parsed("b");
+	wbk_kbman_add(kbman, kc_any);
+	wbk_kbman_add(kbman, kc_ctrl);
+	wbk_kbman_add(kbman, kc_plain);
+
+	for (round = 0; round < 2; round++) {
+		/**
+		 * Bindings ignoring fewer modifiers win
+		 */
+		if (exec(kbman, CTRL, 'a') || g_last_exec != kc_ctrl)
+			exit(2);
+
+		if (exec(kbman, ALT, 'a') || g_last_exec != kc_any
+		    || exec(kbman, CAPSLOCK, 'a') || g_last_exec != kc_any)
+			exit(3);
+
+		/**
+		 * Lock modifiers are ignored by default, others are not
+		 */
+		if (exec(kbman, NUMLOCK, 'b') || g_last_exec != kc_plain)
+			exit(4);
+
+		if (!exec(kbman, CTRL, 'b') || !exec(kbman, F1, 'a'))
+			exit(5);
+
+		if (wbk_kbman_compile(kbman))
+			exit(6);
+	}
+
+	wbk_kbman_free(kbman);
+
+	return 0;
+}
+
+int
+test_sides(void)
+{
+	wbk_kbman_t *kbman;
+	wbk_kc_t *kc_ralt;
+	wbk_kc_t *kc_alt;
+	wbk_kc_t *kc_lctrl;
+	wbk_kc_t *kc_range;
+	wbk_b_t *b;
+	wbk_b_t *other;
+	wbk_be_t be;
+	char *str;
+	int round;
+
+	b = wbk_parser_parse_binding("altgr + e");
+	str = wbk_b_to_str(b);
+	other = wbk_parser_parse_binding(str);
+	if (strcmp(str, "RMod1 + e") || wbk_b_compare(b, other) || !b->modifier_map[ALT])
+		exit(1);
+	free(str);
+	wbk_b_free(other);
+
+	/**
+	 * The generic modifier is held as long as either side is
+	 */
+	be.modifier = LALT;
+	be.key = '\0';
+	wbk_b_add(b, &be);
+	wbk_b_remove(b, &be);
+	if (!b->modifier_map[ALT] || !b->modifier_map[RALT])
+		exit(2);
+
+	be.modifier = RALT;
+	wbk_b_remove(b, &be);
+	if (b->modifier_map[ALT])
+		exit(3);
+	wbk_b_free(b);
+
+	kbman = wbk_kbman_new();
+	kc_ralt = new_kc_parsed("ralt + e");
+	kc_alt = new_kc_parsed("mod1 + e");
+	kc_lctrl = new_kc_parsed("lctrl + x");
+	kc_range = new_kc_parsed("shift + [1-3]");
+	wbk_kbman_add(kbman, kc_ralt);
+	wbk_kbman_add(kbman, kc_alt);
+	wbk_kbman_add(kbman, kc_lctrl);
+	wbk_kbman_add(kbman, kc_range);
+
+	for (round = 0; round < 2; round++) {
+		if (exec(kbman, RALT, 'e') || g_last_exec != kc_ralt)
+			exit(4);
+
+		if (exec(kbman, LALT, 'e') || g_last_exec != kc_alt
+		    || exec(kbman, ALT, 'e') || g_last_exec != kc_alt)
+			exit(5);
+
+		if (exec(kbman, LCTRL, 'x') || g_last_exec != kc_lctrl
+		    || !exec(kbman, RCTRL, 'x'))
+			exit(6);
+
+		/**
+		 * Naming a side rules out the other one
+		 */
+		b = new_binding(RALT, 'e');
+		be.modifier = LALT;
+		be.key = '\0';
+		wbk_b_add(b, &be);
+		g_last_exec = NULL;
+		if (wbk_kbman_exec(kbman, b) || g_last_exec != kc_alt)
+			exit(7);
+		wbk_b_free(b);
+
+		if (exec(kbman, RSHIFT, '2') || g_last_exec != kc_range || g_last_key != '2')
+			exit(8);
+
+		if (wbk_kbman_compile(kbman))
+			exit(9);
+	}
+
+	wbk_kbman_free(kbman);
+
+	return 0;
+}
+
+int main(void)
+{
+	test_modes();
+	test_split();
+	test_many();
+	test_ranges();
+	test_any();
+	test_sides();
+
+	return 0;
+}
@@ -0,0 +1,375 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+#include "kbtable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "kc_sys.h"
+#include "parser.h"
+
+#define RC_FILENAME "check_kbtable.rc"
+
+#define KBMAN_ARR_LEN 30
+
+#define RELOAD_COUNT 200
+
+static wbk_kbtable_t *g_kbtable = NULL;
+static int g_running = 0;
+static int g_exec_count = 0;
+static int g_miss_count = 0;
+
+static void
+write_rc(int version)
+{
+	FILE *file;
+
+	file = fopen(RC_FILENAME, "w");
+	if (file == NULL)
+		exit(100);
+
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  control + a\n");
+	fprintf(file, "\"@mode resize\"\n");
+	fprintf(file, "  control + r\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  control + %c\n", 'b' + version % 2);
+	fprintf(file, "mode \"resize\" {\n");
+	fprintf(file, "\"@mode default\"\n");
+	fprintf(file, "  control + a\n");
+	fprintf(file, "}\n");
+
+	fclose(file);
+}
+
+static wbk_b_t *
+new_binding(wbk_mk_t modifier, char key)
+{
+	wbk_b_t *b;
+	wbk_be_t be;
+
+	b = wbk_b_new();
+
+	be.modifier = modifier;
+	be.key = '\0';
+	wbk_b_add(b, &be);
+
+	be.modifier = NOT_A_MODIFIER;
+	be.key = key;
+	wbk_b_add(b, &be);
+
+	return b;
+}
+
+/**
+ * @return The number of keyboard daemons, which executed a key binding of b.
+ */
+static int
+exec(wbk_kbtable_t *kbtable, wbk_mk_t modifier, char key)
+{
+	wbk_b_t *b;
+	int found;
+	int i;
+
+	b = new_binding(modifier, key);
+
+	found = 0;
+	for (i = 0; i < KBMAN_ARR_LEN; i++) {
+		if (wbk_kbtable_exec(kbtable, i, b) == 0) {
+			found++;
+		}
+	}
+
+	wbk_b_free(b);
+
+	return found;
+}
+
+#if defined(WIN32)
+static DWORD WINAPI
+exec_thread(LPVOID param)
+#else
+static void *
+exec_thread(void *param)
+#endif
+{
+	while (__atomic_load_n(&g_running, __ATOMIC_SEQ_CST)) {
+		if (exec(g_kbtable, CTRL, 'a') != 1) {
+			__atomic_add_fetch(&g_miss_count, 1, __ATOMIC_SEQ_CST);
+		}
+		__atomic_add_fetch(&g_exec_count, 1, __ATOMIC_SEQ_CST);
+	}
+
+	return 0;
+}
+
+static void
+test_load(wbk_parser_t *parser)
+{
+	wbk_kbtable_t *kbtable;
+	wbk_kbtable_gen_t *live;
+
+	kbtable = wbk_kbtable_new(parser, KBMAN_ARR_LEN);
+	wbk_kbtable_set_grace_period(kbtable, 0);
+
+	if (exec(kbtable, CTRL, 'a') != 0)
+		exit(1);
+
+	write_rc(0);
+	if (wbk_kbtable_load(kbtable))
+		exit(2);
+
+	if (exec(kbtable, CTRL, 'a') != 1 || exec(kbtable, CTRL, 'b') != 1)
+		exit(3);
+
+	/**
+	 * Unchanged key bindings are not published again
+	 */
+	live = kbtable->live;
+	if (wbk_kbtable_load(kbtable) || kbtable->live != live)
+		exit(4);
+
+	write_rc(1);
+	if (wbk_kbtable_load(kbtable) || kbtable->live == live)
+		exit(5);
+
+	if (exec(kbtable, CTRL, 'b') != 0 || exec(kbtable, CTRL, 'c') != 1)
+		exit(6);
+
+	if (wbk_kbtable_reclaim(kbtable) != 0)
+		exit(7);
+
+	wbk_kbtable_free(kbtable);
+}
+
+static void
+test_mode_kept(wbk_parser_t *parser)
+{
+	wbk_kbtable_t *kbtable;
+
+	kbtable = wbk_kbtable_new(parser, KBMAN_ARR_LEN);
+
+	write_rc(0);
+	if (wbk_kbtable_load(kbtable))
+		exit(10);
+
+	if (exec(kbtable, CTRL, 'r') != 1)
+		exit(11);
+
+	write_rc(1);
+	if (wbk_kbtable_load(kbtable))
+		exit(12);
+
+	if (strcmp(wbk_kbman_get_mode(kbtable->live->kbman), "resize"))
+		exit(13);
+
+	/**
+	 * control + r is not bound within the resize mode
+	 */
+	if (exec(kbtable, CTRL, 'r') != 0 || exec(kbtable, CTRL, 'a') != 1)
+		exit(14);
+
+	if (strcmp(wbk_kbman_get_mode(kbtable->live->kbman), WBK_KBMAN_DEFAULT_MODE))
+		exit(15);
+
+	/**
+	 * The grace period has not passed yet
+	 */
+	if (wbk_kbtable_reclaim(kbtable) != 1)
+		exit(16);
+
+	wbk_kbtable_free(kbtable);
+}
+
+/**
+ * @return The concurrency limit of the key binding control + key of the
+ * default mode of the live generation or NULL.
+ */
+static wbk_limit_t *
+find_limit(wbk_kbtable_t *kbtable, char key)
+{
+	wbk_kbman_mode_t *mode;
+	wbk_b_t *b;
+	wbk_limit_t *limit;
+	int i;
+
+	b = new_binding(CTRL, key);
+	mode = kbtable->live->kbman->mode_arr[0];
+
+	limit = NULL;
+	for (i = 0; i < mode->kc_arr_len; i++) {
+		/**
+		 * The parser ignores the lock keys
+		 */
+		b->ignore_mask = wbk_kc_get_binding(mode->kc_arr[i])->ignore_mask;
+		if (wbk_b_compare(wbk_kc_get_binding(mode->kc_arr[i]), b) == 0) {
+			limit = wbk_kc_sys_get_limit((wbk_kc_sys_t *) mode->kc_arr[i]);
+		}
+	}
+
+	wbk_b_free(b);
+
+	return limit;
+}
+
+static void
+test_limit_kept(wbk_parser_t *parser)
+{
+	wbk_kbtable_t *kbtable;
+	wbk_limit_t *limit_l;
+	wbk_limit_t *limit_m;
+	FILE *file;
+	int version;
+
+	kbtable = wbk_kbtable_new(parser, KBMAN_ARR_LEN);
+
+	for (version = 0; version < 2; version++) {
+		file = fopen(RC_FILENAME, "w");
+		if (file == NULL)
+			exit(100);
+		fprintf(file, "\"true\" skip-if-running\n");
+		fprintf(file, "  control + l\n");
+		fprintf(file, "\"true\" max_concurrent=%d\n", 2 + version);
+		fprintf(file, "  control + m\n");
+		fclose(file);
+
+		if (wbk_kbtable_load(kbtable))
+			exit(30);
+
+		if (version == 0) {
+			limit_l = find_limit(kbtable, 'l');
+			limit_m = find_limit(kbtable, 'm');
+			if (limit_l == NULL || limit_m == NULL
+			    || wbk_limit_acquire(limit_l) != WBK_LIMIT_ADMIT
+			    || wbk_limit_acquire(limit_m) != WBK_LIMIT_ADMIT)
+				exit(31);
+		}
+	}
+
+	/**
+	 * The process of the unchanged command is still running, the changed
+	 * command starts counting anew
+	 */
+	if (find_limit(kbtable, 'l') != limit_l
+	    || wbk_limit_get_running(find_limit(kbtable, 'l')) != 1
+	    || wbk_limit_acquire(find_limit(kbtable, 'l')) != WBK_LIMIT_DENY)
+		exit(32);
+	if (find_limit(kbtable, 'm') == limit_m
+	    || wbk_limit_get_running(find_limit(kbtable, 'm')) != 0)
+		exit(33);
+
+	wbk_limit_release(limit_l);
+	wbk_limit_release(limit_m);
+
+	wbk_kbtable_free(kbtable);
+}
+
+static void
+test_reload_under_load(wbk_parser_t *parser)
+{
+#if defined(WIN32)
+	HANDLE thread;
+#else
+	pthread_t thread;
+#endif
+	int i;
+
+	g_kbtable = wbk_kbtable_new(parser, KBMAN_ARR_LEN);
+	wbk_kbtable_set_grace_period(g_kbtable, 0);
+
+	write_rc(0);
+	if (wbk_kbtable_load(g_kbtable))
+		exit(20);
+
+	g_running = 1;
+#if defined(WIN32)
+	thread = CreateThread(NULL, 0, exec_thread, NULL, 0, NULL);
+	if (thread == NULL)
+		exit(21);
+#else
+	if (pthread_create(&thread, NULL, exec_thread, NULL))
+		exit(21);
+#endif
+
+	for (i = 1; i <= RELOAD_COUNT; i++) {
+		write_rc(i);
+		if (wbk_kbtable_load(g_kbtable))
+			exit(22);
+		wbk_kbtable_reclaim(g_kbtable);
+	}
+
+	/**
+	 * Reloads requested from the reload thread
+	 */
+	for (i = 0; i < RELOAD_COUNT; i++) {
+		if (wbk_kbtable_reload(g_kbtable))
+			exit(23);
+	}
+	usleep(100 * 1000);
+
+	__atomic_store_n(&g_running, 0, __ATOMIC_SEQ_CST);
+#if defined(WIN32)
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_join(thread, NULL);
+#endif
+
+	if (g_exec_count == 0 || g_miss_count != 0)
+		exit(24);
+
+	if (wbk_kbtable_reclaim(g_kbtable) != 0)
+		exit(25);
+
+	wbk_kbtable_free(g_kbtable);
+	g_kbtable = NULL;
+}
+
+int
+main(void)
+{
+	wbk_parser_t *parser;
+
+	parser = wbk_parser_new(RC_FILENAME);
+
+	test_load(parser);
+	test_mode_kept(parser);
+	test_limit_kept(parser);
+	test_reload_under_load(parser);
+
+	wbk_parser_free(parser);
+	remove(RC_FILENAME);
+
+	return 0;
+}
@@ -0,0 +1,254 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "parser.h"
+#include "kc_builtin.h"
+
+#define OUT_FILENAME "check_kc_builtin.out"
+
+static char g_arg[64];
+static int g_count = 0;
+
+static void
+sleep_ms(int ms)
+{
+#if defined(WIN32)
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+static int
+count_fn(const char *arg, void *param)
+{
+	strncpy(g_arg, arg, sizeof(g_arg) - 1);
+	g_count += *((int *) param);
+
+	return 0;
+}
+
+static int
+fail_fn(const char *arg, void *param)
+{
+	return 1;
+}
+
+static wbk_kc_builtin_t *
+new_kc(const char *binding, const char *cmd)
+{
+	char *copy;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+
+	return (wbk_kc_builtin_t *) wbk_parser_parse_kc(NULL, wbk_parser_parse_binding(binding), copy);
+}
+
+static void
+wait_done(wbk_kc_builtin_t *kc_builtin)
+{
+	int i;
+
+	for (i = 0; i < 200 && wbk_job_queued(kc_builtin->job); i++) {
+		sleep_ms(10);
+	}
+
+	if (wbk_job_queued(kc_builtin->job))
+		exit(99);
+}
+
+static void
+test_registry(void)
+{
+	static int step = 1;
+
+	if (wbk_builtin_register("count", count_fn, &step))
+		exit(1);
+
+	if (wbk_builtin_find("count", 5) == NULL || wbk_builtin_find("count me", 5) == NULL)
+		exit(2);
+
+	if (wbk_builtin_find("coun", 4) || wbk_builtin_find("nope", 4))
+		exit(3);
+
+	if (wbk_builtin_find("write", 5) == NULL || wbk_builtin_find("setenv", 6) == NULL)
+		exit(4);
+}
+
+static void
+test_exec(void)
+{
+	static int step = 1;
+	wbk_kc_builtin_t *kc_builtin;
+	wbk_kc_t *clone;
+	char *str;
+
+	kc_builtin = new_kc("mod4 + r", "\"@count  hello world \"");
+	if (kc_builtin == NULL || strcmp(wbk_kc_builtin_get_name(kc_builtin), "count")
+		|| strcmp(wbk_kc_builtin_get_arg(kc_builtin), "hello world"))
+		exit(10);
+
+	str = wbk_kc_to_str((wbk_kc_t *) kc_builtin);
+	if (strcmp(str, "\"@count hello world\""))
+		exit(11);
+	free(str);
+
+	if (wbk_kc_exec((wbk_kc_t *) kc_builtin))
+		exit(12);
+	wait_done(kc_builtin);
+	if (g_count != 1 || strcmp(g_arg, "hello world"))
+		exit(13);
+
+	clone = wbk_kc_clone((wbk_kc_t *) kc_builtin);
+	if (wbk_kc_compare(clone, (wbk_kc_t *) kc_builtin))
+		exit(14);
+	wbk_kc_exec(clone);
+	wait_done((wbk_kc_builtin_t *) clone);
+	if (g_count != 2)
+		exit(15);
+
+	wbk_kc_free(clone);
+	wbk_kc_free((wbk_kc_t *) kc_builtin);
+
+	kc_builtin = new_kc("mod4 + r", "\"@count\"");
+	str = wbk_kc_to_str((wbk_kc_t *) kc_builtin);
+	if (strcmp(str, "\"@count\""))
+		exit(16);
+	free(str);
+	wbk_kc_free((wbk_kc_t *) kc_builtin);
+
+	/**
+	 * Builtins starting with the name of a command are no such command
+	 */
+	if (wbk_builtin_register("ipcflush", count_fn, &step))
+		exit(17);
+	kc_builtin = new_kc("mod4 + r", "\"@ipcflush now\"");
+	if (kc_builtin == NULL || strcmp(wbk_kc_builtin_get_name(kc_builtin), "ipcflush")
+		|| strcmp(wbk_kc_builtin_get_arg(kc_builtin), "now"))
+		exit(18);
+	wbk_kc_free((wbk_kc_t *) kc_builtin);
+}
+
+static void
+test_write(void)
+{
+	wbk_kc_builtin_t *kc_builtin;
+	char line[16];
+	FILE *file;
+
+	kc_builtin = new_kc("f1", "\"@write " OUT_FILENAME " on\"");
+	wbk_kc_exec((wbk_kc_t *) kc_builtin);
+	wait_done(kc_builtin);
+	wbk_kc_free((wbk_kc_t *) kc_builtin);
+
+	file = fopen(OUT_FILENAME, "r");
+	if (file == NULL)
+		exit(20);
+
+	if (fgets(line, sizeof(line), file) == NULL || strcmp(line, "on\n"))
+		exit(21);
+
+	fclose(file);
+	remove(OUT_FILENAME);
+}
+
+static void
+test_setenv(void)
+{
+	wbk_kc_builtin_t *kc_builtin;
+	const char *value;
+
+	kc_builtin = new_kc("f2", "\"@setenv WBK_CHECK_KC_BUILTIN=dark\"");
+	wbk_kc_exec((wbk_kc_t *) kc_builtin);
+	wait_done(kc_builtin);
+	wbk_kc_free((wbk_kc_t *) kc_builtin);
+
+	value = getenv("WBK_CHECK_KC_BUILTIN");
+	if (value == NULL || strcmp(value, "dark"))
+		exit(30);
+
+	kc_builtin = new_kc("f2", "\"@setenv WBK_CHECK_KC_BUILTIN=\"");
+	wbk_kc_exec((wbk_kc_t *) kc_builtin);
+	wait_done(kc_builtin);
+	wbk_kc_free((wbk_kc_t *) kc_builtin);
+
+	value = getenv("WBK_CHECK_KC_BUILTIN");
+	if (value && value[0] != '\0')
+		exit(31);
+}
+
+static void
+test_no_executor(void)
+{
+	wbk_kc_builtin_t *kc_builtin;
+	wbk_executor_t *executor;
+
+	executor = wbk_executor_get_default();
+	wbk_executor_set_default(NULL);
+
+	/**
+	 * Without an executor the action runs on the calling thread
+	 */
+	kc_builtin = new_kc("f3", "\"@count now\"");
+	if (wbk_kc_exec((wbk_kc_t *) kc_builtin) || g_count != 3 || strcmp(g_arg, "now"))
+		exit(40);
+	wbk_kc_free((wbk_kc_t *) kc_builtin);
+
+	wbk_builtin_register("fail", fail_fn, NULL);
+	kc_builtin = new_kc("f3", "\"@fail\"");
+	if (wbk_kc_exec((wbk_kc_t *) kc_builtin) == 0)
+		exit(41);
+	wbk_kc_free((wbk_kc_t *) kc_builtin);
+
+	wbk_executor_set_default(executor);
+}
+
+int main(void)
+{
+	wbk_executor_t *executor;
+
+	executor = wbk_executor_new();
+	wbk_executor_set_default(executor);
+
+	test_registry();
+	test_exec();
+	test_write();
+	test_setenv();
+	test_no_executor();
+
+	wbk_executor_free(executor);
+
+	return 0;
+}
@@ -0,0 +1,290 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "kc_ipc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "parser.h"
+
+#if defined(WIN32)
+#define ADDRESS "\\\\.\\pipe\\check_kc_ipc"
+#else
+#define ADDRESS "check_kc_ipc.sock"
+#endif
+
+/**
+ * Milliseconds the stand-in consumer waits for a client or a frame
+ */
+#define TIMEOUT 3000
+
+/**
+ * A stand-in consumer reading frames
+ */
+#if defined(WIN32)
+typedef HANDLE conn_t;
+
+static HANDLE g_listen = INVALID_HANDLE_VALUE;
+
+static void
+server_start(void)
+{
+	g_listen = CreateNamedPipeA(ADDRESS, PIPE_ACCESS_INBOUND, PIPE_TYPE_BYTE | PIPE_WAIT,
+	                            PIPE_UNLIMITED_INSTANCES, 4096, 4096, 0, NULL);
+	if (g_listen == INVALID_HANDLE_VALUE)
+		exit(100);
+}
+
+static void
+server_stop(void)
+{
+	CloseHandle(g_listen);
+	g_listen = INVALID_HANDLE_VALUE;
+}
+
+static conn_t
+server_accept(void)
+{
+	HANDLE conn;
+
+	conn = g_listen;
+	if (!ConnectNamedPipe(conn, NULL) && GetLastError() != ERROR_PIPE_CONNECTED)
+		exit(101);
+
+	/**
+	 * The next client connects to a new instance
+	 */
+	server_start();
+
+	return conn;
+}
+
+static void
+server_close(conn_t conn)
+{
+	DisconnectNamedPipe(conn);
+	CloseHandle(conn);
+}
+
+static int
+server_read(conn_t conn, char *buffer, int length)
+{
+	DWORD read;
+	int done;
+
+	done = 0;
+	while (done < length && ReadFile(conn, buffer + done, length - done, &read, NULL)) {
+		done += read;
+	}
+
+	return done < length;
+}
+#else
+typedef int conn_t;
+
+static int g_listen = -1;
+
+static void
+server_start(void)
+{
+	struct sockaddr_un addr;
+
+	memset(&addr, 0, sizeof(struct sockaddr_un));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, ADDRESS);
+	unlink(ADDRESS);
+
+	g_listen = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (g_listen < 0
+	    || bind(g_listen, (struct sockaddr *) &addr, sizeof(struct sockaddr_un))
+	    || listen(g_listen, 4))
+		exit(100);
+}
+
+static void
+server_stop(void)
+{
+	close(g_listen);
+	g_listen = -1;
+	unlink(ADDRESS);
+}
+
+static conn_t
+server_accept(void)
+{
+	struct pollfd pfd;
+	int conn;
+
+	pfd.fd = g_listen;
+	pfd.events = POLLIN;
+	conn = poll(&pfd, 1, TIMEOUT) == 1 ? accept(g_listen, NULL, NULL) : -1;
+	if (conn < 0)
+		exit(101);
+
+	return conn;
+}
+
+static void
+server_close(conn_t conn)
+{
+	close(conn);
+}
+
+static int
+server_read(conn_t conn, char *buffer, int length)
+{
+	struct pollfd pfd;
+	ssize_t read_len;
+	int done;
+
+	pfd.fd = conn;
+	pfd.events = POLLIN;
+
+	done = 0;
+	read_len = 1;
+	while (done < length && read_len > 0 && poll(&pfd, 1, TIMEOUT) == 1) {
+		read_len = read(conn, buffer + done, length - done);
+		done += read_len > 0 ? read_len : 0;
+	}
+
+	return done < length;
+}
+#endif
+
+/**
+ * Reads a frame and compares it to a message
+ */
+static int
+expect_frame(conn_t conn, const char *message)
+{
+	unsigned char header[4];
+	char buffer[64];
+	int length;
+
+	if (server_read(conn, (char *) header, 4))
+		return 1;
+
+	length = header[0] | (header[1] << 8) | (header[2] << 16) | (header[3] << 24);
+	if (length != (int) strlen(message) || server_read(conn, buffer, length))
+		return 1;
+
+	return memcmp(buffer, message, length) != 0;
+}
+
+static wbk_kc_ipc_t *
+new_kc(const char *binding, const char *cmd)
+{
+	char *copy;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+
+	return (wbk_kc_ipc_t *) wbk_parser_parse_kc(NULL, wbk_parser_parse_binding(binding), copy);
+}
+
+int
+main(void)
+{
+	wbk_executor_t *executor;
+	wbk_kc_ipc_t *hello;
+	wbk_kc_ipc_t *bye;
+	conn_t conn;
+	char *str;
+
+	executor = wbk_executor_new();
+	wbk_executor_set_default(executor);
+
+	server_start();
+
+	hello = new_kc("mod4 + h", "\"@ipc " ADDRESS " hello\"");
+	bye = new_kc("mod4 + b", "\"@ipc  " ADDRESS "  good bye \"");
+	if (hello == NULL || bye == NULL
+		|| strcmp(wbk_kc_ipc_get_address(bye), ADDRESS)
+		|| strcmp(wbk_kc_ipc_get_message(bye), "good bye"))
+		exit(1);
+
+	str = wbk_kc_to_str((wbk_kc_t *) hello);
+	if (strcmp(str, "\"@ipc " ADDRESS " hello\""))
+		exit(2);
+	free(str);
+
+	/**
+	 * Commands sending to the same consumer share the connection
+	 */
+	if (hello->ipc != bye->ipc)
+		exit(3);
+
+	/**
+	 * A burst arrives in order
+	 */
+	if (wbk_kc_exec((wbk_kc_t *) hello) || wbk_kc_exec((wbk_kc_t *) hello)
+		|| wbk_kc_exec((wbk_kc_t *) bye))
+		exit(10);
+
+	conn = server_accept();
+	if (expect_frame(conn, "hello") || expect_frame(conn, "hello")
+		|| expect_frame(conn, "good bye"))
+		exit(11);
+
+	/**
+	 * The channel connects again once the consumer dropped the connection
+	 */
+	server_close(conn);
+	wbk_kc_exec((wbk_kc_t *) bye);
+	conn = server_accept();
+	if (expect_frame(conn, "good bye"))
+		exit(20);
+
+	/**
+	 * Messages wait while the consumer is away
+	 */
+	server_close(conn);
+	server_stop();
+	wbk_kc_exec((wbk_kc_t *) hello);
+	wbk_kc_exec((wbk_kc_t *) bye);
+	server_start();
+	conn = server_accept();
+	if (expect_frame(conn, "hello") || expect_frame(conn, "good bye"))
+		exit(30);
+
+	server_close(conn);
+	server_stop();
+
+	wbk_kc_free((wbk_kc_t *) hello);
+	wbk_kc_free((wbk_kc_t *) bye);
+	wbk_executor_free(executor);
+
+	return 0;
+}
@@ -0,0 +1,254 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "kc_macro.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "parser.h"
+
+#define MAX_EVENTS 128
+#define MAX_SENDS 16
+
+static wbk_sink_event_t g_sent[MAX_EVENTS];
+static int g_sent_len = 0;
+static int g_send_len[MAX_SENDS];
+static unsigned long g_send_time[MAX_SENDS];
+static int g_send_count = 0;
+
+static unsigned long
+now(void)
+{
+#if defined(WIN32)
+	return GetTickCount();
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000UL + now.tv_nsec / 1000000L;
+#endif
+}
+
+static void
+sleep_ms(int ms)
+{
+#if defined(WIN32)
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+static int
+record_send(wbk_sink_t *sink, const wbk_sink_batch_t *batch)
+{
+	if (g_send_count < MAX_SENDS && g_sent_len + batch->event_arr_len <= MAX_EVENTS) {
+		memcpy(g_sent + g_sent_len, batch->event_arr, sizeof(wbk_sink_event_t) * batch->event_arr_len);
+		g_sent_len += batch->event_arr_len;
+		g_send_len[g_send_count] = batch->event_arr_len;
+		g_send_time[g_send_count] = now();
+	}
+	g_send_count++;
+
+	return 0;
+}
+
+static void
+reset(void)
+{
+	g_sent_len = 0;
+	g_send_count = 0;
+}
+
+static wbk_kc_macro_t *
+new_kc(const char *binding, const char *cmd)
+{
+	char *copy;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+
+	return (wbk_kc_macro_t *) wbk_parser_parse_kc(NULL, wbk_parser_parse_binding(binding), copy);
+}
+
+static void
+wait_done(wbk_kc_macro_t *kc_macro)
+{
+	int i;
+
+	for (i = 0; i < 200 && wbk_job_queued(&(kc_macro->run->job)); i++) {
+		sleep_ms(10);
+	}
+
+	if (wbk_job_queued(&(kc_macro->run->job)))
+		exit(99);
+}
+
+static int
+sent(int i, wbk_mk_t modifier, char key, int pressed)
+{
+	return i < g_sent_len
+		&& g_sent[i].be.modifier == modifier
+		&& g_sent[i].be.key == key
+		&& g_sent[i].pressed == pressed;
+}
+
+static void
+test_macro(void)
+{
+	wbk_kc_macro_t *kc_macro;
+	char *str;
+
+	kc_macro = new_kc("mod4 + m", "\"@macro control + c; wait 50; type Hi; Return\"");
+	if (kc_macro == NULL || kc_macro->op_arr_len != 3)
+		exit(1);
+
+	str = wbk_kc_to_str((wbk_kc_t *) kc_macro);
+	if (strcmp(str, "\"@macro control + c; wait 50; type Hi; Return\""))
+		exit(2);
+	free(str);
+
+	reset();
+	if (wbk_kc_exec((wbk_kc_t *) kc_macro))
+		exit(3);
+
+	/**
+	 * Executing a running macro again is ignored
+	 */
+	if (wbk_kc_exec((wbk_kc_t *) kc_macro))
+		exit(4);
+	wait_done(kc_macro);
+
+	if (g_send_count != 2 || g_send_len[0] != 5 || g_send_len[1] != 9
+		|| g_send_time[1] - g_send_time[0] < 50)
+		exit(5);
+
+	if (!sent(0, WIN, '\0', 0) || !sent(1, CTRL, '\0', 1)
+		|| !sent(2, NOT_A_MODIFIER, 'c', 1) || !sent(3, NOT_A_MODIFIER, 'c', 0)
+		|| !sent(4, CTRL, '\0', 0)
+		|| !sent(5, SHIFT, '\0', 1) || !sent(6, NOT_A_MODIFIER, 'h', 1)
+		|| !sent(7, NOT_A_MODIFIER, 'h', 0) || !sent(8, SHIFT, '\0', 0)
+		|| !sent(9, NOT_A_MODIFIER, 'i', 1) || !sent(10, NOT_A_MODIFIER, 'i', 0)
+		|| !sent(11, ENTER, '\0', 1) || !sent(12, ENTER, '\0', 0)
+		|| !sent(13, WIN, '\0', 1))
+		exit(6);
+
+	/**
+	 * The macro can be run again once it is done
+	 */
+	reset();
+	wbk_kc_exec((wbk_kc_t *) kc_macro);
+	wait_done(kc_macro);
+	if (g_send_count != 2)
+		exit(7);
+
+	wbk_kc_free((wbk_kc_t *) kc_macro);
+}
+
+static void
+test_stream(void)
+{
+	wbk_kc_macro_t *kc_macro;
+
+	/**
+	 * 26 letters pressed and released are streamed in two batches
+	 */
+	kc_macro = new_kc("f1", "\"@macro type abcdefghijklmnopqrstuvwxyz\"");
+	reset();
+	wbk_kc_exec((wbk_kc_t *) kc_macro);
+	wait_done(kc_macro);
+	if (g_send_count != 2 || g_send_len[0] != WBK_KC_MACRO_BATCH_LEN
+		|| g_send_len[0] + g_send_len[1] != 52)
+		exit(10);
+
+	wbk_kc_free((wbk_kc_t *) kc_macro);
+}
+
+static void
+test_cancel(void)
+{
+	wbk_kc_macro_t *kc_macro;
+
+	kc_macro = new_kc("f2", "\"@macro a; wait 1000; b\"");
+	reset();
+	wbk_kc_exec((wbk_kc_t *) kc_macro);
+	sleep_ms(50);
+
+	/**
+	 * Freeing cancels the delayed rest of the macro
+	 */
+	wbk_kc_free((wbk_kc_t *) kc_macro);
+	sleep_ms(50);
+	if (g_send_count != 1)
+		exit(20);
+}
+
+static void
+test_no_executor(void)
+{
+	wbk_kc_macro_t *kc_macro;
+	wbk_executor_t *executor;
+
+	executor = wbk_executor_get_default();
+	wbk_executor_set_default(NULL);
+
+	kc_macro = new_kc("f3", "\"@macro a\"");
+	if (wbk_kc_exec((wbk_kc_t *) kc_macro) == 0)
+		exit(30);
+	wbk_kc_free((wbk_kc_t *) kc_macro);
+
+	wbk_executor_set_default(executor);
+}
+
+int main(void)
+{
+	wbk_sink_t *sink;
+	wbk_executor_t *executor;
+
+	sink = wbk_sink_new();
+	sink->sink_send = record_send;
+	wbk_sink_set_default(sink);
+
+	executor = wbk_executor_new();
+	wbk_executor_set_default(executor);
+
+	test_macro();
+	test_stream();
+	test_cancel();
+	test_no_executor();
+
+	wbk_executor_free(executor);
+	wbk_sink_free(sink);
+
+	return 0;
+}
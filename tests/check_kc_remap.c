@@ -0,0 +1,229 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "kc_remap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "parser.h"
+
+#define MAX_EVENTS 16
+
+static int g_prepare_count = 0;
+static int g_send_count = 0;
+static wbk_sink_event_t g_sent[MAX_EVENTS];
+static int g_sent_len = 0;
+
+static int
+record_prepare(wbk_sink_t *sink, wbk_sink_batch_t *batch)
+{
+	g_prepare_count++;
+	return batch->event_arr_len > MAX_EVENTS;
+}
+
+static int
+record_send(wbk_sink_t *sink, const wbk_sink_batch_t *batch)
+{
+	g_send_count++;
+	memcpy(g_sent, batch->event_arr, sizeof(wbk_sink_event_t) * batch->event_arr_len);
+	g_sent_len = batch->event_arr_len;
+
+	return 0;
+}
+
+static wbk_kc_t *
+new_kc(const char *binding, const char *cmd)
+{
+	char *copy;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+
+	return wbk_parser_parse_kc(NULL, wbk_parser_parse_binding(binding), copy);
+}
+
+static int
+sent(int i, wbk_mk_t modifier, char key, int pressed)
+{
+	return i < g_sent_len
+		&& g_sent[i].be.modifier == modifier
+		&& g_sent[i].be.key == key
+		&& g_sent[i].pressed == pressed;
+}
+
+static void
+test_remap(void)
+{
+	wbk_kc_t *kc;
+	wbk_kc_t *clone;
+	wbk_kc_t *other;
+	char *str;
+
+	kc = new_kc("mod4 + h", "\"@remap Left\"");
+	if (kc == NULL || g_prepare_count != 1)
+		exit(1);
+
+	str = wbk_kc_to_str(kc);
+	if (strcmp(str, "\"@remap Left\""))
+		exit(2);
+	free(str);
+
+	/**
+	 * Mod4 is still held. It must not be combined with the replacement.
+	 */
+	if (wbk_kc_exec(kc) || wbk_kc_exec(kc))
+		exit(3);
+	if (g_send_count != 2 || g_prepare_count != 1 || g_sent_len != 4
+		|| !sent(0, WIN, '\0', 0) || !sent(1, LEFT, '\0', 1)
+		|| !sent(2, LEFT, '\0', 0) || !sent(3, WIN, '\0', 1))
+		exit(4);
+
+	clone = wbk_kc_clone(kc);
+	other = new_kc("mod4 + h", "\"@remap Right\"");
+	if (wbk_kc_compare(kc, clone) != 0 || wbk_kc_compare(kc, other) == 0)
+		exit(5);
+
+	wbk_kc_free(other);
+	wbk_kc_free(clone);
+	wbk_kc_free(kc);
+}
+
+static void
+test_modifiers(void)
+{
+	wbk_kc_t *kc;
+
+	/**
+	 * Shared modifiers stay pressed
+	 */
+	kc = new_kc("control + h", "\"@remap control + left\"");
+	wbk_kc_exec(kc);
+	if (g_sent_len != 2 || !sent(0, LEFT, '\0', 1) || !sent(1, LEFT, '\0', 0))
+		exit(10);
+	wbk_kc_free(kc);
+
+	kc = new_kc("mod4 + x", "\"@remap control + c\"");
+	wbk_kc_exec(kc);
+	if (g_sent_len != 6
+		|| !sent(0, WIN, '\0', 0) || !sent(1, CTRL, '\0', 1)
+		|| !sent(2, NOT_A_MODIFIER, 'c', 1) || !sent(3, NOT_A_MODIFIER, 'c', 0)
+		|| !sent(4, CTRL, '\0', 0) || !sent(5, WIN, '\0', 1))
+		exit(11);
+	wbk_kc_free(kc);
+
+	/**
+	 * F1 does not modify other keys, so it is not pressed again
+	 */
+	kc = new_kc("f1", "\"@remap Left\"");
+	wbk_kc_exec(kc);
+	if (g_sent_len != 2 || !sent(0, LEFT, '\0', 1) || !sent(1, LEFT, '\0', 0))
+		exit(12);
+	wbk_kc_free(kc);
+
+	/**
+	 * Only the held side is released. It is kept if the replacement holds
+	 * the generic modifier.
+	 */
+	kc = new_kc("ralt + h", "\"@remap Left\"");
+	wbk_kc_exec(kc);
+	if (g_sent_len != 4
+		|| !sent(0, RALT, '\0', 0) || !sent(1, LEFT, '\0', 1)
+		|| !sent(2, LEFT, '\0', 0) || !sent(3, RALT, '\0', 1))
+		exit(13);
+	wbk_kc_free(kc);
+
+	kc = new_kc("ralt + h", "\"@remap mod1 + left\"");
+	wbk_kc_exec(kc);
+	if (g_sent_len != 2 || !sent(0, LEFT, '\0', 1) || !sent(1, LEFT, '\0', 0))
+		exit(14);
+	wbk_kc_free(kc);
+}
+
+static void
+test_hold(void)
+{
+	wbk_kc_t *kc;
+	int send_count;
+
+	/**
+	 * Control is pressed by the hold and released by its end
+	 */
+	kc = new_kc("hold + capslock", "\"@remap control\"");
+	if (wbk_kc_exec(kc) || g_sent_len != 1 || !sent(0, CTRL, '\0', 1))
+		exit(30);
+	if (wbk_kc_exec_end(kc) || g_sent_len != 1 || !sent(0, CTRL, '\0', 0))
+		exit(31);
+	wbk_kc_free(kc);
+
+	/**
+	 * Other replacements are tapped at once and have nothing to end
+	 */
+	kc = new_kc("hold + capslock", "\"@remap escape\"");
+	wbk_kc_exec(kc);
+	send_count = g_send_count;
+	if (g_sent_len != 2 || !sent(0, ESCAPE, '\0', 1) || !sent(1, ESCAPE, '\0', 0)
+		|| wbk_kc_exec_end(kc) || g_send_count != send_count)
+		exit(32);
+	wbk_kc_free(kc);
+
+	kc = new_kc("capslock", "\"@remap control\"");
+	wbk_kc_exec(kc);
+	send_count = g_send_count;
+	if (g_sent_len != 2 || wbk_kc_exec_end(kc) || g_send_count != send_count)
+		exit(33);
+	wbk_kc_free(kc);
+}
+
+static void
+test_no_sink(void)
+{
+	wbk_kc_t *kc;
+
+	wbk_sink_set_default(NULL);
+
+	kc = new_kc("mod4 + h", "\"@remap Left\"");
+	if (kc == NULL || wbk_kc_exec(kc) == 0)
+		exit(20);
+	wbk_kc_free(kc);
+}
+
+int main(void)
+{
+	wbk_sink_t *sink;
+
+	sink = wbk_sink_new();
+	sink->sink_prepare = record_prepare;
+	sink->sink_send = record_send;
+	wbk_sink_set_default(sink);
+
+	test_remap();
+	test_modifiers();
+	test_hold();
+	test_no_sink();
+
+	wbk_sink_free(sink);
+
+	return 0;
+}
@@ -0,0 +1,132 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "launcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "kc_sys.h"
+#include "parser.h"
+
+#define OUT_FILENAME "check_launcher.out"
+
+/**
+ * Waits until a started process wrote a file and compares its first line.
+ */
+static int
+expect_file(const char *filename, const char *line)
+{
+	char buffer[64];
+	FILE *file;
+	int i;
+	int error;
+
+	file = NULL;
+	for (i = 0; i < 300 && file == NULL; i++) {
+		if (access(filename, F_OK) == 0) {
+			/**
+			 * Give the writer time to finish
+			 */
+			usleep(20000);
+			file = fopen(filename, "r");
+		} else {
+			usleep(10000);
+		}
+	}
+
+	error = file == NULL;
+	if (file) {
+		error = line && (fgets(buffer, sizeof(buffer), file) == NULL || strcmp(buffer, line));
+		fclose(file);
+	}
+	remove(filename);
+
+	return error;
+}
+
+int
+main(void)
+{
+	wbk_launcher_t *launcher;
+	wbk_kc_t *kc;
+	char *cmd;
+
+	remove(OUT_FILENAME);
+
+	launcher = wbk_launcher_new();
+	if (launcher == NULL)
+		exit(1);
+
+	/**
+	 * A plain command is started without a shell
+	 */
+	if (wbk_launcher_spawn(launcher, "touch " OUT_FILENAME))
+		exit(10);
+	if (expect_file(OUT_FILENAME, NULL))
+		exit(11);
+
+	/**
+	 * Shell syntax and the quotes of the rc file
+	 */
+	if (wbk_launcher_spawn(launcher, "\"echo hello > " OUT_FILENAME "\""))
+		exit(20);
+	if (expect_file(OUT_FILENAME, "hello\n"))
+		exit(21);
+
+	/**
+	 * The environment of the started processes
+	 */
+	if (wbk_launcher_setenv(launcher, "WBK_CHECK_LAUNCHER=dark"))
+		exit(30);
+	wbk_launcher_spawn(launcher, "echo $WBK_CHECK_LAUNCHER > " OUT_FILENAME);
+	if (expect_file(OUT_FILENAME, "dark\n"))
+		exit(31);
+
+	/**
+	 * A missing executable only fails within the helper
+	 */
+	if (wbk_launcher_spawn(launcher, "wbk-check-launcher-missing"))
+		exit(40);
+
+	/**
+	 * System commands use the default launcher
+	 */
+	wbk_launcher_set_default(launcher);
+	cmd = malloc(sizeof(char) * 64);
+	strcpy(cmd, "\"touch " OUT_FILENAME "\"");
+	kc = (wbk_kc_t *) wbk_kc_sys_new(wbk_parser_parse_binding("mod4 + t"), cmd);
+	if (wbk_kc_exec(kc))
+		exit(50);
+	if (expect_file(OUT_FILENAME, NULL))
+		exit(51);
+	wbk_kc_free(kc);
+	wbk_launcher_set_default(NULL);
+
+	wbk_launcher_free(launcher);
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "launcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "kc_sys.h"
+#include "launcher.h"
+#include "limit.h"
+#include "parser.h"
+
+/**
+ * Waits until a number of processes of a concurrency limit are running.
+ */
+static int
+expect_running(wbk_limit_t *limit, int running)
+{
+	int i;
+
+	for (i = 0; i < 300 && wbk_limit_get_running(limit) != running; i++) {
+		usleep(10000);
+	}
+
+	return wbk_limit_get_running(limit) != running;
+}
+
+static wbk_kc_sys_t *
+parse_kc_sys(const char *cmd)
+{
+	char *copy;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+
+	return (wbk_kc_sys_t *) wbk_parser_parse_kc(NULL, wbk_parser_parse_binding("mod4 + t"), copy);
+}
+
+int
+main(void)
+{
+	wbk_launcher_t *launcher;
+	wbk_limit_t *limit;
+	wbk_kc_sys_t *kc_sys;
+	wbk_kc_t *clone;
+	char *str;
+
+	/**
+	 * Admitting
+	 */
+	limit = wbk_limit_new(WBK_LIMIT_SKIP, 2);
+	if (wbk_limit_acquire(limit) != WBK_LIMIT_ADMIT || wbk_limit_acquire(limit) != WBK_LIMIT_ADMIT)
+		exit(1);
+	if (wbk_limit_acquire(limit) != WBK_LIMIT_DENY || wbk_limit_get_running(limit) != 2)
+		exit(2);
+	wbk_limit_release(limit);
+	if (wbk_limit_acquire(limit) != WBK_LIMIT_ADMIT)
+		exit(3);
+	wbk_limit_release(limit);
+	wbk_limit_release(limit);
+	wbk_limit_free(limit);
+
+	limit = wbk_limit_new(WBK_LIMIT_RESTART, 1);
+	if (wbk_limit_acquire(limit) != WBK_LIMIT_ADMIT || wbk_limit_acquire(limit) != WBK_LIMIT_ADMIT_RESTART)
+		exit(4);
+	wbk_limit_release(limit);
+	wbk_limit_release(limit);
+	wbk_limit_free(limit);
+
+	/**
+	 * The options of the rc file
+	 */
+	kc_sys = parse_kc_sys("\"sleep 0.3\" max_concurrent=2 restart");
+	limit = wbk_kc_sys_get_limit(kc_sys);
+	if (limit == NULL || limit->max != 2 || limit->policy != WBK_LIMIT_RESTART)
+		exit(10);
+	if (strcmp(wbk_kc_sys_get_cmd(kc_sys), "\"sleep 0.3\""))
+		exit(11);
+	str = wbk_kc_to_str((wbk_kc_t *) kc_sys);
+	if (strcmp(str, "\"sleep 0.3\" max_concurrent=2 restart"))
+		exit(12);
+	free(str);
+	clone = wbk_kc_clone((wbk_kc_t *) kc_sys);
+	if (wbk_kc_compare(clone, (wbk_kc_t *) kc_sys) || wbk_kc_sys_get_limit((wbk_kc_sys_t *) clone) != limit)
+		exit(13);
+	wbk_kc_free(clone);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	kc_sys = parse_kc_sys("\"sleep 0.3\"");
+	if (wbk_kc_sys_get_limit(kc_sys))
+		exit(14);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	launcher = wbk_launcher_new();
+	if (launcher == NULL)
+		exit(20);
+	wbk_launcher_set_default(launcher);
+
+	/**
+	 * Triggers are skipped while the process runs and admitted again once
+	 * its exit was reported
+	 */
+	kc_sys = parse_kc_sys("\"sleep 0.3\" skip-if-running");
+	limit = wbk_kc_sys_get_limit(kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (wbk_limit_get_running(limit) != 1)
+		exit(30);
+	if (expect_running(limit, 0))
+		exit(31);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (wbk_limit_get_running(limit) != 1)
+		exit(32);
+	if (expect_running(limit, 0))
+		exit(33);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	/**
+	 * Missing executables are released at once
+	 */
+	kc_sys = parse_kc_sys("\"wbk-check-limit-missing\" skip-if-running");
+	limit = wbk_kc_sys_get_limit(kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (expect_running(limit, 0))
+		exit(40);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	/**
+	 * Restarting terminates the running process
+	 */
+	kc_sys = parse_kc_sys("\"sleep 30\" restart");
+	limit = wbk_kc_sys_get_limit(kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	wbk_kc_exec((wbk_kc_t *) kc_sys);
+	if (expect_running(limit, 1))
+		exit(50);
+	wbk_limit_kill(limit);
+	if (expect_running(limit, 0))
+		exit(51);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	wbk_launcher_set_default(NULL);
+	wbk_launcher_free(launcher);
+
+	return 0;
+}
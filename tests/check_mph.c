@@ -0,0 +1,142 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "launcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mph.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BINDINGS 3000
+
+static wbk_b_t *
+new_binding(int i)
+{
+	wbk_b_t *b;
+	wbk_be_t be;
+
+	b = wbk_b_new();
+
+	be.modifier = WIN + i % 8;
+	be.key = '\0';
+	wbk_b_add(b, &be);
+
+	be.modifier = NOT_A_MODIFIER;
+	be.key = 'a' + i / 8 % 26;
+	wbk_b_add(b, &be);
+
+	be.key = '0' + i / 8 / 26 % 10;
+	wbk_b_add(b, &be);
+
+	b->trigger = i / 8 / 26 / 10 % 2 ? TRIGGER_HOLD : TRIGGER_PRESS;
+
+	return b;
+}
+
+int
+test_hash(int len)
+{
+	wbk_mph_t *mph;
+	wbk_b_t **b_arr;
+	int *values;
+	char *seen;
+	wbk_b_t *b;
+	int value;
+	int i;
+
+	b_arr = malloc(sizeof(wbk_b_t *) * (len + 1));
+	values = malloc(sizeof(int) * (len + 1));
+	seen = calloc(len + 1, sizeof(char));
+
+	for (i = 0; i < len; i++) {
+		b_arr[i] = new_binding(i);
+		values[i] = i;
+	}
+
+	mph = wbk_mph_new((const wbk_b_t **) b_arr, values, len);
+	if (mph == NULL)
+		exit(1);
+
+	/**
+	 * Each binding gets its own slot
+	 */
+	for (i = 0; i < len; i++) {
+		b = wbk_b_clone(b_arr[i]);
+		value = wbk_mph_find(mph, b);
+		if (value != i || seen[value])
+			exit(2);
+		seen[value] = 1;
+		wbk_b_free(b);
+	}
+
+	/**
+	 * Unknown bindings get a candidate, which does not compare equal
+	 */
+	b = new_binding(len);
+	value = wbk_mph_find(mph, b);
+	if (len == 0 ? value != -1 : value < 0 || value >= len
+	    || wbk_b_compare(b_arr[value], b) == 0)
+		exit(3);
+	wbk_b_free(b);
+
+	wbk_mph_free(mph);
+	for (i = 0; i < len; i++) {
+		wbk_b_free(b_arr[i]);
+	}
+	free(b_arr);
+	free(values);
+	free(seen);
+
+	return 0;
+}
+
+int main(void)
+{
+	wbk_b_t *b;
+	wbk_b_t *other;
+
+	/**
+	 * Equal bindings hash equally, the key range is part of the hash
+	 */
+	b = new_binding(42);
+	other = wbk_b_clone(b);
+	if (wbk_mph_hash(b) != wbk_mph_hash(other))
+		exit(10);
+	other->key_last = 'z';
+	if (wbk_mph_hash(b) == wbk_mph_hash(other))
+		exit(11);
+	wbk_b_free(b);
+	wbk_b_free(other);
+
+	test_hash(0);
+	test_hash(1);
+	test_hash(7);
+	test_hash(BINDINGS);
+
+	return 0;
+}
@@ -0,0 +1,127 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+#include "launcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tmpl.h"
+#include "kc_sys.h"
+#include "parser.h"
+
+/**
+ * Compiles and expands a command.
+ */
+static int
+expect_expansion(const char *cmd, const char *key, int slots, const char *expansion)
+{
+	char buffer[WBK_TMPL_EXPAND_LEN];
+	wbk_tmpl_t *tmpl;
+	int error;
+
+	tmpl = wbk_tmpl_new(cmd);
+	error = tmpl->slots != slots
+	        || wbk_tmpl_expand(tmpl, key, buffer, WBK_TMPL_EXPAND_LEN) != (int) strlen(expansion)
+	        || strcmp(buffer, expansion);
+	wbk_tmpl_free(tmpl);
+
+	return error;
+}
+
+static wbk_kc_sys_t *
+parse_kc_sys(const char *binding, const char *cmd)
+{
+	char *copy;
+
+	copy = malloc(sizeof(char) * (strlen(cmd) + 1));
+	strcpy(copy, cmd);
+
+	return (wbk_kc_sys_t *) wbk_parser_parse_kc(NULL, wbk_parser_parse_binding(binding), copy);
+}
+
+int
+main(void)
+{
+	char buffer[WBK_TMPL_EXPAND_LEN];
+	char expansion[WBK_TMPL_EXPAND_LEN];
+	wbk_tmpl_t *tmpl;
+	wbk_kc_sys_t *kc_sys;
+
+	/**
+	 * Slots and literals
+	 */
+	if (expect_expansion("\"launcher --workspace=%key%\"", "3", 1, "\"launcher --workspace=3\""))
+		exit(1);
+	if (expect_expansion("%key%%key%", "a", 2, "aa"))
+		exit(2);
+	if (expect_expansion("\"plain\"", "a", 0, "\"plain\""))
+		exit(3);
+	if (expect_expansion("100%% done", "a", 0, "100% done"))
+		exit(4);
+	if (expect_expansion("50% of %key%", "x", 1, "50% of x"))
+		exit(5);
+	if (expect_expansion("%no closing", "x", 0, "%no closing"))
+		exit(6);
+	if (expect_expansion("% %key%", "x", 1, "% x"))
+		exit(7);
+
+	/**
+	 * Environment variables are read when the template is expanded
+	 */
+	sprintf(expansion, "%s/bin", getenv("PATH"));
+	if (expect_expansion("%PATH%/bin", "x", 1, expansion))
+		exit(10);
+	if (expect_expansion("[%WBK_CHECK_TMPL_UNSET%]", "x", 1, "[]"))
+		exit(11);
+
+	/**
+	 * Expanding into a too small buffer fails
+	 */
+	tmpl = wbk_tmpl_new("0123456789%key%");
+	if (wbk_tmpl_expand(tmpl, "a", buffer, 11) != -1 || buffer[0] != '\0')
+		exit(20);
+	if (wbk_tmpl_expand(tmpl, "a", buffer, 12) != 11)
+		exit(21);
+	wbk_tmpl_free(tmpl);
+
+	/**
+	 * System commands compile their templates once
+	 */
+	kc_sys = parse_kc_sys("mod4 + w", "\"launcher --workspace=%key%\"");
+	if (kc_sys->tmpl == NULL || strcmp(wbk_kc_sys_get_cmd(kc_sys), "\"launcher --workspace=%key%\""))
+		exit(30);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	kc_sys = parse_kc_sys("mod4 + w", "\"launcher --workspace=1\"");
+	if (kc_sys->tmpl)
+		exit(31);
+	wbk_kc_free((wbk_kc_t *) kc_sys);
+
+	return 0;
+}
@@ -0,0 +1,175 @@
+/******************************************************************************
+  This file is part of w32bindkeys.
+
+  Copyright 2020 Richard Paul Baeck <richard.baeck@mailbox.org>
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*******************************************************************************/
+
+
+
+#include "twheel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TIMER_ARR_LEN 500
+
+#define ROUNDS 20000
+
+typedef struct check_timer_s
+{
+	wbk_timer_t timer;
+	unsigned long expires;
+	int fired;
+} check_timer_t;
+
+static wbk_twheel_t *g_twheel = NULL;
+
+static void
+expire_fn(wbk_timer_t *timer, void *param)
+{
+	check_timer_t *check_timer;
+
+	check_timer = (check_timer_t *) param;
+
+	/**
+	 * Timers must neither expire early nor late
+	 */
+	if (wbk_twheel_get_time(g_twheel) != check_timer->expires)
+		exit(1);
+
+	check_timer->fired++;
+}
+
+static void
+test_simple(void)
+{
+	check_timer_t check_timer;
+	unsigned long timeout;
+
+	g_twheel = wbk_twheel_new(1000);
+	wbk_timer_init(&(check_timer.timer), expire_fn, &check_timer);
+	check_timer.fired = 0;
+
+	if (wbk_twheel_next_timeout(g_twheel, &timeout) == 0)
+		exit(10);
+
+	check_timer.expires = 1200;
+	wbk_timer_start(g_twheel, &(check_timer.timer), 200);
+	if (!wbk_timer_pending(&(check_timer.timer)))
+		exit(11);
+
+	if (wbk_twheel_next_timeout(g_twheel, &timeout) || timeout != 200)
+		exit(12);
+
+	wbk_twheel_advance(g_twheel, 1199);
+	if (check_timer.fired != 0)
+		exit(13);
+
+	wbk_twheel_advance(g_twheel, 1500);
+	if (check_timer.fired != 1 || wbk_timer_pending(&(check_timer.timer)))
+		exit(14);
+
+	/**
+	 * Cancelled timers do not fire
+	 */
+	check_timer.expires = 1600;
+	wbk_timer_start(g_twheel, &(check_timer.timer), 100);
+	wbk_timer_cancel(g_twheel, &(check_timer.timer));
+	wbk_twheel_advance(g_twheel, 2000);
+	if (check_timer.fired != 1)
+		exit(15);
+
+	/**
+	 * Time going backwards is ignored
+	 */
+	wbk_twheel_advance(g_twheel, 10);
+	if (wbk_twheel_get_time(g_twheel) != 2000)
+		exit(16);
+
+	wbk_twheel_free(g_twheel);
+}
+
+static void
+test_random(void)
+{
+	check_timer_t *check_timer_arr;
+	unsigned long time;
+	unsigned long timeout;
+	int i;
+	int j;
+
+	srand(1);
+
+	check_timer_arr = malloc(sizeof(check_timer_t) * TIMER_ARR_LEN);
+	for (i = 0; i < TIMER_ARR_LEN; i++) {
+		wbk_timer_init(&(check_timer_arr[i].timer), expire_fn, &(check_timer_arr[i]));
+		check_timer_arr[i].fired = 0;
+	}
+
+	time = 4294960000UL;
+	g_twheel = wbk_twheel_new(time);
+
+	for (i = 0; i < ROUNDS; i++) {
+		j = rand() % TIMER_ARR_LEN;
+
+		switch (rand() % 3) {
+		case 0:
+			/**
+			 * Mostly short timeouts, some of them beyond the first levels
+			 */
+			timeout = 1 + (rand() % 4 ? rand() % 500 : rand() % 5000000);
+			check_timer_arr[j].expires = wbk_twheel_get_time(g_twheel) + timeout;
+			wbk_timer_start(g_twheel, &(check_timer_arr[j].timer), timeout);
+			break;
+
+		case 1:
+			wbk_timer_cancel(g_twheel, &(check_timer_arr[j].timer));
+			break;
+
+		default:
+			time += rand() % 300;
+			wbk_twheel_advance(g_twheel, time);
+		}
+	}
+
+	/**
+	 * All pending timers fire eventually
+	 */
+	wbk_twheel_advance(g_twheel, time + 5000000);
+	for (i = 0; i < TIMER_ARR_LEN; i++) {
+		if (wbk_timer_pending(&(check_timer_arr[i].timer)))
+			exit(20);
+	}
+
+	if (g_twheel->count != 0)
+		exit(21);
+
+	wbk_twheel_free(g_twheel);
+	free(check_timer_arr);
+}
+
+int main(void)
+{
+	test_simple();
+	test_random();
+
+	return 0;
+}